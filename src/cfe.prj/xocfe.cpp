@@ -25,40 +25,111 @@ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
 OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
 USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 @*/
+#include <chrono>
+#include <thread>
+#ifndef _ON_WINDOWS_
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#endif
 #include "../cfe/cfeinc.h"
 #include "../cfe/cfecommacro.h"
 
 static CHAR const* g_c_file_name = nullptr;
 static CHAR const* g_dump_file_name = nullptr;
+static CHAR const* g_summary_file_name = nullptr;
+static bool g_verify_fused_sema = false;
+
+//Set to true if only the declarations are parsed and dumped, the function
+//bodies are skipped by lazy parsing.
+static bool g_is_decl_only = false;
+
+//The path of the Unix socket that compile server listens on.
+static CHAR const* g_server_sock_name = nullptr;
+
+//The path of the Unix socket that client connects to.
+static CHAR const* g_client_sock_name = nullptr;
+
+//Set to true if the request asks compile server to exit.
+static bool g_is_shutdown = false;
+
+//Set to true if source files are compiled in batch mode, namely, there are
+//several source files or the files are given by response file.
+static bool g_is_batch = false;
+
+//Record the source files to be compiled in order.
+static xcom::Vector<CHAR const*> g_c_file_vec;
+
+//Record the content of response files, the names of source file refer to
+//the buffers.
+static xcom::List<CHAR*> g_response_buf_list;
+
+//Dump function definition 'dcl' that compiled in streaming mode.
+static void dumpFuncDef(Decl * dcl)
+{
+    note(g_logmgr, "\nFUNCTION:");
+    g_logmgr->incIndent(2);
+    dump_declaration(dcl, (UINT)-1);
+    g_logmgr->decIndent(2);
+}
+
 
 UINT FrontEnd(xoc::LogMgr * lm, CParser & parser)
 {
     initTypeTran();
 
     STATUS s = ST_SUCC;
+    if (g_enable_stream_func) {
+        //Each function is compiled and dumped as soon as it is parsed, the
+        //dump of global scope at last does not contain function body.
+        s = performFuncStream(parser, dumpFuncDef);
+        if (s != ST_SUCC) {
+            return s;
+        }
+        get_global_scope()->dump();
+        return ST_SUCC;
+    }
+
     s = parser.perform();
     if (s != ST_SUCC) {
         return s;
     }
+    if (g_is_decl_only) {
+        get_global_scope()->dump();
+        return ST_SUCC;
+    }
 
     s = processDeclInit();
     if (s != ST_SUCC) {
         return s;
     }
-
-    s = TypeTransform();
-    if (s != ST_SUCC) {
-        return s;
+    if (g_enable_lazy_fun_body && g_err_msg_list.has_msg()) {
+        //The function bodies are parsed on demand by processDeclInit().
+        return ST_ERR;
     }
 
-    s = TypeCheck();
-    if (s != ST_SUCC) {
-        return s;
-    }
+    if (g_enable_fused_sema) {
+        s = FusedSemanticPass();
+        if (s != ST_SUCC) {
+            return s;
+        }
+    } else {
+        s = TypeTransform();
+        if (s != ST_SUCC) {
+            return s;
+        }
 
-    s = TreeCanonicalize();
-    if (s != ST_SUCC) {
-        return s;
+        s = TypeCheck();
+        if (s != ST_SUCC) {
+            return s;
+        }
+
+        s = TreeCanonicalize();
+        if (s != ST_SUCC) {
+            return s;
+        }
     }
     //Show you all info that generated by CfrontEnd.
     get_global_scope()->dump();
@@ -66,6 +137,219 @@ UINT FrontEnd(xoc::LogMgr * lm, CParser & parser)
 }
 
 
+//Compile file 'fn', and write the dump and the diagnostics into 'h'.
+static void compileInto(CHAR const* fn, FILE * h)
+{
+    CompileCtx ctx;
+    LogMgr * lm = new LogMgr();
+    lm->push(h, nullptr);
+    {
+        CParser parser(&ctx, lm, fn);
+        FrontEnd(lm, parser);
+        show_err(h, fn);
+        show_warn(h, fn);
+    }
+    lm->pop();
+    delete lm;
+}
+
+
+//Compile source file 'fn' by the separate semantic passes and by the fused
+//semantic pass respectively, then compare the dumps and the diagnostics.
+//The verdict is written into 'out'.
+//Return true if the results are identical.
+static bool verifyFusedSema(CHAR const* fn, FILE * out)
+{
+    FILE * ref = ::tmpfile();
+    FILE * fused = ::tmpfile();
+    if (ref == nullptr || fused == nullptr) {
+        fprintf(stderr, "\ncan not create temporary file, errno:%d\n", errno);
+        return false;
+    }
+    bool org = g_enable_fused_sema;
+    g_enable_fused_sema = false;
+    compileInto(fn, ref);
+    g_enable_fused_sema = true;
+    compileInto(fn, fused);
+    g_enable_fused_sema = org;
+
+    ::rewind(ref);
+    ::rewind(fused);
+    UINT lineno = 1;
+    INT c1 = EOF;
+    INT c2 = EOF;
+    do {
+        c1 = ::fgetc(ref);
+        c2 = ::fgetc(fused);
+        if (c1 != c2) { break; }
+        if (c1 == '\n') { lineno++; }
+    } while (c1 != EOF);
+    ::fclose(ref);
+    ::fclose(fused);
+    if (c1 != c2) {
+        fprintf(out, "\n%s - fused semantic pass differs from separate "
+                "passes at line %u of dump\n", fn, lineno);
+        return false;
+    }
+    fprintf(out, "\n%s - fused semantic pass is identical to separate "
+            "passes\n", fn);
+    return true;
+}
+
+
+//Read the source file in background to bring its content into page
+//cache, thus the lexer does not wait for IO when it starts to scan the
+//file.
+class SrcFilePrefetcher {
+    COPY_CONSTRUCTOR(SrcFilePrefetcher);
+    std::thread m_thread;
+protected:
+    static void readFile(CHAR const* fn);
+public:
+    SrcFilePrefetcher() {}
+    ~SrcFilePrefetcher() { wait(); }
+
+    void start(CHAR const* fn)
+    {
+        wait();
+        m_thread = std::thread(readFile, fn);
+    }
+
+    //Wait until the file that started has been read.
+    void wait()
+    {
+        if (m_thread.joinable()) { m_thread.join(); }
+    }
+};
+
+
+void SrcFilePrefetcher::readFile(CHAR const* fn)
+{
+    FILE * h = ::fopen(fn, "rb");
+    if (h == nullptr) { return; }
+    CHAR buf[16384];
+    while (::fread(buf, 1, sizeof(buf), h) == sizeof(buf)) {}
+    ::fclose(h);
+}
+
+
+//Return the microseconds of monotonic clock.
+static ULONGLONG get_usec()
+{
+    return (ULONGLONG)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+//Record the result of compiling one source file in batch mode.
+#define BATCH_RES_file_name(r) ((r)->file_name)
+#define BATCH_RES_status(r) ((r)->status)
+#define BATCH_RES_err_num(r) ((r)->err_num)
+#define BATCH_RES_warn_num(r) ((r)->warn_num)
+#define BATCH_RES_usec(r) ((r)->usec)
+class BatchResult {
+public:
+    CHAR const* file_name;
+    STATUS status;
+    UINT err_num;
+    UINT warn_num;
+    ULONGLONG usec; //elapsed time of compilation.
+public:
+    BatchResult() { clean(); }
+
+    //The constructor is used to satisify sstl.h's default operations.
+    BatchResult(UINT) { clean(); }
+
+    void clean()
+    {
+        file_name = nullptr;
+        status = ST_SUCC;
+        err_num = 0;
+        warn_num = 0;
+        usec = 0;
+    }
+};
+
+
+//Print one line for each source file, the fields are separated by tab.
+//The file name is the last field since it may contain space.
+static void dumpBatchSummary(xcom::Vector<BatchResult> const& resvec,
+                             FILE * h)
+{
+    fprintf(h, "#status\terrors\twarnings\tusec\tfile\n");
+    for (UINT i = 0; i < resvec.get_elem_count(); i++) {
+        BatchResult const& r = resvec.get(i);
+        fprintf(h, "%s\t%u\t%u\t%llu\t%s\n",
+                BATCH_RES_status(&r) == ST_SUCC ? "ok" : "error",
+                BATCH_RES_err_num(&r), BATCH_RES_warn_num(&r),
+                BATCH_RES_usec(&r), BATCH_RES_file_name(&r));
+    }
+}
+
+
+//Compile the source files in g_c_file_vec one by one in context 'ctx', and
+//write the diagnostics into 'out'. If the context reuses memory pools, the
+//symbol table and the pools are shared by all files. The next file is read
+//in background while current file is being compiled.
+//Return the number of files that failed to compile.
+static UINT compileFiles(CompileCtx * ctx, FILE * out)
+{
+    LogMgr * lm = new LogMgr();
+    if (g_dump_file_name != nullptr) {
+        lm->init(g_dump_file_name, true);
+    }
+    xcom::Vector<BatchResult> resvec;
+    SrcFilePrefetcher prefetcher;
+    UINT failed = 0;
+    for (UINT i = 0; i < g_c_file_vec.get_elem_count(); i++) {
+        CHAR const* fn = g_c_file_vec.get(i);
+        prefetcher.wait();
+        if (i + 1 < g_c_file_vec.get_elem_count()) {
+            prefetcher.start(g_c_file_vec.get(i + 1));
+        }
+        BatchResult r;
+        BATCH_RES_file_name(&r) = fn;
+        ULONGLONG start = get_usec();
+        {
+            CParser parser(ctx, lm, fn);
+            BATCH_RES_status(&r) = FrontEnd(lm, parser);
+            show_err(out, fn);
+            show_warn(out, fn);
+            BATCH_RES_err_num(&r) = g_err_msg_list.get_elem_count();
+            BATCH_RES_warn_num(&r) = g_warn_msg_list.get_elem_count();
+            show_diag_summary(out, fn, BATCH_RES_err_num(&r),
+                              BATCH_RES_warn_num(&r));
+        }
+        BATCH_RES_usec(&r) = get_usec() - start;
+        if (BATCH_RES_status(&r) != ST_SUCC || BATCH_RES_err_num(&r) != 0) {
+            BATCH_RES_status(&r) = ST_ERR;
+            failed++;
+        }
+        resvec.append(r);
+        ctx->reset();
+    }
+    delete lm;
+    if (!g_is_batch) { return failed; }
+
+    FILE * h = out;
+    if (g_summary_file_name != nullptr) {
+        h = ::fopen(g_summary_file_name, "w");
+        if (h == nullptr) {
+            fprintf(stderr, "\ncan not open summary file %s, errno:%d\n",
+                    g_summary_file_name, errno);
+            return failed + 1;
+        }
+    } else {
+        fprintf(h, "\n");
+    }
+    dumpBatchSummary(resvec, h);
+    if (h != out) {
+        ::fclose(h);
+    }
+    return failed;
+}
+
+
 static bool is_c_source_file(CHAR * fn)
 {
     CHAR * buf = (CHAR*)ALLOCA(strlen(fn) + 1);
@@ -89,10 +373,91 @@ static CHAR * process_d(INT argc, CHAR * argv[], INT & i)
 }
 
 
+//Parse the kind of lexer scan kernels, e.g: -lexscan sse2.
+static bool process_lexscan(INT argc, CHAR * argv[], INT & i)
+{
+    CHAR const* kind = process_d(argc, argv, i);
+    if (kind == nullptr) { return false; }
+    for (INT k = LEX_SCAN_AUTO; k <= LEX_SCAN_AVX2; k++) {
+        if (!strcmp(kind, getLexScanKindName((LEX_SCAN_KIND)k))) {
+            g_lex_scan_kind = (LEX_SCAN_KIND)k;
+            return true;
+        }
+    }
+    return false;
+}
+
+
+//Read the names of source file from response file, one name per line.
+//Empty lines and lines start with '#' are ignored.
+static bool process_response_file(CHAR const* fn)
+{
+    FILE * h = ::fopen(fn, "rb");
+    if (h == nullptr) {
+        fprintf(stderr, "\ncan not open response file %s, errno:%d\n",
+                fn, errno);
+        return false;
+    }
+    size_t cap = 4096;
+    size_t len = 0;
+    CHAR * buf = (CHAR*)::malloc(cap);
+    for (;;) {
+        if (len + 1 == cap) {
+            cap *= 2;
+            buf = (CHAR*)::realloc(buf, cap);
+        }
+        size_t n = ::fread(buf + len, 1, cap - len - 1, h);
+        if (n == 0) { break; }
+        len += n;
+    }
+    ::fclose(h);
+    buf[len] = 0;
+    g_response_buf_list.append_tail(buf);
+
+    CHAR * next = nullptr;
+    for (CHAR * line = buf; *line != 0; line = next) {
+        CHAR * end = line;
+        while (*end != 0 && *end != '\n') { end++; }
+        next = *end == 0 ? end : end + 1;
+        while (end > line && (xcom::xisspace(end[-1]) || end[-1] == '\r')) {
+            end--;
+        }
+        *end = 0;
+        while (xcom::xisspace(*line)) { line++; }
+        if (*line == 0 || *line == '#') { continue; }
+        g_c_file_vec.append(line);
+    }
+    g_is_batch = true;
+    return true;
+}
+
+
+//Parse the number of threads of semantic passes, e.g: -j 4.
+static bool process_j(INT argc, CHAR * argv[], INT & i)
+{
+    CHAR const* num = process_d(argc, argv, i);
+    if (num == nullptr || !xcom::xisdigit(num)) { return false; }
+    INT n = atoi(num);
+    if (n <= 0) { return false; }
+    g_sema_thread_num = (UINT)n;
+    return true;
+}
+
+
 bool processCmdLine(INT argc, CHAR * argv[])
 {
     if (argc <= 1) {
-        fprintf(stdout, "\nusage: ./xocfe.exe yourfile.c -dump tmp.dump\n");
+        fprintf(stdout, "\nusage: ./xocfe.exe yourfile.c -dump tmp.dump "
+                "[-mmap] [-pool_mmap] [-lexscan auto|scalar|sse2|avx2] "
+                "[-prec_climbing] [-j N] [-fused_sema] "
+                "[-verify_fused_sema] [-stream] [-lazy_body] "
+                "[-decl_only] [-dense_init] [-fold_const] "
+                "[-diag_json]\n"
+                "       ./xocfe.exe a.c b.c ... | @list.txt "
+                "[-summary summary.txt] [options]\n"
+                "       ./xocfe.exe -server xocfe.sock\n"
+                "       ./xocfe.exe -client xocfe.sock [-shutdown] "
+                "[files] [options]\n");
         return false;
     }
     INT i = 1;
@@ -101,16 +466,470 @@ bool processCmdLine(INT argc, CHAR * argv[])
             CHAR const* cmdstr = &argv[i][1];
             if (!strcmp(cmdstr, "dump")) {
                 g_dump_file_name = process_d(argc, argv, i);
+            } else if (!strcmp(cmdstr, "mmap")) {
+                g_enable_map_src_file = true;
+                i++;
+            } else if (!strcmp(cmdstr, "pool_mmap")) {
+                g_smpool_mmap_threshold = MEMPOOL_DEF_MMAP_THRESHOLD;
+                i++;
+            } else if (!strcmp(cmdstr, "prec_climbing")) {
+                g_enable_prec_climbing = true;
+                i++;
+            } else if (!strcmp(cmdstr, "summary")) {
+                g_summary_file_name = process_d(argc, argv, i);
+            } else if (!strcmp(cmdstr, "fused_sema")) {
+                g_enable_fused_sema = true;
+                i++;
+            } else if (!strcmp(cmdstr, "verify_fused_sema")) {
+                g_verify_fused_sema = true;
+                i++;
+            } else if (!strcmp(cmdstr, "stream")) {
+                g_enable_stream_func = true;
+                i++;
+            } else if (!strcmp(cmdstr, "lazy_body")) {
+                g_enable_lazy_fun_body = true;
+                i++;
+            } else if (!strcmp(cmdstr, "decl_only")) {
+                g_is_decl_only = true;
+                g_enable_lazy_fun_body = true;
+                i++;
+            } else if (!strcmp(cmdstr, "dense_init")) {
+                g_enable_dense_init = true;
+                i++;
+            } else if (!strcmp(cmdstr, "fold_const")) {
+                g_enable_fold_const = true;
+                i++;
+            } else if (!strcmp(cmdstr, "diag_json")) {
+                g_enable_diag_json = true;
+                i++;
+            } else if (!strcmp(cmdstr, "server")) {
+                g_server_sock_name = process_d(argc, argv, i);
+                if (g_server_sock_name == nullptr) { return false; }
+            } else if (!strcmp(cmdstr, "client")) {
+                g_client_sock_name = process_d(argc, argv, i);
+                if (g_client_sock_name == nullptr) { return false; }
+            } else if (!strcmp(cmdstr, "shutdown")) {
+                g_is_shutdown = true;
+                i++;
+            } else if (!strcmp(cmdstr, "j")) {
+                if (!process_j(argc, argv, i)) { return false; }
+            } else if (!strcmp(cmdstr, "lexscan")) {
+                if (!process_lexscan(argc, argv, i)) { return false; }
             } else {
                 return false;
             }
+        } else if (argv[i][0] == '@') {
+            if (!process_response_file(&argv[i][1])) { return false; }
+            i++;
         } else if (is_c_source_file(argv[i])) {
-            g_c_file_name = argv[i];
+            g_c_file_vec.append(argv[i]);
             i++;
+        } else {
+            return false;
+        }
+    }
+    if (g_server_sock_name != nullptr && g_client_sock_name != nullptr) {
+        return false;
+    }
+    if (g_c_file_vec.get_elem_count() > 1) {
+        g_is_batch = true;
+    }
+    if (g_c_file_vec.get_elem_count() != 0) {
+        g_c_file_name = g_c_file_vec.get(0);
+    }
+    return true;
+}
+
+
+static void freeResponseBuf()
+{
+    for (CHAR * buf = g_response_buf_list.get_head();
+         buf != nullptr; buf = g_response_buf_list.get_next()) {
+        ::free(buf);
+    }
+    g_response_buf_list.clean();
+}
+
+
+//Restore the options to their default values. Compile server parses the
+//command line of each request from scratch.
+static void resetOption()
+{
+    g_c_file_name = nullptr;
+    g_dump_file_name = nullptr;
+    g_summary_file_name = nullptr;
+    g_server_sock_name = nullptr;
+    g_client_sock_name = nullptr;
+    g_verify_fused_sema = false;
+    g_is_decl_only = false;
+    g_is_batch = false;
+    g_is_shutdown = false;
+    g_c_file_vec.clean();
+    freeResponseBuf();
+    g_enable_map_src_file = false;
+    g_smpool_mmap_threshold = 0;
+    g_enable_prec_climbing = false;
+    g_sema_thread_num = 1;
+    g_lex_scan_kind = LEX_SCAN_AUTO;
+    g_enable_fused_sema = false;
+    g_enable_stream_func = false;
+    g_enable_lazy_fun_body = false;
+    g_enable_dense_init = false;
+    g_enable_fold_const = false;
+    g_enable_diag_json = false;
+}
+
+
+//Perform the compilation that described by the command line options.
+//'ctx': the context that source files are compiled in.
+//'out': the file that the diagnostics are written into.
+//Return the exit code of process.
+static INT runCmdLine(CompileCtx * ctx, FILE * out)
+{
+    if (g_c_file_vec.get_elem_count() == 0) {
+        fprintf(out, "\nthere is no source file to compile\n");
+        return 1;
+    }
+    if (g_verify_fused_sema) {
+        INT res = 0;
+        for (UINT i = 0; i < g_c_file_vec.get_elem_count(); i++) {
+            if (!verifyFusedSema(g_c_file_vec.get(i), out)) { res = 1; }
+        }
+        return res;
+    }
+    UINT failed = compileFiles(ctx, out);
+    if (g_is_batch) {
+        return failed == 0 ? 0 : 1;
+    }
+    return 0;
+}
+
+
+#ifndef _ON_WINDOWS_
+//The protocol between client and compile server. Both sides are on the
+//same machine, thus integers are transferred in native byte order.
+//Request: magic, current directory of client, argument number, arguments.
+//Response: exit code, the output of compilation.
+//A string is transferred as its length followed by its characters.
+#define SERVER_MAGIC 0x45464358 //'XCFE'
+#define SERVER_MAX_ARG_NUM 65536
+#define SERVER_MAX_STR_LEN 0x40000000
+
+//Compile server recreates the symbol table when the number of symbols
+//exceeds the threshold, the symbols of all requests are accumulated in the
+//table otherwise.
+#define SERVER_MAX_SYM_NUM (1 << 20)
+
+static bool writeAll(INT fd, void const* buf, size_t len)
+{
+    CHAR const* p = (CHAR const*)buf;
+    while (len != 0) {
+        ssize_t n = ::write(fd, p, len);
+        if (n < 0 && errno == EINTR) { continue; }
+        if (n <= 0) { return false; }
+        p += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+
+static bool readAll(INT fd, void * buf, size_t len)
+{
+    CHAR * p = (CHAR*)buf;
+    while (len != 0) {
+        ssize_t n = ::read(fd, p, len);
+        if (n < 0 && errno == EINTR) { continue; }
+        if (n <= 0) { return false; }
+        p += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+
+static bool writeUInt(INT fd, UINT v)
+{
+    return writeAll(fd, &v, sizeof(v));
+}
+
+
+static bool readUInt(INT fd, OUT UINT & v)
+{
+    return readAll(fd, &v, sizeof(v));
+}
+
+
+static bool writeStr(INT fd, CHAR const* s, size_t len)
+{
+    return writeUInt(fd, (UINT)len) && writeAll(fd, s, len);
+}
+
+
+//Return the string that allocated by malloc, or nullptr if failed.
+static CHAR * readStr(INT fd)
+{
+    UINT len = 0;
+    if (!readUInt(fd, len) || len > SERVER_MAX_STR_LEN) { return nullptr; }
+    CHAR * s = (CHAR*)::malloc(len + 1);
+    if (s == nullptr) { return nullptr; }
+    if (!readAll(fd, s, len)) {
+        ::free(s);
+        return nullptr;
+    }
+    s[len] = 0;
+    return s;
+}
+
+
+//Fill the address of Unix socket 'sock_name'.
+//Return false if the path is too long.
+static bool initSockAddr(CHAR const* sock_name, OUT sockaddr_un & addr)
+{
+    ::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (::strlen(sock_name) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "\nsocket path %s is too long\n", sock_name);
+        return false;
+    }
+    ::strcpy(addr.sun_path, sock_name);
+    return true;
+}
+
+
+//Read the request from 'fd', compile in context 'ctx', and send back the
+//result. 'org_dir' is the working directory of server.
+//Return false if the request asks server to exit.
+static bool serveRequest(INT fd, CompileCtx * ctx, CHAR const* org_dir)
+{
+    UINT magic = 0;
+    UINT argc = 0;
+    if (!readUInt(fd, magic) || magic != SERVER_MAGIC) { return true; }
+    CHAR * cwd = readStr(fd);
+    if (cwd == nullptr) { return true; }
+    if (!readUInt(fd, argc) || argc > SERVER_MAX_ARG_NUM) {
+        ::free(cwd);
+        return true;
+    }
+    //The first argument is the name of program.
+    xcom::Vector<CHAR*> argv;
+    argv.set(0, (CHAR*)"xocfe.exe");
+    bool is_valid = true;
+    for (UINT i = 0; i < argc; i++) {
+        CHAR * arg = readStr(fd);
+        if (arg == nullptr) {
+            is_valid = false;
+            break;
+        }
+        argv.set(i + 1, arg);
+    }
+
+    bool is_shutdown = false;
+    if (is_valid) {
+        resetOption();
+        INT res = 1;
+        FILE * out = ::tmpfile();
+        if (out == nullptr) {
+            fprintf(stderr, "\ncan not create temporary file, errno:%d\n",
+                    errno);
+        } else if (::chdir(cwd) != 0) {
+            fprintf(out, "\ncan not change directory to %s, errno:%d\n",
+                    cwd, errno);
+        } else if (!processCmdLine((INT)argc + 1, argv.get_vec())) {
+            fprintf(out, "\ninvalid command line\n");
+        } else if (g_server_sock_name != nullptr ||
+                   g_client_sock_name != nullptr) {
+            //Request can not start another server.
+            fprintf(out, "\n-server and -client can not be used in "
+                    "request\n");
+        } else if (g_is_shutdown) {
+            is_shutdown = true;
+            res = 0;
+        } else {
+            //Some messages of parser are printed to stdout directly,
+            //redirect stdout to collect all the output of compilation.
+            ::fflush(stdout);
+            INT org_stdout = ::dup(STDOUT_FILENO);
+            ::dup2(::fileno(out), STDOUT_FILENO);
+            res = runCmdLine(ctx, stdout);
+            ::fflush(stdout);
+            ::dup2(org_stdout, STDOUT_FILENO);
+            ::close(org_stdout);
+        }
+        if (::chdir(org_dir) != 0) {
+            fprintf(stderr, "\ncan not change directory to %s, errno:%d\n",
+                    org_dir, errno);
+        }
+        freeResponseBuf();
+
+        //Send back the exit code and the output.
+        size_t len = 0;
+        CHAR * buf = nullptr;
+        if (out != nullptr) {
+            ::fseek(out, 0, SEEK_END);
+            len = (size_t)::ftell(out);
+            buf = (CHAR*)::malloc(len + 1);
+            ::rewind(out);
+            if (buf == nullptr || ::fread(buf, 1, len, out) != len) {
+                len = 0;
+            }
+            ::fclose(out);
+        }
+        if (writeUInt(fd, (UINT)res)) {
+            writeStr(fd, buf, len);
+        }
+        ::free(buf);
+    }
+    for (UINT i = 1; i <= argc && i < argv.get_elem_count(); i++) {
+        ::free(argv.get(i));
+    }
+    ::free(cwd);
+
+    if (CTX_fe_sym_tab(ctx)->get_elem_count() > SERVER_MAX_SYM_NUM) {
+        delete CTX_fe_sym_tab(ctx);
+        CTX_fe_sym_tab(ctx) = new CLSymTab();
+    }
+    return !is_shutdown;
+}
+
+
+//Remove the socket file at 'sock_name' that is left by a server which is
+//no longer running. The path is kept if it is not a socket, or a server is
+//still listening on it.
+//Return false if the path is in use and server can not start on it.
+static bool removeStaleSocket(CHAR const* sock_name, sockaddr_un const& addr)
+{
+    struct stat st;
+    if (::lstat(sock_name, &st) != 0) {
+        if (errno == ENOENT) { return true; }
+        fprintf(stderr, "\ncan not access %s, errno:%d\n", sock_name, errno);
+        return false;
+    }
+    if (!S_ISSOCK(st.st_mode)) {
+        fprintf(stderr, "\n%s exists and is not a socket\n", sock_name);
+        return false;
+    }
+    INT fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        fprintf(stderr, "\ncan not create socket, errno:%d\n", errno);
+        return false;
+    }
+    INT res = ::connect(fd, (sockaddr const*)&addr, sizeof(addr));
+    INT conn_errno = errno;
+    ::close(fd);
+    if (res == 0) {
+        fprintf(stderr, "\nanother server is listening on %s\n", sock_name);
+        return false;
+    }
+    if (conn_errno != ECONNREFUSED) {
+        fprintf(stderr, "\ncan not probe %s, errno:%d\n", sock_name,
+                conn_errno);
+        return false;
+    }
+    if (::unlink(sock_name) != 0) {
+        fprintf(stderr, "\ncan not remove %s, errno:%d\n", sock_name, errno);
+        return false;
+    }
+    return true;
+}
+
+
+//Serve the compilation requests on Unix socket 'sock_name' until a request
+//asks to shut down. The requests are served one by one in one context,
+//thus the keyword tables, the symbol table and the memory pools are kept
+//warm across requests.
+//Return the exit code of process.
+static INT runServer(CHAR const* sock_name)
+{
+    sockaddr_un addr;
+    if (!initSockAddr(sock_name, addr)) { return 1; }
+    CHAR org_dir[4096];
+    if (::getcwd(org_dir, sizeof(org_dir)) == nullptr) {
+        fprintf(stderr, "\ncan not get current directory, errno:%d\n", errno);
+        return 1;
+    }
+    //Client may close the connection before reading the response.
+    ::signal(SIGPIPE, SIG_IGN);
+    INT lfd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (lfd < 0) {
+        fprintf(stderr, "\ncan not create socket, errno:%d\n", errno);
+        return 1;
+    }
+    //Remove the socket file left by previous server.
+    if (!removeStaleSocket(sock_name, addr)) {
+        ::close(lfd);
+        return 1;
+    }
+    if (::bind(lfd, (sockaddr*)&addr, sizeof(addr)) != 0 ||
+        ::listen(lfd, 16) != 0) {
+        fprintf(stderr, "\ncan not listen on %s, errno:%d\n",
+                sock_name, errno);
+        ::close(lfd);
+        return 1;
+    }
+    CompileCtx ctx;
+    CTX_is_reuse_pool(&ctx) = true;
+    for (;;) {
+        INT fd = ::accept(lfd, nullptr, nullptr);
+        if (fd < 0) {
+            if (errno == EINTR) { continue; }
+            fprintf(stderr, "\ncan not accept connection, errno:%d\n",
+                    errno);
+            break;
         }
+        bool is_continue = serveRequest(fd, &ctx, org_dir);
+        ::close(fd);
+        if (!is_continue) { break; }
+    }
+    ::close(lfd);
+    ::unlink(sock_name);
+    return 0;
+}
+
+
+//Send the command line to compile server, and print the output of server.
+//'res': the exit code that server returned.
+//Return false if the server is not available, the caller should compile in
+//current process.
+static bool runClient(INT argc, CHAR * argv[], OUT INT & res)
+{
+    sockaddr_un addr;
+    if (!initSockAddr(g_client_sock_name, addr)) { return false; }
+    CHAR cwd[4096];
+    if (::getcwd(cwd, sizeof(cwd)) == nullptr) { return false; }
+    INT fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) { return false; }
+    if (::connect(fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+        ::close(fd);
+        return false;
+    }
+    ::signal(SIGPIPE, SIG_IGN);
+
+    //Forward the arguments except the program name and '-client <sock>'.
+    UINT num = 0;
+    for (INT i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-client")) { i++; continue; }
+        num++;
+    }
+    bool succ = writeUInt(fd, SERVER_MAGIC) &&
+                writeStr(fd, cwd, ::strlen(cwd)) && writeUInt(fd, num);
+    for (INT i = 1; succ && i < argc; i++) {
+        if (!strcmp(argv[i], "-client")) { i++; continue; }
+        succ = writeStr(fd, argv[i], ::strlen(argv[i]));
     }
+    UINT code = 0;
+    CHAR * output = nullptr;
+    if (succ && readUInt(fd, code)) {
+        output = readStr(fd);
+    }
+    ::close(fd);
+    if (output == nullptr) { return false; }
+    fputs(output, stdout);
+    ::free(output);
+    res = (INT)code;
     return true;
 }
+#endif
 
 
 //cmdline usage: xocfe example.c -dump a.tmp
@@ -129,20 +948,27 @@ INT main(INT argc, CHAR * argv[])
 {
 #endif
     if (!processCmdLine(argc, argv)) { return 1; }
-    g_fe_sym_tab = new CLSymTab();
-    LogMgr * lm = new LogMgr();
-    if (g_dump_file_name != nullptr) {
-        lm->init(g_dump_file_name, true);
+    INT res = 0;
+#ifndef _ON_WINDOWS_
+    if (g_server_sock_name != nullptr) {
+        res = runServer(g_server_sock_name);
+        freeResponseBuf();
+        return res;
     }
-    CParser parser(lm, g_c_file_name);
-    FrontEnd(lm, parser);
-    show_err();
-    show_warn();
-    fprintf(stdout, "\n%s - (%d) error(s), (%d) warnging(s)\n",
-            g_c_file_name,
-            g_err_msg_list.get_elem_count(),
-            g_warn_msg_list.get_elem_count());
-    delete lm;
-    return 0;
+    if (g_client_sock_name != nullptr && runClient(argc, argv, res)) {
+        freeResponseBuf();
+        return res;
+    }
+#endif
+    if (g_is_shutdown) {
+        //There is no server to shut down.
+        freeResponseBuf();
+        return 0;
+    }
+    //Context holds all the information of current compilation.
+    CompileCtx ctx;
+    CTX_is_reuse_pool(&ctx) = g_is_batch;
+    res = runCmdLine(&ctx, stdout);
+    freeResponseBuf();
+    return res;
 }
-
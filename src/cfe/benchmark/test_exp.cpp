@@ -0,0 +1,119 @@
+/*@
+Copyright (c) 2013-2021, Su Zhenyu steven.known@gmail.com
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the Su Zhenyu nor the names of its contributors
+      may be used to endorse or promote products derived from this software
+      without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+@*/
+#include <time.h>
+#include "../cfeinc.h"
+
+using namespace xfe;
+
+//Evaluate the throughput of parsing expression-heavy code, which is
+//typical for machine generated src file. The input consists of functions
+//that each assigns a huge flat expression composed of all kinds of binary
+//operators. Parser is run by both precedence climbing and the chain of
+//recursive descent functions.
+#define FUNC_NUM 200
+#define STMT_NUM 20
+#define LEAF_NUM 400 //the number of operands of each expression.
+
+static CHAR const* g_input_name = "/tmp/xocfe_bench_exp.c";
+
+static double get_time()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+
+static size_t build_input()
+{
+    static CHAR const* op[] = {
+        "||", "&&", "|", "^", "&", "==", "!=", "<", ">", "<=", ">=",
+        "<<", ">>", "+", "-", "*", "/", "%",
+    };
+    static CHAR const* leaf[] = { "a", "b", "c", "(int)d", "3", "s->f" };
+    FILE * out = fopen(g_input_name, "wb");
+    if (out == nullptr) { return 0; }
+    UINT seed = 1;
+    fprintf(out, "struct S { int f; };\n");
+    for (UINT i = 0; i < FUNC_NUM; i++) {
+        fprintf(out, "int f%u(int a, int b, int c, long d, struct S * s)\n"
+                "{\n    int x;\n", i);
+        for (UINT j = 0; j < STMT_NUM; j++) {
+            fprintf(out, "    x = a");
+            for (UINT k = 1; k < LEAF_NUM; k++) {
+                seed = seed * 1103515245 + 12345;
+                UINT r = seed >> 16;
+                fprintf(out, " %s %s", op[r % (sizeof(op) / sizeof(op[0]))],
+                        leaf[(r >> 8) % (sizeof(leaf) / sizeof(leaf[0]))]);
+            }
+            fprintf(out, ";\n");
+        }
+        fprintf(out, "    return x;\n}\n");
+    }
+    size_t size = (size_t)ftell(out);
+    fclose(out);
+    return size;
+}
+
+
+static void run(size_t total, bool prec_climbing)
+{
+    g_enable_prec_climbing = prec_climbing;
+    CompileCtx ctx;
+    xoc::LogMgr lm;
+    double start = get_time();
+    STATUS s = ST_SUCC;
+    {
+        CParser parser(&ctx, &lm, g_input_name);
+        s = parser.perform();
+    }
+    double elapsed = get_time() - start;
+    printf("\nparser:%-14s status:%s time:%.3fs throughput:%.1fMB/s",
+           prec_climbing ? "climbing" : "descent",
+           s == ST_SUCC ? "succ" : "fail", elapsed,
+           (double)total / (1024 * 1024) / elapsed);
+    setCurCompileCtx(nullptr);
+}
+
+
+int main(int argc, char * argv[])
+{
+    size_t total = build_input();
+    if (total == 0) {
+        printf("\ncan not build input %s\n", g_input_name);
+        return 1;
+    }
+    printf("\ninput:%s, %.1fMB", g_input_name, (double)total / (1024 * 1024));
+    run(total, false);
+    run(total, true);
+    run(total, false);
+    run(total, true);
+    printf("\n");
+    UNLINK(g_input_name);
+    return 0;
+}
@@ -0,0 +1,116 @@
+/*@
+Copyright (c) 2013-2021, Su Zhenyu steven.known@gmail.com
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the Su Zhenyu nor the names of its contributors
+      may be used to endorse or promote products derived from this software
+      without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+@*/
+#include <time.h>
+#include "../cfeinc.h"
+
+//Evaluate the throughput of lexer.
+//The input is built by replicating the given source file until its size
+//reaches about 100MB.
+#define TARGET_BYTE_SIZE (100 * 1024 * 1024)
+
+static CHAR const* g_input_name = "/tmp/xocfe_bench_lex.c";
+
+static double get_time()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+
+static size_t build_input(CHAR const* src)
+{
+    FILE * in = fopen(src, "rb");
+    if (in == nullptr) { return 0; }
+    fseek(in, 0, SEEK_END);
+    long len = ftell(in);
+    fseek(in, 0, SEEK_SET);
+    CHAR * buf = (CHAR*)::malloc(len);
+    size_t n = fread(buf, 1, len, in);
+    fclose(in);
+    FILE * out = fopen(g_input_name, "wb");
+    if (out == nullptr) { ::free(buf); return 0; }
+    size_t total = 0;
+    while (total < TARGET_BYTE_SIZE) {
+        fwrite(buf, 1, n, out);
+        total += n;
+    }
+    fclose(out);
+    ::free(buf);
+    return total;
+}
+
+
+static void run(size_t total, bool map_src, LEX_SCAN_KIND kind)
+{
+    g_enable_map_src_file = map_src;
+    g_lex_scan_kind = kind;
+    //Lexer reports diagnostics through current context.
+    CompileCtx ctx;
+    setCurCompileCtx(&ctx);
+    Lexer lex;
+    g_cur_lexer = &lex;
+    LEX_hsrc(&lex) = fopen(g_input_name, "rb");
+    ASSERT0(LEX_hsrc(&lex));
+    double start = get_time();
+    lex.init();
+    UINT tok_num = 0;
+    for (TOKEN t = lex.getNextToken(); t != T_END && t != T_UNDEF;
+         t = lex.getNextToken()) {
+        tok_num++;
+    }
+    double elapsed = get_time() - start;
+    printf("\nreader:%-6s kernel:%-6s tokens:%u time:%.3fs throughput:%.1fMB/s",
+           map_src ? "mmap" : "chunk",
+           getLexScanKindName(lex.getScanKind()), tok_num, elapsed,
+           (double)total / (1024 * 1024) / elapsed);
+    lex.destroy();
+    fclose(LEX_hsrc(&lex));
+    LEX_hsrc(&lex) = nullptr;
+    g_cur_lexer = nullptr;
+    setCurCompileCtx(nullptr);
+}
+
+
+int main(int argc, char * argv[])
+{
+    CHAR const* src = argc > 1 ? argv[1] : "../../../test/test_ansic.c";
+    size_t total = build_input(src);
+    if (total == 0) {
+        printf("\ncan not build input from %s\n", src);
+        return 1;
+    }
+    printf("\ninput:%s, %.1fMB", src, (double)total / (1024 * 1024));
+    run(total, false, LEX_SCAN_SCALAR);
+    run(total, false, LEX_SCAN_AUTO);
+    run(total, true, LEX_SCAN_SCALAR);
+    run(total, true, LEX_SCAN_AUTO);
+    printf("\n");
+    UNLINK(g_input_name);
+    return 0;
+}
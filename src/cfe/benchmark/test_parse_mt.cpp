@@ -0,0 +1,149 @@
+/*@
+Copyright (c) 2013-2021, Su Zhenyu steven.known@gmail.com
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the Su Zhenyu nor the names of its contributors
+      may be used to endorse or promote products derived from this software
+      without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+@*/
+#include <time.h>
+#include <thread>
+#include <vector>
+#include "../cfeinc.h"
+
+using namespace xfe;
+
+//Evaluate the throughput of front end when compiling several translation
+//units concurrently. Each thread owns its CompileCtx, CParser and LogMgr.
+//The dump file of each thread is compared with the dump of the first thread
+//to verify that threads do not interfere with each other.
+static CHAR const* g_src_name = "../../../test/test_ansic.c";
+static UINT g_unit_num = 16;
+
+static double get_time()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+
+static void get_dump_name(UINT unit, OUT CHAR * buf, UINT buflen)
+{
+    snprintf(buf, buflen, "/tmp/xocfe_bench_mt_%u.tmp", unit);
+}
+
+
+static STATUS compile(UINT unit)
+{
+    CHAR dumpname[64];
+    get_dump_name(unit, dumpname, sizeof(dumpname));
+    CompileCtx ctx;
+    xoc::LogMgr lm;
+    lm.init(dumpname, true);
+    STATUS s = ST_SUCC;
+    {
+        CParser parser(&ctx, &lm, g_src_name);
+        initTypeTran();
+        if ((s = parser.perform()) == ST_SUCC &&
+            (s = processDeclInit()) == ST_SUCC &&
+            (s = TypeTransform()) == ST_SUCC &&
+            (s = TypeCheck()) == ST_SUCC &&
+            (s = TreeCanonicalize()) == ST_SUCC) {
+            get_global_scope()->dump();
+        }
+    }
+    setCurCompileCtx(nullptr);
+    return s;
+}
+
+
+static void run_thread(UINT tid, UINT thread_num, STATUS * res)
+{
+    for (UINT i = tid; i < g_unit_num; i += thread_num) {
+        res[i] = compile(i);
+    }
+}
+
+
+static bool is_same_file(CHAR const* f1, CHAR const* f2)
+{
+    FILE * h1 = fopen(f1, "rb");
+    FILE * h2 = fopen(f2, "rb");
+    bool same = h1 != nullptr && h2 != nullptr;
+    while (same) {
+        INT c1 = fgetc(h1);
+        INT c2 = fgetc(h2);
+        if (c1 != c2) { same = false; }
+        if (c1 == EOF) { break; }
+    }
+    if (h1 != nullptr) { fclose(h1); }
+    if (h2 != nullptr) { fclose(h2); }
+    return same;
+}
+
+
+static bool run(UINT thread_num)
+{
+    std::vector<STATUS> res(g_unit_num, ST_ERR);
+    std::vector<std::thread> threads;
+    double start = get_time();
+    for (UINT i = 0; i < thread_num; i++) {
+        threads.push_back(std::thread(run_thread, i, thread_num, &res[0]));
+    }
+    for (UINT i = 0; i < thread_num; i++) {
+        threads[i].join();
+    }
+    double elapsed = get_time() - start;
+
+    bool ok = true;
+    CHAR first[64];
+    CHAR cur[64];
+    get_dump_name(0, first, sizeof(first));
+    for (UINT i = 0; i < g_unit_num; i++) {
+        get_dump_name(i, cur, sizeof(cur));
+        if (res[i] != ST_SUCC || !is_same_file(first, cur)) { ok = false; }
+    }
+    for (UINT i = 0; i < g_unit_num; i++) {
+        get_dump_name(i, cur, sizeof(cur));
+        UNLINK(cur);
+    }
+    printf("\nthreads:%-3u units:%u time:%.3fs units/s:%.1f %s",
+           thread_num, g_unit_num, elapsed, g_unit_num / elapsed,
+           ok ? "" : "MISMATCH");
+    return ok;
+}
+
+
+int main(int argc, char * argv[])
+{
+    if (argc > 1) { g_src_name = argv[1]; }
+    UINT max_thread = std::thread::hardware_concurrency();
+    if (argc > 2) { max_thread = (UINT)atoi(argv[2]); }
+    if (max_thread == 0) { max_thread = 1; }
+    bool ok = true;
+    for (UINT n = 1; n <= max_thread; n *= 2) {
+        ok &= run(n);
+    }
+    printf("\n");
+    return ok ? 0 : 1;
+}
@@ -29,7 +29,7 @@ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 namespace xfe {
 
-static List<Cell*> g_cell_free_list;
+#define g_cell_free_list CTX_cell_free_list(g_cur_ctx)
 
 static void * xmalloc(size_t size)
 {
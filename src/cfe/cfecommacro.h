@@ -29,6 +29,13 @@ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define ST_SUCC 0 //Status if successful.
 #define ST_EOF 2 //Status meet End-Of-File.
 
+//Declare the variable that each thread owns a separate instance of.
+#ifdef _VC6_
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL thread_local
+#endif
+
 #define ENABLE_ESYMTAB
 
 #ifdef ENABLE_ESYMTAB
@@ -0,0 +1,175 @@
+/*@
+Copyright (c) 2013-2021, Su Zhenyu steven.known@gmail.com
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the Su Zhenyu nor the names of its contributors
+      may be used to endorse or promote products derived from this software
+      without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+@*/
+#include "cfeinc.h"
+
+namespace xfe {
+
+THREAD_LOCAL CompileCtx * g_cur_ctx = nullptr;
+
+//Initialize the state that belongs to one translation unit.
+void CompileCtx::initUnitState()
+{
+    m_cur_scope = nullptr;
+    m_scope_count = 0;
+    m_tree_count = TREE_ID_UNDEF + 1;
+    m_decl_count = DECL_ID_UNDEF + 1;
+    m_aggr_count = AGGR_ID_UNDEF + 1;
+    m_layout_epoch = LAYOUT_EPOCH_UNDEF + 1;
+    m_task_cache_epoch = LAYOUT_EPOCH_UNDEF;
+    m_scope_obj_seq = 0;
+    m_visible_seq = 0;
+    m_complete_aggr_vec.clean();
+    m_aggr_anony_name_count = AGGR_ANONY_ID_UNDEF + 1;
+    m_alignment = PRAGMA_ALIGN; //default alignment.
+    m_schar_type = nullptr;
+    m_sshort_type = nullptr;
+    m_sint_type = nullptr;
+    m_slong_type = nullptr;
+    m_slonglong_type = nullptr;
+    m_uchar_type = nullptr;
+    m_ushort_type = nullptr;
+    m_uint_type = nullptr;
+    m_ulong_type = nullptr;
+    m_ulonglong_type = nullptr;
+    m_float_type = nullptr;
+    m_double_type = nullptr;
+    m_void_type = nullptr;
+    m_enum_type = nullptr;
+}
+
+
+void CompileCtx::init(CompileCtx * parent)
+{
+    m_parser = nullptr;
+    m_parent = parent;
+    m_is_reuse_pool = false;
+    m_pool_general_used = nullptr;
+    m_pool_tree_used = nullptr;
+    m_pool_st_used = nullptr;
+    m_logmgr = nullptr;
+    m_new_tree_vec = nullptr;
+    m_func_stream = nullptr;
+    initUnitState();
+    if (parent == nullptr) {
+        m_fe_sym_tab = new CLSymTab();
+        m_type_tab = new TypeTab();
+        return;
+    }
+
+    //Task context inherits the state of parent that is read by the passes
+    //performed on function.
+    m_new_tree_vec = &m_task_tree_vec;
+    m_fe_sym_tab = parent->m_fe_sym_tab;
+    m_type_tab = parent->m_type_tab;
+    m_logmgr = parent->m_logmgr;
+    m_cur_scope = parent->m_cur_scope;
+    m_scope_count = parent->m_scope_count;
+    m_tree_count = parent->m_tree_count;
+    m_decl_count = parent->m_decl_count;
+    m_aggr_count = parent->m_aggr_count;
+    m_layout_epoch = parent->m_layout_epoch;
+    m_task_cache_epoch = m_layout_epoch;
+    m_scope_obj_seq = parent->m_scope_obj_seq;
+    m_aggr_anony_name_count = parent->m_aggr_anony_name_count;
+    m_alignment = parent->m_alignment;
+    m_schar_type = parent->m_schar_type;
+    m_sshort_type = parent->m_sshort_type;
+    m_sint_type = parent->m_sint_type;
+    m_slong_type = parent->m_slong_type;
+    m_slonglong_type = parent->m_slonglong_type;
+    m_uchar_type = parent->m_uchar_type;
+    m_ushort_type = parent->m_ushort_type;
+    m_uint_type = parent->m_uint_type;
+    m_ulong_type = parent->m_ulong_type;
+    m_ulonglong_type = parent->m_ulonglong_type;
+    m_float_type = parent->m_float_type;
+    m_double_type = parent->m_double_type;
+    m_void_type = parent->m_void_type;
+    m_enum_type = parent->m_enum_type;
+}
+
+
+void CompileCtx::destroy()
+{
+    ASSERTN(m_parser == nullptr, ("parser is still working on the context"));
+    if (g_cur_ctx == this) {
+        setCurCompileCtx(nullptr);
+    }
+    if (is_task()) {
+        //The tables belong to parent.
+        m_fe_sym_tab = nullptr;
+        m_type_tab = nullptr;
+        return;
+    }
+    if (m_pool_general_used != nullptr) {
+        smpoolDelete(m_pool_general_used);
+        m_pool_general_used = nullptr;
+    }
+    if (m_pool_tree_used != nullptr) {
+        smpoolDelete(m_pool_tree_used);
+        m_pool_tree_used = nullptr;
+    }
+    if (m_pool_st_used != nullptr) {
+        smpoolDelete(m_pool_st_used);
+        m_pool_st_used = nullptr;
+    }
+    if (m_fe_sym_tab != nullptr) {
+        delete m_fe_sym_tab;
+        m_fe_sym_tab = nullptr;
+    }
+    if (m_type_tab != nullptr) {
+        delete m_type_tab;
+        m_type_tab = nullptr;
+    }
+}
+
+
+void CompileCtx::reset()
+{
+    ASSERTN(m_parser == nullptr, ("parser is still working on the context"));
+    ASSERT0(!is_task());
+    m_err_msg_list.clean();
+    m_warn_msg_list.clean();
+    m_st_cell_stack.clean();
+    initUnitState();
+
+    //Canonical type-names are allocated in the pools of previous unit.
+    delete m_type_tab;
+    m_type_tab = new TypeTab();
+}
+
+
+void setCurCompileCtx(CompileCtx * ctx)
+{
+    g_cur_ctx = ctx;
+    g_cur_parser = ctx != nullptr ? CTX_parser(ctx) : nullptr;
+    g_cur_lexer = g_cur_parser != nullptr ?
+        &PARSER_lexer(g_cur_parser) : nullptr;
+}
+
+} //namespace xfe
@@ -0,0 +1,239 @@
+/*@
+Copyright (c) 2013-2021, Su Zhenyu steven.known@gmail.com
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the Su Zhenyu nor the names of its contributors
+      may be used to endorse or promote products derived from this software
+      without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+@*/
+#ifndef __CFE_CTX_H__
+#define __CFE_CTX_H__
+
+namespace xfe {
+
+class CParser;
+class FuncStream;
+
+//CompileCtx holds the state of front end that belongs to one compilation,
+//namely one translation unit. Each thread works on its current context, thus
+//several translation units can be compiled at the same time by different
+//threads.
+#define CTX_parser(c) ((c)->m_parser)
+#define CTX_parent(c) ((c)->m_parent)
+#define CTX_is_reuse_pool(c) ((c)->m_is_reuse_pool)
+#define CTX_task_tree_vec(c) ((c)->m_task_tree_vec)
+#define CTX_new_tree_vec(c) ((c)->m_new_tree_vec)
+#define CTX_func_stream(c) ((c)->m_func_stream)
+#define CTX_task_pool_list(c) ((c)->m_task_pool_list)
+#define CTX_pool_general_used(c) ((c)->m_pool_general_used)
+#define CTX_pool_tree_used(c) ((c)->m_pool_tree_used)
+#define CTX_pool_st_used(c) ((c)->m_pool_st_used)
+#define CTX_fe_sym_tab(c) ((c)->m_fe_sym_tab)
+#define CTX_type_tab(c) ((c)->m_type_tab)
+#define CTX_logmgr(c) ((c)->m_logmgr)
+#define CTX_err_msg_list(c) ((c)->m_err_msg_list)
+#define CTX_warn_msg_list(c) ((c)->m_warn_msg_list)
+#define CTX_cur_scope(c) ((c)->m_cur_scope)
+#define CTX_scope_list(c) ((c)->m_scope_list)
+#define CTX_scope_count(c) ((c)->m_scope_count)
+#define CTX_lab2lineno(c) ((c)->m_lab2lineno)
+#define CTX_lab_used(c) ((c)->m_lab_used)
+#define CTX_tree_count(c) ((c)->m_tree_count)
+#define CTX_decl_count(c) ((c)->m_decl_count)
+#define CTX_aggr_count(c) ((c)->m_aggr_count)
+#define CTX_layout_epoch(c) ((c)->m_layout_epoch)
+#define CTX_task_cache_epoch(c) ((c)->m_task_cache_epoch)
+#define CTX_task_decl_size(c) ((c)->m_task_decl_size)
+#define CTX_task_aggr_layout(c) ((c)->m_task_aggr_layout)
+#define CTX_scope_obj_seq(c) ((c)->m_scope_obj_seq)
+#define CTX_visible_seq(c) ((c)->m_visible_seq)
+#define CTX_complete_aggr_vec(c) ((c)->m_complete_aggr_vec)
+#define CTX_aggr_anony_name_count(c) ((c)->m_aggr_anony_name_count)
+#define CTX_alignment(c) ((c)->m_alignment)
+#define CTX_cell_free_list(c) ((c)->m_cell_free_list)
+#define CTX_st_cell_stack(c) ((c)->m_st_cell_stack)
+#define CTX_schar_type(c) ((c)->m_schar_type)
+#define CTX_sshort_type(c) ((c)->m_sshort_type)
+#define CTX_sint_type(c) ((c)->m_sint_type)
+#define CTX_slong_type(c) ((c)->m_slong_type)
+#define CTX_slonglong_type(c) ((c)->m_slonglong_type)
+#define CTX_uchar_type(c) ((c)->m_uchar_type)
+#define CTX_ushort_type(c) ((c)->m_ushort_type)
+#define CTX_uint_type(c) ((c)->m_uint_type)
+#define CTX_ulong_type(c) ((c)->m_ulong_type)
+#define CTX_ulonglong_type(c) ((c)->m_ulonglong_type)
+#define CTX_float_type(c) ((c)->m_float_type)
+#define CTX_double_type(c) ((c)->m_double_type)
+#define CTX_void_type(c) ((c)->m_void_type)
+#define CTX_enum_type(c) ((c)->m_enum_type)
+class CompileCtx {
+    COPY_CONSTRUCTOR(CompileCtx);
+public:
+    CParser * m_parser; //the parser that is working on the context.
+
+    //The context that current context works on behalf of, it is nullptr
+    //if current context is not a task context. A task context shares the
+    //symbol table, the type table and the declarations with its parent,
+    //whereas it owns the memory pools and the diagnostics.
+    CompileCtx * m_parent;
+
+    //Set to true if the parser resets rather than deletes the memory pools
+    //when it is destroyed, the pools are reused by the next translation
+    //unit that compiled in current context.
+    bool m_is_reuse_pool;
+
+    //Record the trees allocated in task context in allocation order, they
+    //will be renumbered when the task is merged into its parent.
+    xcom::Vector<Tree*> m_task_tree_vec;
+
+    //If it is not nullptr, the trees allocated in current context are
+    //appended to the vector in allocation order. It refers to
+    //m_task_tree_vec in task context.
+    xcom::Vector<Tree*> * m_new_tree_vec;
+
+    //If it is not nullptr, each function definition is compiled and
+    //released by the stream as soon as it has been parsed.
+    FuncStream * m_func_stream;
+
+    //Record the memory pools of task contexts that have been merged into
+    //current context. The pools are released along with the parser.
+    xcom::List<SMemPool*> m_task_pool_list;
+    SMemPool * m_pool_general_used;
+    SMemPool * m_pool_tree_used;
+    SMemPool * m_pool_st_used;
+    CLSymTab * m_fe_sym_tab;
+    TypeTab * m_type_tab; //canonical type-names of the compilation.
+    LogMgr * m_logmgr; //the file handler of log file.
+    ErrList m_err_msg_list;
+    WarnList m_warn_msg_list;
+
+    //The outermost scope is global region which id is 0, and the inner
+    //scope scope is function body-stmt which id starts at 1, etc.
+    Scope * m_cur_scope;
+    xcom::List<Scope*> m_scope_list;
+    UINT m_scope_count;
+    Label2Lineno m_lab2lineno;
+    xcom::TTab<xoc::LabelInfo const*> m_lab_used;
+    UINT m_tree_count;
+    UINT m_decl_count;
+    UINT m_aggr_count;
+
+    //The epoch of the layout of aggregates and declarations. The cached
+    //layout and byte size are out of date once the epoch has been changed.
+    //Any change to the alignment of aggregate, to the specifier of field, or
+    //to the dimension of array that had been used to compute a size, has to
+    //advance the epoch.
+    UINT m_layout_epoch;
+
+    //Task context memoizes the byte sizes of declarations and the layouts
+    //of aggregates in the following maps, rather than on the declarations
+    //and aggregates that are shared by concurrent tasks. The maps are
+    //cleaned once the layout epoch differs from m_task_cache_epoch.
+    UINT m_task_cache_epoch;
+    xcom::TMap<Decl const*, UINT> m_task_decl_size;
+    xcom::TMap<Aggr const*, AggrLayout*> m_task_aggr_layout;
+
+    //The sequence number of the latest object added into any scope.
+    UINT m_scope_obj_seq;
+
+    //If it is not zero, the objects of global scope whose sequence numbers
+    //are greater than it are invisible to lookup. It is set when parsing the
+    //function body that has been skipped by lazy parsing, thus the body
+    //sees the global scope as it was at the '{' of body.
+    UINT m_visible_seq;
+
+    //Record the aggregates in the order that they were completed.
+    xcom::Vector<Aggr*> m_complete_aggr_vec;
+
+    //The counter for anonymous name of aggregate.
+    UINT m_aggr_anony_name_count;
+    INT m_alignment; //current alignment that specified by pragma.
+    List<Cell*> m_cell_free_list;
+    Stack<Cell*> m_st_cell_stack;
+
+    //Basic types built by initTypeTran().
+    TypeAttr * m_schar_type;
+    TypeAttr * m_sshort_type;
+    TypeAttr * m_sint_type;
+    TypeAttr * m_slong_type;
+    TypeAttr * m_slonglong_type;
+    TypeAttr * m_uchar_type;
+    TypeAttr * m_ushort_type;
+    TypeAttr * m_uint_type;
+    TypeAttr * m_ulong_type;
+    TypeAttr * m_ulonglong_type;
+    TypeAttr * m_float_type;
+    TypeAttr * m_double_type;
+    TypeAttr * m_void_type;
+    TypeAttr * m_enum_type;
+public:
+    CompileCtx() { init(nullptr); }
+    explicit CompileCtx(CompileCtx * parent) { init(parent); }
+    ~CompileCtx() { destroy(); }
+
+    //'parent': the context that current context works on behalf of, or
+    //nullptr if current context is not a task context.
+    void init(CompileCtx * parent);
+    void initUnitState();
+    void destroy();
+
+    bool is_task() const { return m_parent != nullptr; }
+
+    //Reset current context to compile another translation unit. The symbol
+    //table and the memory pools kept by parser are reused.
+    void reset();
+};
+
+
+//Exported Variables
+//The context that current thread is working on.
+extern THREAD_LOCAL CompileCtx * g_cur_ctx;
+
+//The following names refer to the state of the context of current thread.
+#define g_pool_general_used CTX_pool_general_used(g_cur_ctx)
+#define g_pool_tree_used CTX_pool_tree_used(g_cur_ctx)
+#define g_pool_st_used CTX_pool_st_used(g_cur_ctx)
+#define g_fe_sym_tab CTX_fe_sym_tab(g_cur_ctx)
+#define g_type_tab CTX_type_tab(g_cur_ctx)
+#define g_logmgr CTX_logmgr(g_cur_ctx)
+#define g_err_msg_list CTX_err_msg_list(g_cur_ctx)
+#define g_warn_msg_list CTX_warn_msg_list(g_cur_ctx)
+#define g_cur_scope CTX_cur_scope(g_cur_ctx)
+#define g_scope_list CTX_scope_list(g_cur_ctx)
+#define g_scope_count CTX_scope_count(g_cur_ctx)
+#define g_lab2lineno CTX_lab2lineno(g_cur_ctx)
+#define g_lab_used CTX_lab_used(g_cur_ctx)
+#define g_tree_count CTX_tree_count(g_cur_ctx)
+#define g_decl_count CTX_decl_count(g_cur_ctx)
+#define g_aggr_count CTX_aggr_count(g_cur_ctx)
+#define g_layout_epoch CTX_layout_epoch(g_cur_ctx)
+#define g_aggr_anony_name_count CTX_aggr_anony_name_count(g_cur_ctx)
+#define g_alignment CTX_alignment(g_cur_ctx)
+
+//Exported Functions
+//Set 'ctx' to be the context of current thread. The parser and the lexer
+//of current thread are switched to the ones working on 'ctx' as well.
+//'ctx' may be nullptr.
+void setCurCompileCtx(CompileCtx * ctx);
+
+} //namespace xfe
+#endif
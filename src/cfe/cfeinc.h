@@ -27,6 +27,7 @@ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 @*/
 #include "cfe_targ_const_info.h"
 
+#include <mutex>
 #include "../com/xcominc.h"
 using namespace xcom;
 
@@ -40,12 +41,14 @@ using namespace xoc;
 #include "errno.h"
 #include "cfexport.h"
 #include "err.h"
+#include "lexscan.h"
 #include "lex.h"
 #include "typeck.h"
 #include "typetran.h"
 #include "declinit.h"
 #include "scope.h"
 #include "decl.h"
+#include "typetab.h"
 #include "ctree.h"
 #include "st.h"
 #include "cell.h"
@@ -53,4 +56,8 @@ using namespace xoc;
 #include "parse.h"
 #include "exectree.h"
 #include "treecanon.h"
+#include "functask.h"
+#include "fusesema.h"
+#include "cfectx.h"
+#include "funcstream.h"
 using namespace xfe;
@@ -38,5 +38,38 @@ class Tree;
 //Exported Variable.
 extern bool g_enable_c99_declaration;
 
+//Set true to parse binary expression by precedence climbing, rather than
+//the chain of recursive descent functions. It is off by default until the
+//two parsers have been proven equivalent.
+extern bool g_enable_prec_climbing;
+
+//The number of threads that perform the semantic passes on function
+//definitions. The passes are performed by current thread if it is 1.
+extern UINT g_sema_thread_num;
+
+//Set true to perform type transforming, type checking and tree
+//canonicalization in one traversal of each statement, rather than three
+//separate passes.
+extern bool g_enable_fused_sema;
+
+//Set true to compile each function definition as soon as it has been
+//parsed, and release its body afterwards, see FuncStream.
+extern bool g_enable_stream_func;
+
+//Set true to skip each function body by matching braces in lexer while
+//parsing, the body is parsed when Decl::getFunBody() is invoked.
+extern bool g_enable_lazy_fun_body;
+
+//Set true to record the constant initial values of array in a blob of
+//TR_DENSE_INIT, rather than lowering each element to an assignment.
+extern bool g_enable_dense_init;
+
+//Set true to fold the operation of literals into literal, and remove the
+//statically dead branch of if, while and do-while in tree canonicalization.
+extern bool g_enable_fold_const;
+
+//Set true to print diagnostics in JSON-lines format, one object per line.
+extern bool g_enable_diag_json;
+
 } //namespace xfe
 #endif
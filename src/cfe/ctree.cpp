@@ -29,8 +29,6 @@ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 namespace xfe {
 
-UINT g_tree_count = TREE_ID_UNDEF + 1;
-
 static void * xmalloc(size_t size)
 {
     void * p = smpoolMalloc(size, g_pool_tree_used);
@@ -40,11 +38,153 @@ static void * xmalloc(size_t size)
 }
 
 
+//Record the number of child slots of each TREE_CODE.
+//Note the table has to be updated if a TREE_CODE begins to use a new
+//kid, TREE_fld() will assert in debug mode if the slot is not allocated.
+static BYTE const g_tree_fld_num[] = {
+    0, //TR_NUL
+    2, //TR_ASSIGN
+    0, //TR_ID
+    0, //TR_IMM
+    0, //TR_IMMU
+    0, //TR_IMML
+    0, //TR_IMMUL
+    0, //TR_FP
+    0, //TR_FPF
+    0, //TR_FPLD
+    0, //TR_ENUM_CONST
+    0, //TR_STRING
+    2, //TR_LOGIC_OR
+    2, //TR_LOGIC_AND
+    2, //TR_INCLUSIVE_OR
+    2, //TR_INCLUSIVE_AND
+    2, //TR_XOR
+    2, //TR_EQUALITY
+    2, //TR_RELATION
+    2, //TR_SHIFT
+    2, //TR_ADDITIVE
+    2, //TR_MULTI
+    2, //TR_INTRI_FUN
+    3, //TR_IF
+    0, //TR_ELSE
+    2, //TR_DO
+    2, //TR_WHILE
+    4, //TR_FOR
+    2, //TR_SWITCH
+    0, //TR_BREAK
+    0, //TR_CONTINUE
+    1, //TR_RETURN
+    0, //TR_GOTO
+    0, //TR_LABEL
+    0, //TR_DEFAULT
+    0, //TR_CASE
+    3, //TR_COND
+    2, //TR_CVT
+    0, //TR_TYPE_NAME
+    2, //TR_LDA
+    2, //TR_DEREF
+    1, //TR_INC
+    1, //TR_DEC
+    1, //TR_POST_INC
+    1, //TR_POST_DEC
+    2, //TR_PLUS
+    2, //TR_MINUS
+    2, //TR_REV
+    2, //TR_NOT
+    1, //TR_SIZEOF
+    2, //TR_DMEM
+    2, //TR_INDMEM
+    2, //TR_ARRAY
+    2, //TR_CALL
+    0, //TR_SCOPE
+    0, //TR_INITVAL_SCOPE
+    0, //TR_DECL
+    0, //TR_PRAGMA
+    0, //TR_PREP
+    0, //TR_DENSE_INIT
+};
+
+
+UINT Tree::getFldNum(TREE_CODE code)
+{
+    ASSERT0((UINT)code < sizeof(g_tree_fld_num) / sizeof(g_tree_fld_num[0]));
+    return g_tree_fld_num[code];
+}
+
+
+size_t Tree::getByteSize(TREE_CODE code)
+{
+    return offsetof(Tree, m_fld) + sizeof(Tree*) * getFldNum(code);
+}
+
+
+HOST_INT DenseInit::getInt(ULONG ofst, UINT size, bool is_signed) const
+{
+    ASSERT0(size <= sizeof(ULONGLONG) && ofst + size <= elem_num * elem_size);
+    ULONGLONG v = 0;
+    for (UINT i = 0; i < size; i++) {
+        v |= ((ULONGLONG)data[ofst + i]) << (i * BIT_PER_BYTE);
+    }
+    if (is_signed && size < sizeof(ULONGLONG)) {
+        //Sign extend.
+        UINT shift = (UINT)(sizeof(ULONGLONG) - size) * BIT_PER_BYTE;
+        return ((LONGLONG)(v << shift)) >> shift;
+    }
+    return (LONGLONG)v;
+}
+
+
+double DenseInit::getFP(ULONG ofst, UINT size) const
+{
+    ULONGLONG v = (ULONGLONG)getInt(ofst, size, false);
+    if (size == sizeof(float)) {
+        UINT32 w = (UINT32)v;
+        float f;
+        ::memcpy(&f, &w, sizeof(f));
+        return f;
+    }
+    ASSERT0(size == sizeof(double));
+    UINT64 w = (UINT64)v;
+    double d;
+    ::memcpy(&d, &w, sizeof(d));
+    return d;
+}
+
+
+void DenseInit::setInt(ULONG ofst, UINT size, LONGLONG v)
+{
+    ASSERT0(size <= sizeof(ULONGLONG) && ofst + size <= elem_num * elem_size);
+    for (UINT i = 0; i < size; i++) {
+        data[ofst + i] = (BYTE)(((ULONGLONG)v) >> (i * BIT_PER_BYTE));
+    }
+}
+
+
+void DenseInit::setFP(ULONG ofst, UINT size, double v)
+{
+    if (size == sizeof(float)) {
+        float f = (float)v;
+        UINT32 w;
+        ::memcpy(&w, &f, sizeof(w));
+        setInt(ofst, size, (LONGLONG)w);
+        return;
+    }
+    ASSERT0(size == sizeof(double));
+    UINT64 w;
+    ::memcpy(&w, &v, sizeof(w));
+    setInt(ofst, size, (LONGLONG)w);
+}
+
+
 //Alloc a new tree node from 'g_pool_tree_used'.
+//The node only occupies the child slots that 'tnt' needs.
 Tree * allocTreeNode(TREE_CODE tnt, INT lineno)
 {
-    Tree * t = (Tree*)xmalloc(sizeof(Tree));
+    Tree * t = (Tree*)xmalloc(Tree::getByteSize(tnt));
     TREE_id(t) = g_tree_count++;
+    if (CTX_new_tree_vec(g_cur_ctx) != nullptr) {
+        CTX_new_tree_vec(g_cur_ctx)->append(t);
+    }
     TREE_code(t) = tnt;
     TREE_lineno(t) = lineno;
     TREE_parent(t) = nullptr;
@@ -94,6 +234,65 @@ static void dump_res_ty(Tree const* t)
 }
 
 
+static void dump_dense_value(DenseInit const* di, Decl const* ty, ULONG ofst)
+{
+    UINT size = ty->getDeclByteSize();
+    if (ty->is_fp()) {
+        xoc::prt(g_logmgr, "%g", di->getFP(ofst, size));
+        return;
+    }
+    if (ty->getTypeAttr()->is_unsigned()) {
+        xoc::prt(g_logmgr, "%llu",
+                 (ULONGLONG)di->getInt(ofst, size, false));
+        return;
+    }
+    xoc::prt(g_logmgr, "%lld", (LONGLONG)di->getInt(ofst, size, true));
+}
+
+
+//Dump the blob of TR_DENSE_INIT element by element, the fields of struct
+//element are enclosed in braces.
+static void dump_dense_init(DenseInit const* di)
+{
+    #define DENSE_INIT_DUMP_ELEM_PER_LINE 8
+    Decl const* elemty = DENSE_INIT_elem_type(di);
+    xcom::Vector<Decl*> fldty;
+    xcom::Vector<UINT> fldofst;
+    if (elemty->is_struct()) {
+        Decl * fld = nullptr;
+        UINT ofst = 0;
+        for (INT i = 0; get_aggr_field(elemty->getTypeAttr(), i, &fld, &ofst);
+             i++) {
+            fldty.set(i, fld);
+            fldofst.set(i, ofst);
+        }
+    }
+    note(g_logmgr, "\nDATA:");
+    for (ULONG i = 0; i < DENSE_INIT_elem_num(di); i++) {
+        if (i % DENSE_INIT_DUMP_ELEM_PER_LINE == 0) {
+            note(g_logmgr, "\n  [%lu]", i);
+        }
+        ULONG ofst = i * DENSE_INIT_elem_size(di);
+        if (!elemty->is_struct()) {
+            xoc::prt(g_logmgr, " ");
+            dump_dense_value(di, elemty, ofst);
+            continue;
+        }
+        xoc::prt(g_logmgr, " {");
+        for (UINT j = 0; j < fldty.get_elem_count(); j++) {
+            if (j != 0) { xoc::prt(g_logmgr, ","); }
+            dump_dense_value(di, fldty.get(j), ofst + fldofst.get(j));
+        }
+        xoc::prt(g_logmgr, "}");
+    }
+    if (DENSE_INIT_nonconst_num(di) == 0) { return; }
+    note(g_logmgr, "\nNONCONST_POS:");
+    for (ULONG i = 0; i < DENSE_INIT_nonconst_num(di); i++) {
+        xoc::prt(g_logmgr, " %lu", DENSE_INIT_nonconst_pos(di)[i]);
+    }
+}
+
+
 void Tree::dump() const
 {
     Tree const* t = this;
@@ -128,7 +327,8 @@ void Tree::dump() const
                      name, t->id(), sbuf.getBuf());
             } else {
                 Scope * s = DECL_decl_scope(id_decl);
-                format_declaration(sbuf, get_decl_in_scope(name, s), true);
+                format_declaration(sbuf, get_decl_in_scope(TREE_id_name(t), s),
+                                   true);
                 xoc::note(g_logmgr, "\nID(id:%u):'%s' Scope:%d Decl:%s",
                           t->id(), name, SCOPE_level(s), sbuf.getBuf());
             }
@@ -611,6 +811,19 @@ void Tree::dump() const
         TREE_decl(t)->dump();
         g_logmgr->decIndent(dn);
         break;
+    case TR_DENSE_INIT: {
+        DenseInit const* di = TREE_dense_init(t);
+        note(g_logmgr, "\nDENSE_INIT(id:%u):'%s' ELEM_NUM:%lu ELEM_SIZE:%u",
+             t->id(), DENSE_INIT_decl(di)->getDeclSym()->getStr(),
+             DENSE_INIT_elem_num(di), DENSE_INIT_elem_size(di));
+        dump_ty(DENSE_INIT_elem_type(di));
+        dump_line(t);
+
+        g_logmgr->incIndent(dn);
+        dump_dense_init(di);
+        g_logmgr->decIndent(dn);
+        break;
+    }
     default:
         ASSERTN(0, ("unknown tree type:%d",t->getCode()));
         return;
@@ -728,6 +941,7 @@ bool Tree::isRHS() const
     case TR_PRAGMA:
     case TR_PREP:
     case TR_DECL:
+    case TR_DENSE_INIT:
         return false;
     case TR_ID:
     case TR_IMM:
@@ -789,7 +1003,7 @@ Tree * Tree::getArrayBase() const
 
 void Tree::setParentForKid()
 {
-    for (UINT i = 0; i < MAX_TREE_FLDS; i++) {
+    for (UINT i = 0; i < getFldNum(); i++) {
         Tree * t = TREE_fld(this, i);
         if (t != nullptr) {
             setParent(this , t);
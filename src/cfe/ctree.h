@@ -103,6 +103,7 @@ typedef enum _TREE_CODE {
     TR_DECL, // record node that indicates declaration of variable or type-name.
     TR_PRAGMA, // pragma
     TR_PREP, // preprocessor output info
+    TR_DENSE_INIT, // record constant initial values of array in a blob
 } TREE_CODE;
 
 
@@ -139,77 +140,79 @@ public:
 //1. Unary operator: & * + - ~ ! indicate via TREE_lchild
 //2. Binary operator: '=' '*=' '/=' '%=' '+=' '-=' '<<=' '>>=' '&=' '^='
 //   indicated via TREE_lchild and TREE_rchild.
+//The maximum number of kids, the actual number depends on TREE_CODE,
+//see Tree::getFldNum().
 #define MAX_TREE_FLDS 4
 #define TREE_id(tn) ((tn)->m_id)
 #define TREE_token(tn) ((tn)->m_tok)
 #define TREE_lineno(tn) ((tn)->m_lineno)
 #define TREE_code(tn) ((tn)->m_tree_node_code)
 #define TREE_result_type(tn) ((tn)->m_result_type_name)
-#define TREE_fld(tn,N) ((tn)->m_fld[N]) //access no.N child of tree
+#define TREE_fld(tn,N) ((tn)->fld(N)) //access no.N child of tree
 #define TREE_parent(tn) ((tn)->m_parent) //parent tree node
 #define TREE_nsib(tn) ((tn)->next) //next sibling(default)
 #define TREE_psib(tn) ((tn)->prev) //prev sibling
-#define TREE_rchild(tn) ((tn)->m_fld[0]) //rchild of the tree
-#define TREE_lchild(tn) ((tn)->m_fld[1]) //lchild of the tree
+#define TREE_rchild(tn) TREE_fld(tn,0) //rchild of the tree
+#define TREE_lchild(tn) TREE_fld(tn,1) //lchild of the tree
 #define TREE_token_lst(tn) ((tn)->u1.token_list) //Pragma
 
 //If (determiannt) { then-stmt-list } else { else-stmt-list }
-#define TREE_if_det(tn) ((tn)->m_fld[0])  //determinant of if-stmt
-#define TREE_if_true_stmt(tn) ((tn)->m_fld[1]) //then-stmt of if-stmt
-#define TREE_if_false_stmt(tn) ((tn)->m_fld[2]) //else-stmt of if-stmt
+#define TREE_if_det(tn) TREE_fld(tn,0)  //determinant of if-stmt
+#define TREE_if_true_stmt(tn) TREE_fld(tn,1) //then-stmt of if-stmt
+#define TREE_if_false_stmt(tn) TREE_fld(tn,2) //else-stmt of if-stmt
 
 //for (init-list; determinant; step-list) { stmt-list }
-#define TREE_for_init(tn) ((tn)->m_fld[0]) //initialize of for-stmt
-#define TREE_for_det(tn) ((tn)->m_fld[1]) //determinant of for-stmt
-#define TREE_for_step(tn) ((tn)->m_fld[2]) //step of for-stmt
-#define TREE_for_body(tn) ((tn)->m_fld[3]) //body of for-stmt
+#define TREE_for_init(tn) TREE_fld(tn,0) //initialize of for-stmt
+#define TREE_for_det(tn) TREE_fld(tn,1) //determinant of for-stmt
+#define TREE_for_step(tn) TREE_fld(tn,2) //step of for-stmt
+#define TREE_for_body(tn) TREE_fld(tn,3) //body of for-stmt
 
 //do {body} while (determinant)
-#define TREE_dowhile_det(tn) ((tn)->m_fld[0]) //determinant of dowhile-stmt
-#define TREE_dowhile_body(tn) ((tn)->m_fld[1]) //body of dowhile-stmt
+#define TREE_dowhile_det(tn) TREE_fld(tn,0) //determinant of dowhile-stmt
+#define TREE_dowhile_body(tn) TREE_fld(tn,1) //body of dowhile-stmt
 
 //while (determinant) do {body}
-#define TREE_whiledo_det(tn) ((tn)->m_fld[0]) //determinant of whiledo-stmt
-#define TREE_whiledo_body(tn) ((tn)->m_fld[1]) //body of whiledo-stmt
+#define TREE_whiledo_det(tn) TREE_fld(tn,0) //determinant of whiledo-stmt
+#define TREE_whiledo_body(tn) TREE_fld(tn,1) //body of whiledo-stmt
 
 //switch (determinant) { stmt-list }
-#define TREE_switch_det(tn) ((tn)->m_fld[0]) //determinant of switch-stmt
-#define TREE_switch_body(tn) ((tn)->m_fld[1]) //statement of switch-stmt
+#define TREE_switch_det(tn) TREE_fld(tn,0) //determinant of switch-stmt
+#define TREE_switch_body(tn) TREE_fld(tn,1) //statement of switch-stmt
 
 //conditional exp
-#define TREE_det(tn) ((tn)->m_fld[0])
-#define TREE_true_part(tn) ((tn)->m_fld[1])
-#define TREE_false_part(tn) ((tn)->m_fld[2])
+#define TREE_det(tn) TREE_fld(tn,0)
+#define TREE_true_part(tn) TREE_fld(tn,1)
+#define TREE_false_part(tn) TREE_fld(tn,2)
 
 //converting exp
-#define TREE_cvt_type(tn) ((tn)->m_fld[0])
+#define TREE_cvt_type(tn) TREE_fld(tn,0)
 #define TREE_type_name(tn) ((tn)->u1.type_name)
 //#define TREE_ct_type(tn) ((tn)->u1.ty)
-#define TREE_cvt_exp(tn) ((tn)->m_fld[1])
+#define TREE_cvt_exp(tn) TREE_fld(tn,1)
 
 //array referecne
-#define TREE_array_base(tn) (tn)->m_fld[0]
-#define TREE_array_indx(tn) (tn)->m_fld[1]
+#define TREE_array_base(tn) TREE_fld(tn,0)
+#define TREE_array_indx(tn) TREE_fld(tn,1)
 
 //function invoke
-#define TREE_fun_exp(tn) (tn)->m_fld[0]
-#define TREE_para_list(tn) (tn)->m_fld[1]
+#define TREE_fun_exp(tn) TREE_fld(tn,0)
+#define TREE_para_list(tn) TREE_fld(tn,1)
 
 //struct/union member reference
-#define TREE_base_region(tn) (tn)->m_fld[0]
-#define TREE_field(tn) (tn)->m_fld[1]
+#define TREE_base_region(tn) TREE_fld(tn,0)
+#define TREE_field(tn) TREE_fld(tn,1)
 
 //return expression
-#define TREE_ret_exp(tn) (tn)->m_fld[0]
+#define TREE_ret_exp(tn) TREE_fld(tn,0)
 
 //inc/pos-inc
-#define TREE_inc_exp(tn) (tn)->m_fld[0]
+#define TREE_inc_exp(tn) TREE_fld(tn,0)
 
 //dec/post-dec
-#define TREE_dec_exp(tn) (tn)->m_fld[0]
+#define TREE_dec_exp(tn) TREE_fld(tn,0)
 
 //sizeof exp
-#define TREE_sizeof_exp(tn) (tn)->m_fld[0]
+#define TREE_sizeof_exp(tn) TREE_fld(tn,0)
 
 //enum def
 #define TREE_enum(t) (t)->u1.u11.e
@@ -250,6 +253,57 @@ public:
 //record the declaration of variable or type-name
 #define TREE_decl(t) (t)->u1.decl
 
+//Memoized result of constant expression, see computeConstExp().
+//Only the operator nodes record it, because they do not use u1 otherwise.
+#define TREE_cst_val(t) (t)->u1.u13.val
+#define TREE_cst_size(t) (t)->u1.u13.size
+#define TREE_cst_is_unsigned(t) (t)->u1.u13.is_unsigned
+#define TREE_cst_is_memo(t) (t)->u1.u13.is_memo
+
+//TR_DENSE_INIT uses it.
+//record the constant initial values of array
+#define TREE_dense_init(t) (t)->u1.dense_init
+
+//Record the initial values of array in a byte blob that is laid out as
+//the array in memory, see TR_DENSE_INIT. The blob holds the first
+//'elem_num' elements, the elements beyond it are zero. Scalar values are
+//stored in little-endian byte order. The elements whose initial value is
+//not constant are zero in the blob, their positions are recorded in
+//'nonconst_pos' and they are initialized by the assignments that follow
+//the TR_DENSE_INIT.
+#define DENSE_INIT_decl(di) ((di)->decl)
+#define DENSE_INIT_elem_type(di) ((di)->elem_type)
+#define DENSE_INIT_elem_size(di) ((di)->elem_size)
+#define DENSE_INIT_elem_num(di) ((di)->elem_num)
+#define DENSE_INIT_data(di) ((di)->data)
+#define DENSE_INIT_nonconst_pos(di) ((di)->nonconst_pos)
+#define DENSE_INIT_nonconst_num(di) ((di)->nonconst_num)
+class DenseInit {
+public:
+    Decl const* decl; //array declaration
+    Decl const* elem_type; //element type, either scalar or struct
+    UINT elem_size; //byte size of element
+    ULONG elem_num; //number of elements in blob
+    BYTE * data; //blob of elem_num * elem_size bytes
+    ULONG * nonconst_pos; //flattened positions of non-constant elements
+    ULONG nonconst_num; //number of non-constant elements
+public:
+    //Read the scalar value at byte offset 'ofst' of blob.
+    LONGLONG getInt(ULONG ofst, UINT size, bool is_signed) const;
+    double getFP(ULONG ofst, UINT size) const;
+
+    //Write the scalar value at byte offset 'ofst' of blob, the value is
+    //truncated to 'size' bytes.
+    void setInt(ULONG ofst, UINT size, LONGLONG v);
+    void setFP(ULONG ofst, UINT size, double v);
+};
+
+
+//Tree node is allocated with a variable number of child slots according to
+//its TREE_CODE, thus leaf nodes, e.g: TR_ID, TR_IMM, do not pay for the
+//child pointers they never use. The kid slots have to be placed at the
+//end of node. Note the node is allocated in 'g_pool_tree_used' and must
+//not be instantiated as a local variable or an array element.
 class Tree {
 public:
     UINT m_id;
@@ -263,7 +317,6 @@ public:
     //specifier to describing the result-data-type while current
     //Tree operator is acted.
     Decl * m_result_type_name;
-    Tree * m_fld[MAX_TREE_FLDS]; //for any other use
 
     union {
         struct {
@@ -274,6 +327,12 @@ public:
             Sym const* id_name; //record symbol of TR_ID in SymTab
             Decl * id_decl; //record legal declaration
         } u12;
+        struct {
+            LONGLONG val; //value of constant expression
+            BYTE size; //byte size of the type of value
+            BYTE is_unsigned:1; //true if the type of value is unsigned
+            BYTE is_memo:1; //true if the value has been memoized
+        } u13;
         CLSym const* sval; //record a string in C-language SymTab
         Sym const* lab_name; //record a label name in SymTab
         HOST_INT ival; //record an integer value
@@ -288,16 +347,39 @@ public:
         TokenList * token_list; //record a token-list
         Scope * for_scope; //record scope if tree is for-stmt
         Decl * decl; //record the declaration of variable or type-name.
+        DenseInit * dense_init; //record constant initial values of array
     } u1;
 
+    //Child slots. Only the first getFldNum() slots are allocated.
+    Tree * m_fld[MAX_TREE_FLDS];
+
 public:
     void dump() const;
 
+    //Return the reference of No.n child slot.
+    Tree *& fld(UINT n)
+    {
+        ASSERTN(n < getFldNum(), ("tree code %d does not have kid %u",
+                                  getCode(), n));
+        return m_fld[n];
+    }
+    Tree * const& fld(UINT n) const
+    {
+        ASSERTN(n < getFldNum(), ("tree code %d does not have kid %u",
+                                  getCode(), n));
+        return m_fld[n];
+    }
+
     TREE_CODE getCode() const { return TREE_code(this); }
     TOKEN getToken() const { return TREE_token(this); }
     Decl * getResultType() const { return TREE_result_type(this); }
     Decl * getTypeName() const { return TREE_type_name(this); }
     INT getLineno() const { return TREE_lineno(this); }
+    //Return the number of child slots that allocated for current node.
+    UINT getFldNum() const { return getFldNum(getCode()); }
+    static UINT getFldNum(TREE_CODE code);
+    //Return the byte size of tree node that has given code.
+    static size_t getByteSize(TREE_CODE code);
     Tree * getArrayBase() const;
 
     UINT id() const { return TREE_id(this); }
@@ -340,8 +422,5 @@ Tree * get_aggr_base(Tree * t);
 //Get base of aggregate/array if exist.
 Tree * get_base(Tree * t);
 
-//Exported Variables
-extern UINT g_tree_count;
-
 } //namespace xfe
 #endif
@@ -39,8 +39,6 @@ static Decl * abstract_declarator(TypeAttr * qua);
 static Decl * pointer(TypeAttr ** qua);
 static INT compute_array_dim(Decl * dclr, bool allow_dim0_is_empty);
 static Tree * refine_tree_list(Tree * t);
-static bool isEnumTagExist(
-    EnumTab const* entab, CHAR const* id_name, OUT Enum ** e);
 static INT format_base_spec(xcom::DefFixedStrBuf & buf, TypeAttr const* ty);
 static INT format_aggr(xcom::DefFixedStrBuf & buf, TypeAttr const* ty);
 static INT format_aggr(xcom::DefFixedStrBuf & buf, Aggr const* s);
@@ -48,16 +46,14 @@ static INT format_aggr_complete(xcom::DefFixedStrBuf & buf, Aggr const* s);
 static UINT computeArrayByteSize(TypeAttr const* spec, Decl const* decl);
 static void type_spec_aggr_field(Aggr * aggr, TypeAttr * ty);
 static bool parse_function_definition(Decl * declaration);
+static bool parse_function_body(Decl * declaration, Decl * para_list);
+static Scope * parse_lazy_fun_body(Decl * declaration);
 static bool checkAggrComplete(Decl * decl);
 static bool checkBitfield(Decl * decl);
 static void fixExternArraySize(Decl * declaration);
 static void add_enum(TypeAttr * ta);
 static void inferAndSetEValue(EnumValueList * evals);
 
-UINT g_decl_count = DECL_ID_UNDEF + 1;
-UINT g_aggr_count = AGGR_ID_UNDEF + 1;
-UINT g_aggr_anony_name_count = AGGR_ANONY_ID_UNDEF + 1;
-INT g_alignment = PRAGMA_ALIGN; //default alignment.
 CHAR const* g_dcl_name [] = { //character of DCL enum-type.
     "",
     "ARRAY",
@@ -81,6 +77,41 @@ static void * xmalloc(unsigned long size)
 }
 
 
+//Return the number of errors and warnings that have been reported.
+static UINT get_diag_count()
+{
+    return g_err_msg_list.get_elem_count() + g_warn_msg_list.get_elem_count();
+}
+
+
+//Return true if the size and the layout that computed while 'diagn'
+//diagnostics had been reported could be memoized.
+static bool is_memoizable(UINT diagn)
+{
+    //Do not memoize if there is diagnostic, the diagnostic should be
+    //reported by every query.
+    return get_diag_count() == diagn;
+}
+
+
+//Return the context that memoizes sizes and layouts in its own maps, or
+//nullptr if current context memoizes them on the declarations and
+//aggregates. Task context only reads the values memoized on the shared
+//objects, because they may be queried by concurrent tasks at the same
+//time.
+static CompileCtx * get_task_cache_ctx()
+{
+    CompileCtx * ctx = g_cur_ctx;
+    if (!ctx->is_task()) { return nullptr; }
+    if (CTX_task_cache_epoch(ctx) != g_layout_epoch) {
+        CTX_task_decl_size(ctx).clean();
+        CTX_task_aggr_layout(ctx).clean();
+        CTX_task_cache_epoch(ctx) = g_layout_epoch;
+    }
+    return ctx;
+}
+
+
 //Complement the INT specifier.
 //e.g: unsigned => unsigned int
 //    register => register int
@@ -243,6 +274,8 @@ Decl * dupDecl(Decl const* src)
     DECL_child(q) = nullptr;
     DECL_prev(q) = nullptr;
     DECL_next(q) = nullptr;
+    DECL_is_canon_type(q) = false;
+    DECL_byte_size_epoch(q) = LAYOUT_EPOCH_UNDEF;
     return q;
 }
 
@@ -416,6 +449,10 @@ bool Aggr::is_equal(Aggr const& src) const
 bool Decl::is_equal(Decl const& src) const
 {
     if (this == &src) { return true; }
+    if (TypeTab::isExactCanon(this) && TypeTab::isExactCanon(&src)) {
+        //Structurally identical canonical type-names are the same object.
+        return false;
+    }
     if (DECL_dt(this) != DECL_dt(&src)) { return false; }
     switch (DECL_dt(this)) {
     case DCL_NULL: ASSERT0(0);
@@ -633,6 +670,15 @@ Tree * Decl::getDeclInitTree() const
 }
 
 
+Scope * Decl::getFunBody() const
+{
+    if (DECL_is_lazy_body(this)) {
+        return parse_lazy_fun_body(const_cast<Decl*>(this));
+    }
+    return DECL_fun_body(this);
+}
+
+
 //Return true if 'd1' and 'd2' are the same identifier.
 //Note d1 and d2's identifier may be NULL.
 bool Decl::is_decl_equal(Decl const* d1, Decl const* d2)
@@ -943,15 +989,32 @@ ULONG Decl::getComplexTypeSize() const
 //This function will compute array size.
 UINT Decl::getDeclByteSize() const
 {
+    if (DECL_byte_size_epoch(this) == g_layout_epoch) {
+        return DECL_byte_size(this);
+    }
+    CompileCtx * taskctx = get_task_cache_ctx();
+    if (taskctx != nullptr) {
+        bool find = false;
+        UINT size = CTX_task_decl_size(taskctx).get(this, &find);
+        if (find) { return size; }
+    }
     TypeAttr const* spec = getTypeAttr();
     if (is_dt_declaration() || is_dt_typename()) {
         Decl const* d = getDeclarator(); //get declarator
         ASSERTN(d && (d->is_dt_declarator() || d->is_dt_abs_declarator()),
                 ("illegal declarator"));
-        if (d->is_complex_type()) {
-            return getComplexTypeSize();
-        }
-        return spec->getSpecTypeSize();
+        UINT diagn = get_diag_count();
+        UINT size = d->is_complex_type() ?
+            (UINT)getComplexTypeSize() : spec->getSpecTypeSize();
+        if (!is_memoizable(diagn)) { return size; }
+        if (taskctx != nullptr) {
+            CTX_task_decl_size(taskctx).setAlways(this, size);
+            return size;
+        }
+        Decl * pthis = const_cast<Decl*>(this);
+        DECL_byte_size(pthis) = size;
+        DECL_byte_size_epoch(pthis) = g_layout_epoch;
+        return size;
     }
     ASSERTN(0, ("unexpected declaration"));
     return 0;
@@ -1547,8 +1610,9 @@ bool isStructTypeExistInCurScope(CHAR const* tag, bool is_complete,
                                  Struct ** s)
 {
     Scope * sc = g_cur_scope;
-    if (isAggrTypeExist((List<Aggr*>*)sc->getStructList(),
-                        tag, is_complete, (Aggr**)s)) {
+    Aggr * a = nullptr;
+    if (isAggrTypeExist(sc, true, tag, is_complete, &a)) {
+        *s = (Struct*)a;
         return true;
     }
     return false;
@@ -1588,30 +1652,34 @@ static bool is_indirection(Decl const* dcl)
 //dcl:   DCL_DECLARATION info
 bool isDeclExistInOuterScope(CHAR const* name, OUT Decl ** dcl)
 {
+    return isDeclExistInOuterScope(find_sym(name), dcl);
+}
+
+
+//name: unique symbol for each of scope.
+//dcl:   DCL_DECLARATION info
+bool isDeclExistInOuterScope(Sym const* name, OUT Decl ** dcl)
+{
+    if (name == nullptr) { return false; }
     for (Scope const* scope = g_cur_scope; scope != nullptr;
          scope = SCOPE_parent(scope)) {
-        for (Decl * dcl_list = scope->getDeclList();
-             dcl_list != nullptr;) {//declaration list
-            Decl * dr = dcl_list;
-            dcl_list = DECL_next(dcl_list);
-            Sym const* sym = dr->getDeclSym();
-            if (sym == nullptr) {
-                continue;
-            }
-            if (::strcmp(sym->getStr(), name) == 0) {
-                *dcl = dr;
-                return true;
-            }
+        Decl * dr = scope->findDecl(name);
+        if (dr != nullptr) {
+            *dcl = dr;
+            return true;
         }
     }
     return false;
 }
 
 
-//Return true if 'decl' is unique at a list of Decl.
-bool isUniqueDecl(Decl const* decl_list, Decl const* decl)
+//Return true if 'decl' is unique at the declaration list of 'scope'.
+bool isUniqueDecl(Scope const* scope, Decl const* decl)
 {
-    for (Decl const* dcl = decl_list; dcl != nullptr; dcl = DECL_next(dcl)) {
+    //Only the declaration that has same name may be equal to 'decl'.
+    for (SymChain const* c = scope->getDeclChain(decl->getDeclSym());
+         c != nullptr; c = SYM_CHAIN_next(c)) {
+        Decl const* dcl = (Decl const*)SYM_CHAIN_obj(c);
         if (dcl == decl) { continue; }
         if (!Decl::is_decl_equal(dcl, decl)) { continue; }
         if (dcl->isAggrInComplete()) {
@@ -1636,18 +1704,14 @@ bool isUniqueDecl(Decl const* decl_list, Decl const* decl)
 Decl * get_decl_in_scope(CHAR const* name, Scope const* scope)
 {
     if (scope == nullptr) { return nullptr; }
+    return scope->findDecl(find_sym(name));
+}
 
-    Decl * dcl_list = scope->getDeclList();
-    while (dcl_list != nullptr) { //declaration list
-        Decl * dr = dcl_list;
-        dcl_list = DECL_next(dcl_list);
-        Sym const* sym = dr->getDeclSym();
-        if (sym == nullptr) { continue; }
-        if (::strcmp(sym->getStr(), name) == 0) {
-            return dr;
-        }
-    }
-    return nullptr;
+
+Decl * get_decl_in_scope(Sym const* name, Scope const* scope)
+{
+    if (scope == nullptr) { return nullptr; }
+    return scope->findDecl(name);
 }
 
 
@@ -1656,7 +1720,7 @@ static TypeAttr * typedef_name(TypeAttr * ty)
 {
     Decl * ut = nullptr;
     if (g_real_token != T_ID) { return nullptr; }
-    if (!isUserTypeExistInOuterScope(g_real_token_string, &ut)) {
+    if (!isUserTypeExistInOuterScope(CParser::findTokenSym(), &ut)) {
         return nullptr;
     }
     if (ty == nullptr) {
@@ -1970,6 +2034,10 @@ static TypeAttr * type_spec_struct(TypeAttr * ty)
     //    struct A a2;
     //    ...
     //  In actually, a1 and a2 are implemented in different alignment.
+    if (AGGR_align(s) != (UINT)alignment) {
+        //Memoized layouts depend on the alignment of aggregate.
+        g_layout_epoch++;
+    }
     AGGR_align(s) = alignment;
 
     TYPE_aggr_type(ty) = s;
@@ -2010,6 +2078,7 @@ static void type_spec_aggr_field(Aggr * aggr, TypeAttr * ty)
         return;
     }
     AGGR_is_complete(aggr) = true;
+    CTX_complete_aggr_vec(g_cur_ctx).append(aggr);
 }
 
 
@@ -2082,6 +2151,10 @@ static TypeAttr * type_spec_union(TypeAttr * ty)
     //    union A a2;
     //    ...
     //So, a1 and a2 are implement as different alignment!
+    if (AGGR_align(s) != (UINT)alignment) {
+        //Memoized layouts depend on the alignment of aggregate.
+        g_layout_epoch++;
+    }
     AGGR_align(s) = alignment;
 
     TYPE_aggr_type(ty) = s;
@@ -2169,16 +2242,18 @@ static EnumValueList * enumrator(Enum * en)
 
     LONGLONG idx = 0;
     EnumValueList * evl = (EnumValueList*)xmalloc(sizeof(EnumValueList));
-    EVAL_name(evl) = g_fe_sym_tab->add(g_real_token_string);
+    EVAL_name(evl) = CParser::addTokenToSymTab();
 
     Enum * tmp = nullptr;
-    if (g_cur_scope->isEnumExist(g_real_token_string, &tmp, (INT*)&idx)) {
+    if (g_cur_scope->isEnumExist(EVAL_name(evl), &tmp, (INT*)&idx)) {
         err(g_real_line_num, "'%s' : redefinition , different basic type",
             g_real_token_string);
         return evl;
     }
 
     xcom::add_next(&ENUM_vallist(en), evl);
+    g_cur_scope->addEnumVal(
+        en, evl, (INT)xcom::cnt_list(en->getValList()) - 1);
 
     CParser::match(T_ID);
     if (g_real_token != T_ASSIGN) {
@@ -2238,7 +2313,7 @@ static TypeAttr * enum_spec(TypeAttr * ty)
 
     if (g_real_token == T_ID) {
         //Parse enumerator's name. Note the name is optional.
-        ENUM_name(ty->getEnumType()) = g_fe_sym_tab->add(g_real_token_string);
+        ENUM_name(ty->getEnumType()) = CParser::addTokenToSymTab();
         CParser::match(T_ID);
     }
 
@@ -2466,17 +2541,16 @@ static TypeAttr * parseAggrType(
 static TypeAttr * parseUserDefinedSpecifier(TypeAttr * ty, bool * parse_finish)
 {
     Decl * ut = nullptr;
-    if (isUserTypeExistInOuterScope(g_real_token_string, &ut)) {
+    Sym const* sym = CParser::findTokenSym();
+    if (isUserTypeExistInOuterScope(sym, &ut)) {
         return parseUserType(ty, parse_finish);
     }
     Struct * s = nullptr;
-    if (isStructExistInOuterScope(g_cur_scope, g_real_token_string,
-                                  false, &s)) {
+    if (isStructExistInOuterScope(g_cur_scope, sym, false, &s)) {
         return parseAggrType(ty, parse_finish, s, true);
     }
     Union * u = nullptr;
-    if (isUnionExistInOuterScope(g_cur_scope, g_real_token_string,
-                                 false, &u)) {
+    if (isUnionExistInOuterScope(g_cur_scope, sym, false, &u)) {
         return parseAggrType(ty, parse_finish, u, false);
     }
 
@@ -2798,10 +2872,10 @@ static Decl * direct_abstract_declarator(TypeAttr * qua)
         DECL_is_paren(dcl) = 1;
         break;
     case T_ID: { //identifier
-        Sym const* sym = g_fe_sym_tab->add(g_real_token_string);
+        Sym const* sym = CParser::addTokenToSymTab();
         g_cur_scope->addToSymList(sym);
         dcl = newDecl(DCL_ID);
-        DECL_id_tree(dcl) = CParser::id();
+        DECL_id_tree(dcl) = CParser::id(sym, g_real_token);
         DECL_qua(dcl) = qua;
         CParser::match(T_ID);
         break;
@@ -3290,7 +3364,7 @@ static bool process_declaration(OUT Decl * declaration)
     } else {
         //Check the declaration that should be unique at current scope.
         //Variable definition/declaration.
-        if (!isUniqueDecl(g_cur_scope->getDeclList(), declaration)) {
+        if (!isUniqueDecl(g_cur_scope, declaration)) {
             err(g_real_line_num, "'%s' already defined",
                 declaration->getDeclSym()->getStr());
             return false;
@@ -3445,10 +3519,10 @@ static Decl * direct_declarator(TypeAttr const* ts, TypeAttr * qua)
                 "meet '%s', illegal qualifier of declaration",
                 g_real_token_string);
         }
-        Sym const* sym = g_fe_sym_tab->add(g_real_token_string);
+        Sym const* sym = CParser::addTokenToSymTab();
         g_cur_scope->addToSymList(sym);
         dcl = newDecl(DCL_ID);
-        DECL_id_tree(dcl) = CParser::id();
+        DECL_id_tree(dcl) = CParser::id(sym, g_real_token);
         DECL_qua(dcl) = qua;
         CParser::match(T_ID);
         break;
@@ -3674,10 +3748,9 @@ static Tree * refineArray(Tree * t)
     if (base->getCode() != TR_ID) { return t; }
 
     //ID is unique to its scope.
-    CHAR const* name = TREE_id_name(base)->getStr();
     ASSERT0(TREE_id_decl(base));
     Scope * s = TREE_id_decl(base)->getDeclScope();
-    Decl * decl = get_decl_in_scope(name, s);
+    Decl * decl = get_decl_in_scope(TREE_id_name(base), s);
     ASSERT0(decl != nullptr);
     if (decl->is_formal_param()) {
         return refineArrayParam(t, base, decl);
@@ -3699,7 +3772,7 @@ static Tree * refine_tree(Tree * t)
         SCOPE_stmt_list(s) = refine_tree_list(s->getStmtList());
     }
 
-    for (UINT i = 0; i < MAX_TREE_FLDS; i++) {
+    for (UINT i = 0; i < t->getFldNum(); i++) {
         refine_tree_list(TREE_fld(t, i));
     }
     return t;
@@ -3791,10 +3864,20 @@ bool isAggrExistInOuterScope(Scope * scope, CHAR const* tag, bool is_complete,
                              TypeAttr const* ta, OUT Aggr ** s)
 {
     if (ta->isStructExpanded()) {
-        return isStructExistInOuterScope(scope, tag, is_complete, (Struct**)s);
+        Struct * st = nullptr;
+        if (!isStructExistInOuterScope(scope, tag, is_complete, &st)) {
+            return false;
+        }
+        *s = st;
+        return true;
     }
     ASSERT0(ta->isUnionExpanded());
-    return isUnionExistInOuterScope(scope, tag, is_complete, (Union**)s);
+    Union * un = nullptr;
+    if (!isUnionExistInOuterScope(scope, tag, is_complete, &un)) {
+        return false;
+    }
+    *s = un;
+    return true;
 }
 
 
@@ -3802,10 +3885,20 @@ bool isAggrExistInOuterScope(Scope * scope, Sym const* tag, bool is_complete,
                              TypeAttr const* ta, OUT Aggr ** s)
 {
     if (ta->isStructExpanded()) {
-        return isStructExistInOuterScope(scope, tag, is_complete, (Struct**)s);
+        Struct * st = nullptr;
+        if (!isStructExistInOuterScope(scope, tag, is_complete, &st)) {
+            return false;
+        }
+        *s = st;
+        return true;
     }
     ASSERT0(ta->isUnionExpanded());
-    return isUnionExistInOuterScope(scope, tag, is_complete, (Union**)s);
+    Union * un = nullptr;
+    if (!isUnionExistInOuterScope(scope, tag, is_complete, &un)) {
+        return false;
+    }
+    *s = un;
+    return true;
 }
 
 
@@ -3815,13 +3908,9 @@ bool isStructExistInOuterScope(Scope * scope, CHAR const* tag,
                                bool is_complete, OUT Struct ** s)
 {
     ASSERT0(scope);
-    for (Scope * sc = scope; sc != nullptr; sc = SCOPE_parent(sc)) {
-        if (isAggrTypeExist((List<Aggr*>*)sc->getStructList(),
-                            tag, is_complete, (Aggr**)s)) {
-            return true;
-        }
-    }
-    return false;
+    Sym const* sym = find_sym(tag);
+    if (sym == nullptr) { return false; }
+    return isStructExistInOuterScope(scope, sym, is_complete, s);
 }
 
 
@@ -3832,8 +3921,9 @@ bool isStructExistInOuterScope(Scope * scope, Sym const* tag,
 {
     ASSERT0(scope);
     for (Scope * sc = scope; sc != nullptr; sc = SCOPE_parent(sc)) {
-        if (isAggrTypeExist((List<Aggr*>*)sc->getStructList(),
-                            tag, is_complete, (Aggr**)s)) {
+        Aggr * a = nullptr;
+        if (isAggrTypeExist(sc, true, tag, is_complete, &a)) {
+            *s = (Struct*)a;
             return true;
         }
     }
@@ -3846,15 +3936,9 @@ bool isStructExistInOuterScope(Scope * scope, Sym const* tag,
 bool isUnionExistInOuterScope(Scope * scope, CHAR const* tag,
                               bool is_complete, OUT Union ** s)
 {
-    Scope * sc = scope;
-    while (sc != nullptr) {
-        if (isAggrTypeExist((List<Aggr*>*)sc->getUnionList(), tag,
-                            is_complete, (Aggr**)s)) {
-            return true;
-        }
-        sc = SCOPE_parent(sc);
-    }
-    return false;
+    Sym const* sym = find_sym(tag);
+    if (sym == nullptr) { return false; }
+    return isUnionExistInOuterScope(scope, sym, is_complete, s);
 }
 
 
@@ -3865,8 +3949,9 @@ bool isUnionExistInOuterScope(Scope * scope, Sym const* tag,
 {
     Scope * sc = scope;
     while (sc != nullptr) {
-        if (isAggrTypeExist((List<Aggr*>*)sc->getUnionList(), tag,
-                            is_complete, (Aggr**)s)) {
+        Aggr * a = nullptr;
+        if (isAggrTypeExist(sc, false, tag, is_complete, &a)) {
+            *s = (Union*)a;
             return true;
         }
         sc = sc->getParent();
@@ -3882,8 +3967,15 @@ bool isUnionExistInOuterScope(Scope * scope, Sym const* tag,
 //idx: index in enum 'e' value list, start at 0.
 bool findEnumVal(CHAR const* name, OUT Enum ** e, OUT INT * idx)
 {
+    return findEnumVal(find_sym(name), e, idx);
+}
+
+
+bool findEnumVal(Sym const* sym, OUT Enum ** e, OUT INT * idx)
+{
+    if (sym == nullptr) { return false; }
     for (Scope * sc = g_cur_scope; sc != nullptr; sc = SCOPE_parent(sc)) {
-        if (sc->isEnumExist(name, e, idx)) {
+        if (sc->isEnumExist(sym, e, idx)) {
             return true;
         }
     }
@@ -3894,9 +3986,13 @@ bool findEnumVal(CHAR const* name, OUT Enum ** e, OUT INT * idx)
 //Enum typed identifier is effective at all of outer scopes.
 bool isEnumTagExistInOuterScope(CHAR const* cl, OUT Enum ** e)
 {
+    Sym const* sym = find_sym(cl);
+    if (sym == nullptr) { return false; }
     Scope * sc = g_cur_scope;
     while (sc != nullptr) {
-        if (isEnumTagExist(sc->getEnumTab(), cl, e)) {
+        Enum * en = sc->findEnumTag(sym);
+        if (en != nullptr) {
+            *e = en;
             return true;
         }
         sc = SCOPE_parent(sc);
@@ -3954,48 +4050,33 @@ bool Enum::isEnumValExistAndEvalValue(EnumValueList const* evl,
 //END Enum
 
 
-//Return true if enum identifier existed.
-static bool isEnumTagExist(EnumTab const* entab, CHAR const* id_name,
-                           OUT Enum ** e)
+bool isUserTypeExist(Scope const* sc, CHAR const* ut_name,
+                     OUT Decl ** decl)
 {
-    if (entab == nullptr || id_name == nullptr) { return false; }
-    EnumTabIter it;
-    for (Enum * en = entab->get_first(it);
-         en != nullptr; en = entab->get_next(it)) {
-        if (en->getName() == nullptr) {
-            continue;
-        }
-        if (::strcmp(en->getName()->getStr(), id_name) == 0) {
-            *e = en;
-            return true;
-        }
+    if (sc == nullptr || ut_name == nullptr) { return false; }
+    Decl * dcl = sc->findUserType(find_sym(ut_name));
+    if (dcl != nullptr) {
+        *decl = dcl;
+        return true;
     }
     return false;
 }
 
 
-bool isUserTypeExist(UserTypeList const* ut_list, CHAR const* ut_name,
-                     OUT Decl ** decl)
+bool isUserTypeExistInOuterScope(CHAR const* ut_name, OUT Decl ** decl)
 {
-    if (ut_list == nullptr || ut_name == nullptr) { return false; }
-
-    for (UserTypeList const* utl = ut_list; utl != nullptr;
-         utl = USER_TYPE_LIST_next(utl)) {
-        Decl * dcl = USER_TYPE_LIST_utype(utl);
-        if (::strcmp(dcl->getDeclSym()->getStr(), ut_name) == 0) {
-            *decl = dcl;
-            return true;
-        }
-    }
-    return false;
+    return isUserTypeExistInOuterScope(find_sym(ut_name), decl);
 }
 
 
-bool isUserTypeExistInOuterScope(CHAR const* ut_name, OUT Decl ** decl)
+bool isUserTypeExistInOuterScope(Sym const* sym, OUT Decl ** decl)
 {
+    if (sym == nullptr) { return false; }
     Scope * sc = g_cur_scope;
     while (sc != nullptr) {
-        if (isUserTypeExist(SCOPE_user_type_list(sc), ut_name, decl)) {
+        Decl * dcl = sc->findUserType(sym);
+        if (dcl != nullptr) {
+            *decl = dcl;
             return true;
         }
         sc = SCOPE_parent(sc);
@@ -4004,38 +4085,24 @@ bool isUserTypeExistInOuterScope(CHAR const* ut_name, OUT Decl ** decl)
 }
 
 
-bool isAggrTypeExist(List<Aggr*> const* aggrs, Sym const* tag,
+bool isAggrTypeExist(Scope const* sc, bool is_struct, Sym const* tag,
                      bool is_complete, OUT Aggr ** s)
 {
     if (tag == nullptr) { return false; }
-    xcom::C<Aggr*> * ct;
-    for (Aggr * st = aggrs->get_head(&ct);
-         ct != nullptr; st = aggrs->get_next(&ct)) {
-        if (st->getTag() == tag && (!is_complete || st->is_complete())) {
-            *s = st;
-            return true;
-        }
+    Aggr * a = sc->findAggr(tag, is_struct, is_complete);
+    if (a != nullptr) {
+        *s = a;
+        return true;
     }
     return false;
 }
 
 
-bool isAggrTypeExist(List<Aggr*> const* aggrs, CHAR const* tag,
+bool isAggrTypeExist(Scope const* sc, bool is_struct, CHAR const* tag,
                      bool is_complete, OUT Aggr ** s)
 {
     if (tag == nullptr) { return false; }
-    xcom::C<Aggr*> * ct;
-    for (Aggr * st = aggrs->get_head(&ct);
-         ct != nullptr; st = aggrs->get_next(&ct)) {
-        Sym const* sym = st->getTag();
-        if (sym == nullptr) { continue; }
-        if (::strcmp(sym->getStr(), tag) == 0 &&
-            (!is_complete || st->is_complete())) {
-            *s = st;
-            return true;
-        }
-    }
-    return false;
+    return isAggrTypeExist(sc, is_struct, find_sym(tag), is_complete, s);
 }
 
 
@@ -4047,7 +4114,7 @@ bool inFirstSetOfDeclaration()
         //decaration.
         //e.g: typedef struct tagS S;
         //     S is belong to the first-set, whereas tagS is not.
-        if (isUserTypeExistInOuterScope(g_real_token_string, &ut)) {
+        if (isUserTypeExistInOuterScope(CParser::findTokenSym(), &ut)) {
             return true;
         }
         return false;
@@ -4200,47 +4267,83 @@ UINT Aggr::computeAlignedSize(UINT size, UINT max_field_size) const
 }
 
 
-static UINT compute_field_ofst(
-    Aggr const* s, UINT ofst, Decl const* dcl, UINT field_align,
-    UINT * elem_bytesize)
+//Compute the byte size and the number of element of field 'dcl'.
+//The number of element is 0 if 'dcl' is array with zero highest dimension.
+static UINT compute_field_elem_size(Decl const* dcl, OUT UINT * elem_num)
 {
     if (dcl->is_array()) {
         Decl const* elem_dcl = dcl->getArrayBaseDecl();
-        *elem_bytesize = elem_dcl->getDeclByteSize();
-        UINT elem_num = dcl->getArrayElemNum();
-        if (elem_num != 0) {
-            //C-language allows the highest dimension of array to be zero.
-            //e.g:struct { int a; char cc[]; };
-            ofst = compute_field_ofst_consider_pad(
-                s, ofst, *elem_bytesize, elem_num, AGGR_field_align(s));
-        }
+        UINT elem_bytesize = elem_dcl->getDeclByteSize();
+        *elem_num = (UINT)dcl->getArrayElemNum();
+        return elem_bytesize;
+    }
+    *elem_num = 1;
+    return dcl->getDeclByteSize();
+}
+
+
+//Return the byte offset after appending 'elem_num' elements that byte size
+//is 'elem_bytesize' to 'ofst'.
+static UINT append_field_ofst(Aggr const* s, UINT ofst, UINT elem_bytesize,
+                              UINT elem_num)
+{
+    if (elem_num == 0) {
+        //C-language allows the highest dimension of array to be zero.
+        //e.g:struct { int a; char cc[]; };
         return ofst;
     }
-    *elem_bytesize = dcl->getDeclByteSize();
-    ofst = compute_field_ofst_consider_pad(
-        s, ofst, *elem_bytesize, 1, AGGR_field_align(s));
-    return ofst;
+    return compute_field_ofst_consider_pad(
+        s, ofst, elem_bytesize, elem_num, AGGR_field_align(s));
 }
 
 
-UINT TypeAttr::computeStructTypeSize(Aggr const* s)
+static UINT compute_field_ofst(
+    Aggr const* s, UINT ofst, Decl const* dcl, UINT field_align,
+    UINT * elem_bytesize)
+{
+    UINT elem_num = 0;
+    *elem_bytesize = compute_field_elem_size(dcl, &elem_num);
+    return append_field_ofst(s, ofst, *elem_bytesize, elem_num);
+}
+
+
+//Walk through the fields of struct 's' to compute the byte size of fields
+//and the offset of each field.
+//The offset of field conforms to get_aggr_field(), which does not pack the
+//adjacent bit fields.
+//layout: record the byte size, and the offset of field if
+//        AGGR_LAYOUT_field_ofst is not nullptr.
+static void compute_struct_layout(Aggr const* s, MOD AggrLayout * layout)
 {
     UINT ofst = 0;
     UINT max_field_sz = 0;
+    UINT fld_ofst = 0; //offset of field that conforms to get_aggr_field().
+    UINT * fld_ofst_vec = AGGR_LAYOUT_field_ofst(layout);
+    UINT i = 0;
     for (Decl const* dcl = s->getDeclList(); dcl != nullptr;) {
         if (dcl->is_bitfield()) {
+            Decl const* start = dcl;
+
             //dcl will be updated to next declaration in
             //computeBitFieldByteSize().
             UINT bytesize = computeBitFieldByteSize(&dcl);
             ofst = compute_field_ofst_consider_pad(s, ofst, bytesize, 1,
                                                    AGGR_field_align(s));
             max_field_sz = MAX(max_field_sz, bytesize);
+            if (fld_ofst_vec == nullptr) { continue; }
+            for (; start != dcl; start = DECL_next(start), i++) {
+                fld_ofst_vec[i] = fld_ofst;
+                UINT elem_bytesize = 0;
+                fld_ofst = compute_field_ofst(s, fld_ofst, start,
+                                              AGGR_field_align(s),
+                                              &elem_bytesize);
+            }
             continue;
         }
 
-        UINT elem_bytesize = 0;
-        UINT newofst = compute_field_ofst(s, ofst, dcl, AGGR_field_align(s),
-                                          &elem_bytesize);
+        UINT elem_num = 0;
+        UINT elem_bytesize = compute_field_elem_size(dcl, &elem_num);
+        UINT newofst = append_field_ofst(s, ofst, elem_bytesize, elem_num);
         if (newofst < ofst) {
             err(g_real_line_num, "field size may be too large");
             //Error recovery: to avoid ASSERTION in size verification.
@@ -4248,22 +4351,133 @@ UINT TypeAttr::computeStructTypeSize(Aggr const* s)
         }
         ofst = newofst;
         max_field_sz = MAX(max_field_sz, elem_bytesize);
+        if (fld_ofst_vec != nullptr) {
+            fld_ofst_vec[i] = fld_ofst;
+            fld_ofst = append_field_ofst(s, fld_ofst, elem_bytesize, elem_num);
+        }
         dcl = DECL_next(dcl);
+        i++;
     }
-
-    UINT size = ofst;
-    return s->computeAlignedSize(size, max_field_sz);
+    AGGR_LAYOUT_size(layout) = ofst;
+    AGGR_LAYOUT_max_field_size(layout) = max_field_sz;
 }
 
 
-UINT TypeAttr::computeUnionTypeSize(Aggr const* s)
+static void compute_union_layout(Aggr const* s, MOD AggrLayout * layout)
 {
     UINT size = 0;
     for (Decl const* dcl = s->getDeclList();
          dcl != nullptr; dcl = DECL_next(dcl)) {
         size = MAX(size, dcl->getDeclByteSize());
     }
-    return s->computeAlignedSize(size, size);
+    AGGR_LAYOUT_size(layout) = size;
+    AGGR_LAYOUT_max_field_size(layout) = size;
+}
+
+
+AggrLayout const* Aggr::getLayout() const
+{
+    AggrLayout const* l = AGGR_layout(this);
+    if (l != nullptr && AGGR_LAYOUT_epoch(l) == g_layout_epoch) {
+        return l;
+    }
+    CompileCtx * taskctx = get_task_cache_ctx();
+    if (taskctx == nullptr) { return nullptr; }
+    //The layouts in the map are all computed in current epoch.
+    return CTX_task_aggr_layout(taskctx).get(this);
+}
+
+
+//Allocate the layout of aggregate that has 'n' fields.
+static AggrLayout * alloc_layout(UINT n, bool is_struct)
+{
+    AggrLayout * layout = (AggrLayout*)xmalloc(sizeof(AggrLayout));
+    AGGR_LAYOUT_field_num(layout) = n;
+    if (is_struct && n != 0) {
+        //Round the offset array up to keep the following nodes aligned.
+        AGGR_LAYOUT_field_ofst(layout) = (UINT*)xmalloc(
+            (size_t)xcom::ceil_align(sizeof(UINT) * n, alignof(Decl)));
+    }
+    return layout;
+}
+
+
+AggrLayout const* Aggr::computeLayout(bool is_struct) const
+{
+    if (!is_complete()) { return nullptr; }
+    AggrLayout const* l = getLayout();
+    if (l != nullptr) { return l; }
+    CompileCtx * taskctx = get_task_cache_ctx();
+    if (taskctx != nullptr) {
+        //The layout is allocated in the pool of task, and memoized in the
+        //map of task.
+        AggrLayout * layout = alloc_layout(xcom::cnt_list(getDeclList()),
+                                           is_struct);
+        UINT diagn = get_diag_count();
+        if (is_struct) {
+            compute_struct_layout(this, layout);
+        } else {
+            compute_union_layout(this, layout);
+        }
+        if (is_memoizable(diagn)) {
+            AGGR_LAYOUT_epoch(layout) = g_layout_epoch;
+            CTX_task_aggr_layout(taskctx).setAlways(this, layout);
+        }
+        return layout;
+    }
+
+    AggrLayout * layout = AGGR_layout(this);
+    if (layout == nullptr && FuncStream::isInFuncArena()) {
+        //The layout allocated in function arena would be released along
+        //with the function body, even if the aggregate is global.
+        return nullptr;
+    }
+    if (layout == nullptr) {
+        layout = alloc_layout(xcom::cnt_list(getDeclList()), is_struct);
+        AGGR_layout(const_cast<Aggr*>(this)) = layout;
+    }
+    ASSERT0(AGGR_LAYOUT_field_num(layout) == xcom::cnt_list(getDeclList()));
+    UINT diagn = get_diag_count();
+    if (is_struct) {
+        compute_struct_layout(this, layout);
+    } else {
+        compute_union_layout(this, layout);
+    }
+    AGGR_LAYOUT_epoch(layout) = is_memoizable(diagn) ?
+        g_layout_epoch : LAYOUT_EPOCH_UNDEF;
+    return layout;
+}
+
+
+UINT TypeAttr::computeStructTypeSize(Aggr const* s)
+{
+    AggrLayout const* l = s->computeLayout(true);
+    if (l == nullptr) {
+        //Incomplete struct, or the layout could not be memoized.
+        AggrLayout tmp;
+        ::memset((void*)&tmp, 0, sizeof(AggrLayout));
+        compute_struct_layout(s, &tmp);
+        return s->computeAlignedSize(AGGR_LAYOUT_size(&tmp),
+                                     AGGR_LAYOUT_max_field_size(&tmp));
+    }
+    return s->computeAlignedSize(AGGR_LAYOUT_size(l),
+                                 AGGR_LAYOUT_max_field_size(l));
+}
+
+
+UINT TypeAttr::computeUnionTypeSize(Aggr const* s)
+{
+    AggrLayout const* l = s->computeLayout(false);
+    if (l == nullptr) {
+        //Incomplete union, or the layout could not be memoized.
+        AggrLayout tmp;
+        ::memset((void*)&tmp, 0, sizeof(AggrLayout));
+        compute_union_layout(s, &tmp);
+        return s->computeAlignedSize(AGGR_LAYOUT_size(&tmp),
+                                     AGGR_LAYOUT_max_field_size(&tmp));
+    }
+    return s->computeAlignedSize(AGGR_LAYOUT_size(l),
+                                 AGGR_LAYOUT_max_field_size(l));
 }
 
 
@@ -5014,6 +5228,14 @@ bool TypeAttr::isUnionExpanded() const
 Decl * convertToPointerTypeName(Decl const* decl)
 {
     ASSERT0(decl);
+    ASSERTN(decl->is_dt_typename(), ("expect type-name"));
+    Decl const* absdeclor = DECL_decl_list(decl);
+    if (absdeclor->is_dt_abs_declarator() && !DECL_is_bit_field(absdeclor)) {
+        //Share the canonical type-name.
+        Decl * ptn = g_type_tab->getPointerTypeName(decl->getTypeAttr(),
+                                                    DECL_trait(decl));
+        if (ptn != nullptr) { return ptn; }
+    }
     Decl * tn = dupTypeName(decl);
     Decl * declor = tn->getPureDeclaratorList();
     if (declor->is_dt_abs_declarator()) {
@@ -5058,9 +5280,14 @@ bool get_aggr_field(TypeAttr const* ty, CHAR const* name, Decl ** fld_decl,
     ASSERT0(ty->is_aggr());
     Aggr * s = ty->getAggrType();
     bool is_union = ty->is_union();
+    AggrLayout const* l = is_union ? nullptr : s->getLayout();
     UINT ofst = 0;
+    UINT i = 0;
     for (Decl * dcl = s->getDeclList(); dcl != nullptr;
-         dcl = DECL_next(dcl)) {
+         dcl = DECL_next(dcl), i++) {
+        if (l != nullptr) {
+            ofst = AGGR_LAYOUT_field_ofst(l)[i];
+        }
         Sym const* sym = dcl->getDeclSym();
         if (::strcmp(name, sym->getStr()) == 0) {
             if (fld_decl != nullptr) {
@@ -5081,8 +5308,9 @@ bool get_aggr_field(TypeAttr const* ty, CHAR const* name, Decl ** fld_decl,
                 return true;
             }
         }
-        if (is_union) {
+        if (is_union || l != nullptr) {
             //Each field in UNION is offset from 0.
+            //Or the offset has been recorded in layout.
             continue;
         }
         UINT elem_bytesize = 0;
@@ -5103,18 +5331,21 @@ bool get_aggr_field(TypeAttr const* ty, INT idx, Decl ** fld_decl,
     Decl * dcl = s->getDeclList();
     UINT ofst = 0;
     bool is_union = ty->is_union();
-    for (; dcl != nullptr && idx >= 0; dcl = DECL_next(dcl), idx--) {
+    AggrLayout const* l = is_union ? nullptr : s->getLayout();
+    for (UINT i = 0; dcl != nullptr && idx >= 0;
+         dcl = DECL_next(dcl), idx--, i++) {
         if (idx == 0) {
             if (fld_decl != nullptr) {
                 *fld_decl = dcl;
             }
             if (fld_ofst != nullptr) {
-                *fld_ofst = ofst;
+                *fld_ofst = l != nullptr ? AGGR_LAYOUT_field_ofst(l)[i] : ofst;
             }
             return true;
         }
-        if (is_union) {
+        if (is_union || l != nullptr) {
             //Each field in UNION is offset from 0.
+            //Or the offset has been recorded in layout.
             continue;
         }
         UINT elem_bytesize = 0;
@@ -5209,15 +5440,17 @@ static bool parse_function_definition(Decl * declaration)
     }
 
     //Check if 'decl' is unique at scope declaration list.
-    Decl * dcl = g_cur_scope->getDeclList();
-    while (dcl != nullptr) {
+    //Only the declaration that has same name may be equal to 'decl'.
+    for (SymChain const* c = g_cur_scope->getDeclChain(
+             declaration->getDeclSym());
+         c != nullptr; c = SYM_CHAIN_next(c)) {
+        Decl * dcl = (Decl*)SYM_CHAIN_obj(c);
         if (Decl::is_decl_equal(dcl, declaration) && declaration != dcl
             && DECL_is_fun_def(dcl)) {
             err(g_real_line_num, "function '%s' already defined",
                 dcl->getDeclSym()->getStr());
             return false;
         }
-        dcl = DECL_next(dcl);
     }
 
     //Add decl to scope here to support recursive func-call.
@@ -5233,6 +5466,32 @@ static bool parse_function_definition(Decl * declaration)
 
     remove_redundant_para(declaration);
     Decl * para_list = get_parameter_list(declaration);
+
+    //In streaming mode, the function body is allocated in function arena,
+    //and released once the function has been compiled.
+    FuncStream * fs = CTX_func_stream(g_cur_ctx);
+    if (g_enable_lazy_fun_body && fs == nullptr) {
+        LazyFunBody * body = CParser::skipFunBody();
+        if (body != nullptr) {
+            DECL_is_fun_def(declaration) = true;
+            DECL_is_lazy_body(declaration) = true;
+            DECL_lazy_body(declaration) = body;
+            return true;
+        }
+    }
+    if (fs != nullptr) {
+        fs->openArena(declaration);
+    }
+    bool succ = parse_function_body(declaration, para_list);
+    if (fs != nullptr) {
+        fs->closeArena(declaration);
+    }
+    return succ;
+}
+
+
+static bool parse_function_body(Decl * declaration, Decl * para_list)
+{
     DECL_fun_body(declaration) = CParser::compound_stmt(para_list);
 
     DECL_is_fun_def(declaration) = true;
@@ -5251,6 +5510,45 @@ static bool parse_function_definition(Decl * declaration)
 }
 
 
+//Parse the function body that has been skipped by lazy parsing.
+//The body is parsed in global scope with the alignment of context when
+//it was skipped. The objects added into global scope after the body are
+//invisible, and the aggregates completed after the body are regarded as
+//incomplete, thus the body sees the global scope as it was at '{'.
+static Scope * parse_lazy_fun_body(Decl * declaration)
+{
+    ASSERT0(DECL_is_lazy_body(declaration));
+    ASSERTN(!g_cur_ctx->is_task(), ("task can not parse function body"));
+    LazyFunBody const* body = DECL_lazy_body(declaration);
+    DECL_is_lazy_body(declaration) = false;
+    DECL_fun_body(declaration) = nullptr;
+    Scope * org_scope = g_cur_scope;
+    UINT org_align = g_alignment;
+    UINT org_visible_seq = CTX_visible_seq(g_cur_ctx);
+    xcom::Vector<Aggr*> & cvec = CTX_complete_aggr_vec(g_cur_ctx);
+    UINT complete_num = cvec.get_elem_count();
+    for (UINT i = LAZY_FUN_BODY_complete_aggr_num(body);
+         i < complete_num; i++) {
+        AGGR_is_complete(cvec.get(i)) = false;
+    }
+    g_cur_scope = get_global_scope();
+    g_alignment = LAZY_FUN_BODY_align(body);
+    CTX_visible_seq(g_cur_ctx) = LAZY_FUN_BODY_visible_seq(body);
+    {
+        LazyFunBodyScanner scanner(body);
+        parse_function_body(declaration, get_parameter_list(declaration));
+    }
+    CTX_visible_seq(g_cur_ctx) = org_visible_seq;
+    for (UINT i = LAZY_FUN_BODY_complete_aggr_num(body);
+         i < complete_num; i++) {
+        AGGR_is_complete(cvec.get(i)) = true;
+    }
+    g_cur_scope = org_scope;
+    g_alignment = org_align;
+    return DECL_fun_body(declaration);
+}
+
+
 static Decl * factor_user_type_rec(Decl const* decl, TypeAttr ** new_spec)
 {
     ASSERT0(decl->is_dt_declaration() || decl->is_dt_typename());
@@ -34,6 +34,7 @@ namespace xfe {
 #define DECL_ID_UNDEF 0
 #define AGGR_ID_UNDEF 0
 #define AGGR_ANONY_ID_UNDEF 0
+#define LAYOUT_EPOCH_UNDEF 0
 
 class Scope;
 
@@ -123,6 +124,31 @@ public:
 };
 
 
+//The class records the memory layout of a complete aggregate.
+//The layout is computed by the first size query after the aggregate became
+//complete, and reused by the following size and offset queries until
+//any alignment or declaration it depends on has been changed,
+//see g_layout_epoch.
+#define AGGR_LAYOUT_epoch(l) ((l)->epoch)
+#define AGGR_LAYOUT_size(l) ((l)->size)
+#define AGGR_LAYOUT_max_field_size(l) ((l)->max_field_size)
+#define AGGR_LAYOUT_field_num(l) ((l)->field_num)
+#define AGGR_LAYOUT_field_ofst(l) ((l)->field_ofst)
+class AggrLayout {
+public:
+    //The epoch of layout that the record computed in, 0 means the record
+    //is out of date.
+    UINT epoch;
+    UINT size; //byte size of fields, not include the tail padding.
+    UINT max_field_size; //byte size of the biggest field.
+    UINT field_num; //the number of fields.
+
+    //Byte offset of each field, indexed by the position in field list.
+    //The offset of UNION field is always 0, thus it is nullptr for UNION.
+    UINT * field_ofst;
+};
+
+
 //Aggregation
 #define AGGR_id(s) ((s)->m_id)
 #define AGGR_decl_list(s) ((s)->m_decl_list)
@@ -132,6 +158,7 @@ public:
 #define AGGR_field_align(s) ((s)->m_field_align)
 #define AGGR_pack_align(s) ((s)->m_pack_align)
 #define AGGR_scope(s) ((s)->m_scope)
+#define AGGR_layout(s) ((s)->m_layout)
 class Aggr {
 public:
     UINT m_id:31;
@@ -144,16 +171,27 @@ public:
     Decl * m_decl_list;
     xoc::Sym const* m_tag;
     Scope * m_scope;
+    AggrLayout * m_layout; //cached layout of complete aggregate.
 public:
     //Compute new alignment size according to given 'size' and 'max_field_size'.
     UINT computeAlignedSize(UINT size, UINT max_field_size) const;
 
+    //Compute the layout of complete aggregate, the cached layout is returned
+    //if it is up to date. Task context caches the layout in its own map.
+    //Return nullptr if the aggregate is incomplete, or the layout can not be
+    //kept beyond the function arena of FuncStream.
+    AggrLayout const* computeLayout(bool is_struct) const;
+
     Decl * getDeclList() const { return AGGR_decl_list(this); }
     xoc::Sym const* getTag() const { return AGGR_tag(this); }
     UINT getAlign() const { return AGGR_align(this); }
     UINT getPackAlign() const { return AGGR_pack_align(this); }
     Scope * getScope() const { return AGGR_scope(this); }
 
+    //Return the cached layout if it is up to date, otherwise nullptr.
+    //Task context also looks up the layouts that it cached itself.
+    AggrLayout const* getLayout() const;
+
     UINT id() const { return AGGR_id(this); }
     bool is_equal(Aggr const& src) const;
     bool is_complete() const { return AGGR_is_complete(this); }
@@ -471,6 +509,15 @@ public:
 //ONLY used in DCL_DECLARATION
 #define DECL_is_formal_param(d) ((d)->m_is_formal_param)
 #define DECL_is_anony_aggr(d) ((d)->m_is_anony_aggregate)
+
+//Set to true if the TYPE_NAME is the canonical type-name that is interned
+//by TypeTab. The Decl is shared and MUST NOT be modified.
+#define DECL_is_canon_type(d) ((d)->m_is_canon_type)
+
+//Record the cached result of getDeclByteSize(). The cache is valid if
+//DECL_byte_size_epoch is equal to g_layout_epoch.
+#define DECL_byte_size(d) ((d)->m_byte_size)
+#define DECL_byte_size_epoch(d) ((d)->m_byte_size_epoch)
 #define DECL_dt(d) ((d)->decl_type)
 #define DECL_next(d) ((d)->next)
 #define DECL_prev(d) ((d)->prev)
@@ -498,6 +545,12 @@ public:
 //If current 'decl' is a function define, the followed member record its body.
 #define DECL_fun_body(d) ((d)->u2.fun_body)
 
+//Set to true if current 'decl' is a function define whose body has been
+//skipped by lazy parsing, the followed member record the range of body
+//instead of DECL_fun_body. The body is parsed by getFunBody() on demand.
+#define DECL_is_lazy_body(d) ((d)->m_is_lazy_body)
+#define DECL_lazy_body(d) ((d)->u2.lazy_body)
+
 //Record the formal parameter position if Decl is a parameter.
 #define DECL_formal_param_pos(d) ((d)->u1.formal_param_pos)
 
@@ -574,6 +627,28 @@ typedef enum {
     DCL_ABS_DECLARATOR, //abstract declarator
 } DCL;
 
+//Record the function body that has been skipped by lazy parsing.
+#define LAZY_FUN_BODY_begin(b) ((b)->begin)
+#define LAZY_FUN_BODY_end(b) ((b)->end)
+#define LAZY_FUN_BODY_align(b) ((b)->align)
+#define LAZY_FUN_BODY_visible_seq(b) ((b)->visible_seq)
+#define LAZY_FUN_BODY_complete_aggr_num(b) ((b)->complete_aggr_num)
+class LazyFunBody {
+public:
+    LexPos begin; //the position of '{'.
+    UINT end; //the byte offset after the matched '}'.
+    UINT align; //the alignment of context when the body was skipped.
+
+    //The sequence number of the latest object added into scope when the
+    //body was skipped, see CTX_visible_seq.
+    UINT visible_seq;
+
+    //The number of aggregates that had been completed when the body was
+    //skipped, see CTX_complete_aggr_vec.
+    UINT complete_aggr_num;
+};
+
+
 class Decl {
 public:
     //1 indicates that the Decl enclosed with a pair of '(' ')'.
@@ -587,6 +662,8 @@ public:
     BYTE m_is_formal_param:1; //Decl is a formal parameter.
     BYTE m_is_anony_aggregate:1; //Decl is an anonymous aggregate, which
                                  //means it does NOT have identifier.
+    BYTE m_is_canon_type:1; //Decl is a canonical type-name.
+    BYTE m_is_lazy_body:1; //function body has not been parsed.
 
     UINT m_id;
     UINT lineno; //record line number of declaration.
@@ -596,6 +673,8 @@ public:
 
     //memory alignment of declaration in the current context.
     UINT align;
+    UINT m_byte_size; //cached byte size of declaration.
+    UINT m_byte_size_epoch; //the layout epoch of the cached byte size.
 
     DCL decl_type;
     Decl * prev;
@@ -652,6 +731,10 @@ public:
         //ONLY record as a child of DCL_DECLARATION
         Scope * fun_body;
 
+        //Record the function body that has not been parsed.
+        //ONLY record as a child of DCL_DECLARATION
+        LazyFunBody * lazy_body;
+
         //Record an initializing tree
         //ONLY record as a child of DCL_DECLARATOR
         Tree * init;
@@ -842,7 +925,8 @@ public:
     Decl const* getDeclarator() const;
 
     //Get the function body scope.
-    Scope * getFunBody() const { return DECL_fun_body(this); }
+    //The body is parsed at first if it has been skipped by lazy parsing.
+    Scope * getFunBody() const;
 
     //Return the scope that current declaration is resided in.
     Scope * getDeclScope() const { return DECL_decl_scope(this); }
@@ -1095,10 +1179,12 @@ INT format_user_type(Decl const* ut, INT indent);
 INT format_declarator(IN Decl const* decl, TypeAttr const* ty, INT indent);
 INT format_declaration(IN Decl const* decl, INT indent, bool is_complete);
 bool findEnumVal(CHAR const* name, OUT Enum ** e, OUT INT * idx);
+bool findEnumVal(Sym const* name, OUT Enum ** e, OUT INT * idx);
 
 bool isDeclExistInOuterScope(CHAR const* name, OUT Decl ** dcl);
+bool isDeclExistInOuterScope(Sym const* name, OUT Decl ** dcl);
 bool isAbsDeclaraotr(Decl const* declarator);
-bool isUniqueDecl(Decl const* decl_list, Decl const* decl);
+bool isUniqueDecl(Scope const* scope, Decl const* decl);
 bool isUnionExistInOuterScope(
     Scope * scope, CHAR const* tag, bool is_complete, OUT Union ** s);
 
@@ -1123,19 +1209,22 @@ bool isStructExistInOuterScope(
     Scope * scope, CHAR const* tag, bool is_complete, OUT Struct ** s);
 bool isEnumTagExistInOuterScope(CHAR const* cl, OUT Enum ** e);
 bool isUserTypeExistInOuterScope(CHAR const* cl, OUT Decl ** ut);
+bool isUserTypeExistInOuterScope(Sym const* cl, OUT Decl ** ut);
 
-//Return true if enum-value existed in current scope.
-bool isUserTypeExist(
-    UserTypeList const* ut_list, CHAR const* ut_name, Decl ** ut);
+//Return true if the type-name existed in given scope.
+bool isUserTypeExist(Scope const* sc, CHAR const* ut_name, Decl ** ut);
 bool isAggrTypeExist(
-    List<Aggr*> const* aggrs, Sym const* tag, bool is_complete, OUT Aggr ** s);
+    Scope const* sc, bool is_struct, Sym const* tag, bool is_complete,
+    OUT Aggr ** s);
 bool isAggrTypeExist(
-    List<Aggr*> const* aggrs, CHAR const* tag, bool is_complete, OUT Aggr ** s);
+    Scope const* sc, bool is_struct, CHAR const* tag, bool is_complete,
+    OUT Aggr ** s);
 bool inFirstSetOfDeclaration();
 
 //fun_dclor: record the declarator that indicates a parameter list.
 Decl * get_parameter_list(Decl * dcl, OUT Decl ** fun_dclor = nullptr);
 Decl * get_decl_in_scope(CHAR const* name, Scope const* scope);
+Decl * get_decl_in_scope(Sym const* name, Scope const* scope);
 INT get_enum_const_val(Enum const* e, INT idx);
 CHAR const* get_enum_const_name(Enum const* e, INT idx);
 bool get_aggr_field(
@@ -1162,12 +1251,6 @@ Decl * makeupAndExpandUserType(Decl const* ut);
 Decl * type_name();
 
 //Exported Variables
-extern INT g_alignment;
-extern UINT g_decl_count;
-extern UINT g_aggr_count;
-
-//The counter for anonymous name of aggregate.
-extern UINT g_aggr_anony_name_count;
 extern CHAR const* g_dcl_name[];
 
 } //namespace xfe
@@ -80,6 +80,369 @@ static INT processArrayInitRecur(Decl const* dcl, Tree * initval, UINT curdim,
 }
 
 
+#define DENSE_INIT_SPARSE_FACTOR 4
+#define DENSE_INIT_SPARSE_SLACK 16
+
+bool g_enable_dense_init = false;
+
+static void * xmalloc(size_t size)
+{
+    void * p = smpoolMalloc(size, g_pool_tree_used);
+    ASSERT0(p != nullptr);
+    ::memset((void*)p, 0, size);
+    return p;
+}
+
+
+//Record the value of constant initial-value.
+class DenseValue {
+public:
+    bool is_fp;
+    bool is_unsigned;
+    LONGLONG ival;
+    double fval;
+};
+
+
+//The class records the constant initial values of array in DenseInit.
+//It walks the initial-value tree twice, the first walk checks whether the
+//initializer can be held in blob and counts the elements, the second walk
+//fills the blob. The element whose initial value is not constant is lowered
+//to assignments as processArrayInitRecur() does.
+class DenseInitBuilder {
+    COPY_CONSTRUCTOR(DenseInitBuilder);
+    bool m_is_fill; //true if the walk fills the blob.
+    Decl * m_dcl; //array declaration
+    Decl const* m_elem_type;
+    UINT m_elem_size;
+    UINT m_dim_num;
+    ULONG m_elem_num;
+    ULONG m_const_num;
+    ULONG m_nonconst_num;
+    DenseInit * m_di;
+    Tree * m_stmts; //assignments of non-constant elements
+    Tree * m_last_stmt; //the last node of m_stmts
+    xcom::Vector<ULONG> m_dim_len; //number of elements in each dimension
+    xcom::Vector<ULONG> m_dim_stride; //number of elements of each step
+    xcom::Vector<UINT> m_dimvec; //position in each dimension
+    xcom::Vector<Decl*> m_fld_ty; //field types of struct element
+    xcom::Vector<UINT> m_fld_ofst; //field offsets of struct element
+protected:
+    bool checkElem(Tree const* t, OUT bool & is_const) const;
+    static bool evalConst(Tree const* t, OUT DenseValue & v);
+    void fillElem(Tree const* t, ULONG pos);
+    bool initDim();
+    bool initElemType();
+    static bool isDenseScalar(Decl const* ty);
+    bool walkElem(Tree * t, UINT curdim, ULONG pos);
+    bool walkList(Tree * list, UINT curdim, ULONG pos);
+    void writeScalar(Decl const* ty, Tree const* t, ULONG ofst);
+public:
+    DenseInitBuilder(Decl * dcl) : m_dcl(dcl)
+    {
+        m_is_fill = false;
+        m_elem_type = nullptr;
+        m_elem_size = 0;
+        m_dim_num = 0;
+        m_elem_num = 0;
+        m_const_num = 0;
+        m_nonconst_num = 0;
+        m_di = nullptr;
+        m_stmts = nullptr;
+        m_last_stmt = nullptr;
+    }
+
+    //Return the list of TR_DENSE_INIT and the assignments of non-constant
+    //elements, or nullptr if the initializer can not be held in blob, or
+    //the blob would be much sparser than the initial values.
+    Tree * build(Tree * initval);
+};
+
+
+//Return true if the value of 'ty' can be held in blob.
+bool DenseInitBuilder::isDenseScalar(Decl const* ty)
+{
+    if (!ty->is_scalar() || ty->is_bitfield()) { return false; }
+    UINT size = ty->getDeclByteSize();
+    if (ty->is_fp()) {
+        return size == sizeof(float) || size == sizeof(double);
+    }
+    return ty->is_integer() && size > 0 && size <= sizeof(ULONGLONG);
+}
+
+
+bool DenseInitBuilder::initDim()
+{
+    m_dim_num = m_dcl->getArrayDim();
+    if (m_dim_num == 0) { return false; }
+    ULONG stride = 1;
+    for (INT i = m_dim_num - 1; i >= 0; i--) {
+        ULONG n = m_dcl->getArrayElemnumToDim(i);
+        if (n == 0) { return false; }
+        m_dim_len.set(i, n);
+        m_dim_stride.set(i, stride);
+        m_dimvec.set(i, 0);
+        stride *= n;
+    }
+    return true;
+}
+
+
+//The element should be either scalar or struct that only consists of
+//scalar fields.
+bool DenseInitBuilder::initElemType()
+{
+    Decl const* ty = m_dcl->getArrayBaseDecl();
+    ASSERT0(ty);
+    if (isDenseScalar(ty)) {
+        m_elem_type = ty;
+        m_elem_size = ty->getDeclByteSize();
+        return true;
+    }
+    if (!ty->is_struct() || !ty->isAggrComplete()) { return false; }
+    Decl * fld = nullptr;
+    UINT ofst = 0;
+    for (INT i = 0; get_aggr_field(ty->getTypeAttr(), i, &fld, &ofst); i++) {
+        if (!isDenseScalar(fld)) { return false; }
+        m_fld_ty.set(i, fld);
+        m_fld_ofst.set(i, ofst);
+    }
+    m_elem_type = ty;
+    m_elem_size = ty->getDeclByteSize();
+    return m_fld_ty.get_elem_count() != 0 && m_elem_size != 0;
+}
+
+
+//Return true if 't' is constant, and record its value in 'v'.
+bool DenseInitBuilder::evalConst(Tree const* t, OUT DenseValue & v)
+{
+    v.is_fp = false;
+    v.is_unsigned = false;
+    v.ival = 0;
+    v.fval = 0;
+    switch (t->getCode()) {
+    case TR_IMM:
+    case TR_IMML:
+        v.ival = (LONGLONG)TREE_imm_val(t);
+        return true;
+    case TR_IMMU:
+    case TR_IMMUL:
+        v.is_unsigned = true;
+        v.ival = (LONGLONG)(HOST_UINT)TREE_imm_val(t);
+        return true;
+    case TR_FP:
+        v.is_fp = true;
+        v.fval = ::atof(TREE_fp_str_val(t)->getStr());
+        return true;
+    case TR_FPF:
+        v.is_fp = true;
+        v.fval = (float)::atof(TREE_fp_str_val(t)->getStr());
+        return true;
+    case TR_ENUM_CONST:
+        v.ival = get_enum_const_val(TREE_enum(t), TREE_enum_val_idx(t));
+        return true;
+    case TR_PLUS:
+        return evalConst(TREE_lchild(t), v);
+    case TR_MINUS:
+        //The negation of unsigned value depends on the width of its type,
+        //leave it to the assignment.
+        if (!evalConst(TREE_lchild(t), v) || v.is_unsigned) { return false; }
+        if (v.is_fp) {
+            v.fval = -v.fval;
+        } else {
+            v.ival = (LONGLONG)(0 - (ULONGLONG)v.ival);
+        }
+        return true;
+    default:;
+    }
+    return false;
+}
+
+
+//Return false if the initial value of element can not be held in blob.
+//is_const: set to true if all initial values of element are constant.
+bool DenseInitBuilder::checkElem(Tree const* t, OUT bool & is_const) const
+{
+    DenseValue v;
+    if (!m_elem_type->is_struct()) {
+        if (t->getCode() == TR_INITVAL_SCOPE) { return false; }
+        is_const = evalConst(t, v);
+        return true;
+    }
+    //The initial values of struct element should be enclosed in braces.
+    if (t->getCode() != TR_INITVAL_SCOPE) { return false; }
+    is_const = true;
+    UINT i = 0;
+    for (Tree const* fv = TREE_initval_scope(t);
+         fv != nullptr; fv = TREE_nsib(fv), i++) {
+        if (i >= m_fld_ty.get_elem_count() ||
+            fv->getCode() == TR_INITVAL_SCOPE) {
+            return false;
+        }
+        if (!evalConst(fv, v)) { is_const = false; }
+    }
+    return true;
+}
+
+
+//Convert the constant 't' to 'ty' and write it at byte offset 'ofst'.
+void DenseInitBuilder::writeScalar(Decl const* ty, Tree const* t, ULONG ofst)
+{
+    DenseValue v;
+    bool succ = evalConst(t, v);
+    ASSERT0(succ);
+    DUMMYUSE(succ);
+    UINT size = ty->getDeclByteSize();
+    if (ty->is_fp()) {
+        double d = v.fval;
+        if (!v.is_fp) {
+            d = v.is_unsigned ? (double)(ULONGLONG)v.ival : (double)v.ival;
+        }
+        m_di->setFP(ofst, size, d);
+        return;
+    }
+    LONGLONG i = v.ival;
+    if (ty->is_bool()) {
+        i = v.is_fp ? v.fval != 0 : v.ival != 0;
+    } else if (v.is_fp) {
+        i = ty->getTypeAttr()->is_unsigned() ?
+            (LONGLONG)(ULONGLONG)v.fval : (LONGLONG)v.fval;
+    }
+    m_di->setInt(ofst, size, i);
+}
+
+
+void DenseInitBuilder::fillElem(Tree const* t, ULONG pos)
+{
+    ULONG ofst = pos * m_elem_size;
+    if (!m_elem_type->is_struct()) {
+        writeScalar(m_elem_type, t, ofst);
+        return;
+    }
+    UINT i = 0;
+    for (Tree const* fv = TREE_initval_scope(t);
+         fv != nullptr; fv = TREE_nsib(fv), i++) {
+        writeScalar(m_fld_ty.get(i), fv, ofst + m_fld_ofst.get(i));
+    }
+}
+
+
+//pos: flattened position of element in array.
+bool DenseInitBuilder::walkElem(Tree * t, UINT curdim, ULONG pos)
+{
+    bool is_const = false;
+    if (!checkElem(t, is_const)) { return false; }
+    if (!m_is_fill) {
+        m_elem_num = MAX(m_elem_num, pos + 1);
+        if (is_const) {
+            m_const_num++;
+        } else {
+            m_nonconst_num++;
+        }
+        return true;
+    }
+    if (is_const) {
+        fillElem(t, pos);
+        return true;
+    }
+    DENSE_INIT_nonconst_pos(m_di)[m_nonconst_num++] = pos;
+    Tree * elemstmts = nullptr;
+    processArrayInitRecur(m_dcl, t, curdim, m_dimvec, &elemstmts);
+    xcom::add_next(&m_stmts, &m_last_stmt, elemstmts);
+    return true;
+}
+
+
+//list: initial values of dimension 'curdim'.
+//pos: flattened position of the first element of 'list'.
+bool DenseInitBuilder::walkList(Tree * list, UINT curdim, ULONG pos)
+{
+    UINT i = 0;
+    for (Tree * t = list; t != nullptr; t = TREE_nsib(t), i++) {
+        if (i >= m_dim_len.get(curdim)) {
+            //Excess initial value.
+            return false;
+        }
+        m_dimvec.set(curdim, i);
+        ULONG p = pos + i * m_dim_stride.get(curdim);
+        if (curdim + 1 == m_dim_num) {
+            if (!walkElem(t, curdim, p)) { return false; }
+            continue;
+        }
+        //The initial values of sub-dimension should be enclosed in braces.
+        if (t->getCode() != TR_INITVAL_SCOPE ||
+            !walkList(TREE_initval_scope(t), curdim + 1, p)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+Tree * DenseInitBuilder::build(Tree * initval)
+{
+    ASSERT0(initval->getCode() == TR_INITVAL_SCOPE);
+    if (!initDim() || !initElemType()) { return nullptr; }
+    m_is_fill = false;
+    if (!walkList(TREE_initval_scope(initval), 0, 0)) { return nullptr; }
+    ULONG listed = m_const_num + m_nonconst_num;
+    if (m_const_num == 0 ||
+        m_elem_num > (listed + DENSE_INIT_SPARSE_SLACK) *
+                     DENSE_INIT_SPARSE_FACTOR) {
+        return nullptr;
+    }
+
+    m_di = (DenseInit*)xmalloc(sizeof(DenseInit));
+    DENSE_INIT_decl(m_di) = m_dcl;
+    DENSE_INIT_elem_type(m_di) = genTypeName(m_elem_type);
+    DENSE_INIT_elem_size(m_di) = m_elem_size;
+    DENSE_INIT_elem_num(m_di) = m_elem_num;
+    //The pool does not align the memory, round the blob up so that the tree
+    //node allocated after it is still aligned.
+    DENSE_INIT_data(m_di) = (BYTE*)xmalloc((size_t)xcom::ceil_align(
+        m_elem_num * m_elem_size, alignof(Tree)));
+    if (m_nonconst_num != 0) {
+        DENSE_INIT_nonconst_pos(m_di) =
+            (ULONG*)xmalloc(sizeof(ULONG) * m_nonconst_num);
+    }
+    DENSE_INIT_nonconst_num(m_di) = m_nonconst_num;
+
+    m_is_fill = true;
+    m_nonconst_num = 0;
+    bool succ = walkList(TREE_initval_scope(initval), 0, 0);
+    ASSERT0(succ && m_nonconst_num == DENSE_INIT_nonconst_num(m_di));
+    DUMMYUSE(succ);
+
+    Tree * t = buildDenseInit(m_di);
+    TREE_lineno(t) = initval->getLineno();
+    xcom::add_next(&t, m_stmts);
+    return t;
+}
+
+
+//Return true if the initialization of array has been recorded by
+//TR_DENSE_INIT.
+//stmts: records generated tree if it is not NULL, otherwise append the
+//       genereted stmt after placeholder.
+static bool processDenseArrayInit(Decl * dcl, Tree * initval,
+                                  OUT Tree ** stmts)
+{
+    DenseInitBuilder builder(dcl);
+    Tree * stmtlst = builder.build(initval);
+    if (stmtlst == nullptr) { return false; }
+    if (stmts != nullptr) {
+        xcom::add_next(stmts, stmtlst);
+        return true;
+    }
+    ASSERT0(DECL_placeholder(dcl));
+    //Because placeholder will never be header of list, the insertion will
+    //always insert a node after placeholder.
+    Tree * pl = DECL_placeholder(dcl);
+    xcom::insertafter(&pl, stmtlst);
+    return true;
+}
+
+
 //dcl: the declaration of array, it may be modifed.
 //initval: the initial-value tree to array.
 //stmts: records generated tree to perform initialization of array if it is
@@ -100,16 +463,21 @@ static INT processArrayInit(Decl * dcl, Tree * initval, OUT Tree ** stmts)
     UINT pos_in_curdim = 0;
     UINT curdim = 0;
     Tree * stmtlst = nullptr;
+    Tree * last = nullptr;
     for (Tree * t = TREE_initval_scope(initval);
          t != nullptr; t = TREE_nsib(t), pos_in_curdim++) {
         dimvec.set(curdim, pos_in_curdim);
-        if (stmts != nullptr) {
-            processArrayInitRecur(dcl, t, curdim, dimvec, stmts);
-        } else {
-            processArrayInitRecur(dcl, t, curdim, dimvec, &stmtlst);
-        }
+        //Append the stmts of each element at the tail, walking the whole
+        //list for each element costs quadratic time for large initializer.
+        Tree * elemstmts = nullptr;
+        processArrayInitRecur(dcl, t, curdim, dimvec, &elemstmts);
+        xcom::add_next(&stmtlst, &last, elemstmts);
     }
 
+    if (stmts != nullptr) {
+        xcom::add_next(stmts, stmtlst);
+        return ST_SUCC;
+    }
     if (stmtlst != nullptr) {
         ASSERT0(DECL_placeholder(dcl));
         //Because placeholder will never be header of list, the insertion will
@@ -163,6 +531,10 @@ static INT processArrayInit(Decl * dcl, OUT Tree ** stmts)
     if (new_initval != initval) {
         dcl->setDeclInitTree(new_initval);
     }
+    if (g_enable_dense_init &&
+        processDenseArrayInit(dcl, new_initval, stmts)) {
+        return ST_SUCC;
+    }
     return processArrayInit(dcl, new_initval, stmts);
 }
 
@@ -433,30 +805,32 @@ static INT processScalarInit(Decl const* dcl, OUT Tree ** stmts)
 }
 
 
+static INT processDecl(Decl * dcl, OUT Tree ** stmts)
+{
+    if (dcl->is_fun_def()) {
+        if (ST_SUCC != processFuncDef(dcl) || g_err_msg_list.has_msg()) {
+            return ST_ERR;
+        }
+        return ST_SUCC;
+    }
+    if (!dcl->is_initialized()) { return ST_SUCC; }
+    if (dcl->is_pointer()) {
+        return processScalarInit(dcl, stmts);
+    }
+    if (dcl->is_array()) {
+        return processArrayInit(dcl, stmts);
+    }
+    if (dcl->is_aggr()) {
+        return processAggrInit(dcl, stmts);
+    }
+    return processScalarInit(dcl, stmts);
+}
+
+
 static INT processDeclList(Decl * decl, OUT Tree ** stmts)
 {
     for (Decl * dcl = decl; dcl != nullptr; dcl = DECL_next(dcl)) {
-        if (dcl->is_fun_def()) {
-            if (ST_SUCC != processFuncDef(dcl) ||
-                g_err_msg_list.has_msg()) {
-                return ST_ERR;
-            }
-            continue;
-        }
-        if (!dcl->is_initialized()) { continue; }
-        if (dcl->is_pointer()) {
-            if (ST_SUCC != processScalarInit(dcl, stmts)) { return ST_ERR; }
-            continue;
-        }
-        if (dcl->is_array()) {
-            if (ST_SUCC != processArrayInit(dcl, stmts)) { return ST_ERR; }
-            continue;
-        }
-        if (dcl->is_aggr()) {
-            if (ST_SUCC != processAggrInit(dcl, stmts)) { return ST_ERR; }
-            continue;
-        }
-        if (ST_SUCC != processScalarInit(dcl, stmts)) { return ST_ERR; }
+        if (ST_SUCC != processDecl(dcl, stmts)) { return ST_ERR; }
     }
     return ST_SUCC;
 }
@@ -565,6 +939,25 @@ static INT processFuncDef(Decl * dcl)
 }
 
 
+INT processDeclInitGlobalDecl(Decl * dcl, OUT Tree ** stmts)
+{
+    ASSERT0(dcl->getDeclScope() == get_global_scope());
+    return processDecl(dcl, stmts);
+}
+
+
+INT processDeclInitGlobalStmt(Tree * stmts)
+{
+    Scope * s = get_global_scope();
+    ASSERT0(s);
+    if (ST_SUCC != processStmt(&SCOPE_stmt_list(s), true)) {
+        return ST_ERR;
+    }
+    xcom::insertbefore(&SCOPE_stmt_list(s), SCOPE_stmt_list(s), stmts);
+    return ST_SUCC;
+}
+
+
 //Infer type to tree nodes.
 INT processDeclInit()
 {
@@ -33,5 +33,14 @@ namespace xfe {
 //Infer type to tree nodes.
 INT processDeclInit();
 
+//Process the initialization of declaration 'dcl' of global scope, or the
+//function body if 'dcl' is function definition. The stmts generated by the
+//initialization of global variable are appended to 'stmts'.
+INT processDeclInitGlobalDecl(Decl * dcl, OUT Tree ** stmts);
+
+//Process the stmt list of global scope, then insert 'stmts' that generated
+//by processDeclInitGlobalDecl() before the stmt list.
+INT processDeclInitGlobalStmt(Tree * stmts);
+
 } //namespace xfe
 #endif
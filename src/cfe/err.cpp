@@ -29,40 +29,558 @@ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 namespace xfe {
 
-ErrList g_err_msg_list;
-WarnList g_warn_msg_list;
+bool g_enable_diag_json = false;
 
+//The byte size of the buffer that accumulates the output of diagnostics.
+#define DIAG_BUF_SIZE 4096
+
+//The kind of argument that consumed by conversion specification.
+typedef enum {
+    DIAG_ARG_UNDEF = 0,
+    DIAG_ARG_PERCENT, //'%%' does not consume argument.
+    DIAG_ARG_INT,
+    DIAG_ARG_UINT,
+    DIAG_ARG_LONG,
+    DIAG_ARG_ULONG,
+    DIAG_ARG_LONGLONG,
+    DIAG_ARG_ULONGLONG,
+    DIAG_ARG_SIZE,
+    DIAG_ARG_DOUBLE,
+    DIAG_ARG_STR,
+    DIAG_ARG_PTR,
+} DIAG_ARG_KIND;
+
+
+//Record a conversion specification of format.
+#define DIAG_SPEC_kind(s) ((s)->kind)
+#define DIAG_SPEC_conv(s) ((s)->conv)
+#define DIAG_SPEC_len(s) ((s)->len)
+class DiagSpec {
+public:
+    DIAG_ARG_KIND kind;
+    CHAR conv; //the conversion character, e.g: 'd', 's'.
+    UINT len; //byte length of the specification, include '%'.
+};
+
+
+//Accumulate the text of diagnostics. If the buffer is attached to a file,
+//the text is written into the file in batch, otherwise the buffer grows to
+//hold all the text.
+class DiagBuf {
+    COPY_CONSTRUCTOR(DiagBuf);
+    FILE * m_h;
+    CHAR * m_buf;
+    UINT m_len;
+    UINT m_cap;
+    CHAR m_init_buf[DIAG_BUF_SIZE];
+protected:
+    //Reserve 'n' bytes after the end of text.
+    void reserve(UINT n);
+public:
+    DiagBuf(FILE * h)
+    {
+        m_h = h;
+        m_buf = m_init_buf;
+        m_len = 0;
+        m_cap = DIAG_BUF_SIZE;
+    }
+    ~DiagBuf()
+    {
+        flush();
+        if (m_buf != m_init_buf) { ::free(m_buf); }
+    }
+
+    void append(CHAR const* s, UINT len)
+    {
+        reserve(len);
+        ::memcpy(m_buf + m_len, s, len);
+        m_len += len;
+    }
+    void append(CHAR const* s) { append(s, (UINT)::strlen(s)); }
+    void append(CHAR c)
+    {
+        reserve(1);
+        m_buf[m_len++] = c;
+    }
+
+    //Append the string formed by 'format' that has exactly one argument.
+    template <class T> void appendf(CHAR const* format, T v)
+    {
+        reserve(64);
+        INT n = ::snprintf(m_buf + m_len, m_cap - m_len, format, v);
+        if (n < 0) { return; }
+        if ((UINT)n >= m_cap - m_len) {
+            reserve((UINT)n + 1);
+            n = ::snprintf(m_buf + m_len, m_cap - m_len, format, v);
+        }
+        m_len += (UINT)n;
+    }
+
+    //Append 'len' bytes of 's' as the content of JSON string.
+    void appendJsonStr(CHAR const* s, UINT len);
+
+    void clean() { m_len = 0; }
+    void flush();
+    CHAR const* getBuf() const { return m_buf; }
+    UINT getLen() const { return m_len; }
+};
+
+
+void DiagBuf::reserve(UINT n)
+{
+    if (m_len + n <= m_cap) { return; }
+    if (m_h != nullptr) {
+        flush();
+        if (n <= m_cap) { return; }
+    }
+    UINT cap = m_cap * 2;
+    for (; cap < m_len + n; cap *= 2);
+    CHAR * buf = (CHAR*)::malloc(cap);
+    ::memcpy(buf, m_buf, m_len);
+    if (m_buf != m_init_buf) { ::free(m_buf); }
+    m_buf = buf;
+    m_cap = cap;
+}
+
+
+void DiagBuf::flush()
+{
+    if (m_h == nullptr || m_len == 0) { return; }
+    ::fwrite(m_buf, 1, m_len, m_h);
+    m_len = 0;
+}
+
+
+void DiagBuf::appendJsonStr(CHAR const* s, UINT len)
+{
+    for (UINT i = 0; i < len; i++) {
+        BYTE c = (BYTE)s[i];
+        switch (c) {
+        case '"': append("\\\"", 2); break;
+        case '\\': append("\\\\", 2); break;
+        case '\n': append("\\n", 2); break;
+        case '\r': append("\\r", 2); break;
+        case '\t': append("\\t", 2); break;
+        default:
+            if (c < 0x20) {
+                appendf("\\u%04x", (UINT)c);
+            } else {
+                append((CHAR)c);
+            }
+        }
+    }
+}
+
+
+//Allocate diagnostic of 'size' bytes.
+//The pool does not align the memory it returns, thus the size is rounded up
+//to the alignment of Diag, and the extra bytes are used to align the
+//diagnostic if the pool is left unaligned by other objects.
 static void * xmalloc(size_t size)
 {
-    BYTE * p = (BYTE*)smpoolMalloc(size, g_pool_general_used);
+    size_t align = alignof(Diag);
+    size = (size + align - 1) / align * align;
+    BYTE * p = (BYTE*)smpoolMalloc(size + align - 1, g_pool_general_used);
     if (p == nullptr) { return nullptr; }
+    p += (align - (size_t)p % align) % align;
     ::memset((void*)p, 0, size);
     return (void*)p;
 }
 
 
-void show_err()
+//Parse the conversion specification that begins at 'p'.
+//Return false if the specification is not supported, e.g: the width is
+//given by argument.
+static bool parseSpec(CHAR const* p, OUT DiagSpec & spec)
+{
+    ASSERT0(*p == '%');
+    CHAR const* q = p + 1;
+    if (*q == '%') {
+        DIAG_SPEC_kind(&spec) = DIAG_ARG_PERCENT;
+        DIAG_SPEC_conv(&spec) = '%';
+        DIAG_SPEC_len(&spec) = 2;
+        return true;
+    }
+    for (; *q != 0 && ::strchr("-+ #0", *q) != nullptr; q++);
+    for (; *q >= '0' && *q <= '9'; q++);
+    if (*q == '.') {
+        for (q++; *q >= '0' && *q <= '9'; q++);
+    }
+    //Length modifier.
+    UINT lcnt = 0;
+    CHAR lmod = 0;
+    if (*q == 'h' || *q == 'l') {
+        lmod = *q;
+        for (; *q == lmod; q++, lcnt++);
+    } else if (*q == 'z' || *q == 't' || *q == 'j') {
+        lmod = *q;
+        q++;
+    }
+    CHAR conv = *q;
+    DIAG_SPEC_conv(&spec) = conv;
+    DIAG_SPEC_len(&spec) = (UINT)(q - p) + 1;
+    bool is_long = lmod == 'l' && lcnt == 1;
+    bool is_longlong = (lmod == 'l' && lcnt == 2) || lmod == 'j';
+    bool is_size = lmod == 'z' || lmod == 't';
+    switch (conv) {
+    case 'd':
+    case 'i':
+        DIAG_SPEC_kind(&spec) = is_longlong ? DIAG_ARG_LONGLONG :
+            is_long ? DIAG_ARG_LONG : is_size ? DIAG_ARG_SIZE : DIAG_ARG_INT;
+        break;
+    case 'u':
+    case 'x':
+    case 'X':
+    case 'o':
+        DIAG_SPEC_kind(&spec) = is_longlong ? DIAG_ARG_ULONGLONG :
+            is_long ? DIAG_ARG_ULONG : is_size ? DIAG_ARG_SIZE : DIAG_ARG_UINT;
+        break;
+    case 'c':
+        if (lmod != 0) { return false; }
+        DIAG_SPEC_kind(&spec) = DIAG_ARG_INT;
+        break;
+    case 'f':
+    case 'F':
+    case 'e':
+    case 'E':
+    case 'g':
+    case 'G':
+    case 'a':
+    case 'A':
+        if (lmod != 0 && !is_long) { return false; }
+        DIAG_SPEC_kind(&spec) = DIAG_ARG_DOUBLE;
+        break;
+    case 's':
+        if (lmod != 0) { return false; }
+        DIAG_SPEC_kind(&spec) = DIAG_ARG_STR;
+        break;
+    case 'p':
+        DIAG_SPEC_kind(&spec) = DIAG_ARG_PTR;
+        break;
+    default: return false;
+    }
+    return true;
+}
+
+
+//Record the kinds of arguments of 'fmt' into 'kinds'.
+//Return false if there is unsupported specification, or too many arguments.
+static bool scanFormat(CHAR const* fmt, OUT BYTE * kinds, OUT UINT & argnum)
+{
+    argnum = 0;
+    for (CHAR const* p = ::strchr(fmt, '%'); p != nullptr;
+         p = ::strchr(p, '%')) {
+        DiagSpec spec;
+        if (!parseSpec(p, spec)) { return false; }
+        p += DIAG_SPEC_len(&spec);
+        if (DIAG_SPEC_kind(&spec) == DIAG_ARG_PERCENT) { continue; }
+        if (argnum >= MAX_DIAG_ARG_NUM) { return false; }
+        kinds[argnum++] = (BYTE)DIAG_SPEC_kind(&spec);
+    }
+    return true;
+}
+
+
+//Build diagnostic whose message is formatted right now, it is used when
+//the format can not be recorded in compact form.
+static Diag * buildFormattedDiag(INT lineno, CHAR const* fmt, va_list args)
+{
+    StrBuf sbuf(64);
+    sbuf.vsprint(fmt, args);
+    size_t l = sbuf.strlen();
+    size_t size = sizeof(Diag) + l + 1;
+    ASSERT0(size <= (size_t)(UINT)-1);
+    Diag * d = (Diag*)xmalloc(size);
+    DIAG_fmt(d) = fmt;
+    DIAG_lineno(d) = lineno;
+    DIAG_size(d) = (UINT)size;
+    DIAG_argnum(d) = 1;
+    DIAG_is_formatted(d) = true;
+    DIAG_arg(d, 0).sofst = sizeof(Diag);
+    ::memcpy((CHAR*)d + sizeof(Diag), sbuf.buf, l + 1);
+    return d;
+}
+
+
+//Build diagnostic that records format 'fmt' and the raw arguments.
+static Diag * buildDiag(INT lineno, CHAR const* fmt, va_list args)
+{
+    BYTE kinds[MAX_DIAG_ARG_NUM];
+    UINT argnum = 0;
+    if (!scanFormat(fmt, kinds, argnum)) {
+        return buildFormattedDiag(lineno, fmt, args);
+    }
+    DiagArg vals[MAX_DIAG_ARG_NUM];
+    CHAR const* strs[MAX_DIAG_ARG_NUM];
+    size_t strsize = 0;
+    for (UINT i = 0; i < argnum; i++) {
+        strs[i] = nullptr;
+        switch (kinds[i]) {
+        case DIAG_ARG_INT: vals[i].ival = va_arg(args, INT); break;
+        case DIAG_ARG_UINT: vals[i].ival = va_arg(args, UINT); break;
+        case DIAG_ARG_LONG: vals[i].ival = va_arg(args, LONG); break;
+        case DIAG_ARG_ULONG: vals[i].ival = va_arg(args, ULONG); break;
+        case DIAG_ARG_LONGLONG: vals[i].ival = va_arg(args, LONGLONG); break;
+        case DIAG_ARG_ULONGLONG:
+            vals[i].ival = (LONGLONG)va_arg(args, ULONGLONG);
+            break;
+        case DIAG_ARG_SIZE: vals[i].ival = va_arg(args, size_t); break;
+        case DIAG_ARG_DOUBLE: vals[i].fval = va_arg(args, double); break;
+        case DIAG_ARG_PTR: vals[i].pval = va_arg(args, void*); break;
+        case DIAG_ARG_STR:
+            strs[i] = va_arg(args, CHAR const*);
+            if (strs[i] != nullptr) { strsize += ::strlen(strs[i]) + 1; }
+            break;
+        default: UNREACHABLE();
+        }
+    }
+
+    //The arguments are followed by the copied strings.
+    size_t argsize = sizeof(DiagArg) * (argnum == 0 ? 1 : argnum);
+    size_t size = offsetof(Diag, args) + argsize + strsize;
+    ASSERT0(size <= (size_t)(UINT)-1);
+    Diag * d = (Diag*)xmalloc(size);
+    DIAG_fmt(d) = fmt;
+    DIAG_lineno(d) = lineno;
+    DIAG_size(d) = (UINT)size;
+    DIAG_argnum(d) = argnum;
+    UINT ofst = (UINT)(offsetof(Diag, args) + argsize);
+    for (UINT i = 0; i < argnum; i++) {
+        if (kinds[i] != DIAG_ARG_STR) {
+            DIAG_arg(d, i) = vals[i];
+            continue;
+        }
+        if (strs[i] == nullptr) {
+            DIAG_arg(d, i).sofst = DIAG_NULL_STR_OFST;
+            continue;
+        }
+        size_t l = ::strlen(strs[i]) + 1;
+        ::memcpy((CHAR*)d + ofst, strs[i], l);
+        DIAG_arg(d, i).sofst = ofst;
+        ofst += (UINT)l;
+    }
+    return d;
+}
+
+
+static Diag * dupDiag(Diag const* d)
+{
+    Diag * p = (Diag*)xmalloc(d->getSize());
+    ::memcpy(p, d, d->getSize());
+    return p;
+}
+
+
+//The identifier is FNV-1a hash value of format.
+UINT Diag::getId() const
+{
+    UINT h = 2166136261u;
+    for (CHAR const* p = DIAG_fmt(this); *p != 0; p++) {
+        h = (h ^ (BYTE)*p) * 16777619u;
+    }
+    return h;
+}
+
+
+//Append argument 'a' of 'd' that formatted by specification 'spec'.
+//'specstr' is the text of specification.
+static void formatArg(Diag const* d, UINT i, DiagSpec const& spec,
+                      CHAR const* specstr, MOD DiagBuf & buf)
+{
+    DiagArg const& a = DIAG_arg(d, i);
+    switch (DIAG_SPEC_kind(&spec)) {
+    case DIAG_ARG_INT: buf.appendf(specstr, (INT)a.ival); return;
+    case DIAG_ARG_UINT: buf.appendf(specstr, (UINT)a.ival); return;
+    case DIAG_ARG_LONG: buf.appendf(specstr, (LONG)a.ival); return;
+    case DIAG_ARG_ULONG: buf.appendf(specstr, (ULONG)a.ival); return;
+    case DIAG_ARG_LONGLONG: buf.appendf(specstr, a.ival); return;
+    case DIAG_ARG_ULONGLONG: buf.appendf(specstr, (ULONGLONG)a.ival); return;
+    case DIAG_ARG_SIZE: buf.appendf(specstr, (size_t)a.ival); return;
+    case DIAG_ARG_DOUBLE: buf.appendf(specstr, a.fval); return;
+    case DIAG_ARG_PTR: buf.appendf(specstr, a.pval); return;
+    case DIAG_ARG_STR: {
+        CHAR const* s = d->getStrArg(i);
+        if (s != nullptr && DIAG_SPEC_len(&spec) == 2) {
+            //Plain '%s' does not need formatting.
+            buf.append(s);
+            return;
+        }
+        buf.appendf(specstr, s != nullptr ? s : "(null)");
+        return;
+    }
+    default: UNREACHABLE();
+    }
+}
+
+
+//Append the message of 'd' into 'buf'.
+static void formatDiag(Diag const* d, MOD DiagBuf & buf)
+{
+    if (DIAG_is_formatted(d)) {
+        buf.append(d->getStrArg(0));
+        return;
+    }
+    UINT argi = 0;
+    CHAR const* p = DIAG_fmt(d);
+    for (CHAR const* q = ::strchr(p, '%'); q != nullptr;
+         q = ::strchr(p, '%')) {
+        buf.append(p, (UINT)(q - p));
+        DiagSpec spec;
+        bool succ = parseSpec(q, spec);
+        ASSERT0_DUMMYUSE(succ);
+        p = q + DIAG_SPEC_len(&spec);
+        if (DIAG_SPEC_kind(&spec) == DIAG_ARG_PERCENT) {
+            buf.append('%');
+            continue;
+        }
+        CHAR specstr[32];
+        UINT l = MIN(DIAG_SPEC_len(&spec), sizeof(specstr) - 1);
+        ::memcpy(specstr, q, l);
+        specstr[l] = 0;
+        formatArg(d, argi++, spec, specstr, buf);
+    }
+    buf.append(p);
+}
+
+
+//Append the raw arguments of 'd' as JSON array into 'buf'.
+static void formatJsonArgs(Diag const* d, MOD DiagBuf & buf)
 {
-    if (!g_err_msg_list.has_msg()) { return; }
-    fprintf(stdout, "\n");
-    for (ErrMsg * e = g_err_msg_list.get_head();
-         e != nullptr; e = g_err_msg_list.get_next()) {
-        fprintf(stdout, "\nerror(%d):%s", ERR_MSG_lineno(e), ERR_MSG_msg(e));
+    buf.append('[');
+    if (DIAG_is_formatted(d)) {
+        buf.append(']');
+        return;
     }
-    fprintf(stdout, "\n");
+    UINT argi = 0;
+    for (CHAR const* p = ::strchr(DIAG_fmt(d), '%'); p != nullptr;
+         p = ::strchr(p, '%')) {
+        DiagSpec spec;
+        bool succ = parseSpec(p, spec);
+        ASSERT0_DUMMYUSE(succ);
+        p += DIAG_SPEC_len(&spec);
+        if (DIAG_SPEC_kind(&spec) == DIAG_ARG_PERCENT) { continue; }
+        if (argi != 0) { buf.append(','); }
+        DiagArg const& a = DIAG_arg(d, argi);
+        switch (DIAG_SPEC_kind(&spec)) {
+        case DIAG_ARG_INT:
+            if (DIAG_SPEC_conv(&spec) == 'c') {
+                CHAR c = (CHAR)a.ival;
+                buf.append('"');
+                buf.appendJsonStr(&c, 1);
+                buf.append('"');
+                break;
+            }
+            buf.appendf("%d", (INT)a.ival);
+            break;
+        case DIAG_ARG_UINT: buf.appendf("%u", (UINT)a.ival); break;
+        case DIAG_ARG_LONG: buf.appendf("%ld", (LONG)a.ival); break;
+        case DIAG_ARG_ULONG: buf.appendf("%lu", (ULONG)a.ival); break;
+        case DIAG_ARG_LONGLONG: buf.appendf("%lld", a.ival); break;
+        case DIAG_ARG_ULONGLONG:
+        case DIAG_ARG_SIZE:
+            buf.appendf("%llu", (ULONGLONG)a.ival);
+            break;
+        case DIAG_ARG_DOUBLE:
+            if (::isfinite(a.fval)) {
+                buf.appendf("%.17g", a.fval);
+            } else {
+                buf.append("null");
+            }
+            break;
+        case DIAG_ARG_PTR: buf.appendf("\"%p\"", a.pval); break;
+        case DIAG_ARG_STR: {
+            CHAR const* s = d->getStrArg(argi);
+            if (s == nullptr) {
+                buf.append("null");
+                break;
+            }
+            buf.append('"');
+            buf.appendJsonStr(s, (UINT)::strlen(s));
+            buf.append('"');
+            break;
+        }
+        default: UNREACHABLE();
+        }
+        argi++;
+    }
+    buf.append(']');
 }
 
 
-void show_warn()
+//Append one line of JSON object that describes 'd' into 'buf'.
+//msgbuf: the buffer that used to format the message.
+static void formatJsonDiag(Diag const* d, CHAR const* severity,
+                           CHAR const* fn, MOD DiagBuf & msgbuf,
+                           MOD DiagBuf & buf)
 {
-    if (!g_warn_msg_list.has_msg()) { return; }
-    fprintf(stdout, "\n");
-    for (WarnMsg * e = g_warn_msg_list.get_head();
-         e != nullptr; e = g_warn_msg_list.get_next()) {
-        fprintf(stdout, "\nwarning(%d):%s",
-                WARN_MSG_lineno(e), WARN_MSG_msg(e));
+    buf.append("{\"severity\":\"");
+    buf.append(severity);
+    buf.appendf("\",\"id\":\"%08x\"", d->getId());
+    if (fn != nullptr) {
+        buf.append(",\"file\":\"");
+        buf.appendJsonStr(fn, (UINT)::strlen(fn));
+        buf.append('"');
     }
-    fprintf(stdout, "\n");
+    buf.appendf(",\"line\":%d,\"message\":\"", d->getLineno());
+    msgbuf.clean();
+    formatDiag(d, msgbuf);
+    buf.appendJsonStr(msgbuf.getBuf(), msgbuf.getLen());
+    buf.append("\",\"args\":");
+    formatJsonArgs(d, buf);
+    buf.append("}\n");
+}
+
+
+template <class DiagListType>
+static void showDiagList(DiagListType & lst, CHAR const* severity,
+                         CHAR const* fn, FILE * h)
+{
+    if (!lst.has_msg()) { return; }
+    DiagBuf buf(h);
+    if (g_enable_diag_json) {
+        DiagBuf msgbuf(nullptr);
+        for (Diag const* d = lst.get_head(); d != nullptr;
+             d = lst.get_next()) {
+            formatJsonDiag(d, severity, fn, msgbuf, buf);
+        }
+        return;
+    }
+    buf.append('\n');
+    for (Diag const* d = lst.get_head(); d != nullptr; d = lst.get_next()) {
+        buf.append('\n');
+        buf.append(severity);
+        buf.appendf("(%d):", d->getLineno());
+        formatDiag(d, buf);
+    }
+    buf.append('\n');
+}
+
+
+void show_err(FILE * h, CHAR const* fn)
+{
+    showDiagList(g_err_msg_list, "error", fn, h);
+}
+
+
+void show_warn(FILE * h, CHAR const* fn)
+{
+    showDiagList(g_warn_msg_list, "warning", fn, h);
+}
+
+
+void show_diag_summary(FILE * h, CHAR const* fn, UINT err_num,
+                       UINT warn_num)
+{
+    if (!g_enable_diag_json) {
+        fprintf(h, "\n%s - (%d) error(s), (%d) warnging(s)\n", fn,
+                err_num, warn_num);
+        return;
+    }
+    DiagBuf buf(h);
+    buf.append("{\"severity\":\"summary\",\"file\":\"");
+    buf.appendJsonStr(fn, (UINT)::strlen(fn));
+    buf.appendf("\",\"errors\":%u", err_num);
+    buf.appendf(",\"warnings\":%u}\n", warn_num);
 }
 
 
@@ -70,18 +588,9 @@ void show_warn()
 void warn(INT line_num, CHAR const* msg, ...)
 {
     if (msg == nullptr) { return; }
-    WarnMsg * p = nullptr;
-    StrBuf sbuf(64);
     va_list arg;
     va_start(arg, msg);
-    sbuf.vsprint(msg, arg);
-    p = (WarnMsg*)xmalloc(sizeof(WarnMsg));
-    size_t l = sbuf.strlen();
-    p->msg = (CHAR*)xmalloc(l + 1);
-    ::memcpy(p->msg, sbuf.buf, l);
-    p->msg[l] = 0;
-    p->lineno = line_num;
-    g_warn_msg_list.append_tail(p);
+    g_warn_msg_list.append_tail(buildDiag(line_num, msg, arg));
     va_end(arg);
 }
 
@@ -90,22 +599,25 @@ void warn(INT line_num, CHAR const* msg, ...)
 void err(INT line_num, CHAR const* msg, ...)
 {
     if (msg == nullptr) { return; }
-    ErrMsg * p = nullptr;
-    StrBuf sbuf(64);
     va_list arg;
     va_start(arg, msg);
-    sbuf.vsprint(msg, arg);
-    p = (ErrMsg*)xmalloc(sizeof(ErrMsg));
-    size_t l = sbuf.strlen();
-    p->msg = (CHAR*)xmalloc(l + 1);
-    ::memcpy(p->msg, sbuf.buf, l);
-    p->msg[l] = 0;
-    p->lineno = line_num;
-    g_err_msg_list.append_tail(p);
+    g_err_msg_list.append_tail(buildDiag(line_num, msg, arg));
     va_end(arg);
 }
 
 
+void addErr(Diag const* d)
+{
+    g_err_msg_list.append_tail(dupDiag(d));
+}
+
+
+void addWarn(Diag const* d)
+{
+    g_warn_msg_list.append_tail(dupDiag(d));
+}
+
+
 INT is_too_many_err()
 {
     return g_err_msg_list.get_elem_count() > TOO_MANY_ERR;
@@ -34,25 +34,63 @@ namespace xfe {
 #define ERR_SHOW 1
 #define WARN_SHOW 2
 
-//Record each error msg
-#define WARN_MSG_msg(e) ((e)->msg)
-#define WARN_MSG_lineno(e) ((e)->lineno)
-class WarnMsg {
-public:
-    CHAR * msg;
-    INT lineno;
+//The maximum number of arguments that recorded in diagnostic. The message
+//of diagnostic that has more arguments is formatted when it is reported.
+#define MAX_DIAG_ARG_NUM 16
+
+//The string offset that represents nullptr.
+#define DIAG_NULL_STR_OFST ((UINT)-1)
+
+//Record the raw argument of diagnostic.
+//The string argument is copied into the diagnostic, and is recorded by its
+//byte offset to the diagnostic, thus diagnostic can be copied by memcpy.
+union DiagArg {
+    LONGLONG ival;
+    double fval;
+    void const* pval;
+    UINT sofst;
 };
 
 
-//Record each error msg
-#define ERR_MSG_msg(e) ((e)->msg)
-#define ERR_MSG_lineno(e) ((e)->lineno)
-class ErrMsg {
+//Record each diagnostic in compact form. The message is not formatted until
+//the diagnostic is emitted, reporting a diagnostic only records the format
+//and the raw arguments. The format is string literal, which also identifies
+//the kind of diagnostic.
+#define DIAG_fmt(d) ((d)->fmt)
+#define DIAG_lineno(d) ((d)->lineno)
+#define DIAG_size(d) ((d)->size)
+#define DIAG_argnum(d) ((d)->argnum)
+#define DIAG_is_formatted(d) ((d)->is_formatted)
+#define DIAG_arg(d, i) ((d)->args[i])
+class Diag {
 public:
-    CHAR * msg;
+    CHAR const* fmt;
     INT lineno;
+    UINT size; //byte size of diagnostic, include the copied strings.
+    UINT argnum:8;
+    //True if the message has been formatted when it is reported, and
+    //recorded as the only string argument.
+    UINT is_formatted:1;
+    DiagArg args[1]; //the arguments in the order of format.
+public:
+    //Return the identifier of the kind of diagnostic, it is computed from
+    //the format, thus it is stable between runs.
+    UINT getId() const;
+    INT getLineno() const { return DIAG_lineno(this); }
+    UINT getSize() const { return DIAG_size(this); }
+    CHAR const* getStrArg(UINT i) const
+    {
+        ASSERT0(i < DIAG_argnum(this));
+        UINT ofst = DIAG_arg(this, i).sofst;
+        return ofst == DIAG_NULL_STR_OFST ? nullptr :
+               (CHAR const*)this + ofst;
+    }
 };
 
+#define ERR_MSG_lineno(e) DIAG_lineno(e)
+#define WARN_MSG_lineno(e) DIAG_lineno(e)
+typedef Diag ErrMsg;
+typedef Diag WarnMsg;
 
 class ErrList : public xcom::List<ErrMsg*> {
 public:
@@ -64,15 +102,29 @@ public:
     bool has_msg() const { return get_elem_count() != 0; }
 };
 
-//Exported Variables
-extern ErrList g_err_msg_list;
-extern WarnList g_warn_msg_list;
-
 //Exported Functions
+//Report warning and error at line 'line_num' respectively.
+//msg: the format of message. It must have static storage duration, e.g:
+//     string literal, because the diagnostic refers to it until the message
+//     is emitted, and its text is the identifier of diagnostic. Pass the
+//     text that is built at runtime as argument, e.g: err(line, "%s", buf).
 void warn(INT line_num, CHAR const* msg, ...);
 void err(INT line_num, CHAR const* msg, ...);
-void show_err();
-void show_warn();
+
+//Append a copy of diagnostic 'd' to the error or warning list of current
+//context respectively.
+void addErr(Diag const* d);
+void addWarn(Diag const* d);
+
+//Print the diagnostics of current context into 'h'.
+//fn: the source file name, it is only printed in JSON-lines format, and
+//    may be nullptr.
+void show_err(FILE * h = stdout, CHAR const* fn = nullptr);
+void show_warn(FILE * h = stdout, CHAR const* fn = nullptr);
+
+//Print the number of diagnostics of source file 'fn' into 'h'.
+void show_diag_summary(FILE * h, CHAR const* fn, UINT err_num,
+                       UINT warn_num);
 INT is_too_many_err();
 
 } //namespace xfe
@@ -30,241 +30,511 @@ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 namespace xfe {
 
 //Computing expected value in compiling period, such as constant expression.
-// 'g_is_allow_float' cannot be used via extern , it must be assigned with
-// 'compute_constant_value' absolutely.
+//The evaluator returns the value of each sub-expression directly rather than
+//pushing it into a stack of Cell, and memoizes the value of operator node
+//on the node itself, thus the constant expression that is shared by
+//duplicated declarators, e.g: array dimension, is evaluated only once.
 
-static bool g_is_allow_float = false;
-static Stack<Cell*> g_cell_stack;
-static bool compute_conditional_exp(IN Tree * t);
+class ConstExpEval {
+    COPY_CONSTRUCTOR(ConstExpEval);
+    bool m_is_allow_float;
 
-static Cell * pushv(LONGLONG v)
+    //Diagnostics are not reported if it is greater than 0.
+    UINT m_quiet_level;
+protected:
+    bool evalBinaryOp(Tree * t, OUT CstValue & v);
+    bool evalCond(Tree * t, OUT CstValue & v);
+    bool evalCvt(Tree * t, OUT CstValue & v);
+    bool evalEnumConst(Tree * t, OUT CstValue & v);
+    bool evalImm(Tree * t, OUT CstValue & v);
+    bool evalSizeof(Tree * t, OUT CstValue & v);
+    bool evalUnaryOp(Tree * t, OUT CstValue & v);
+    bool evalOperator(Tree * t, OUT CstValue & v);
+
+    static UINT getDiagCount()
+    {
+        return g_err_msg_list.get_elem_count() +
+               g_warn_msg_list.get_elem_count();
+    }
+
+    //Return true if the value of operator node 't' can be memoized.
+    static bool isMemoizable(Tree const* t);
+
+    //msg: string literal, it is recorded as the format of diagnostic.
+    void reportErr(INT lineno, CHAR const* msg) const
+    {
+        if (m_quiet_level == 0) { err(lineno, msg); }
+    }
+    void reportWarn(INT lineno, CHAR const* msg) const
+    {
+        if (m_quiet_level == 0) { warn(lineno, msg); }
+    }
+public:
+    ConstExpEval(bool is_allow_float)
+    {
+        m_is_allow_float = is_allow_float;
+        m_quiet_level = 0;
+    }
+
+    //Return true if 't' is constant expression, and record its value in 'v'.
+    bool eval(Tree * t, OUT CstValue & v);
+};
+
+
+bool ConstExpEval::isMemoizable(Tree const* t)
 {
-    Cell * c = newcell(0);
-    CELL_val(c) = v;
-    CELL_line_no(c) = g_real_line_num;
-    g_cell_stack.push(c);
-    return c;
+    switch (t->getCode()) {
+    case TR_LOGIC_OR:
+    case TR_LOGIC_AND:
+    case TR_INCLUSIVE_OR:
+    case TR_INCLUSIVE_AND:
+    case TR_XOR:
+    case TR_EQUALITY:
+    case TR_RELATION:
+    case TR_SHIFT:
+    case TR_ADDITIVE:
+    case TR_MULTI:
+    case TR_PLUS:
+    case TR_MINUS:
+    case TR_REV:
+    case TR_NOT:
+    case TR_COND:
+    case TR_CVT:
+    case TR_SIZEOF:
+        return true;
+    default:;
+    }
+    return false;
 }
 
 
-static LONGLONG popv()
+//Compute the common type of 'l' and 'r' by usual arithmetic conversion.
+//Note the operands should have been promoted.
+void CstValue::computeCommonType(CstValue const& l, CstValue const& r,
+                                 OUT UINT & size, OUT bool & is_unsigned)
 {
-    Cell *c = g_cell_stack.pop();
-    if (!c) {
-        err(g_real_line_num, "cell value stack cannot be nullptr");
-        return -1;
+    if (l.size == r.size) {
+        size = l.size;
+        is_unsigned = l.is_unsigned || r.is_unsigned;
+        return;
     }
-    free_cell(c);
-    return (LONG)CELL_val(c);
+    //The operand of greater size can represent all values of the other.
+    CstValue const& g = l.size > r.size ? l : r;
+    size = g.size;
+    is_unsigned = g.is_unsigned;
 }
 
 
-static bool compute_enum_const(Tree * t)
+bool ConstExpEval::evalImm(Tree * t, OUT CstValue & v)
 {
-    Enum const* e = TREE_enum(t);
-    INT i = TREE_enum_val_idx(t);
-    EnumValueList const* evl = e->getValList();
-    for (; i > 0; i--, evl = EVAL_next(evl)) {
-        ASSERT0(evl);
+    LONGLONG i = (LONGLONG)TREE_imm_val(t);
+    switch (t->getCode()) {
+    case TR_IMM:
+        //The literal that exceeds int is typed long long.
+        if (i == CstValue::normalize(i, BYTE_PER_INT, false)) {
+            v.set(i, BYTE_PER_INT, false);
+        } else {
+            v.set(i, BYTE_PER_LONGLONG, false);
+        }
+        return true;
+    case TR_IMMU:
+        i = (LONGLONG)(HOST_UINT)TREE_imm_val(t);
+        if (i == CstValue::normalize(i, BYTE_PER_INT, true)) {
+            v.set(i, BYTE_PER_INT, true);
+        } else {
+            v.set(i, BYTE_PER_LONGLONG, true);
+        }
+        return true;
+    case TR_IMML:
+        v.set(i, BYTE_PER_LONGLONG, false);
+        return true;
+    case TR_IMMUL:
+        v.set(i, BYTE_PER_LONGLONG, true);
+        return true;
+    default: UNREACHABLE();
     }
+    return false;
+}
 
-    ASSERT0(evl);
-    pushv(EVAL_val(evl));
+
+bool ConstExpEval::evalEnumConst(Tree * t, OUT CstValue & v)
+{
+    v.set(get_enum_const_val(TREE_enum(t), TREE_enum_val_idx(t)),
+          BYTE_PER_INT, false);
     return true;
 }
 
 
-//Compute byte size of TYPE_NAME and record in the cell stack, or record
-//-1 if failed. The function return true if the computation is success,
-//otherwise return false.
-static bool compute_sizeof(Tree * t)
+//The type of sizeof is size_t.
+bool ConstExpEval::evalSizeof(Tree * t, OUT CstValue & v)
 {
     Tree * p = TREE_sizeof_exp(t);
-    if (p->getCode() == TR_TYPE_NAME) {
-        Decl * dcl = TREE_type_name(p);
-        ASSERT0(dcl && DECL_dt(dcl) == DCL_TYPE_NAME);
-        ASSERT0(DECL_spec(dcl));
-
-        if (dcl->is_user_type_ref()) {
-            dcl = makeupAndExpandUserType(dcl);
-            TREE_type_name(p) = dcl;
+    if (p->getCode() == TR_ID) {
+        //The size of identifier is the size of its declaration.
+        Decl * dcl = nullptr;
+        ULONG sz = 0;
+        if (isDeclExistInOuterScope(TREE_id_name(p), &dcl)) {
+            sz = dcl->getDeclByteSize();
         }
-
-        ULONG sz = dcl->getDeclByteSize();
-        //if (is_complex_type(abs_decl) || dcl->is_user_type_ref()) {
-        //    sz = getComplexTypeSize(dcl);
-        //} else {
-        //    sz = getSimplyTypeSize(attr);
-        //}
-
-        if (sz != 0) {
-            pushv(sz);
-            return true;
+        if (sz == 0) {
+            reportErr(p->getLineno(), "expected constant expression");
+            return false;
         }
-    } else {
-        return compute_conditional_exp(p);
+        v.set(sz, BYTE_PER_POINTER, true);
+        return true;
     }
-
-    err(p->getLineno(), "'sizeof' requires type-name");
-
-    return false;
+    if (p->getCode() != TR_TYPE_NAME) {
+        //The size of constant expression is the size of its type.
+        CstValue pv;
+        if (!eval(p, pv)) { return false; }
+        v.set(pv.size, BYTE_PER_POINTER, true);
+        return true;
+    }
+    Decl * dcl = TREE_type_name(p);
+    ASSERT0(dcl && DECL_dt(dcl) == DCL_TYPE_NAME);
+    ASSERT0(DECL_spec(dcl));
+    if (dcl->is_user_type_ref()) {
+        dcl = makeupAndExpandUserType(dcl);
+        TREE_type_name(p) = dcl;
+    }
+    ULONG sz = dcl->getDeclByteSize();
+    if (sz == 0) {
+        reportErr(p->getLineno(), "'sizeof' requires type-name");
+        return false;
+    }
+    v.set(sz, BYTE_PER_POINTER, true);
+    return true;
 }
 
 
-static bool compute_unary_op(Tree * t)
+bool ConstExpEval::evalCvt(Tree * t, OUT CstValue & v)
 {
-    if (!compute_conditional_exp(TREE_lchild(t))) {
+    Tree * exp = TREE_cvt_exp(t);
+    Decl * dcl = TREE_type_name(TREE_cvt_type(t));
+    ASSERT0(dcl);
+    if (dcl->is_user_type_ref()) {
+        dcl = makeupAndExpandUserType(dcl);
+        TREE_type_name(TREE_cvt_type(t)) = dcl;
+    }
+    bool is_int = dcl->is_integer() || dcl->is_pointer();
+    if (is_int && exp->is_imm_fp()) {
+        //Floating constant is permitted to be the immediate operand of
+        //cast in integer constant expression.
+        v.val = (LONGLONG)::atof(TREE_fp_str_val(exp)->getStr());
+    } else if (!eval(exp, v)) {
         return false;
     }
-    LONGLONG l = popv();
-    switch (t->getCode()) {
+    if (!is_int) {
+        //Conversion to other type keeps the value.
+        return true;
+    }
+    if (dcl->is_bool()) {
+        v.set(v.val != 0, BYTE_PER_CHAR, true);
+        return true;
+    }
+    if (dcl->is_pointer()) {
+        v.set(v.val, BYTE_PER_POINTER, true);
+        return true;
+    }
+    UINT size = dcl->getDeclByteSize();
+    if (size == 0 || size > sizeof(LONGLONG)) { return true; }
+    v.set(v.val, size, dcl->getTypeAttr()->is_unsigned());
+    return true;
+}
+
+
+void computeConstUnaryOp(TREE_CODE code, MOD CstValue & v)
+{
+    v.promote();
+    switch (code) {
     case TR_PLUS: // +123
-        pushv(l);
-        break;
+        return;
     case TR_MINUS:  // -123
-        pushv((LONGLONG)-l);
-        break;
+        v.set((LONGLONG)(0 - (ULONGLONG)v.val), v.size, v.is_unsigned);
+        return;
     case TR_REV:  // Reverse
-        pushv(~l);
-        break;
+        v.set(~v.val, v.size, v.is_unsigned);
+        return;
     case TR_NOT:  // get non-value
-        pushv(!l);
-        break;
-    default:
-        err(t->getLineno(),"illegal duality expression");
-        return false;
+        v.setBool(v.val == 0);
+        return;
+    default: UNREACHABLE();
     }
-    return true;
 }
 
 
-static bool compute_binary_op(Tree * t)
+//The type of shift is the promoted type of left operand.
+static void computeShift(TOKEN tok, CstValue const& l, CstValue const& r,
+                         OUT CstValue & v)
 {
-    if (t == nullptr) { return false; }
-    LONGLONG r,l;
-    if (!compute_conditional_exp(TREE_lchild(t))) { return false; }
-    if (!compute_conditional_exp(TREE_rchild(t))) { return false; }
-    r = popv();
-    l = popv();
+    ULONGLONG bits = l.size * BIT_PER_BYTE;
+    bool is_neg_cnt = !r.is_unsigned && r.val < 0;
+    bool is_neg_left = !l.is_unsigned && l.val < 0;
+    if (is_neg_cnt || (ULONGLONG)r.val >= bits) {
+        //The behavior is undefined, shift out all bits.
+        v.set(tok == T_RSHIFT && is_neg_left ? -1 : 0, l.size, l.is_unsigned);
+        return;
+    }
+    switch (tok) {
+    case T_LSHIFT:
+        v.set((LONGLONG)((ULONGLONG)l.val << r.val), l.size, l.is_unsigned);
+        return;
+    case T_RSHIFT:
+        if (l.is_unsigned) {
+            v.set((LONGLONG)((ULONGLONG)l.val >> r.val), l.size, true);
+        } else {
+            v.set(l.val >> r.val, l.size, false);
+        }
+        return;
+    default: UNREACHABLE();
+    }
+}
+
+
+//'l' and 'r' have been converted to the type of 'v', and 'r' is not zero.
+static void computeDivRem(TOKEN tok, CstValue const& l, CstValue const& r,
+                          MOD CstValue & v)
+{
+    bool is_div = tok == T_DIV;
+    ASSERT0(is_div || tok == T_MOD);
+    ASSERT0(r.val != 0);
+    if (v.is_unsigned) {
+        ULONGLONG a = (ULONGLONG)l.val;
+        ULONGLONG b = (ULONGLONG)r.val;
+        v.set((LONGLONG)(is_div ? a / b : a % b), v.size, true);
+        return;
+    }
+    if (r.val == -1) {
+        //Avoid the overflow of host when dividing the minimum value.
+        v.set(is_div ? (LONGLONG)(0 - (ULONGLONG)l.val) : 0, v.size, false);
+        return;
+    }
+    v.set(is_div ? l.val / r.val : l.val % r.val, v.size, false);
+}
+
+
+bool computeConstBinaryOp(Tree const* t, CstValue l, CstValue r,
+                          OUT CstValue & v)
+{
+    l.promote();
+    r.promote();
     switch (t->getCode()) {
     case TR_LOGIC_OR: //logical or
-        l = l || r;
-        pushv(l);
-        break;
+        v.setBool(l.val != 0 || r.val != 0);
+        return true;
     case TR_LOGIC_AND: //logical and
-        l = l && r;
-        pushv(l);
-        break;
+        v.setBool(l.val != 0 && r.val != 0);
+        return true;
+    case TR_SHIFT: // >> <<
+        computeShift(TREE_token(t), l, r, v);
+        return true;
+    default:;
+    }
+
+    //Convert operands to common type.
+    UINT size;
+    bool is_unsigned;
+    CstValue::computeCommonType(l, r, size, is_unsigned);
+    l.set(l.val, size, is_unsigned);
+    r.set(r.val, size, is_unsigned);
+    v.set(0, size, is_unsigned);
+    ULONGLONG ul = (ULONGLONG)l.val;
+    ULONGLONG ur = (ULONGLONG)r.val;
+    switch (t->getCode()) {
     case TR_INCLUSIVE_OR: //inclusive or
-        l = l | r;
-        pushv(l);
-        break;
+        v.set((LONGLONG)(ul | ur), size, is_unsigned);
+        return true;
     case TR_INCLUSIVE_AND: //inclusive and
-        l = l & r;
-        pushv(l);
-        break;
+        v.set((LONGLONG)(ul & ur), size, is_unsigned);
+        return true;
     case TR_XOR: //exclusive or
-        l = l ^ r;
-        pushv(l);
-        break;
+        v.set((LONGLONG)(ul ^ ur), size, is_unsigned);
+        return true;
     case TR_EQUALITY: // == !=
         switch (TREE_token(t)) {
-        case T_EQU:
-            l = (l == r);
-            pushv(l);
-            break;
-        case T_NOEQU:
-            l = (l != r);
-            pushv(l);
-            break;
+        case T_EQU: v.setBool(ul == ur); return true;
+        case T_NOEQU: v.setBool(ul != ur); return true;
         default: UNREACHABLE();
         }
-        break;
-    case TR_RELATION: // < > >= <=
-        switch (TREE_token(t)) {
-        case T_LESSTHAN:
-            l = (l == r);
-            pushv(l);
-            break;
-        case T_MORETHAN:
-            l = (l != r);
-            pushv(l);
-            break;
-        case T_NOLESSTHAN:
-            l = (l >= r);
-            pushv(l);
-            break;
-        case T_NOMORETHAN:
-            l = (l <= r);
-            pushv(l);
-            break;
-        default: UNREACHABLE();
+        return false;
+    case TR_RELATION: { // < > >= <=
+        INT cmp = 0;
+        if (is_unsigned) {
+            cmp = ul < ur ? -1 : (ul > ur ? 1 : 0);
+        } else {
+            cmp = l.val < r.val ? -1 : (l.val > r.val ? 1 : 0);
         }
-        break;
-    case TR_SHIFT:   // >> <<
         switch (TREE_token(t)) {
-        case T_LSHIFT:
-            l = (l << r);
-            pushv(l);
-            break;
-        case T_RSHIFT:
-            l = (l >> r);
-            pushv(l);
-            break;
+        case T_LESSTHAN: v.setBool(cmp < 0); return true;
+        case T_MORETHAN: v.setBool(cmp > 0); return true;
+        case T_NOLESSTHAN: v.setBool(cmp >= 0); return true;
+        case T_NOMORETHAN: v.setBool(cmp <= 0); return true;
         default: UNREACHABLE();
         }
-        break;
+        return false;
+    }
     case TR_ADDITIVE: // '+' '-'
         switch (TREE_token(t)) {
-        case T_ADD:
-            l = (l + r);
-            pushv(l);
-            break;
-        case T_SUB:
-            l = (l - r);
-            pushv(l);
-            break;
+        case T_ADD: v.set((LONGLONG)(ul + ur), size, is_unsigned); return true;
+        case T_SUB: v.set((LONGLONG)(ul - ur), size, is_unsigned); return true;
         default: UNREACHABLE();
         }
-        break;
-    case TR_MULTI:    // '*' '/' '%'
-        switch (TREE_token(t)) {
-        case T_ASTERISK:
-            l = (l * r);
-            pushv(l);
-            break;
-        case T_DIV:
-            l = (l / r);
-            pushv(l);
-            if (r == 0) { warn(t->getLineno(), "divisor is zero"); }
-            break;
-        case T_MOD:
-            l = (l % r);
-            pushv(l);
-            if (r == 0) { warn(t->getLineno(), "divisor is zero"); }
-            break;
+        return false;
+    case TR_MULTI: // '*' '/' '%'
+        if (TREE_token(t) == T_ASTERISK) {
+            v.set((LONGLONG)(ul * ur), size, is_unsigned);
+            return true;
+        }
+        if (r.val == 0) { return false; }
+        computeDivRem(TREE_token(t), l, r, v);
+        return true;
+    default:;
+    }
+    return false;
+}
+
+
+//Return true if signed operation 'code' of 'a' and 'b' overflows the
+//signed type whose byte size is 'size'.
+//'a' and 'b' have been normalized to the type.
+static bool isSignedOverflow(TREE_CODE code, TOKEN tok, LONGLONG a,
+                             LONGLONG b, UINT size)
+{
+    if (size < sizeof(LONGLONG)) {
+        //The exact result is representable by LONGLONG.
+        LONGLONG res = 0;
+        switch (code) {
+        case TR_ADDITIVE: res = tok == T_ADD ? a + b : a - b; break;
+        case TR_MULTI: res = a * b; break;
         default: UNREACHABLE();
         }
-        break;
-    default:
-        err(t->getLineno(),"illegal duality expression");
+        return CstValue::normalize(res, size, false) != res;
+    }
+    LONGLONG maxv = (LONGLONG)(~(ULONGLONG)0 >> 1);
+    LONGLONG minv = -maxv - 1;
+    switch (code) {
+    case TR_ADDITIVE:
+        if (tok == T_ADD) {
+            return b > 0 ? a > maxv - b : a < minv - b;
+        }
+        return b < 0 ? a > maxv + b : a < minv + b;
+    case TR_MULTI:
+        if (a == 0 || b == 0) { return false; }
+        if (a > 0) {
+            return b > 0 ? a > maxv / b : b < minv / a;
+        }
+        return b > 0 ? a < minv / b : b < maxv / a;
+    default: UNREACHABLE();
+    }
+    return false;
+}
+
+
+bool isConstUnaryOpUndef(TREE_CODE code, CstValue v)
+{
+    v.promote();
+    if (code != TR_MINUS || v.is_unsigned) { return false; }
+    //The minimum value of the type can not be negated.
+    return v.val == CstValue::normalize(
+        (LONGLONG)((ULONGLONG)1 << (v.size * BIT_PER_BYTE - 1)), v.size,
+        false);
+}
+
+
+bool isConstBinaryOpUndef(Tree const* t, CstValue l, CstValue r)
+{
+    l.promote();
+    r.promote();
+    if (t->getCode() == TR_SHIFT) {
+        ULONGLONG bits = l.size * BIT_PER_BYTE;
+        if ((!r.is_unsigned && r.val < 0) || (ULONGLONG)r.val >= bits) {
+            return true;
+        }
+        if (TREE_token(t) != T_LSHIFT || l.is_unsigned) { return false; }
+        //Shifting negative value, or shifting bit into or past the sign
+        //bit is undefined.
+        return l.val < 0 ||
+               ((ULONGLONG)l.val >> (bits - 1 - (ULONGLONG)r.val)) != 0;
+    }
+    if (t->getCode() != TR_ADDITIVE && t->getCode() != TR_MULTI) {
         return false;
     }
+    UINT size;
+    bool is_unsigned;
+    CstValue::computeCommonType(l, r, size, is_unsigned);
+    if (is_unsigned) { return false; }
+    l.set(l.val, size, false);
+    r.set(r.val, size, false);
+    if (t->getCode() == TR_MULTI && TREE_token(t) != T_ASTERISK) {
+        //The quotient of minimum value divided by -1 is not representable,
+        //the division by zero is handled by computeConstBinaryOp().
+        return r.val == -1 &&
+               isSignedOverflow(TR_MULTI, T_ASTERISK, l.val, -1, size);
+    }
+    return isSignedOverflow(t->getCode(), TREE_token(t), l.val, r.val, size);
+}
+
+
+bool ConstExpEval::evalUnaryOp(Tree * t, OUT CstValue & v)
+{
+    if (!eval(TREE_lchild(t), v)) { return false; }
+    computeConstUnaryOp(t->getCode(), v);
     return true;
 }
 
 
-static bool compute_conditional_exp(IN Tree * t)
+bool ConstExpEval::evalBinaryOp(Tree * t, OUT CstValue & v)
+{
+    CstValue l;
+    CstValue r;
+    if (!eval(TREE_lchild(t), l)) { return false; }
+    if (!eval(TREE_rchild(t), r)) { return false; }
+    if (computeConstBinaryOp(t, l, r, v)) { return true; }
+    if (t->getCode() == TR_MULTI) {
+        //The result of division by zero is regarded as zero.
+        reportWarn(t->getLineno(), "divisor is zero");
+        v.set(0, v.size, v.is_unsigned);
+        return true;
+    }
+    reportErr(t->getLineno(), "illegal duality expression");
+    return false;
+}
+
+
+//The type of conditional expression is the common type of both arms,
+//whereas only the selected arm is evaluated.
+bool ConstExpEval::evalCond(Tree * t, OUT CstValue & v)
+{
+    CstValue det;
+    if (!eval(TREE_det(t), det)) { return false; }
+    Tree * sel = det.val != 0 ? TREE_true_part(t) : TREE_false_part(t);
+    Tree * other = det.val != 0 ? TREE_false_part(t) : TREE_true_part(t);
+    if (!eval(sel, v)) { return false; }
+    v.promote();
+
+    //Infer the type of the other arm without reporting diagnostic.
+    CstValue ov;
+    m_quiet_level++;
+    bool is_const = eval(other, ov);
+    m_quiet_level--;
+    if (!is_const) { return true; }
+    ov.promote();
+    UINT size;
+    bool is_unsigned;
+    CstValue::computeCommonType(v, ov, size, is_unsigned);
+    v.set(v.val, size, is_unsigned);
+    return true;
+}
+
+
+bool ConstExpEval::evalOperator(Tree * t, OUT CstValue & v)
 {
-    if (t == nullptr) { return true;}
     switch (t->getCode()) {
-    case TR_ENUM_CONST:
-        return compute_enum_const(t);
     case TR_PLUS: // +123
     case TR_MINUS:  // -123
     case TR_REV:  // Reverse
     case TR_NOT:  // get non-value
-        return compute_unary_op(t);
+        return evalUnaryOp(t, v);
     case TR_LOGIC_OR: //logical or
     case TR_LOGIC_AND: //logical and
     case TR_INCLUSIVE_OR: //inclusive or
@@ -275,66 +545,96 @@ static bool compute_conditional_exp(IN Tree * t)
     case TR_SHIFT:   // >> <<
     case TR_ADDITIVE: // '+' '-'
     case TR_MULTI:// '*' '/' '%'
-        return compute_binary_op(t);
+        return evalBinaryOp(t, v);
+    case TR_COND:
+        return evalCond(t, v);
+    case TR_CVT:
+        return evalCvt(t, v);
+    case TR_SIZEOF:
+        return evalSizeof(t, v);
+    default: UNREACHABLE();
+    }
+    return false;
+}
+
+
+bool ConstExpEval::eval(Tree * t, OUT CstValue & v)
+{
+    if (t == nullptr) {
+        v.set(0, BYTE_PER_INT, false);
+        return true;
+    }
+    if (isMemoizable(t)) {
+        if (TREE_cst_is_memo(t)) {
+            v.val = TREE_cst_val(t);
+            v.size = TREE_cst_size(t);
+            v.is_unsigned = TREE_cst_is_unsigned(t);
+            return true;
+        }
+        UINT diagn = getDiagCount();
+        if (!evalOperator(t, v)) { return false; }
+
+        //Do not memoize if there is diagnostic, the diagnostic should be
+        //reported by every evaluation. Task context only reads the
+        //memoized values.
+        if (m_quiet_level == 0 && !m_is_allow_float &&
+            getDiagCount() == diagn && !g_cur_ctx->is_task()) {
+            TREE_cst_val(t) = v.val;
+            TREE_cst_size(t) = (BYTE)v.size;
+            TREE_cst_is_unsigned(t) = v.is_unsigned;
+            TREE_cst_is_memo(t) = true;
+        }
+        return true;
+    }
+    switch (t->getCode()) {
+    case TR_ENUM_CONST:
+        return evalEnumConst(t, v);
     case TR_IMM:
     case TR_IMMU:
     case TR_IMML:
     case TR_IMMUL:
-        pushv(TREE_imm_val(t));
-        break;
+        return evalImm(t, v);
     case TR_FP:
     case TR_FPF:
     case TR_FPLD:
-        if (!g_is_allow_float) {
-            err(t->getLineno(),"constant expression is not integral");
+        if (!m_is_allow_float) {
+            reportErr(t->getLineno(), "constant expression is not integral");
             return false;
         }
-        pushv((LONGLONG)::atof(TREE_fp_str_val(t)->getStr()));
-        break;
-    case TR_SIZEOF:
-        return compute_sizeof(t);
+        v.set((LONGLONG)::atof(TREE_fp_str_val(t)->getStr()),
+              BYTE_PER_LONGLONG, false);
+        return true;
     case TR_ID: {
-            Decl * dcl = nullptr;
-            if (!isDeclExistInOuterScope(SYM_name(TREE_id_name(t)), &dcl)) {
-                err(t->getLineno(), "'%s' undefined");
-                return false;
+        Decl * dcl = nullptr;
+        if (!isDeclExistInOuterScope(TREE_id_name(t), &dcl)) {
+            if (m_quiet_level == 0) {
+                err(t->getLineno(), "'%s' undefined",
+                    TREE_id_name(t)->getStr());
             }
-            err(t->getLineno(), "expected constant expression");
             return false;
-
-            //TODO: infer the constant value of ID.
-            //pushv(getDeclByteSize(dcl));
-        break;
-    }
-    case TR_COND: {
-        if (!compute_conditional_exp(TREE_det(t))) { return false; }
-        LONGLONG v = popv();
-        if (v != 0) {
-            return compute_conditional_exp(TREE_true_part(t));
-        } else {
-            return compute_conditional_exp(TREE_false_part(t));
         }
-        break;
+        //TODO: infer the constant value of ID.
+        reportErr(t->getLineno(), "expected constant expression");
+        return false;
     }
-    case TR_CVT:
-        return compute_conditional_exp(TREE_cvt_exp(t));
     default:
-        err(t->getLineno(), "expected constant expression");
+        reportErr(t->getLineno(), "expected constant expression");
         return false;
     }
-    return true;
+    return false;
 }
 
 
 bool computeConstExp(IN Tree * t, OUT LONGLONG * v, bool is_allow_float)
 {
     ASSERT0(t && v);
-    g_is_allow_float = is_allow_float;
-    if (!compute_conditional_exp(t)) {
+    ConstExpEval ev(is_allow_float);
+    CstValue cv;
+    if (!ev.eval(t, cv)) {
         *v = 0;
         return false;
     }
-    *v = popv();
+    *v = cv.val;
     return true;
 }
 
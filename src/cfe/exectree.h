@@ -30,6 +30,66 @@ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 namespace xfe {
 
+//Record the value and the type of integer constant expression.
+//The value is normalized to its type, namely it is sign-extended if the
+//type is signed, otherwise zero-extended.
+class CstValue {
+public:
+    LONGLONG val;
+    UINT size; //byte size of the type of value
+    bool is_unsigned; //true if the type of value is unsigned
+public:
+    CstValue() : val(0), size(BYTE_PER_INT), is_unsigned(false) {}
+
+    //Compute the common type of 'l' and 'r' by usual arithmetic conversion.
+    static void computeCommonType(CstValue const& l, CstValue const& r,
+                                  OUT UINT & size, OUT bool & is_unsigned);
+
+    static LONGLONG normalize(LONGLONG v, UINT size, bool is_unsigned)
+    {
+        if (size >= sizeof(LONGLONG)) { return v; }
+        UINT shift = (UINT)(sizeof(LONGLONG) - size) * BIT_PER_BYTE;
+        if (is_unsigned) {
+            return (LONGLONG)(((ULONGLONG)v << shift) >> shift);
+        }
+        return ((LONGLONG)((ULONGLONG)v << shift)) >> shift;
+    }
+
+    //Integer promotion.
+    void promote()
+    {
+        if (size < BYTE_PER_INT) { set(val, BYTE_PER_INT, false); }
+    }
+
+    void set(LONGLONG v, UINT sz, bool is_uns)
+    {
+        size = sz;
+        is_unsigned = is_uns;
+        val = normalize(v, sz, is_uns);
+    }
+    void setBool(bool v) { set(v ? 1 : 0, BYTE_PER_INT, false); }
+};
+
+
+//Compute the value of unary operator 'code' on 'v' in place.
+//'code' is one of TR_PLUS, TR_MINUS, TR_REV and TR_NOT.
+void computeConstUnaryOp(TREE_CODE code, MOD CstValue & v);
+
+//Compute the value of binary operator 't' with operand values 'l' and 'r'.
+//Return false if the operator is not computable, e.g: the divisor is zero.
+bool computeConstBinaryOp(Tree const* t, CstValue l, CstValue r,
+                          OUT CstValue & v);
+
+//Return true if the behavior of unary operator 'code' on 'v' is undefined,
+//e.g: negating the minimum value of signed type.
+bool isConstUnaryOpUndef(TREE_CODE code, CstValue v);
+
+//Return true if the behavior of binary operator 't' with operand values 'l'
+//and 'r' is undefined, e.g: the signed operation overflows, or the shift
+//count is out of range. computeConstBinaryOp() still computes a value for
+//such operation, which is the value of constant expression.
+bool isConstBinaryOpUndef(Tree const* t, CstValue l, CstValue r);
+
 extern bool computeConstExp(IN Tree * t, OUT LONGLONG * v,
                             bool is_allow_float);
 
@@ -0,0 +1,225 @@
+/*@
+Copyright (c) 2013-2021, Su Zhenyu steven.known@gmail.com
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the Su Zhenyu nor the names of its contributors
+      may be used to endorse or promote products derived from this software
+      without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+@*/
+#include "cfeinc.h"
+
+namespace xfe {
+
+bool g_enable_stream_func = false;
+
+//The diagnostic that is kept out of memory pool while function arena is
+//being released.
+#define SAVED_DIAG_diag(d) ((d)->diag)
+#define SAVED_DIAG_is_err(d) ((d)->is_err)
+class SavedDiag {
+public:
+    Diag * diag;
+    bool is_err;
+};
+
+
+//Copy diagnostic 'd' out of memory pool.
+static Diag * saveDiag(Diag const* d)
+{
+    Diag * p = (Diag*)::malloc(d->getSize());
+    ::memcpy(p, d, d->getSize());
+    return p;
+}
+
+
+FuncStream::FuncStream(FuncStreamHandler handler)
+{
+    m_is_failed = false;
+    m_is_in_arena = false;
+    m_handler = handler;
+    m_last_decl = nullptr;
+    m_init_stmts = nullptr;
+    m_scope_num = 0;
+    m_err_num = 0;
+    m_warn_num = 0;
+}
+
+
+//Perform the passes on the declaration of global scope in the order of the
+//passes that performed on whole translation unit.
+void FuncStream::handleDecl(Decl * dcl)
+{
+    if (m_is_failed) { return; }
+
+    //The passes may change the line number of lexer, whereas the lexer is
+    //still scanning the source file.
+    UINT src_line_num = g_src_line_num;
+    UINT real_line_num = g_real_line_num;
+    bool succ = handleDeclImpl(dcl);
+    g_src_line_num = src_line_num;
+    g_real_line_num = real_line_num;
+    if (!succ) {
+        m_is_failed = true;
+        return;
+    }
+    if (dcl->is_fun_def() && m_handler != nullptr) {
+        m_handler(dcl);
+    }
+}
+
+
+//Return false if there is error.
+bool FuncStream::handleDeclImpl(Decl * dcl)
+{
+    if (g_err_msg_list.has_msg() ||
+        ST_SUCC != processDeclInitGlobalDecl(dcl, &m_init_stmts) ||
+        ST_SUCC != TypeTranGlobalDecl(dcl) ||
+        ST_SUCC != checkGlobalDecl(dcl) ||
+        ST_SUCC != canonGlobalDecl(dcl) ||
+        g_err_msg_list.has_msg()) {
+        return false;
+    }
+    return true;
+}
+
+
+void FuncStream::handlePendingDecl(Decl * end)
+{
+    Decl * dcl = m_last_decl != nullptr ? DECL_next(m_last_decl) :
+                                          get_global_scope()->getDeclList();
+    for (; dcl != end; dcl = DECL_next(dcl)) {
+        ASSERT0(dcl);
+        ASSERTN(!dcl->is_fun_def(), ("function has been handled"));
+        handleDecl(dcl);
+        m_last_decl = dcl;
+    }
+}
+
+
+void FuncStream::openArena(Decl * dcl)
+{
+    ASSERT0(!m_is_in_arena);
+    handlePendingDecl(dcl);
+    ASSERT0(DECL_next(dcl) == nullptr);
+    m_scope_num = g_scope_list.get_elem_count();
+    m_err_num = g_err_msg_list.get_elem_count();
+    m_warn_num = g_warn_msg_list.get_elem_count();
+    m_general_mark = smpoolMark(g_pool_general_used);
+    m_tree_mark = smpoolMark(g_pool_tree_used);
+    m_st_mark = smpoolMark(g_pool_st_used);
+    m_type_tab_mark = g_type_tab->mark();
+    m_is_in_arena = true;
+}
+
+
+//Release the memory that allocated for the body of function 'dcl', and
+//detach the body from global scope. The diagnostics reported in the arena
+//are reallocated after the release.
+void FuncStream::releaseArena(Decl * dcl)
+{
+    Scope * body = DECL_fun_body(dcl);
+    if (body != nullptr) {
+        xcom::remove(&SCOPE_sub(get_global_scope()), body);
+        DECL_fun_body(dcl) = nullptr;
+    }
+
+    //Keep the diagnostics out of the pool.
+    xcom::Vector<SavedDiag*> diagvec;
+    while (g_warn_msg_list.get_elem_count() > m_warn_num) {
+        SavedDiag * d = (SavedDiag*)::malloc(sizeof(SavedDiag));
+        SAVED_DIAG_diag(d) = saveDiag(g_warn_msg_list.remove_tail());
+        SAVED_DIAG_is_err(d) = false;
+        diagvec.append(d);
+    }
+    while (g_err_msg_list.get_elem_count() > m_err_num) {
+        SavedDiag * d = (SavedDiag*)::malloc(sizeof(SavedDiag));
+        SAVED_DIAG_diag(d) = saveDiag(g_err_msg_list.remove_tail());
+        SAVED_DIAG_is_err(d) = true;
+        diagvec.append(d);
+    }
+
+    //The scopes and labels of function body, and the free cells are in the
+    //arena.
+    while (g_scope_list.get_elem_count() > m_scope_num) {
+        g_scope_list.remove_tail()->destroy();
+    }
+    g_lab2lineno.clean();
+    g_lab_used.clean();
+    clean_free_cell_list();
+    g_type_tab->release(m_type_tab_mark);
+    smpoolRelease(g_pool_general_used, m_general_mark);
+    smpoolRelease(g_pool_tree_used, m_tree_mark);
+    smpoolRelease(g_pool_st_used, m_st_mark);
+
+    //Report the diagnostics again in the order of reporting.
+    for (VecIdx i = diagvec.get_last_idx(); i >= 0; i--) {
+        SavedDiag * d = diagvec.get(i);
+        if (SAVED_DIAG_is_err(d)) {
+            addErr(SAVED_DIAG_diag(d));
+        } else {
+            addWarn(SAVED_DIAG_diag(d));
+        }
+        ::free(SAVED_DIAG_diag(d));
+        ::free(d);
+    }
+}
+
+
+void FuncStream::closeArena(Decl * dcl)
+{
+    ASSERT0(m_is_in_arena);
+    handleDecl(dcl);
+    releaseArena(dcl);
+    m_last_decl = dcl;
+    m_is_in_arena = false;
+}
+
+
+STATUS FuncStream::finish()
+{
+    ASSERT0(!m_is_in_arena);
+    if (get_global_scope() == nullptr) { return ST_SUCC; }
+    handlePendingDecl(nullptr);
+    if (m_is_failed || g_err_msg_list.has_msg() ||
+        ST_SUCC != processDeclInitGlobalStmt(m_init_stmts) ||
+        ST_SUCC != TypeTranGlobalStmt() ||
+        ST_SUCC != checkGlobalStmt() ||
+        ST_SUCC != canonGlobalStmt()) {
+        return ST_ERR;
+    }
+    return ST_SUCC;
+}
+
+
+STATUS performFuncStream(CParser & parser, FuncStreamHandler handler)
+{
+    FuncStream fs(handler);
+    CTX_func_stream(g_cur_ctx) = &fs;
+    STATUS s = parser.perform();
+    if (s == ST_SUCC) {
+        s = fs.finish();
+    }
+    CTX_func_stream(g_cur_ctx) = nullptr;
+    return s;
+}
+
+} //namespace xfe
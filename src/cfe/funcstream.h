@@ -0,0 +1,111 @@
+/*@
+Copyright (c) 2013-2021, Su Zhenyu steven.known@gmail.com
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the Su Zhenyu nor the names of its contributors
+      may be used to endorse or promote products derived from this software
+      without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+@*/
+#ifndef __FUNCSTREAM_H__
+#define __FUNCSTREAM_H__
+
+namespace xfe {
+
+//The handler is invoked on each function definition once it has been
+//compiled in streaming mode. The body of function is released after the
+//handler returned, thus the handler must not keep any reference to the
+//objects of the body.
+typedef void (*FuncStreamHandler)(Decl * dcl);
+
+//FuncStream compiles each function definition as soon as it has been parsed.
+//The body of function is allocated in function arena, namely the memory
+//allocated after the marks of the pools of current context. The
+//declarations of global scope that precede the function are handled before
+//the arena is opened. Once the body has been parsed, the function is run
+//through declaration initialization, type transforming, type checking and
+//tree canonicalization, handed to the handler, and released along with the
+//arena. Only the declarations of global scope are kept, thus the memory is
+//bounded by the largest function rather than the whole translation unit.
+//Once there is error, the rest of functions are parsed and released without
+//compiling.
+class FuncStream {
+    COPY_CONSTRUCTOR(FuncStream);
+    bool m_is_failed;
+    bool m_is_in_arena;
+    FuncStreamHandler m_handler;
+
+    //The last declaration of global scope that has been handled.
+    Decl * m_last_decl;
+
+    //Record the stmts that generated by the initialization of global
+    //variables, they are inserted before the stmt list of global scope.
+    Tree * m_init_stmts;
+
+    //The state of current context at the beginning of function arena.
+    UINT m_scope_num;
+    UINT m_err_num;
+    UINT m_warn_num;
+    SMemPoolMark m_general_mark;
+    SMemPoolMark m_tree_mark;
+    SMemPoolMark m_st_mark;
+    TypeTabMark m_type_tab_mark;
+protected:
+    void handleDecl(Decl * dcl);
+    bool handleDeclImpl(Decl * dcl);
+
+    //Handle the declarations of global scope from the next of m_last_decl
+    //to the one before 'end'. 'end' may be nullptr.
+    void handlePendingDecl(Decl * end);
+    void releaseArena(Decl * dcl);
+public:
+    explicit FuncStream(FuncStreamHandler handler);
+
+    //The function is invoked by parser when the body of function definition
+    //'dcl' is about to be parsed.
+    void openArena(Decl * dcl);
+
+    //The function is invoked by parser when the body of function definition
+    //'dcl' has been parsed.
+    void closeArena(Decl * dcl);
+
+    //Handle the rest of declarations and the stmt list of global scope.
+    //Return ST_ERR if there is error.
+    STATUS finish();
+
+    //Return true if current thread is parsing or compiling a function body
+    //in streaming mode.
+    static bool isInFuncArena()
+    {
+        FuncStream const* fs = CTX_func_stream(g_cur_ctx);
+        return fs != nullptr && fs->m_is_in_arena;
+    }
+};
+
+
+//Parse the source file of 'parser' in streaming mode, each function
+//definition is compiled and handed to 'handler' as soon as it has been
+//parsed, then the body of function is released.
+//Return ST_ERR if there is error.
+STATUS performFuncStream(CParser & parser, FuncStreamHandler handler);
+
+} //namespace xfe
+#endif
@@ -0,0 +1,324 @@
+/*@
+Copyright (c) 2013-2021, Su Zhenyu steven.known@gmail.com
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the Su Zhenyu nor the names of its contributors
+      may be used to endorse or promote products derived from this software
+      without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+@*/
+#include <atomic>
+#include <thread>
+#include "cfeinc.h"
+
+namespace xfe {
+
+UINT g_sema_thread_num = 1;
+
+//FuncTask records the declarations that handled by one task, from 'first'
+//to 'last' in order, and the context that the task works in.
+#define FUNC_TASK_first(t) ((t)->first)
+#define FUNC_TASK_last(t) ((t)->last)
+#define FUNC_TASK_is_serial(t) ((t)->is_serial)
+#define FUNC_TASK_status(t) ((t)->status)
+#define FUNC_TASK_ctx(t) ((t)->ctx)
+class FuncTask {
+    COPY_CONSTRUCTOR(FuncTask);
+public:
+    Decl * first;
+    Decl * last;
+    bool is_serial; //task is performed before the others by current thread.
+    STATUS status;
+    CompileCtx ctx;
+public:
+    FuncTask(Decl * f, Decl * l, bool serial, CompileCtx * parent) :
+        ctx(parent)
+    {
+        first = f;
+        last = l;
+        is_serial = serial;
+        status = ST_SUCC;
+        CTX_pool_general_used(&ctx) = smpoolCreateThreadCache(256);
+        CTX_pool_tree_used(&ctx) = smpoolCreateThreadCache(128);
+    }
+    ~FuncTask()
+    {
+        //The pools have been handed over to parent if the task is merged.
+        if (CTX_pool_general_used(&ctx) != nullptr) {
+            smpoolDelete(CTX_pool_general_used(&ctx));
+        }
+        if (CTX_pool_tree_used(&ctx) != nullptr) {
+            smpoolDelete(CTX_pool_tree_used(&ctx));
+        }
+    }
+};
+
+
+//FuncTaskMgr partitions the declarations of global scope into tasks,
+//dispatches the tasks to worker threads, and merges the result of tasks
+//into current context.
+class FuncTaskMgr {
+    COPY_CONSTRUCTOR(FuncTaskMgr);
+    FuncTaskHandler m_handler;
+    CompileCtx * m_parent;
+    xcom::Vector<FuncTask*> m_task_vec;
+    std::atomic<UINT> m_next_task; //index of the task to be dispatched.
+
+    //The line number of lexer of parent when tasks start, which is the
+    //line number of diagnostics that have no line number of tree.
+    UINT m_src_line_num;
+    INT m_real_line_num;
+protected:
+    void addTask(Decl * first, Decl * last, bool is_serial);
+    void mergeDiag(CompileCtx * tc);
+    STATUS merge();
+    void partition(Scope * s, FuncTaskIsSerial is_serial);
+    void precomputeLayout(Scope * s);
+    void performTask(FuncTask * t, Lexer * lexer);
+    void runWorker();
+    static void runWorkerThread(FuncTaskMgr * mgr) { mgr->runWorker(); }
+public:
+    FuncTaskMgr(FuncTaskHandler handler);
+    ~FuncTaskMgr();
+
+    STATUS perform(Scope * s, FuncTaskIsSerial is_serial, UINT thread_num);
+};
+
+
+FuncTaskMgr::FuncTaskMgr(FuncTaskHandler handler)
+{
+    m_handler = handler;
+    m_parent = g_cur_ctx;
+    m_next_task = 0;
+    m_src_line_num = 0;
+    m_real_line_num = 0;
+}
+
+
+FuncTaskMgr::~FuncTaskMgr()
+{
+    for (UINT i = 0; i < m_task_vec.get_elem_count(); i++) {
+        delete m_task_vec.get(i);
+    }
+}
+
+
+void FuncTaskMgr::addTask(Decl * first, Decl * last, bool is_serial)
+{
+    m_task_vec.append(new FuncTask(first, last, is_serial, m_parent));
+}
+
+
+void FuncTaskMgr::partition(Scope * s, FuncTaskIsSerial is_serial)
+{
+    Decl * first = nullptr;
+    Decl * prev = nullptr;
+    for (Decl * dcl = s->getDeclList(); dcl != nullptr;
+         prev = dcl, dcl = DECL_next(dcl)) {
+        ASSERT0(dcl->getDeclScope() == s);
+        if (is_serial != nullptr && is_serial(dcl)) {
+            if (first != nullptr) {
+                addTask(first, prev, false);
+                first = nullptr;
+            }
+            addTask(dcl, dcl, true);
+            continue;
+        }
+        if (first == nullptr) {
+            first = dcl;
+        }
+        if (dcl->is_fun_def()) {
+            addTask(first, dcl, false);
+            first = nullptr;
+        }
+    }
+    if (first != nullptr) {
+        addTask(first, prev, false);
+    }
+}
+
+
+//Compute the layouts of the complete aggregates of scope 's' in parent,
+//thus the layouts are memoized on the aggregates and shared by tasks,
+//rather than computed by each task that refers to them.
+void FuncTaskMgr::precomputeLayout(Scope * s)
+{
+    ASSERT0(g_cur_ctx == m_parent);
+    UINT errn = g_err_msg_list.get_elem_count();
+    UINT warnn = g_warn_msg_list.get_elem_count();
+    for (Struct * st = SCOPE_struct_list(s).get_head(); st != nullptr;
+         st = SCOPE_struct_list(s).get_next()) {
+        st->computeLayout(true);
+    }
+    for (Union * un = SCOPE_union_list(s).get_head(); un != nullptr;
+         un = SCOPE_union_list(s).get_next()) {
+        un->computeLayout(false);
+    }
+    //The layout that has diagnostic is not memoized, the diagnostic will
+    //be reported by the task that refers to it.
+    while (g_err_msg_list.get_elem_count() > errn) {
+        g_err_msg_list.remove_tail();
+    }
+    while (g_warn_msg_list.get_elem_count() > warnn) {
+        g_warn_msg_list.remove_tail();
+    }
+}
+
+
+void FuncTaskMgr::performTask(FuncTask * t, Lexer * lexer)
+{
+    setCurCompileCtx(&FUNC_TASK_ctx(t));
+
+    //The lexer only provides line number for diagnostics.
+    g_cur_lexer = lexer;
+    g_src_line_num = m_src_line_num;
+    g_real_line_num = m_real_line_num;
+    for (Decl * dcl = FUNC_TASK_first(t); dcl != nullptr;
+         dcl = DECL_next(dcl)) {
+        if (m_handler(dcl) != ST_SUCC) {
+            FUNC_TASK_status(t) = ST_ERR;
+            break;
+        }
+        if (dcl == FUNC_TASK_last(t)) { break; }
+    }
+    setCurCompileCtx(nullptr);
+}
+
+
+void FuncTaskMgr::runWorker()
+{
+    Lexer lexer;
+    for (UINT i = m_next_task++; i < m_task_vec.get_elem_count();
+         i = m_next_task++) {
+        FuncTask * t = m_task_vec.get(i);
+        if (FUNC_TASK_is_serial(t)) { continue; }
+        performTask(t, &lexer);
+    }
+}
+
+
+void FuncTaskMgr::mergeDiag(CompileCtx * tc)
+{
+    for (ErrMsg * e = CTX_err_msg_list(tc).get_head();
+         e != nullptr; e = CTX_err_msg_list(tc).get_next()) {
+        g_err_msg_list.append_tail(e);
+    }
+    for (WarnMsg * w = CTX_warn_msg_list(tc).get_head();
+         w != nullptr; w = CTX_warn_msg_list(tc).get_next()) {
+        g_warn_msg_list.append_tail(w);
+    }
+}
+
+
+//Merge tasks into parent in the order of declarations. The diagnostics
+//of tasks are merged until the task that the serial handling stops at.
+STATUS FuncTaskMgr::merge()
+{
+    ASSERT0(g_cur_ctx == m_parent);
+    STATUS st = ST_SUCC;
+    bool is_layout_changed = false;
+    for (UINT i = 0; i < m_task_vec.get_elem_count(); i++) {
+        FuncTask * t = m_task_vec.get(i);
+        CompileCtx * tc = &FUNC_TASK_ctx(t);
+
+        //Renumber trees as if they were allocated by parent.
+        xcom::Vector<Tree*> const& tv = CTX_task_tree_vec(tc);
+        for (UINT j = 0; j < tv.get_elem_count(); j++) {
+            TREE_id(tv.get(j)) = g_tree_count++;
+        }
+        g_decl_count = MAX(g_decl_count, CTX_decl_count(tc));
+        g_aggr_count = MAX(g_aggr_count, CTX_aggr_count(tc));
+        is_layout_changed |= CTX_layout_epoch(tc) != g_layout_epoch;
+
+        //Trees and diagnostics of task are allocated in its pools.
+        CTX_task_pool_list(m_parent).append_tail(CTX_pool_general_used(tc));
+        CTX_task_pool_list(m_parent).append_tail(CTX_pool_tree_used(tc));
+        CTX_pool_general_used(tc) = nullptr;
+        CTX_pool_tree_used(tc) = nullptr;
+        if (st != ST_SUCC) { continue; }
+
+        mergeDiag(tc);
+        //The handler of function definition returns ST_ERR if there are
+        //errors of preceding declarations in serial handling.
+        if (FUNC_TASK_status(t) != ST_SUCC ||
+            (FUNC_TASK_last(t)->is_fun_def() && g_err_msg_list.has_msg())) {
+            st = ST_ERR;
+        }
+    }
+    if (is_layout_changed) {
+        //Tasks refilled the specifier of declarations that may be shared.
+        g_layout_epoch++;
+    }
+    return st;
+}
+
+
+STATUS FuncTaskMgr::perform(Scope * s, FuncTaskIsSerial is_serial,
+                            UINT thread_num)
+{
+    partition(s, is_serial);
+    m_src_line_num = g_src_line_num;
+    m_real_line_num = g_real_line_num;
+
+    //Handle the declarations that read by function definitions in advance.
+    Lexer lexer;
+    for (UINT i = 0; i < m_task_vec.get_elem_count(); i++) {
+        FuncTask * t = m_task_vec.get(i);
+        if (FUNC_TASK_is_serial(t)) {
+            performTask(t, &lexer);
+        }
+    }
+    setCurCompileCtx(m_parent);
+    precomputeLayout(s);
+
+    thread_num = MIN(thread_num, m_task_vec.get_elem_count());
+    std::thread * workers = new std::thread[thread_num];
+    for (UINT i = 0; i < thread_num; i++) {
+        workers[i] = std::thread(runWorkerThread, this);
+    }
+    for (UINT i = 0; i < thread_num; i++) {
+        workers[i].join();
+    }
+    delete [] workers;
+    setCurCompileCtx(m_parent);
+    return merge();
+}
+
+
+STATUS performFuncTask(FuncTaskHandler handler, FuncTaskIsSerial is_serial)
+{
+    Scope * s = get_global_scope();
+    ASSERT0(s);
+    //The serial handling terminates at the first function definition if
+    //there has been error, thus there is no need to dispatch tasks.
+    if (g_sema_thread_num <= 1 || g_err_msg_list.has_msg()) {
+        for (Decl * dcl = s->getDeclList(); dcl != nullptr;
+             dcl = DECL_next(dcl)) {
+            ASSERT0(dcl->getDeclScope() == s);
+            if (handler(dcl) != ST_SUCC) { return ST_ERR; }
+        }
+        return ST_SUCC;
+    }
+    FuncTaskMgr mgr(handler);
+    return mgr.perform(s, is_serial, g_sema_thread_num);
+}
+
+} //namespace xfe
@@ -0,0 +1,59 @@
+/*@
+Copyright (c) 2013-2021, Su Zhenyu steven.known@gmail.com
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the Su Zhenyu nor the names of its contributors
+      may be used to endorse or promote products derived from this software
+      without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+@*/
+#ifndef __FUNCTASK_H__
+#define __FUNCTASK_H__
+
+namespace xfe {
+
+//The handler performs a pass on the declaration 'dcl' of global scope.
+//Return ST_ERR if the pass should not go on to the next declaration. Note
+//the handler has to return ST_ERR after handling a function definition if
+//there is any error in g_err_msg_list.
+typedef STATUS (*FuncTaskHandler)(Decl * dcl);
+
+//Return true if handling 'dcl' modifies the declarations that may be read
+//by the handling of function definitions, such declaration will be handled
+//before the function definitions.
+typedef bool (*FuncTaskIsSerial)(Decl const* dcl);
+
+//Perform 'handler' on each declaration of global scope in order.
+//If g_sema_thread_num is greater than 1, the declarations are partitioned
+//into tasks, each task consists of the declarations up to a function
+//definition, and the tasks are performed by a pool of worker threads. Each
+//task works in a task context which owns the memory pools and diagnostics.
+//After all tasks have finished, the diagnostics are merged into current
+//context in the order of declarations, and the trees allocated by tasks
+//are renumbered in the same order, thus the result is identical to the
+//result of performing 'handler' by current thread.
+//is_serial: it may be nullptr if there is no declaration to be handled
+//           before function definitions.
+//Return ST_ERR if 'handler' returned ST_ERR on any declaration.
+STATUS performFuncTask(FuncTaskHandler handler, FuncTaskIsSerial is_serial);
+
+} //namespace xfe
+#endif
@@ -0,0 +1,308 @@
+/*@
+Copyright (c) 2013-2021, Su Zhenyu steven.known@gmail.com
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the Su Zhenyu nor the names of its contributors
+      may be used to endorse or promote products derived from this software
+      without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+@*/
+#include "cfeinc.h"
+
+namespace xfe {
+
+bool g_enable_fused_sema = false;
+
+//The phases of fused semantic pass, in the order of separate passes.
+typedef enum {
+    SEMA_TYPE_TRAN = 0,
+    SEMA_TYPE_CHECK,
+    SEMA_TREE_CANON,
+    SEMA_PHASE_NUM,
+} SEMA_PHASE;
+
+//SemaPhase records the result of one phase. The diagnostics and trees
+//generated by the phase are kept apart from the other phases.
+#define SEMA_PHASE_is_failed(p) ((p)->is_failed)
+#define SEMA_PHASE_err_list(p) ((p)->err_list)
+#define SEMA_PHASE_warn_list(p) ((p)->warn_list)
+#define SEMA_PHASE_tree_vec(p) ((p)->tree_vec)
+class SemaPhase {
+    COPY_CONSTRUCTOR(SemaPhase);
+public:
+    //Set to true if the separate pass would return ST_ERR, the phase
+    //stops at where the separate pass stops.
+    bool is_failed;
+    ErrList err_list;
+    WarnList warn_list;
+
+    //Record the trees allocated by the phase in allocation order.
+    xcom::Vector<Tree*> tree_vec;
+public:
+    SemaPhase() { is_failed = false; }
+};
+
+
+class FusedSema {
+    COPY_CONSTRUCTOR(FusedSema);
+    SemaPhase m_phase[SEMA_PHASE_NUM];
+
+    //The diagnostics generated before fused pass.
+    UINT m_base_err_num;
+    UINT m_base_warn_num;
+    xcom::Vector<Tree*> * m_org_tree_vec;
+protected:
+    void commit();
+    void enter(SEMA_PHASE p);
+    void fail(SEMA_PHASE p) { SEMA_PHASE_is_failed(&m_phase[p]) = true; }
+    void handleDecl(Decl * dcl);
+    void handleFuncDef(Decl * dcl);
+    void handleStmtList(OUT Tree ** stmt_list, TYCtx * tt_cont,
+                        TYCtx * tc_cont);
+    void handleStmtListEnd();
+
+    //Return true if there is error in g_err_msg_list when the separate pass
+    //of phase 'p' is performed.
+    bool hasErr(SEMA_PHASE p) const
+    {
+        return m_base_err_num != 0 ||
+               SEMA_PHASE_err_list(&m_phase[p]).has_msg();
+    }
+
+    //Return true if the separate pass of phase 'p' would be performed
+    //at present.
+    bool isActive(SEMA_PHASE p) const
+    {
+        for (UINT i = SEMA_TYPE_TRAN; i <= (UINT)p; i++) {
+            if (SEMA_PHASE_is_failed(&m_phase[i])) { return false; }
+        }
+        return true;
+    }
+    void leave(SEMA_PHASE p);
+public:
+    FusedSema();
+
+    STATUS perform();
+};
+
+
+FusedSema::FusedSema()
+{
+    m_base_err_num = g_err_msg_list.get_elem_count();
+    m_base_warn_num = g_warn_msg_list.get_elem_count();
+    m_org_tree_vec = CTX_new_tree_vec(g_cur_ctx);
+    if (m_base_err_num != 0) {
+        //TreeCanonicalize() does nothing if there has been error.
+        fail(SEMA_TREE_CANON);
+    }
+}
+
+
+void FusedSema::enter(SEMA_PHASE p)
+{
+    CTX_new_tree_vec(g_cur_ctx) = &SEMA_PHASE_tree_vec(&m_phase[p]);
+}
+
+
+//Move the diagnostics that generated by phase 'p' into its own lists.
+void FusedSema::leave(SEMA_PHASE p)
+{
+    CTX_new_tree_vec(g_cur_ctx) = m_org_tree_vec;
+    SemaPhase * ph = &m_phase[p];
+    if (g_err_msg_list.get_elem_count() > m_base_err_num) {
+        ErrList tmp;
+        while (g_err_msg_list.get_elem_count() > m_base_err_num) {
+            tmp.append_head(g_err_msg_list.remove_tail());
+        }
+        for (ErrMsg * e = tmp.get_head(); e != nullptr; e = tmp.get_next()) {
+            SEMA_PHASE_err_list(ph).append_tail(e);
+        }
+    }
+    if (g_warn_msg_list.get_elem_count() > m_base_warn_num) {
+        WarnList tmp;
+        while (g_warn_msg_list.get_elem_count() > m_base_warn_num) {
+            tmp.append_head(g_warn_msg_list.remove_tail());
+        }
+        for (WarnMsg * w = tmp.get_head(); w != nullptr; w = tmp.get_next()) {
+            SEMA_PHASE_warn_list(ph).append_tail(w);
+        }
+    }
+}
+
+
+//Transform, check and canonicalize each statement in 'stmt_list' in turn.
+void FusedSema::handleStmtList(OUT Tree ** stmt_list, TYCtx * tt_cont,
+                               TYCtx * tc_cont)
+{
+    TreeCanon tc;
+    TreeCanonCtx ctx;
+    bool is_check_stopped = false;
+    Tree * next = nullptr;
+    for (Tree * t = *stmt_list; t != nullptr; t = next) {
+        next = TREE_nsib(t);
+        enter(SEMA_TYPE_TRAN);
+        INT st = TypeTran(t, tt_cont);
+        leave(SEMA_TYPE_TRAN);
+        if (st != ST_SUCC) {
+            fail(SEMA_TYPE_TRAN);
+            return;
+        }
+        if (isActive(SEMA_TYPE_CHECK) && !is_check_stopped) {
+            enter(SEMA_TYPE_CHECK);
+            is_check_stopped = !checkTree(t, tc_cont);
+            leave(SEMA_TYPE_CHECK);
+        }
+        if (isActive(SEMA_TREE_CANON)) {
+            enter(SEMA_TREE_CANON);
+            bool succ = tc.handleTreeInList(t, stmt_list, &ctx);
+            leave(SEMA_TREE_CANON);
+            if (!succ) {
+                *stmt_list = nullptr;
+                fail(SEMA_TREE_CANON);
+            }
+        }
+    }
+}
+
+
+//Each separate pass returns ST_ERR if there is error after handling a
+//statement list.
+void FusedSema::handleStmtListEnd()
+{
+    for (UINT p = SEMA_TYPE_TRAN; p < SEMA_PHASE_NUM; p++) {
+        if (isActive((SEMA_PHASE)p) && hasErr((SEMA_PHASE)p)) {
+            fail((SEMA_PHASE)p);
+        }
+    }
+}
+
+
+void FusedSema::handleFuncDef(Decl * dcl)
+{
+    Scope * body = dcl->getFunBody();
+    TYCtx tt_cont;
+    enter(SEMA_TYPE_TRAN);
+    INT st = TypeTranDeclInitList(body->getDeclList(), &tt_cont);
+    leave(SEMA_TYPE_TRAN);
+    if (st != ST_SUCC) {
+        fail(SEMA_TYPE_TRAN);
+        return;
+    }
+
+    TYCtx tc_cont;
+    tc_cont.current_func_declaration = dcl;
+    if (isActive(SEMA_TYPE_CHECK)) {
+        enter(SEMA_TYPE_CHECK);
+        checkDeclInit(body->getDeclList(), nullptr);
+        leave(SEMA_TYPE_CHECK);
+    }
+    handleStmtList(&SCOPE_stmt_list(body), &tt_cont, &tc_cont);
+    handleStmtListEnd();
+}
+
+
+void FusedSema::handleDecl(Decl * dcl)
+{
+    if (isActive(SEMA_TYPE_CHECK)) {
+        enter(SEMA_TYPE_CHECK);
+        checkDeclaration(dcl);
+        leave(SEMA_TYPE_CHECK);
+    }
+    if (dcl->is_fun_def()) {
+        handleFuncDef(dcl);
+        if (!isActive(SEMA_TYPE_TRAN)) { return; }
+    }
+    if (dcl->is_initialized()) {
+        TYCtx cont;
+        enter(SEMA_TYPE_TRAN);
+        INT st = TypeTranDeclInit(dcl, &cont);
+        leave(SEMA_TYPE_TRAN);
+        if (st != ST_SUCC || hasErr(SEMA_TYPE_TRAN)) {
+            fail(SEMA_TYPE_TRAN);
+        }
+    }
+}
+
+
+//Renumber trees and append diagnostics to current context in the order of
+//separate passes. The diagnostics of phases after the first failed phase
+//are discarded, since the separate passes would not be performed.
+void FusedSema::commit()
+{
+    UINT tree_num = 0;
+    for (UINT p = SEMA_TYPE_TRAN; p < SEMA_PHASE_NUM; p++) {
+        tree_num += SEMA_PHASE_tree_vec(&m_phase[p]).get_elem_count();
+    }
+    ASSERT0(g_tree_count >= tree_num);
+    UINT id = g_tree_count - tree_num;
+    for (UINT p = SEMA_TYPE_TRAN; p < SEMA_PHASE_NUM; p++) {
+        xcom::Vector<Tree*> const& tv = SEMA_PHASE_tree_vec(&m_phase[p]);
+        for (UINT i = 0; i < tv.get_elem_count(); i++) {
+            TREE_id(tv.get(i)) = id++;
+        }
+    }
+    for (UINT p = SEMA_TYPE_TRAN; p < SEMA_PHASE_NUM; p++) {
+        SemaPhase * ph = &m_phase[p];
+        for (ErrMsg * e = SEMA_PHASE_err_list(ph).get_head();
+             e != nullptr; e = SEMA_PHASE_err_list(ph).get_next()) {
+            g_err_msg_list.append_tail(e);
+        }
+        for (WarnMsg * w = SEMA_PHASE_warn_list(ph).get_head();
+             w != nullptr; w = SEMA_PHASE_warn_list(ph).get_next()) {
+            g_warn_msg_list.append_tail(w);
+        }
+        if (SEMA_PHASE_is_failed(ph)) { break; }
+    }
+}
+
+
+STATUS FusedSema::perform()
+{
+    Scope * s = get_global_scope();
+    for (Decl * dcl = s->getDeclList(); dcl != nullptr;
+         dcl = DECL_next(dcl)) {
+        ASSERT0(dcl->getDeclScope() == s);
+        handleDecl(dcl);
+        if (!isActive(SEMA_TYPE_TRAN)) { break; }
+    }
+    if (isActive(SEMA_TYPE_TRAN)) {
+        TYCtx tt_cont;
+        TYCtx tc_cont;
+        handleStmtList(&SCOPE_stmt_list(s), &tt_cont, &tc_cont);
+        handleStmtListEnd();
+    }
+    commit();
+    for (UINT p = SEMA_TYPE_TRAN; p < SEMA_PHASE_NUM; p++) {
+        if (SEMA_PHASE_is_failed(&m_phase[p])) { return ST_ERR; }
+    }
+    return ST_SUCC;
+}
+
+
+INT FusedSemanticPass()
+{
+    initTypeTran();
+    if (get_global_scope() == nullptr) { return ST_SUCC; }
+    FusedSema fs;
+    return fs.perform();
+}
+
+} //namespace xfe
@@ -25,6 +25,11 @@ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
 OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
 USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 @*/
+#ifndef _ON_WINDOWS_
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#endif
 #include "../com/xcominc.h"
 #include "err.h"
 #include "cfeinc.h"
@@ -33,41 +38,18 @@ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #define OCTAL_LITERAL_LEN_IN_STRING 3
 #define HEX_LITERAL_LEN_IN_STRING 2
+#define OFST_TAB_LINE_SIZE (m_ofst_tab_byte_size / sizeof(LONG))
 
 namespace xfe {
 
-static INT g_cur_token_string_pos = 0;
-static CHAR g_cur_char = 0; //See details about the paper about LL1
-static bool g_is_dos = true;
-static INT g_cur_line_pos = 0;
-static INT g_cur_line_num = 0;
-static CHAR g_file_buf[LEX_MAX_BUF_LINE];
-static INT  g_file_buf_pos = LEX_MAX_BUF_LINE;
-static INT  g_last_read_num = 0;
-
-//Set true to return the newline charactors as normal character.
-static bool g_use_newline_char = true;
-static UINT g_cur_src_ofst = 0; //Record current file offset of src file
-
-UINT g_src_line_num = 0; //line number of src file
-TOKEN g_cur_token = T_UNDEF;
-
-//The string buffer which token were reside.
-CHAR g_cur_token_string[LEX_MAX_BUF_LINE] = {0};
-CHAR * g_cur_line = nullptr; //Current parsing line of src file
-UINT g_cur_line_len = 0; //The current line buf length ,than read from file buf
-LONG * g_ofst_tab = nullptr; //Record offset of each line in src file
-LONG g_ofst_tab_byte_size = 0; //Record byte size position of Offset Table
-bool g_enable_newline_token = false; //Set true to regard '\n' as token.
+//Set true to map the whole src file into memory rather than reading it
+//chunk by chunk. Lines are then referenced in place without copying.
+bool g_enable_map_src_file = false;
 
 //If true, recognize the true and false token.
 bool g_enable_true_false_token = true;
-FILE * g_hsrc = nullptr;
-INT g_real_line_num = 0;
 
-//Record the number of disgarded line, that always
-//sparking by preprecossor.
-UINT g_disgarded_line_num = 0;
+THREAD_LOCAL Lexer * g_cur_lexer = nullptr;
 
 //Make sure following Tokens or Keywords is consistent with
 //declarations of TOKEN enumeration declared in lex.h.
@@ -262,253 +244,710 @@ static KeywordInfo g_keyword_info[] = {
 
 static UINT g_keyword_num = sizeof(g_keyword_info)/sizeof(g_keyword_info[0]);
 
+//Map the character to the token that consists of the single character.
+//The entry is T_UNDEF if the character may start a longer token.
+static TOKEN g_punc_token[256];
+
+
+//Initialize or realloc offset table.
+void Lexer::growOfstTab()
+{
+    if (m_ofst_tab == nullptr) {
+        m_ofst_tab_byte_size = LEX_MAX_OFST_BUF_LEN * sizeof(LONG);
+        m_ofst_tab = (LONG*)::malloc(m_ofst_tab_byte_size);
+        ::memset((void*)m_ofst_tab, 0, m_ofst_tab_byte_size);
+    }
+    if (OFST_TAB_LINE_SIZE < (m_src_line_num + 10)) {
+        //The lexer may start scanning from any line, see initAt().
+        LONG byte_size = (LONG)((m_src_line_num + 10 + LEX_MAX_OFST_BUF_LEN) *
+                                sizeof(LONG));
+        m_ofst_tab = (LONG*)::realloc(m_ofst_tab, byte_size);
+        ::memset((void*)(((BYTE*)m_ofst_tab) + m_ofst_tab_byte_size),
+                 0, byte_size - m_ofst_tab_byte_size);
+        m_ofst_tab_byte_size = byte_size;
+    }
+}
+
+
+//The function read one line (end by '\n') from the whole src file content
+//in 'm_src_buf'. Different from getLine(), the line is not copied, and
+//'m_cur_line' refers to the line inside 'm_src_buf' directly.
+//The line-end recognition is the same as getLine().
+//Return status which will be ST_SUCC or ST_EOF.
+INT Lexer::getLineFromSrcBuf()
+{
+    growOfstTab();
+    CHAR const* start = m_src_buf + m_cur_src_ofst;
+    CHAR const* end = m_src_buf + m_src_buf_len;
+    CHAR const* p = start;
+    m_cur_line = start;
+    m_cur_line_ofst = m_cur_src_ofst;
+    m_cur_line_pos = 0;
+    for (; (p = LEX_SCAN_find_line_end(&m_scan)(p, end)) < end; p++) {
+        if (*p == 0xd) {
+            if (p + 1 < end && p[1] == 0xa) {
+                //DOS line-end characters.
+                m_is_dos = true;
+                p += 2;
+                m_src_line_num++;
+                goto FIN;
+            }
+            if (m_is_dos) {
+                //Single 0xD under DOS text format also terminates the line.
+                p++;
+                goto FIN;
+            }
+            continue;
+        }
+        //unix text format
+        ASSERT0(*p == 0xa);
+        m_is_dos = false;
+        p++;
+        m_src_line_num++;
+        goto FIN;
+    }
+    if (p == start) {
+        //There is nothing more can be read from source file.
+        m_src_line_num++;
+        m_cur_line_num = 0;
+        return ST_EOF;
+    }
+FIN:
+    m_cur_src_ofst = (UINT)(p - m_src_buf);
+    ASSERT0((m_src_line_num + 1) < OFST_TAB_LINE_SIZE);
+    m_ofst_tab[m_src_line_num + 1] = m_cur_src_ofst;
+    {
+        //Keep consistent with getLine() that regards the line as
+        //terminated by the first '\0'.
+        CHAR const* zero = (CHAR const*)::memchr(start, 0, p - start);
+        m_cur_line_num = (INT)((zero != nullptr ? zero : p) - start);
+    }
+    return ST_SUCC;
+}
+
 
 //The function read one line (end by '\n') from source code buffer.
 //Return status which will be ST_SUCC or ST_ERR.
-static INT getLine()
+INT Lexer::getLine()
 {
-    //Initialize or realloc offset table.
-    if (g_ofst_tab == nullptr) {
-        g_ofst_tab_byte_size = LEX_MAX_OFST_BUF_LEN * sizeof(LONG);
-        g_ofst_tab = (LONG*)::malloc(g_ofst_tab_byte_size);
-        ::memset((void*)g_ofst_tab, 0, g_ofst_tab_byte_size);
-    } else if (OFST_TAB_LINE_SIZE < (g_src_line_num + 10)) {
-        g_ofst_tab = (LONG*)::realloc(g_ofst_tab, g_ofst_tab_byte_size +
-                                      LEX_MAX_OFST_BUF_LEN * sizeof(LONG));
-        ::memset((void*)(((BYTE*)g_ofst_tab) + g_ofst_tab_byte_size),
-                 0, LEX_MAX_OFST_BUF_LEN * sizeof(LONG));
-        g_ofst_tab_byte_size += LEX_MAX_OFST_BUF_LEN * sizeof(LONG);
+    if (m_src_buf != nullptr) {
+        return getLineFromSrcBuf();
     }
+    growOfstTab();
     UINT pos = 0;
     bool has_some_chars_in_cur_line = false;
+    m_cur_line_ofst = m_cur_src_ofst;
     for (;;) {
-        if (g_cur_line == nullptr) {
-            g_cur_line_len = LEX_MAX_BUF_LINE;
-            g_cur_line = (CHAR*)::malloc(g_cur_line_len);
-            if (g_cur_line == nullptr) {
+        if (m_line_buf == nullptr) {
+            m_cur_line_len = LEX_MAX_BUF_LINE;
+            m_line_buf = (CHAR*)::malloc(m_cur_line_len);
+            if (m_line_buf == nullptr) {
                 goto FAILED;
             }
+            m_cur_line = m_line_buf;
         }
 
         //Read the most LEX_MAX_BUF_LINE characters from source file.
-        if (g_file_buf_pos >= g_last_read_num) {
-            ASSERT0(g_hsrc);
-            INT dw = (INT)::fread(g_file_buf, 1, LEX_MAX_BUF_LINE, g_hsrc);
+        if (m_file_buf_pos >= m_last_read_num) {
+            ASSERT0(m_hsrc);
+            INT dw = (INT)::fread(m_file_buf, 1, LEX_MAX_BUF_LINE, m_hsrc);
             if (dw == 0) {
                 if (!has_some_chars_in_cur_line) {
-                    //Some characters had been put into 'g_cur_line', but the
-                    //last character of 'g_file_buf' is not '0xD,0xA'. Thus we
+                    //Some characters had been put into 'm_cur_line', but the
+                    //last character of 'm_file_buf' is not '0xD,0xA'. Thus we
                     //should keep reading characters till the last character in
-                    //'g_file_buf. But there is nothing more can be
+                    //'m_file_buf. But there is nothing more can be
                     //read from source file until the last file read, so 'dw'
                     //is zero.
                     //This situation may take place when we are meeting the
                     //file that is terminated without a '0xD,0xA'.
                     //TODO:Considering the case, we should not return
                     //'FEOF' directly , instead we should process the last
-                    //characters in 'g_cur_line' correctly.
+                    //characters in 'm_cur_line' correctly.
                     goto FEOF;
                 }
                 goto FIN;
             }
-            g_last_read_num = dw;
-            g_last_read_num = MIN(g_last_read_num, LEX_MAX_BUF_LINE);
-            g_file_buf_pos = 0;
+            m_last_read_num = dw;
+            m_last_read_num = MIN(m_last_read_num, LEX_MAX_BUF_LINE);
+            m_file_buf_pos = 0;
         }
         //Get one line characters from buffer which end up with '0xD,0xA'
         //under DOS or '0xA' under Linux.
         bool is_0xd_recog = false;
-        while (g_file_buf_pos < g_last_read_num) {
-            if (g_file_buf[g_file_buf_pos] == 0xd &&
+        while (m_file_buf_pos < m_last_read_num) {
+            if (m_file_buf[m_file_buf_pos] == 0xd &&
                 //DOS line-end characters.
-                g_file_buf[g_file_buf_pos + 1] == 0xa) {
-                g_is_dos = true;
-                if (g_use_newline_char) {
-                    g_cur_line[pos] = g_file_buf[g_file_buf_pos];
+                m_file_buf[m_file_buf_pos + 1] == 0xa) {
+                m_is_dos = true;
+                if (m_use_newline_char) {
+                    m_line_buf[pos] = m_file_buf[m_file_buf_pos];
                     pos++;
-                    g_file_buf_pos++;
-                    g_cur_line[pos] = g_file_buf[g_file_buf_pos];
+                    m_file_buf_pos++;
+                    m_line_buf[pos] = m_file_buf[m_file_buf_pos];
                     pos++;
-                    g_file_buf_pos++;
+                    m_file_buf_pos++;
                 } else {
-                    g_file_buf_pos += 2;
+                    m_file_buf_pos += 2;
                 }
-                g_cur_src_ofst += 2;
-                g_src_line_num++;
+                m_cur_src_ofst += 2;
+                m_src_line_num++;
                 goto FIN;
             }
-            if (g_file_buf[g_file_buf_pos] == 0xa) { //unix text format
+            if (m_file_buf[m_file_buf_pos] == 0xa) { //unix text format
                 if (is_0xd_recog) {
                     //We have met '0xD', the '0xA' is one of
                     //the terminate string '0xD,0xA' under DOS text format.
-                    if (g_use_newline_char) {
-                        g_cur_line[pos] = g_file_buf[g_file_buf_pos];
+                    if (m_use_newline_char) {
+                        m_line_buf[pos] = m_file_buf[m_file_buf_pos];
                         pos++;
-                        g_file_buf_pos++;
+                        m_file_buf_pos++;
                     } else {
-                        g_file_buf_pos++; //omit the terminate charactor '0xa'
+                        m_file_buf_pos++; //omit the terminate charactor '0xa'
                     }
                     is_0xd_recog = false;
                 } else {
-                    g_is_dos = false;
-                    if (g_use_newline_char) {
-                        g_cur_line[pos] = g_file_buf[g_file_buf_pos];
+                    m_is_dos = false;
+                    if (m_use_newline_char) {
+                        m_line_buf[pos] = m_file_buf[m_file_buf_pos];
                         pos++;
-                        g_file_buf_pos++;
+                        m_file_buf_pos++;
                     } else {
-                        g_file_buf_pos ++;
+                        m_file_buf_pos ++;
                     }
                 }
-                g_cur_src_ofst++;
-                g_src_line_num++;
+                m_cur_src_ofst++;
+                m_src_line_num++;
                 goto FIN;
             }
-            if (g_file_buf[g_file_buf_pos] == 0xd && g_is_dos) {
-                //0xD is the last charactor in 'g_file_buf', thus 0xA
+            if (m_file_buf[m_file_buf_pos] == 0xd && m_is_dos) {
+                //0xD is the last charactor in 'm_file_buf', thus 0xA
                 //should be recognized in getNextToken() in order to guarantee
                 //the lex token parsing correctly, or else some exceptions
                 //occurred in text file.
                 is_0xd_recog = true;
-                if (g_use_newline_char) {
-                    g_cur_line[pos] = g_file_buf[g_file_buf_pos];
+                if (m_use_newline_char) {
+                    m_line_buf[pos] = m_file_buf[m_file_buf_pos];
                     pos++;
-                    g_file_buf_pos++;
+                    m_file_buf_pos++;
                 } else {
-                    g_file_buf_pos++;
+                    m_file_buf_pos++;
                 }
-                g_cur_src_ofst++;
+                m_cur_src_ofst++;
                 goto FIN;
             }
-            if (pos >= g_cur_line_len) {
+            if (pos >= m_cur_line_len) {
                 //Escalate the line buffer.
-                g_cur_line_len += LEX_MAX_BUF_LINE;
-                g_cur_line = (CHAR*)::realloc(g_cur_line, g_cur_line_len);
+                m_cur_line_len += LEX_MAX_BUF_LINE;
+                m_line_buf = (CHAR*)::realloc(m_line_buf, m_cur_line_len);
+                m_cur_line = m_line_buf;
             }
-            g_cur_line[pos] = g_file_buf[g_file_buf_pos];
+            m_line_buf[pos] = m_file_buf[m_file_buf_pos];
             pos++;
-            g_file_buf_pos++;
+            m_file_buf_pos++;
             has_some_chars_in_cur_line = true;
-            g_cur_src_ofst++;
+            m_cur_src_ofst++;
         }
     }
 FIN:
-    ASSERT0((g_src_line_num + 1) < OFST_TAB_LINE_SIZE);
-    g_ofst_tab[g_src_line_num + 1] = g_cur_src_ofst;
-    g_cur_line[pos] = 0;
-    g_cur_line_num = (INT)strlen(g_cur_line);
-    g_cur_line_pos = 0;
+    ASSERT0((m_src_line_num + 1) < OFST_TAB_LINE_SIZE);
+    m_ofst_tab[m_src_line_num + 1] = m_cur_src_ofst;
+    m_line_buf[pos] = 0;
+    m_cur_line_num = (INT)strlen(m_line_buf);
+    m_cur_line_pos = 0;
     return ST_SUCC;
 FAILED:
     return ST_ERR;
 FEOF:
-    g_src_line_num++;
-    g_cur_line[pos] = 0;
-    g_cur_line_num = 0;
-    g_cur_line_pos = 0;
+    m_src_line_num++;
+    m_line_buf[pos] = 0;
+    m_cur_line_num = 0;
+    m_cur_line_pos = 0;
     return ST_EOF;
 }
 
 
-class String2Token : public HMap<CHAR const*, TOKEN, HashFuncString2> {
+//Collision-free hash table of keywords. Each slot records the index to
+//'g_keyword_info', the length, the first and the last character of keyword,
+//which are also the input of hash function.
+//NOTE: the table must be regenerated by com/perfect_hash.cpp whenever
+//'g_keyword_info' is modified:
+//  >sed -n '/g_keyword_info\[\] = {/,/^};/p' cfe/lex.cpp | ./perfect_hash
+#define PERFECT_HASH_EMPTY 0xFF
+class PerfectHashEntry {
 public:
-    String2Token(UINT bsize) : HMap<CHAR const*, TOKEN, HashFuncString2>(bsize)
-    {}
-    virtual ~String2Token() {}
+    BYTE idx;
+    BYTE len;
+    BYTE first;
+    BYTE last;
+};
+
+//Generated by com/perfect_hash.cpp, do not edit.
+#define PERFECT_HASH_MUL_LEN 37
+#define PERFECT_HASH_MUL_FIRST 1
+#define PERFECT_HASH_MUL_LAST 1
+#define PERFECT_HASH_TAB_SIZE 128
+static PerfectHashEntry const g_perfect_hash_tab[PERFECT_HASH_TAB_SIZE] = {
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { 8, 8, 'u', 'd' },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { 34, 8, 'v', 'e' },
+    { 12, 5, 'f', 'e' },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { 18, 5, 'b', 'k' },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { 28, 8, 'r', 'r' },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { 35, 8, 'r', 't' },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { 33, 5, 'c', 't' },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { 5, 5, 'f', 't' },
+    { 40, 2, 92, 'n' },
+    { 22, 5, 'w', 'e' },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { 15, 2, 'i', 'f' },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { 14, 5, 'u', 'n' },
+    { 21, 2, 'd', 'o' },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { 2, 5, 's', 't' },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { 6, 6, 'd', 'e' },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { 30, 6, 'i', 'e' },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { 39, 6, 'p', 'a' },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { 29, 6, 'e', 'n' },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { 31, 6, 's', 'c' },
+    { 7, 6, 's', 'd' },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { 36, 6, 's', 'f' },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { 23, 6, 's', 'h' },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { 19, 6, 'r', 'n' },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { 13, 6, 's', 't' },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { 26, 3, 'f', 'r' },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { 3, 3, 'i', 't' },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { 25, 7, 'd', 't' },
+    { 24, 4, 'c', 'e' },
+    { 32, 7, 't', 'f' },
+    { 16, 4, 'e', 'e' },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { 10, 4, 'b', 'l' },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { 27, 4, 'a', 'o' },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { 37, 4, 'e', 'm' },
+    { 4, 4, 'l', 'g' },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { 1, 4, 'c', 'r' },
+    { 17, 4, 'g', 'o' },
+    { 38, 1, '#', '#' },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { 11, 4, 't', 'e' },
+    { 0, 4, 'v', 'd' },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { 20, 8, 'c', 'e' },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { 9, 8, 'l', 'g' },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
+    { PERFECT_HASH_EMPTY, 0, 0, 0 },
 };
 
-String2Token g_str2token(0);
 
-//This is the first function you should invoke before start lex scanning.
+static inline UINT computeKeyWordHash(UINT len, BYTE first, BYTE last)
+{
+    return (len * PERFECT_HASH_MUL_LEN + first * PERFECT_HASH_MUL_FIRST +
+            last * PERFECT_HASH_MUL_LAST) & (PERFECT_HASH_TAB_SIZE - 1);
+}
+
+
+//Return the keyword token of string 's' which length is 'len', or T_UNDEF
+//if 's' is not keyword.
+static inline TOKEN getKeyWord(CHAR const* s, UINT len)
+{
+    if (len == 0 || len > 255) { return T_UNDEF; }
+    BYTE first = (BYTE)s[0];
+    BYTE last = (BYTE)s[len - 1];
+    PerfectHashEntry const* e =
+        &g_perfect_hash_tab[computeKeyWordHash(len, first, last)];
+    if (e->idx == PERFECT_HASH_EMPTY || e->len != len || e->first != first ||
+        e->last != last) {
+        return T_UNDEF;
+    }
+    KeywordInfo const* ki = &g_keyword_info[e->idx];
+    if (::memcmp(KEYWORD_INFO_name(ki), s, len) != 0) {
+        return T_UNDEF;
+    }
+    return KEYWORD_INFO_token(ki);
+}
+
+
+//Check the generated table is consistent with 'g_keyword_info'.
 static void initKeyWordTab()
 {
-    g_str2token.init(64); //Must be power of 2 since we use HashFuncString2.
+    ASSERTN(g_keyword_num < PERFECT_HASH_EMPTY, ("too many keywords"));
+    #ifdef _DEBUG_
+    UINT num = 0;
+    for (UINT i = 0; i < PERFECT_HASH_TAB_SIZE; i++) {
+        if (g_perfect_hash_tab[i].idx != PERFECT_HASH_EMPTY) { num++; }
+    }
+    ASSERTN(num == g_keyword_num, ("keyword hash table is out of date"));
     for (UINT i = 0; i < g_keyword_num; i++) {
-        g_str2token.set(KEYWORD_INFO_name(&g_keyword_info[i]),
-                        KEYWORD_INFO_token(&g_keyword_info[i]));
+        CHAR const* name = KEYWORD_INFO_name(&g_keyword_info[i]);
+        ASSERTN(getKeyWord(name, (UINT)::strlen(name)) ==
+                KEYWORD_INFO_token(&g_keyword_info[i]),
+                ("keyword hash table is out of date"));
     }
+    #endif
 }
 
 
-static void finiKeyWordTab()
+static void initPuncTokenTab()
 {
-    g_str2token.destroy(); //Must be power of 2 since we use HashFuncString2.
+    static KeywordInfo const punc[] = {
+        { T_AT,         "@" },
+        { T_SEMI,       ";" },
+        { T_COMMA,      "," },
+        { T_LLPAREN,    "{" },
+        { T_RLPAREN,    "}" },
+        { T_LSPAREN,    "[" },
+        { T_RSPAREN,    "]" },
+        { T_LPAREN,     "(" },
+        { T_RPAREN,     ")" },
+        { T_REV,        "~" },
+        { T_QUES_MARK,  "?" },
+        { T_SHARP,      "#" },
+    };
+    for (UINT i = 0; i < sizeof(g_punc_token) / sizeof(g_punc_token[0]);
+         i++) {
+        g_punc_token[i] = T_UNDEF;
+    }
+    for (UINT i = 0; i < sizeof(punc) / sizeof(punc[0]); i++) {
+        g_punc_token[(BYTE)KEYWORD_INFO_name(&punc[i])[0]] =
+            KEYWORD_INFO_token(&punc[i]);
+    }
+}
+
+
+//Map or read the whole src file into 'm_src_buf'.
+//The file will be mapped if it is a regular file, otherwise, e.g: pipe or
+//character device, the content will be read until EOF.
+bool Lexer::initSrcBuf()
+{
+    ASSERT0(m_hsrc && m_src_buf == nullptr);
+    #ifndef _ON_WINDOWS_
+    INT fd = ::fileno(m_hsrc);
+    struct stat st;
+    if (::fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        void * p = ::mmap(nullptr, (size_t)st.st_size, PROT_READ,
+                          MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED) {
+            //Lexer always scans the file from head to tail.
+            ::madvise(p, (size_t)st.st_size, MADV_SEQUENTIAL);
+            m_src_buf = (CHAR const*)p;
+            m_src_buf_len = (size_t)st.st_size;
+            m_src_buf_is_mapped = true;
+            return true;
+        }
+    }
+    #endif
+    size_t cap = LEX_MAX_BUF_LINE;
+    size_t len = 0;
+    CHAR * buf = (CHAR*)::malloc(cap);
+    if (buf == nullptr) { return false; }
+    for (;;) {
+        if (len == cap) {
+            cap *= 2;
+            CHAR * newbuf = (CHAR*)::realloc(buf, cap);
+            if (newbuf == nullptr) {
+                ::free(buf);
+                return false;
+            }
+            buf = newbuf;
+        }
+        size_t n = ::fread(buf + len, 1, cap - len, m_hsrc);
+        if (n == 0) { break; }
+        len += n;
+    }
+    m_src_buf = buf;
+    m_src_buf_len = len;
+    m_src_buf_is_mapped = false;
+    return true;
+}
+
+
+void Lexer::finiSrcBuf()
+{
+    if (m_src_buf == nullptr) { return; }
+    #ifndef _ON_WINDOWS_
+    if (m_src_buf_is_borrowed) {
+        //The buffer is released by its owner.
+    } else if (m_src_buf_is_mapped) {
+        ::munmap((void*)m_src_buf, m_src_buf_len);
+    } else {
+        ::free((void*)m_src_buf);
+    }
+    #else
+    if (!m_src_buf_is_borrowed) {
+        ::free((void*)m_src_buf);
+    }
+    #endif
+    m_src_buf = nullptr;
+    m_src_buf_len = 0;
+    m_src_buf_is_mapped = false;
+    m_src_buf_is_borrowed = false;
 }
 
 
-void initLexer()
+//Initialize the read-only tables that shared by all lexers.
+static bool initLexerTab()
 {
-    g_cur_token_string_pos = 0;
-    g_cur_char = 0;
-    g_is_dos = true;
-    g_cur_line_pos = 0;
-    g_cur_line_num = 0;
-    g_file_buf[0] = 0;
-    g_last_read_num = 0;
-    g_cur_src_ofst = 0; //record current file offset of src file
-    g_src_line_num = 0; //record line number of src file
-    g_cur_token = T_UNDEF;
-    g_real_line_num = 0;
-    g_disgarded_line_num = 0;
-    ASSERT0(g_cur_line == nullptr && g_cur_line_len == 0);
-    ASSERT0(g_ofst_tab == nullptr && g_ofst_tab_byte_size == 0);
-    ASSERTN(g_hsrc, ("src file handler not initialized"));
     initKeyWordTab();
+    initPuncTokenTab();
+    return true;
+}
+
+
+Lexer::Lexer()
+{
+    m_hsrc = nullptr;
+    m_cur_token = T_UNDEF;
+    m_src_line_num = 0;
+    m_real_line_num = 0;
+    m_disgarded_line_num = 0;
+    m_enable_newline_token = false;
+    m_cur_token_string[0] = 0;
+    m_cur_token_text = m_cur_token_string;
+    m_cur_token_string_pos = 0;
+    m_cur_token_hash = 0;
+    m_cur_char = 0;
+    m_is_dos = true;
+    m_use_newline_char = true;
+    m_src_buf_is_mapped = false;
+    m_cur_line_pos = 0;
+    m_cur_line_num = 0;
+    m_file_buf_pos = LEX_MAX_BUF_LINE;
+    m_last_read_num = 0;
+    m_cur_src_ofst = 0;
+    m_cur_line_ofst = 0;
+    m_cur_line_len = 0;
+    m_cur_line = nullptr;
+    m_line_buf = nullptr;
+    m_ofst_tab = nullptr;
+    m_ofst_tab_byte_size = 0;
+    m_src_buf = nullptr;
+    m_src_buf_len = 0;
+    m_src_buf_is_borrowed = false;
+    m_stop_ofst = (UINT)-1;
+    m_cur_token_view.ofst = 0;
+    m_cur_token_view.len = 0;
+    initLexScanKernel(LEX_SCAN_SCALAR, &m_scan);
 }
 
 
-void finiLexer()
+void Lexer::init()
 {
-    if (g_ofst_tab != nullptr) {
-        ::free(g_ofst_tab);
-        g_ofst_tab = nullptr;
-        g_ofst_tab_byte_size = 0;
+    //The tables are initialized only once even if there are several
+    //lexers working in different threads.
+    static bool s_is_tab_init = initLexerTab();
+    DUMMYUSE(s_is_tab_init);
+
+    m_cur_token_text = m_cur_token_string;
+    m_cur_token_string_pos = 0;
+    m_cur_char = 0;
+    m_is_dos = true;
+    m_cur_line_pos = 0;
+    m_cur_line_num = 0;
+    m_file_buf[0] = 0;
+    m_file_buf_pos = LEX_MAX_BUF_LINE;
+    m_last_read_num = 0;
+    m_cur_src_ofst = 0; //record current file offset of src file
+    m_src_line_num = 0; //record line number of src file
+    m_cur_token = T_UNDEF;
+    m_real_line_num = 0;
+    m_disgarded_line_num = 0;
+    m_cur_line_ofst = 0;
+    m_stop_ofst = (UINT)-1;
+    m_cur_token_view.ofst = 0;
+    m_cur_token_view.len = 0;
+    ASSERT0(m_cur_line == nullptr && m_cur_line_len == 0);
+    ASSERT0(m_ofst_tab == nullptr && m_ofst_tab_byte_size == 0);
+    ASSERTN(m_hsrc, ("src file handler not initialized"));
+
+    //Lazy parsing scans the function body again from the content in
+    //memory.
+    if ((g_enable_map_src_file || g_enable_lazy_fun_body) &&
+        !initSrcBuf()) {
+        //Keep reading src file chunk by chunk.
+        m_src_buf = nullptr;
     }
-    if (g_cur_line != nullptr) {
-        ::free(g_cur_line);
-        g_cur_line = nullptr;
-        g_cur_line_len = 0;
+    initLexScanKernel(g_lex_scan_kind, &m_scan);
+}
+
+
+void Lexer::destroy()
+{
+    if (m_ofst_tab != nullptr) {
+        ::free(m_ofst_tab);
+        m_ofst_tab = nullptr;
+        m_ofst_tab_byte_size = 0;
     }
-    finiKeyWordTab();
+    if (m_line_buf != nullptr) {
+        ::free(m_line_buf);
+        m_line_buf = nullptr;
+        m_cur_line_len = 0;
+    }
+    m_cur_line = nullptr;
+    finiSrcBuf();
+}
+
+
+void Lexer::initAt(Lexer const& src, LexPos const& pos, UINT stop_ofst)
+{
+    ASSERTN(src.m_src_buf, ("content of src file is not in memory"));
+    ASSERT0(m_src_buf == nullptr && m_cur_line == nullptr);
+    ASSERT0(LEX_POS_tok_ofst(&pos) >= LEX_POS_line_ofst(&pos) &&
+            LEX_POS_tok_ofst(&pos) < stop_ofst);
+    m_src_buf = src.m_src_buf;
+    m_src_buf_len = src.m_src_buf_len;
+    m_src_buf_is_borrowed = true;
+    m_stop_ofst = stop_ofst;
+
+    //Restore the state after the line that contains the token has been
+    //read, then the next character is the first one of token.
+    m_is_dos = LEX_POS_is_dos(&pos);
+    m_cur_line = m_src_buf + LEX_POS_line_ofst(&pos);
+    m_cur_line_ofst = LEX_POS_line_ofst(&pos);
+    m_cur_line_num = (INT)LEX_POS_line_len(&pos);
+    m_cur_line_pos = (INT)(LEX_POS_tok_ofst(&pos) - LEX_POS_line_ofst(&pos));
+    m_cur_src_ofst = LEX_POS_next_line_ofst(&pos);
+    m_src_line_num = LEX_POS_src_line_num(&pos);
+    m_cur_char = 0;
+    m_cur_token = T_UNDEF;
+    m_scan = src.m_scan;
+}
+
+
+CHAR const* Lexer::getSrcBuf(OUT size_t * len) const
+{
+    if (len != nullptr) { *len = m_src_buf_len; }
+    return m_src_buf;
 }
 
 
-static TOKEN getKeyWord(CHAR const* s)
+CHAR const* Lexer::getCurTokenString()
 {
-    if (s == nullptr) return T_UNDEF;
-    return g_str2token.get(s);
+    if (m_cur_token_text != m_cur_token_string) {
+        //The text refers to the spelling in 'm_src_buf', copy it only if
+        //the string is really required.
+        ASSERT0(m_cur_token_string_pos < LEX_MAX_BUF_LINE);
+        ::memcpy(m_cur_token_string, m_cur_token_text, m_cur_token_string_pos);
+        m_cur_token_string[m_cur_token_string_pos] = 0;
+        m_cur_token_text = m_cur_token_string;
+    }
+    return m_cur_token_string;
 }
 
 
-UINT getCurTokenStringLen()
+//Return the byte offset of 'm_cur_char' in src file.
+inline UINT Lexer::getCurCharOfst() const
 {
-    //e.g:current token string is "ab\0c", the function return 4.
-    return g_cur_token_string_pos;
+    if (m_cur_line_pos == 0) {
+        //Nothing has been read from current line, e.g: meet EOF.
+        return m_cur_line_ofst;
+    }
+    return m_cur_line_ofst + m_cur_line_pos - 1;
 }
 
 
-//Get a charactor from g_cur_line.
+//Read new line and get the first charactor from it.
 //If it meets the EOF, the return value will be -1.
-static CHAR getNextChar()
+CHAR Lexer::getNextCharFromNewLine()
 {
     CHAR res = '0';
     INT st = 0;
-    if (g_cur_line == nullptr) {
+    if (m_cur_line == nullptr) {
         if ((st = getLine()) == ST_SUCC) {
-            res = g_cur_line[g_cur_line_pos];
-            g_cur_line_pos++;
+            res = m_cur_line[m_cur_line_pos];
+            m_cur_line_pos++;
         } else if(st == ST_EOF) {
             res = ST_EOF;
         }
-    } else if (g_cur_line_pos < g_cur_line_num) {
-        res = g_cur_line[g_cur_line_pos];
-        g_cur_line_pos++;
+    } else if (m_cur_line_pos < m_cur_line_num) {
+        res = m_cur_line[m_cur_line_pos];
+        m_cur_line_pos++;
     } else {
         st = getLine();
         if (st == ST_SUCC) {
             do {
-                res = g_cur_line[g_cur_line_pos];
-                g_cur_line_pos++;
-                if (g_cur_line_num != 0) {
+                res = m_cur_line[m_cur_line_pos];
+                m_cur_line_pos++;
+                if (m_cur_line_num != 0) {
                     break;
                 }
                 st = getLine();
@@ -521,6 +960,46 @@ static CHAR getNextChar()
 }
 
 
+//Get a charactor from m_cur_line.
+//If it meets the EOF, the return value will be -1.
+inline CHAR Lexer::getNextChar()
+{
+    if (m_cur_line != nullptr && m_cur_line_pos < m_cur_line_num) {
+        return m_cur_line[m_cur_line_pos++];
+    }
+    return getNextCharFromNewLine();
+}
+
+
+//Skip the successive spaces and tabs, and update 'm_cur_char' with the
+//next character.
+//'m_cur_char' is a space or tab right now.
+void Lexer::skipSpace()
+{
+    ASSERT0(IS_LEX_CC(m_cur_char, LEX_CC_SPACE) && m_cur_line);
+    CHAR const* start = m_cur_line + m_cur_line_pos;
+    CHAR const* p = LEX_SCAN_skip_space(&m_scan)(
+        start, m_cur_line + m_cur_line_num);
+    m_cur_line_pos += (INT)(p - start);
+    m_cur_char = getNextChar();
+}
+
+
+//Append the characters from current position of line to token string, until
+//meeting the character that 'stop' stops at, or the end of current line.
+void Lexer::copyCharsUntil(LexScanFunc stop)
+{
+    if (m_cur_line == nullptr) { return; }
+    CHAR const* start = m_cur_line + m_cur_line_pos;
+    CHAR const* p = stop(start, m_cur_line + m_cur_line_num);
+    size_t len = p - start;
+    ASSERT0(m_cur_token_string_pos + len < LEX_MAX_BUF_LINE);
+    ::memcpy(&m_cur_token_string[m_cur_token_string_pos], start, len);
+    m_cur_token_string_pos += (INT)len;
+    m_cur_line_pos += (INT)len;
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////
 //YOU SHOULD CONSTRUCT THE FOLLOWING FUNCTION ACCRODING TO YOUR LEXICAL       //
 //TOKEN WORD.                                                                 //
@@ -532,29 +1011,29 @@ static CHAR getNextChar()
 //the suffix if exist is legal.
 //e.g:0x7fffull, 1.1f, etc.
 //t: the latest token that has been parsed by previous functions.
-static TOKEN parse_suffix(TOKEN t)
+TOKEN Lexer::parse_suffix(TOKEN t)
 {
     ASSERT0(t != T_UNDEF);
-    if (xcom::upper(g_cur_char) == 'L') {
+    if (xcom::upper(m_cur_char) == 'L') {
         //e.g: 1000L
         //t is long integer.
         if (t == T_IMM) {
             t = T_IMML;
-            g_cur_char = getNextChar();
-            if (xcom::upper(g_cur_char) == 'L') {
+            m_cur_char = getNextChar();
+            if (xcom::upper(m_cur_char) == 'L') {
                 //e.g: 1000LL
                 t = T_IMMLL;
-                g_cur_char = getNextChar();
-                if (xcom::upper(g_cur_char) == 'U') {
+                m_cur_char = getNextChar();
+                if (xcom::upper(m_cur_char) == 'U') {
                     //e.g: 1000LLU <=> 1000ULL
                     t = T_IMMULL;
-                    g_cur_char = getNextChar();
+                    m_cur_char = getNextChar();
                 }
                 return t;
             }
-            if (xcom::upper(g_cur_char) == 'U') {
+            if (xcom::upper(m_cur_char) == 'U') {
                 //e.g: 1000LU <=> 1000UL
-                g_cur_char = getNextChar();
+                m_cur_char = getNextChar();
                 return T_IMMUL;
             }
             return t;
@@ -562,45 +1041,45 @@ static TOKEN parse_suffix(TOKEN t)
         if (t == T_FP) {
             //e.g: 1.11L
             //If suffixed by the letter L, imm has type with long double.
-            g_cur_char = getNextChar();
+            m_cur_char = getNextChar();
             return T_FPLD;
         }
         return t;
     }
-    if (xcom::upper(g_cur_char) == 'U') {
+    if (xcom::upper(m_cur_char) == 'U') {
         if (t == T_IMM) {
             //e.g: 1000U
             //t is unsigned integer.
             t = T_IMMU;
-            g_cur_char = getNextChar();
-            if (xcom::upper(g_cur_char) == 'L') {
+            m_cur_char = getNextChar();
+            if (xcom::upper(m_cur_char) == 'L') {
                 //e.g: 1000UL
                 t = T_IMMUL;
-                g_cur_char = getNextChar();
-                if (xcom::upper(g_cur_char) == 'L') {
+                m_cur_char = getNextChar();
+                if (xcom::upper(m_cur_char) == 'L') {
                     //e.g: 1000ULL
                     t = T_IMMULL;
-                    g_cur_char = getNextChar();
+                    m_cur_char = getNextChar();
                 }
                 return t;
             }
             return t;
         }
         ASSERT0(t == T_FP);
-        err(g_real_line_num, "invalid suffix \"%c\" on float constant",
-            g_cur_char);
-        g_cur_char = getNextChar();
+        err(m_real_line_num, "invalid suffix \"%c\" on float constant",
+            m_cur_char);
+        m_cur_char = getNextChar();
         return t;
     }
-    if (xcom::upper(g_cur_char) == 'F') {
+    if (xcom::upper(m_cur_char) == 'F') {
         //e.g:1.0F, emphasize that immeidate is float rather than double.
         if (t == T_IMM) {
-            err(g_real_line_num, "invalid suffix \"%c\" on integer constant",
-                g_cur_char);
+            err(m_real_line_num, "invalid suffix \"%c\" on integer constant",
+                m_cur_char);
             return t;
         }
         ASSERT0(t == T_FP);
-        g_cur_char = getNextChar();
+        m_cur_char = getNextChar();
         t = T_FPF;
         return t;
     }
@@ -608,33 +1087,33 @@ static TOKEN parse_suffix(TOKEN t)
 }
 
 
-//'g_cur_char' hold the current charactor right now.
-//You should assign 'g_cur_char' the next valid charactor before
+//'m_cur_char' hold the current charactor right now.
+//You should assign 'm_cur_char' the next valid charactor before
 //the function return.
-static TOKEN t_num()
+TOKEN Lexer::t_num()
 {
     CHAR c = getNextChar();
     CHAR b_is_fp = 0;
     TOKEN t = T_UNDEF;
-    if (g_cur_char == '0' && (xcom::upper(c) == 'X')) {
+    if (m_cur_char == '0' && (xcom::upper(c) == 'X')) {
         //hex
-        g_cur_token_string[g_cur_token_string_pos++] = c;
+        m_cur_token_string[m_cur_token_string_pos++] = c;
         while (xcom::xisdigithex(c = getNextChar())) {
-            g_cur_token_string[g_cur_token_string_pos++] = c;
+            m_cur_token_string[m_cur_token_string_pos++] = c;
         }
-        g_cur_token_string[g_cur_token_string_pos] = 0;
-        g_cur_char = c;
+        m_cur_token_string[m_cur_token_string_pos] = 0;
+        m_cur_char = c;
         t = T_IMM;
         goto SUFFIX;
     }
-    if (g_cur_char == '0' && (xcom::upper(c) == 'B')) {
+    if (m_cur_char == '0' && (xcom::upper(c) == 'B')) {
         //binary
-        g_cur_token_string[g_cur_token_string_pos++] = c;
+        m_cur_token_string[m_cur_token_string_pos++] = c;
         while (xcom::xisdigitbin(c = getNextChar())) {
-            g_cur_token_string[g_cur_token_string_pos++] = c;
+            m_cur_token_string[m_cur_token_string_pos++] = c;
         }
-        g_cur_token_string[g_cur_token_string_pos] = 0;
-        g_cur_char = c;
+        m_cur_token_string[m_cur_token_string_pos] = 0;
+        m_cur_char = c;
         t = T_IMM;
         goto SUFFIX;
     }
@@ -644,10 +1123,10 @@ static TOKEN t_num()
         if (c == '.') {
             b_is_fp = 1;
         }
-        g_cur_token_string[g_cur_token_string_pos++] = c;
+        m_cur_token_string[m_cur_token_string_pos++] = c;
         if (b_is_fp) { //there is already present '.'
            while (xcom::xisdigit(c = getNextChar())) {
-               g_cur_token_string[g_cur_token_string_pos++] = c;
+               m_cur_token_string[m_cur_token_string_pos++] = c;
            }
         } else {
             while (xcom::xisdigit(c = getNextChar()) || c == '.') {
@@ -658,16 +1137,16 @@ static TOKEN t_num()
                        break;
                    }
                }
-               g_cur_token_string[g_cur_token_string_pos++] = c;
+               m_cur_token_string[m_cur_token_string_pos++] = c;
            }
         }
-        g_cur_token_string[g_cur_token_string_pos] = 0;
-        g_cur_char = c;
+        m_cur_token_string[m_cur_token_string_pos] = 0;
+        m_cur_char = c;
         if (b_is_fp) { t = T_FP; }
         else { t = T_IMM; }
     } else {
-        g_cur_token_string[g_cur_token_string_pos] = 0;
-        g_cur_char = c;
+        m_cur_token_string[m_cur_token_string_pos] = 0;
+        m_cur_char = c;
         t = T_IMM; //t is '0','1','2','3','4','5','6','7','8','9'
     }
 SUFFIX:
@@ -677,7 +1156,7 @@ SUFFIX:
 
 //User input is: \X...
 //e.g:'\X','\A-\F','\xdd','\aabb'
-static bool try_handle_escape_hex_digit(MOD CHAR & c)
+bool Lexer::try_handle_escape_hex_digit(MOD CHAR & c)
 {
     ASSERT0(xcom::upper(c) == 'X' || xcom::xisdigithex_alpha(c));
     //Finally, the escape \ddd consists of the backslash followed
@@ -693,13 +1172,13 @@ static bool try_handle_escape_hex_digit(MOD CHAR & c)
     }
     UINT n = 0;
     while (xcom::xisdigithex(c)) {
-        g_cur_token_string[g_cur_token_string_pos] = c;
-        g_cur_token_string_pos++;
+        m_cur_token_string[m_cur_token_string_pos] = c;
+        m_cur_token_string_pos++;
         n++;
         c = getNextChar();
     }
     if (n > HEX_LITERAL_LEN_IN_STRING && only_allow_two_hex) {
-        err(g_real_line_num,
+        err(m_real_line_num,
             "constant literal is too large, only permit two hex digits");
     }
     return true;
@@ -708,7 +1187,7 @@ static bool try_handle_escape_hex_digit(MOD CHAR & c)
 
 //User input is: \[0-9]...
 //c: a character which belongs to the range of [0-9].
-static bool try_handle_escape_digit(MOD CHAR & c)
+bool Lexer::try_handle_escape_digit(MOD CHAR & c)
 {
     ASSERT0(xcom::xisdigit(c));
     //Finally, the escape \ddd consists of the backslash followed
@@ -719,67 +1198,67 @@ static bool try_handle_escape_digit(MOD CHAR & c)
     //which are taken to specify the desired character.
     UINT n = 0;
     while (xcom::xisdigithex_octal(c) && n < OCTAL_LITERAL_LEN_IN_STRING) {
-        g_cur_token_string[g_cur_token_string_pos] = c;
-        g_cur_token_string_pos++;
+        m_cur_token_string[m_cur_token_string_pos] = c;
+        m_cur_token_string_pos++;
         c = getNextChar();
         n++;
     }
-    g_cur_token_string[g_cur_token_string_pos] = 0;
-    g_cur_token_string_pos -= n;
+    m_cur_token_string[m_cur_token_string_pos] = 0;
+    m_cur_token_string_pos -= n;
 
     //longlong type truncated to char type. e.g:0x1f5 trunated to 0xf5.
     CHAR o = (CHAR)xcom::xatoll(
-        &g_cur_token_string[g_cur_token_string_pos], true);
-    g_cur_token_string[g_cur_token_string_pos] = o;
-    g_cur_token_string_pos++;
+        &m_cur_token_string[m_cur_token_string_pos], true);
+    m_cur_token_string[m_cur_token_string_pos] = o;
+    m_cur_token_string_pos++;
     return true;
 }
 
 
 //c is escape char.
-static bool try_handle_escape_char(MOD CHAR & c)
+bool Lexer::try_handle_escape_char(MOD CHAR & c)
 {
     ASSERT0(c == '\\');
     c = getNextChar();
     switch (c) {
     case 'n':
         //newline, 0xa
-        g_cur_token_string[g_cur_token_string_pos++] = '\n';
+        m_cur_token_string[m_cur_token_string_pos++] = '\n';
         c = getNextChar();
         return true;
     case 't':
         //horizontal tab
-        g_cur_token_string[g_cur_token_string_pos++] = '\t';
+        m_cur_token_string[m_cur_token_string_pos++] = '\t';
         c = getNextChar();
         return true;
     case 'b':
         //backspace
-        g_cur_token_string[g_cur_token_string_pos++] = '\b';
+        m_cur_token_string[m_cur_token_string_pos++] = '\b';
         c = getNextChar();
         return true;
     case 'r':
         //carriage return, 0xd
-        g_cur_token_string[g_cur_token_string_pos++] = '\r';
+        m_cur_token_string[m_cur_token_string_pos++] = '\r';
         c = getNextChar();
         return true;
     case 'f':
         //form feed
-        g_cur_token_string[g_cur_token_string_pos++] = '\f';
+        m_cur_token_string[m_cur_token_string_pos++] = '\f';
         c = getNextChar();
         return true;
     case '\\':
         //backslash
-        g_cur_token_string[g_cur_token_string_pos++] = '\\';
+        m_cur_token_string[m_cur_token_string_pos++] = '\\';
         c = getNextChar();
         return true;
     case '\'':
         //single quote
-        g_cur_token_string[g_cur_token_string_pos++] = '\'';
+        m_cur_token_string[m_cur_token_string_pos++] = '\'';
         c = getNextChar();
         return true;
     case '"':
         //double quote
-        g_cur_token_string[g_cur_token_string_pos++] = '"';
+        m_cur_token_string[m_cur_token_string_pos++] = '"';
         c = getNextChar();
         return true;
     default:
@@ -790,37 +1269,38 @@ static bool try_handle_escape_char(MOD CHAR & c)
             return try_handle_escape_hex_digit(c);
         }
     }
-    g_cur_token_string[g_cur_token_string_pos++] = '\\';
-    g_cur_token_string[g_cur_token_string_pos++] = c;
+    m_cur_token_string[m_cur_token_string_pos++] = '\\';
+    m_cur_token_string[m_cur_token_string_pos++] = c;
     c = getNextChar();
     return false; //The parameter is not an escape char.
 }
 
 
-//'g_cur_char' hold the current charactor right now.
-//You should assign 'g_cur_char' the next valid charactor before
+//'m_cur_char' hold the current charactor right now.
+//You should assign 'm_cur_char' the next valid charactor before
 //the function return.
-static TOKEN t_string()
+TOKEN Lexer::t_string()
 {
-    ASSERT0(g_cur_char == '"');
+    ASSERT0(m_cur_char == '"');
     CHAR c = getNextChar();
     while (c != '"') {
         if (c == '\\' && try_handle_escape_char(c)) {
             continue;
         }
-        g_cur_token_string[g_cur_token_string_pos++] = c;
+        m_cur_token_string[m_cur_token_string_pos++] = c;
+        copyCharsUntil(LEX_SCAN_find_string_stop(&m_scan));
         c = getNextChar();
     }
-    g_cur_char = getNextChar();
-    g_cur_token_string[g_cur_token_string_pos] = 0;
+    m_cur_char = getNextChar();
+    m_cur_token_string[m_cur_token_string_pos] = 0;
     return T_STRING;
 }
 
 
-//'g_cur_char' hold the current charactor right now.
-//You should assign 'g_cur_char' the next valid charactor before
+//'m_cur_char' hold the current charactor right now.
+//You should assign 'm_cur_char' the next valid charactor before
 //the function return.
-static TOKEN t_char_list()
+TOKEN Lexer::t_char_list()
 {
     CHAR c = getNextChar();
     while (c != '\'') {
@@ -829,43 +1309,43 @@ static TOKEN t_char_list()
             c = getNextChar();
             if (c == 'n' ) {
                 //newline, 0xa
-                g_cur_token_string[g_cur_token_string_pos++] = '\n';
+                m_cur_token_string[m_cur_token_string_pos++] = '\n';
                 c = getNextChar();
                 continue;
             }
             if (c == 't') {
                 //horizontal tab
-                g_cur_token_string[g_cur_token_string_pos++] = '\t';
+                m_cur_token_string[m_cur_token_string_pos++] = '\t';
                 c = getNextChar();
                 continue;
             }
             if (c == 'b') {
                 //backspace
-                g_cur_token_string[g_cur_token_string_pos++] = '\b';
+                m_cur_token_string[m_cur_token_string_pos++] = '\b';
                 c = getNextChar();
                 continue;
             }
             if (c == 'r') {
                 //carriage return, 0xd
-                g_cur_token_string[g_cur_token_string_pos++] = '\r';
+                m_cur_token_string[m_cur_token_string_pos++] = '\r';
                 c = getNextChar();
                 continue;
             }
             if (c == 'f') {
                 //form feed
-                g_cur_token_string[g_cur_token_string_pos++] = '\f';
+                m_cur_token_string[m_cur_token_string_pos++] = '\f';
                 c = getNextChar();
                 continue;
             }
             if (c == '\\') {
                 //backslash
-                g_cur_token_string[g_cur_token_string_pos++] = '\\';
+                m_cur_token_string[m_cur_token_string_pos++] = '\\';
                 c = getNextChar();
                 continue;
             }
             if (c == '\'') {
                 //single quote
-                g_cur_token_string[g_cur_token_string_pos++] = '\'';
+                m_cur_token_string[m_cur_token_string_pos++] = '\'';
                 c = getNextChar();
                 continue;
             }
@@ -878,17 +1358,17 @@ static TOKEN t_char_list()
                 //which are taken to specify the desired character.
                 UINT n = 0;
                 while ((c >= '0' && c <= '7') && n < 3) {
-                    g_cur_token_string[g_cur_token_string_pos++] = c;
+                    m_cur_token_string[m_cur_token_string_pos++] = c;
                     n++;
                     c = getNextChar();
                 }
-                g_cur_token_string[g_cur_token_string_pos] = 0;
-                g_cur_token_string_pos -= n;
+                m_cur_token_string[m_cur_token_string_pos] = 0;
+                m_cur_token_string_pos -= n;
 
                 //long type truncated to char type.
-                CHAR o = (CHAR)xatoll(&g_cur_token_string[
-                    g_cur_token_string_pos], true);
-                g_cur_token_string[g_cur_token_string_pos++] = o;
+                CHAR o = (CHAR)xatoll(&m_cur_token_string[
+                    m_cur_token_string_pos], true);
+                m_cur_token_string[m_cur_token_string_pos++] = o;
                 continue;
             }
             if (xcom::upper(c) == 'X' || (c >= 'a' && c <= 'f') ||
@@ -902,56 +1382,96 @@ static TOKEN t_char_list()
                 }
                 UINT n = 0;
                 while (xcom::xisdigithex(c)) {
-                    g_cur_token_string[g_cur_token_string_pos++] = c;
+                    m_cur_token_string[m_cur_token_string_pos++] = c;
                     n++;
                     c = getNextChar();
                 }
                 if (n > 2 && only_allow_two_hex) {
-                    err(g_real_line_num,
+                    err(m_real_line_num,
                         "constant too big, only permit two hex digits");
                 }
                 continue;
             }
-            g_cur_token_string[g_cur_token_string_pos++] = '\\';
-            g_cur_token_string[g_cur_token_string_pos++] = c;
+            m_cur_token_string[m_cur_token_string_pos++] = '\\';
+            m_cur_token_string[m_cur_token_string_pos++] = c;
             c = getNextChar();
             continue;
         }
-        g_cur_token_string[g_cur_token_string_pos++] = c;
+        m_cur_token_string[m_cur_token_string_pos++] = c;
+        copyCharsUntil(LEX_SCAN_find_char_list_stop(&m_scan));
         c = getNextChar();
     }
-    g_cur_char = getNextChar();
-    g_cur_token_string[g_cur_token_string_pos] = 0;
+    m_cur_char = getNextChar();
+    m_cur_token_string[m_cur_token_string_pos] = 0;
     return T_CHAR_LIST;
 }
 
 
-//'g_cur_char' hold the current charactor right now.
-//You should assign 'g_cur_char' the next valid charactor before
+//'m_cur_char' hold the current charactor right now.
+//You should assign 'm_cur_char' the next valid charactor before
 //the function return.
-static TOKEN t_id()
+TOKEN Lexer::t_id()
 {
-    CHAR c = getNextChar();
-    while (xcom::xisalpha(c) || c == '_' || xcom::xisdigit(c)) {
-        g_cur_token_string[g_cur_token_string_pos++] = c;
+    CHAR c;
+    if (m_src_buf != nullptr) {
+        //The text of identifier refers to its spelling in 'm_src_buf',
+        //thus the characters are skipped rather than copied.
+        CHAR const* start = m_cur_line + m_cur_line_pos;
+        CHAR const* p = LEX_SCAN_skip_id_body(&m_scan)(
+            start, m_cur_line + m_cur_line_num);
+        m_cur_line_pos += (INT)(p - start);
+        m_cur_token_string_pos = (INT)(m_cur_line_ofst + m_cur_line_pos -
+                                       m_cur_token_view.ofst);
+        c = getNextChar();
+        if (!IS_LEX_CC(c, LEX_CC_ID)) {
+            m_cur_char = c;
+            m_cur_token_text = m_src_buf + m_cur_token_view.ofst;
+            return classifyId();
+        }
+        //Identifier continues in next line, e.g: the line is terminated
+        //by '\0', the spelling is not contiguous any more.
+        ASSERT0(m_cur_token_string_pos < LEX_MAX_BUF_LINE);
+        ::memcpy(m_cur_token_string, m_src_buf + m_cur_token_view.ofst,
+                 m_cur_token_string_pos);
+    } else {
+        copyCharsUntil(LEX_SCAN_skip_id_body(&m_scan));
         c = getNextChar();
     }
-    g_cur_char = c;
-    g_cur_token_string[g_cur_token_string_pos] = 0;
-    TOKEN tok = getKeyWord(g_cur_token_string);
+    while (IS_LEX_CC(c, LEX_CC_ID)) {
+        //Identifier continues in next line.
+        m_cur_token_string[m_cur_token_string_pos++] = c;
+        copyCharsUntil(LEX_SCAN_skip_id_body(&m_scan));
+        c = getNextChar();
+    }
+    m_cur_char = c;
+    m_cur_token_string[m_cur_token_string_pos] = 0;
+    return classifyId();
+}
+
+
+//Return the keyword token if the text of current token is keyword,
+//otherwise return T_ID.
+TOKEN Lexer::classifyId()
+{
+    TOKEN tok = getKeyWord(m_cur_token_text, m_cur_token_string_pos);
     if (tok != T_UNDEF) {
         return tok;
     }
+
+    //Compute the hash value while the string is still in cache, thus parser
+    //could intern the identifier without scanning it again.
+    m_cur_token_hash = CLSymTab::computeHash(m_cur_token_text,
+                                             m_cur_token_string_pos);
     return T_ID;
 }
 
 
-static TOKEN t_solidus_solidus(bool * is_restart)
+TOKEN Lexer::t_solidus_solidus(bool * is_restart)
 {
     TOKEN t = T_UNDEF;
     INT st = getLine();
     if (st == ST_SUCC) {
-        g_cur_char = getNextChar();
+        m_cur_char = getNextChar();
         ASSERT0(is_restart);
         *is_restart = true;
         return T_UNDEF;
@@ -963,20 +1483,20 @@ static TOKEN t_solidus_solidus(bool * is_restart)
 }
 
 
-static TOKEN t_solidus_asterisk(bool * is_restart)
+TOKEN Lexer::t_solidus_asterisk(bool * is_restart)
 {
-    TOKEN t = T_UNDEF;
-    UINT cur_line_num = g_src_line_num;
-    CHAR c = getNextChar();
-    CHAR c1 = 0;
+    //Search the multipul-comment terminated token '*/' line by line.
+    //Note '/*' has been consumed right now.
     for (;;) {
-        cur_line_num = g_src_line_num;
-        c1 = getNextChar();
-        if (c == '*' && c1 == '/') {
-            if (g_src_line_num == cur_line_num) {
+        CHAR const* end = m_cur_line + m_cur_line_num;
+        CHAR const* p = m_cur_line + m_cur_line_pos;
+        while ((p = LEX_SCAN_find_asterisk(&m_scan)(p, end)) < end) {
+            p++;
+            if (p < end && *p == '/') {
                 //We meet the multipul-comment terminated token '*/',
                 //so change the parsing state to normal.
-                g_cur_char = getNextChar();
+                m_cur_line_pos = (INT)(p + 1 - m_cur_line);
+                m_cur_char = getNextChar();
 
                 //CASE: recur_lex.c, Do NOT recursive call into
                 //getNextToken() if meeting end of comments.
@@ -986,63 +1506,61 @@ static TOKEN t_solidus_asterisk(bool * is_restart)
                 *is_restart = true;
                 return T_UNDEF;
             }
-            c = c1;
-            continue;
         }
-        if (c == ST_EOF || c1 == ST_EOF) {
+        if (getLine() != ST_SUCC) {
             return T_END;
         }
-        c = c1;
     }
-    return t;
+    UNREACHABLE();
+    return T_UNDEF;
 }
 
 
-//'g_cur_char' hold the current charactor right now.
-//You should assign 'g_cur_char' the next valid charactor before
+//'m_cur_char' hold the current charactor right now.
+//You should assign 'm_cur_char' the next valid charactor before
 //the function return.
 //is_restart: record the result if lexer need to restart getNextToken().
-static TOKEN t_solidus(bool * is_restart)
+TOKEN Lexer::t_solidus(bool * is_restart)
 {
     CHAR c = getNextChar();
     switch (c) {
     case '=': // /=
-        g_cur_token_string[g_cur_token_string_pos++] = '/';
-        g_cur_token_string[g_cur_token_string_pos++] = c;
-        g_cur_token_string[g_cur_token_string_pos] = 0;
-        g_cur_char = getNextChar();
+        m_cur_token_string[m_cur_token_string_pos++] = '/';
+        m_cur_token_string[m_cur_token_string_pos++] = c;
+        m_cur_token_string[m_cur_token_string_pos] = 0;
+        m_cur_char = getNextChar();
         return T_DIVEQU;
     case '/': //single comment line
         return t_solidus_solidus(is_restart);
     case '*': // multi comment line
         return t_solidus_asterisk(is_restart);
     default:
-        g_cur_token_string[g_cur_token_string_pos++] = g_cur_char;
-        g_cur_token_string[g_cur_token_string_pos] = 0;
-        g_cur_char = c;
+        m_cur_token_string[m_cur_token_string_pos++] = m_cur_char;
+        m_cur_token_string[m_cur_token_string_pos] = 0;
+        m_cur_char = c;
         return T_DIV;
     }
     return T_UNDEF;
 }
 
 
-//'g_cur_char' hold the current charactor right now.
-//You should assign 'g_cur_char' the next valid charactor before
+//'m_cur_char' hold the current charactor right now.
+//You should assign 'm_cur_char' the next valid charactor before
 //the function return.
-TOKEN t_dot()
+TOKEN Lexer::t_dot()
 {
-    //Here g_cur_char is '.'
+    //Here m_cur_char is '.'
     CHAR c = 0;
     TOKEN t;
-    g_cur_token_string[g_cur_token_string_pos++] = g_cur_char;
+    m_cur_token_string[m_cur_token_string_pos++] = m_cur_char;
     c = getNextChar();
     if (c == '.') {
         // token string is ..
-        g_cur_token_string[g_cur_token_string_pos++] = c;
+        m_cur_token_string[m_cur_token_string_pos++] = c;
         c = getNextChar();
         if (c == '.') {
             // token string is ...
-            g_cur_token_string[g_cur_token_string_pos++] = c;
+            m_cur_token_string[m_cur_token_string_pos++] = c;
             t = T_DOTDOTDOT;
             c = getNextChar();
         } else {
@@ -1053,8 +1571,8 @@ TOKEN t_dot()
         //token string is '.'
         t = T_DOT;
     }
-    g_cur_token_string[g_cur_token_string_pos] = 0;
-    g_cur_char = c;
+    m_cur_token_string[m_cur_token_string_pos] = 0;
+    m_cur_char = c;
     return t;
 }
 
@@ -1072,231 +1590,231 @@ TokenInfo const* get_token_info(TOKEN tok)
 }
 
 
-static TOKEN t_rest(bool * is_restart)
+TOKEN Lexer::t_rest(bool * is_restart)
 {
     TOKEN token = T_UNDEF;
-    switch (g_cur_char) {
+    switch (m_cur_char) {
     case '-':
-        g_cur_token_string[g_cur_token_string_pos++] = g_cur_char;
-        g_cur_char = getNextChar();
-        switch (g_cur_char) {
+        m_cur_token_string[m_cur_token_string_pos++] = m_cur_char;
+        m_cur_char = getNextChar();
+        switch (m_cur_char) {
         case '=': //'-='
             token = T_SUBEQU;
-            g_cur_token_string[g_cur_token_string_pos++] = g_cur_char;
-            g_cur_token_string[g_cur_token_string_pos] = 0;
-            g_cur_char = getNextChar();
+            m_cur_token_string[m_cur_token_string_pos++] = m_cur_char;
+            m_cur_token_string[m_cur_token_string_pos] = 0;
+            m_cur_char = getNextChar();
             break;
         case '>': //'->'
             token = T_ARROW;
-            g_cur_token_string[g_cur_token_string_pos++] = g_cur_char;
-            g_cur_token_string[g_cur_token_string_pos] = 0;
-            g_cur_char = getNextChar();
+            m_cur_token_string[m_cur_token_string_pos++] = m_cur_char;
+            m_cur_token_string[m_cur_token_string_pos] = 0;
+            m_cur_char = getNextChar();
             break;
         case '-': //'--'
             token = T_SUBSUB;
-            g_cur_token_string[g_cur_token_string_pos++] = g_cur_char;
-            g_cur_token_string[g_cur_token_string_pos] = 0;
-            g_cur_char = getNextChar();
+            m_cur_token_string[m_cur_token_string_pos++] = m_cur_char;
+            m_cur_token_string[m_cur_token_string_pos] = 0;
+            m_cur_char = getNextChar();
             break;
         default: //'-'
             token = T_SUB;
-            g_cur_token_string[g_cur_token_string_pos] = 0;
+            m_cur_token_string[m_cur_token_string_pos] = 0;
         }
         break;
     case '+':
-        g_cur_token_string[g_cur_token_string_pos++] = g_cur_char;
-        g_cur_char = getNextChar();
-        switch (g_cur_char) {
+        m_cur_token_string[m_cur_token_string_pos++] = m_cur_char;
+        m_cur_char = getNextChar();
+        switch (m_cur_char) {
         case '=': //'+='
             token = T_ADDEQU;
-            g_cur_token_string[g_cur_token_string_pos++] = g_cur_char;
-            g_cur_token_string[g_cur_token_string_pos] = 0;
-            g_cur_char = getNextChar();
+            m_cur_token_string[m_cur_token_string_pos++] = m_cur_char;
+            m_cur_token_string[m_cur_token_string_pos] = 0;
+            m_cur_char = getNextChar();
             break;
         case '+': //'++'
             token = T_ADDADD;
-            g_cur_token_string[g_cur_token_string_pos++] = g_cur_char;
-            g_cur_token_string[g_cur_token_string_pos] = 0;
-            g_cur_char = getNextChar();
+            m_cur_token_string[m_cur_token_string_pos++] = m_cur_char;
+            m_cur_token_string[m_cur_token_string_pos] = 0;
+            m_cur_char = getNextChar();
             break;
         default: //'+'
             token = T_ADD;
-            g_cur_token_string[g_cur_token_string_pos] = 0;
+            m_cur_token_string[m_cur_token_string_pos] = 0;
         }
         break;
     case '%':
-        g_cur_token_string[g_cur_token_string_pos++] = g_cur_char;
-        g_cur_char = getNextChar();
-        switch (g_cur_char) {
+        m_cur_token_string[m_cur_token_string_pos++] = m_cur_char;
+        m_cur_char = getNextChar();
+        switch (m_cur_char) {
         case '=': //'%='
             token = T_REMEQU;
-            g_cur_token_string[g_cur_token_string_pos++] = g_cur_char;
-            g_cur_token_string[g_cur_token_string_pos] = 0;
-            g_cur_char = getNextChar();
+            m_cur_token_string[m_cur_token_string_pos++] = m_cur_char;
+            m_cur_token_string[m_cur_token_string_pos] = 0;
+            m_cur_char = getNextChar();
             break;
         default: //'%'
             token = T_MOD;
-            g_cur_token_string[g_cur_token_string_pos] = 0;
+            m_cur_token_string[m_cur_token_string_pos] = 0;
         }
         break;
     case '^':
-        g_cur_token_string[g_cur_token_string_pos++] = g_cur_char;
-        g_cur_char = getNextChar();
-        if (g_cur_char == '=') { //'^='
+        m_cur_token_string[m_cur_token_string_pos++] = m_cur_char;
+        m_cur_char = getNextChar();
+        if (m_cur_char == '=') { //'^='
             token = T_XOREQU;
-            g_cur_token_string[g_cur_token_string_pos++] = g_cur_char;
-            g_cur_token_string[g_cur_token_string_pos] = 0;
-            g_cur_char = getNextChar();
+            m_cur_token_string[m_cur_token_string_pos++] = m_cur_char;
+            m_cur_token_string[m_cur_token_string_pos] = 0;
+            m_cur_char = getNextChar();
         } else { //'^'
             token = T_XOR;
-            g_cur_token_string[g_cur_token_string_pos] = 0;
+            m_cur_token_string[m_cur_token_string_pos] = 0;
         }
         break;
     case '=':
-        g_cur_token_string[g_cur_token_string_pos++] = g_cur_char;
-        g_cur_char = getNextChar();
-        if (g_cur_char == '=') { //'=='
+        m_cur_token_string[m_cur_token_string_pos++] = m_cur_char;
+        m_cur_char = getNextChar();
+        if (m_cur_char == '=') { //'=='
             token = T_EQU;
-            g_cur_token_string[g_cur_token_string_pos++] = g_cur_char;
-            g_cur_token_string[g_cur_token_string_pos] = 0;
-            g_cur_char = getNextChar();
+            m_cur_token_string[m_cur_token_string_pos++] = m_cur_char;
+            m_cur_token_string[m_cur_token_string_pos] = 0;
+            m_cur_char = getNextChar();
         } else { //'='
             token = T_ASSIGN;
-            g_cur_token_string[g_cur_token_string_pos] = 0;
+            m_cur_token_string[m_cur_token_string_pos] = 0;
         }
         break;
     case '*':
-        g_cur_token_string[g_cur_token_string_pos++] = g_cur_char;
-        g_cur_char = getNextChar();
-        if (g_cur_char == '=') { //'*='
+        m_cur_token_string[m_cur_token_string_pos++] = m_cur_char;
+        m_cur_char = getNextChar();
+        if (m_cur_char == '=') { //'*='
             token = T_MULEQU;
-            g_cur_token_string[g_cur_token_string_pos++] = g_cur_char;
-            g_cur_token_string[g_cur_token_string_pos] = 0;
-            g_cur_char = getNextChar();
+            m_cur_token_string[m_cur_token_string_pos++] = m_cur_char;
+            m_cur_token_string[m_cur_token_string_pos] = 0;
+            m_cur_char = getNextChar();
         } else { //'*'
             token = T_ASTERISK;
-            g_cur_token_string[g_cur_token_string_pos] = 0;
+            m_cur_token_string[m_cur_token_string_pos] = 0;
         }
         break;
     case '&':
-        g_cur_token_string[g_cur_token_string_pos++] = g_cur_char;
-        g_cur_char = getNextChar();
-        if (g_cur_char == '&') { //'&&'
+        m_cur_token_string[m_cur_token_string_pos++] = m_cur_char;
+        m_cur_char = getNextChar();
+        if (m_cur_char == '&') { //'&&'
             token = T_AND;
-            g_cur_token_string[g_cur_token_string_pos++] = g_cur_char;
-            g_cur_token_string[g_cur_token_string_pos] = 0;
-            g_cur_char = getNextChar();
-        } else if (g_cur_char == '=') { //&=
+            m_cur_token_string[m_cur_token_string_pos++] = m_cur_char;
+            m_cur_token_string[m_cur_token_string_pos] = 0;
+            m_cur_char = getNextChar();
+        } else if (m_cur_char == '=') { //&=
             token = T_BITANDEQU;
-            g_cur_token_string[g_cur_token_string_pos++] = g_cur_char;
-            g_cur_token_string[g_cur_token_string_pos] = 0;
-            g_cur_char = getNextChar();
+            m_cur_token_string[m_cur_token_string_pos++] = m_cur_char;
+            m_cur_token_string[m_cur_token_string_pos] = 0;
+            m_cur_char = getNextChar();
         } else { //'&'
             token = T_BITAND;
-            g_cur_token_string[g_cur_token_string_pos] = 0;
+            m_cur_token_string[m_cur_token_string_pos] = 0;
         }
         break;
     case '|':
-        g_cur_token_string[g_cur_token_string_pos++] = g_cur_char;
-        g_cur_char = getNextChar();
-        switch (g_cur_char) {
+        m_cur_token_string[m_cur_token_string_pos++] = m_cur_char;
+        m_cur_char = getNextChar();
+        switch (m_cur_char) {
         case '|': //'||'
             token = T_OR;
-            g_cur_token_string[g_cur_token_string_pos++] = g_cur_char;
-            g_cur_token_string[g_cur_token_string_pos] = 0;
-            g_cur_char = getNextChar();
+            m_cur_token_string[m_cur_token_string_pos++] = m_cur_char;
+            m_cur_token_string[m_cur_token_string_pos] = 0;
+            m_cur_char = getNextChar();
             break;
         case '=': //|=
             token = T_BITOREQU;
-            g_cur_token_string[g_cur_token_string_pos++] = g_cur_char;
-            g_cur_token_string[g_cur_token_string_pos] = 0;
-            g_cur_char = getNextChar();
+            m_cur_token_string[m_cur_token_string_pos++] = m_cur_char;
+            m_cur_token_string[m_cur_token_string_pos] = 0;
+            m_cur_char = getNextChar();
             break;
         default: // '|'
             token = T_BITOR;
-            g_cur_token_string[g_cur_token_string_pos] = 0;
+            m_cur_token_string[m_cur_token_string_pos] = 0;
         }
         break;
     case ':':
-        g_cur_token_string[g_cur_token_string_pos++] = g_cur_char;
-        g_cur_char = getNextChar();
-        if (g_cur_char == ':') { //'::'
+        m_cur_token_string[m_cur_token_string_pos++] = m_cur_char;
+        m_cur_char = getNextChar();
+        if (m_cur_char == ':') { //'::'
             token = T_DCOLON;
-            g_cur_token_string[g_cur_token_string_pos++] = g_cur_char;
-            g_cur_token_string[g_cur_token_string_pos] = 0;
-            g_cur_char = getNextChar();
+            m_cur_token_string[m_cur_token_string_pos++] = m_cur_char;
+            m_cur_token_string[m_cur_token_string_pos] = 0;
+            m_cur_char = getNextChar();
         } else { //':'
             token = T_COLON;
-            g_cur_token_string[g_cur_token_string_pos] = 0;
+            m_cur_token_string[m_cur_token_string_pos] = 0;
         }
         break;
     case '>':
-        g_cur_token_string[g_cur_token_string_pos++] = g_cur_char;
-        g_cur_char = getNextChar();
-        switch (g_cur_char) {
+        m_cur_token_string[m_cur_token_string_pos++] = m_cur_char;
+        m_cur_char = getNextChar();
+        switch (m_cur_char) {
         case '>':
-            g_cur_token_string[g_cur_token_string_pos++] = g_cur_char;
-            g_cur_char = getNextChar();
-            if (g_cur_char == '=') { // >>=
+            m_cur_token_string[m_cur_token_string_pos++] = m_cur_char;
+            m_cur_char = getNextChar();
+            if (m_cur_char == '=') { // >>=
                 token = T_RSHIFTEQU;
-                g_cur_token_string[g_cur_token_string_pos++] = g_cur_char;
-                g_cur_token_string[g_cur_token_string_pos] = 0;
-                g_cur_char = getNextChar();
+                m_cur_token_string[m_cur_token_string_pos++] = m_cur_char;
+                m_cur_token_string[m_cur_token_string_pos] = 0;
+                m_cur_char = getNextChar();
             } else { // >>
                 token = T_RSHIFT;
-                g_cur_token_string[g_cur_token_string_pos] = 0;
+                m_cur_token_string[m_cur_token_string_pos] = 0;
             }
             break;
         case '=': // '>='
             token = T_NOLESSTHAN;
-            g_cur_token_string[g_cur_token_string_pos++] = g_cur_char;
-            g_cur_token_string[g_cur_token_string_pos] = 0;
-            g_cur_char = getNextChar();
+            m_cur_token_string[m_cur_token_string_pos++] = m_cur_char;
+            m_cur_token_string[m_cur_token_string_pos] = 0;
+            m_cur_char = getNextChar();
             break;
         default: //'>'
             token = T_MORETHAN;
-            g_cur_token_string[g_cur_token_string_pos] = 0;
+            m_cur_token_string[m_cur_token_string_pos] = 0;
         }
         break;
     case '<':
-        g_cur_token_string[g_cur_token_string_pos++] = g_cur_char;
-        g_cur_char = getNextChar();
-        switch (g_cur_char) {
+        m_cur_token_string[m_cur_token_string_pos++] = m_cur_char;
+        m_cur_char = getNextChar();
+        switch (m_cur_char) {
         case '<':
-            g_cur_token_string[g_cur_token_string_pos++] = g_cur_char;
-            g_cur_char = getNextChar();
-            if (g_cur_char == '=') { // <<=
+            m_cur_token_string[m_cur_token_string_pos++] = m_cur_char;
+            m_cur_char = getNextChar();
+            if (m_cur_char == '=') { // <<=
                 token = T_LSHIFTEQU;
-                g_cur_token_string[g_cur_token_string_pos++] = g_cur_char;
-                g_cur_token_string[g_cur_token_string_pos] = 0;
-                g_cur_char = getNextChar();
+                m_cur_token_string[m_cur_token_string_pos++] = m_cur_char;
+                m_cur_token_string[m_cur_token_string_pos] = 0;
+                m_cur_char = getNextChar();
             } else { // <<
                 token = T_LSHIFT;
-                g_cur_token_string[g_cur_token_string_pos] = 0;
+                m_cur_token_string[m_cur_token_string_pos] = 0;
             }
             break;
         case '=': // '<='
             token = T_NOMORETHAN;
-            g_cur_token_string[g_cur_token_string_pos++] = g_cur_char;
-            g_cur_token_string[g_cur_token_string_pos] = 0;
-            g_cur_char = getNextChar();
+            m_cur_token_string[m_cur_token_string_pos++] = m_cur_char;
+            m_cur_token_string[m_cur_token_string_pos] = 0;
+            m_cur_char = getNextChar();
             break;
         default: // '<'
             token = T_LESSTHAN;
-            g_cur_token_string[g_cur_token_string_pos] = 0;
+            m_cur_token_string[m_cur_token_string_pos] = 0;
         }
         break;
     case '!':
-        g_cur_token_string[g_cur_token_string_pos++] = g_cur_char;
-        g_cur_char = getNextChar();
-        if (g_cur_char == '=') { // '!='
+        m_cur_token_string[m_cur_token_string_pos++] = m_cur_char;
+        m_cur_char = getNextChar();
+        if (m_cur_char == '=') { // '!='
             token = T_NOEQU;
-            g_cur_token_string[g_cur_token_string_pos++] = g_cur_char;
-            g_cur_token_string[g_cur_token_string_pos] = 0;
-            g_cur_char = getNextChar();
+            m_cur_token_string[m_cur_token_string_pos++] = m_cur_char;
+            m_cur_token_string[m_cur_token_string_pos] = 0;
+            m_cur_char = getNextChar();
         } else { // '!'
             token = T_NOT;
-            g_cur_token_string[g_cur_token_string_pos] = 0;
+            m_cur_token_string[m_cur_token_string_pos] = 0;
         }
         break;
     case '/':
@@ -1309,7 +1827,7 @@ static TOKEN t_rest(bool * is_restart)
     //DO NOT ADD NEW CASES AFTER THIS LINE.//
     /////////////////////////////////////////
     default:
-        if (g_cur_token == T_END) {
+        if (m_cur_token == T_END) {
             //Meet file end.
             token = T_END;
         } else {
@@ -1322,170 +1840,221 @@ static TOKEN t_rest(bool * is_restart)
 
 
 //Get current token.
-TOKEN getNextToken()
+TOKEN Lexer::getNextToken()
 {
-    if (g_cur_token == T_END) { return g_cur_token; }
+    if (m_cur_token == T_END) { return m_cur_token; }
     TOKEN token = T_UNDEF;
-    g_cur_token_string_pos = 0;
-    g_cur_token_string[0] = 0;
-    while (g_cur_char == 0) { g_cur_char = getNextChar(); }
+    m_cur_token_string_pos = 0;
+    m_cur_token_string[0] = 0;
+    m_cur_token_text = m_cur_token_string;
+RESTART:
+    while (m_cur_char == 0) { m_cur_char = getNextChar(); }
 START:
-    switch (g_cur_char) {
+    m_cur_token_view.ofst = getCurCharOfst();
+    if (m_cur_token_view.ofst >= m_stop_ofst) {
+        token = T_END;
+        goto FIN;
+    }
+    if (g_punc_token[(BYTE)m_cur_char] != T_UNDEF) {
+        //Single character token.
+        token = g_punc_token[(BYTE)m_cur_char];
+        if (m_src_buf != nullptr) {
+            //Refer to the spelling rather than copy it.
+            m_cur_token_text = m_src_buf + m_cur_token_view.ofst;
+            m_cur_token_string_pos = 1;
+        } else {
+            m_cur_token_string[m_cur_token_string_pos++] = m_cur_char;
+            m_cur_token_string[m_cur_token_string_pos] = 0;
+        }
+        m_cur_char = getNextChar();
+        goto FIN;
+    }
+    if (IS_LEX_CC(m_cur_char, LEX_CC_SPACE)) {
+        skipSpace();
+        goto RESTART;
+    }
+    if (IS_LEX_CC(m_cur_char, LEX_CC_ALPHA)) { //identifier
+        if (m_src_buf == nullptr) {
+            m_cur_token_string[m_cur_token_string_pos++] = m_cur_char;
+        }
+        token = t_id();
+        if (g_enable_true_false_token &&
+            (token == T_TRUE || token == T_FALSE)) {
+            m_cur_token_text = m_cur_token_string;
+            if (token == T_TRUE) {
+                m_cur_token_string[0] = '1';
+                m_cur_token_string[1] = 0;
+            } else {
+                m_cur_token_string[0] = '0';
+                m_cur_token_string[1] = 0;
+            }
+            token = T_IMM;
+            m_cur_token_string_pos = 1;
+        }
+        goto FIN;
+    }
+    if (IS_LEX_CC(m_cur_char, LEX_CC_DIGIT)) { //imm
+        m_cur_token_string[m_cur_token_string_pos++] = m_cur_char;
+        token = t_num();
+        goto FIN;
+    }
+    switch (m_cur_char) {
     case ST_EOF:
         token = T_END; //Meet file end.
         break;
     case 0xa:
     case 0xd:
         //'\n'
-        if (g_enable_newline_token && g_cur_char == 0xa) {
+        if (m_enable_newline_token && m_cur_char == 0xa) {
             token = T_NEWLINE;
-            g_cur_token_string[g_cur_token_string_pos++] = g_cur_char;
-            g_cur_token_string[g_cur_token_string_pos] = 0;
-            g_cur_char = getNextChar();
+            m_cur_token_string[m_cur_token_string_pos++] = m_cur_char;
+            m_cur_token_string[m_cur_token_string_pos] = 0;
+            m_cur_char = getNextChar();
         } else {
             //CASE: recur_lex.c, Do NOT recursive call into
             //getNextToken() if meeting end of source code line.
             //Avoid stack overflow.
             //token = getNextToken();
-            g_cur_char = getNextChar();
+            m_cur_char = getNextChar();
             goto START;
         }
         break;
-    case '\t':
-        while ((g_cur_char = getNextChar()) == '\t') { }
-        token = getNextToken();
-        break;
-    case ' ':
-        while((g_cur_char = getNextChar())==' ') { }
-        token = getNextToken();
-        break;
-    case '@':
-        token = T_AT;
-        g_cur_token_string[g_cur_token_string_pos++] = g_cur_char;
-        g_cur_token_string[g_cur_token_string_pos] = 0;
-        g_cur_char = getNextChar();
-        break;
-    case ';':
-        token = T_SEMI;
-        g_cur_token_string[g_cur_token_string_pos++] = g_cur_char;
-        g_cur_token_string[g_cur_token_string_pos] = 0;
-        g_cur_char = getNextChar();
-        break;
-    case ',':
-        token = T_COMMA;
-        g_cur_token_string[g_cur_token_string_pos++] = g_cur_char;
-        g_cur_token_string[g_cur_token_string_pos] = 0;
-        g_cur_char=getNextChar();
-        break;
-    case '{':
-        token = T_LLPAREN;
-        g_cur_token_string[g_cur_token_string_pos++] = g_cur_char;
-        g_cur_token_string[g_cur_token_string_pos] = 0;
-        g_cur_char = getNextChar();
-        break;
-    case '}':
-        token = T_RLPAREN;
-        g_cur_token_string[g_cur_token_string_pos++] = g_cur_char;
-        g_cur_token_string[g_cur_token_string_pos] = 0;
-        g_cur_char = getNextChar();
-        break;
-    case '[':
-        token = T_LSPAREN;
-        g_cur_token_string[g_cur_token_string_pos++] = g_cur_char;
-        g_cur_token_string[g_cur_token_string_pos] = 0;
-        g_cur_char = getNextChar();
+    case '"': //string
+        token = t_string();
         break;
-    case ']':
-        token = T_RSPAREN;
-        g_cur_token_string[g_cur_token_string_pos++] = g_cur_char;
-        g_cur_token_string[g_cur_token_string_pos] = 0;
-        g_cur_char = getNextChar();
+    case '\'': //char list
+        token = t_char_list();
         break;
-    case '(':
-        token = T_LPAREN;
-        g_cur_token_string[g_cur_token_string_pos++] = g_cur_char;
-        g_cur_token_string[g_cur_token_string_pos] = 0;
-        g_cur_char = getNextChar();
-        break;
-    case ')':
-        token = T_RPAREN;
-        g_cur_token_string[g_cur_token_string_pos++] = g_cur_char;
-        g_cur_token_string[g_cur_token_string_pos] = 0;
-        g_cur_char = getNextChar();
-        break;
-    case '~':
-        token = T_REV;
-        g_cur_token_string[g_cur_token_string_pos++] = g_cur_char;
-        g_cur_token_string[g_cur_token_string_pos] = 0;
-        g_cur_char = getNextChar();
-        break;
-    case '?':
-        token = T_QUES_MARK;
-        g_cur_token_string[g_cur_token_string_pos++] = g_cur_char;
-        g_cur_token_string[g_cur_token_string_pos] = 0;
-        g_cur_char = getNextChar();
-        break;
-    case '#':
-        token = T_SHARP;
-        g_cur_token_string[g_cur_token_string_pos++] = g_cur_char;
-        g_cur_token_string[g_cur_token_string_pos] = 0;
-        g_cur_char = getNextChar();
-        break;
-    default:
-        if (g_cur_char == '"') { //string
-            token = t_string();
-        } else if (g_cur_char == '\'') { //char list
-            token = t_char_list();
-        } else if (xcom::xisalpha(g_cur_char) ||
-                   g_cur_char == '_') { //identifier
-            g_cur_token_string[g_cur_token_string_pos++] = g_cur_char;
-            token = t_id();
-            if (g_enable_true_false_token &&
-                (token == T_TRUE || token == T_FALSE)) {
-                if (token == T_TRUE) {
-                    g_cur_token_string[0] = '1';
-                    g_cur_token_string[1] = 0;
-                } else {
-                    g_cur_token_string[0] = '0';
-                    g_cur_token_string[1] = 0;
+    default: {
+        bool is_restart = false;
+        token = t_rest(&is_restart);
+        if (is_restart) {
+            ASSERT0(token == T_UNDEF);
+            goto START;
+        }
+    }
+    }
+FIN:
+    m_cur_token_view.len = token == T_END ?
+        0 : getCurCharOfst() - m_cur_token_view.ofst;
+    m_cur_token = token;
+    return token;
+}
+
+
+bool Lexer::skipBlock(OUT LexPos * begin, OUT UINT * end)
+{
+    ASSERT0(m_cur_token == T_LLPAREN && begin && end);
+    UINT tok_ofst = m_cur_token_view.ofst;
+    if (m_cur_line == nullptr || m_cur_line_pos == 0 ||
+        tok_ofst < m_cur_line_ofst ||
+        tok_ofst >= m_cur_line_ofst + (UINT)m_cur_line_num) {
+        //'{' is not in current line, e.g: meet EOF after '{'.
+        return false;
+    }
+    LEX_POS_tok_ofst(begin) = tok_ofst;
+    LEX_POS_line_ofst(begin) = m_cur_line_ofst;
+    LEX_POS_line_len(begin) = (UINT)m_cur_line_num;
+    LEX_POS_next_line_ofst(begin) = m_cur_src_ofst;
+    LEX_POS_src_line_num(begin) = m_src_line_num;
+    LEX_POS_is_dos(begin) = m_is_dos;
+    INT org_line_pos = m_cur_line_pos;
+
+    //'m_cur_char' is the character after '{', scan from it.
+    m_cur_line_pos--;
+    UINT depth = 1;
+    CHAR quote = 0; //the quote of string or char-list that being skipped.
+    bool in_comment = false;
+    for (;;) {
+        CHAR const* lend = m_cur_line + m_cur_line_num;
+        CHAR const* p = m_cur_line + m_cur_line_pos;
+        while (p < lend) {
+            if (in_comment) {
+                p = LEX_SCAN_find_asterisk(&m_scan)(p, lend);
+                if (p == lend) { break; }
+                p++;
+                if (p < lend && *p == '/') {
+                    p++;
+                    in_comment = false;
                 }
-                token = T_IMM;
-                g_cur_token_string_pos = 1;
+                continue;
             }
-        } else if (xcom::xisdigit(g_cur_char) != 0) { //imm
-            g_cur_token_string[g_cur_token_string_pos++] = g_cur_char;
-            token = t_num();
-        } else {
-            bool is_restart = false;
-            token = t_rest(&is_restart);
-            if (is_restart) {
-                ASSERT0(token == T_UNDEF);
-                goto START;
+            if (quote != 0) {
+                p = quote == '"' ?
+                    LEX_SCAN_find_string_stop(&m_scan)(p, lend) :
+                    LEX_SCAN_find_char_list_stop(&m_scan)(p, lend);
+                if (p == lend) { break; }
+                if (*p == '\\') {
+                    //Skip the escaped character.
+                    p += 2;
+                    continue;
+                }
+                p++;
+                quote = 0;
+                continue;
+            }
+            p = LEX_SCAN_find_block_stop(&m_scan)(p, lend);
+            if (p == lend) { break; }
+            CHAR c = *p++;
+            if (c == '{') {
+                depth++;
+            } else if (c == '}') {
+                depth--;
+                if (depth == 0) {
+                    m_cur_line_pos = (INT)(p - m_cur_line);
+                    *end = m_cur_line_ofst + m_cur_line_pos;
+                    m_cur_token = T_RLPAREN;
+                    m_cur_char = getNextChar();
+                    return true;
+                }
+            } else if (c == '"' || c == '\'') {
+                quote = c;
+            } else {
+                ASSERT0(c == '/');
+                if (p < lend && *p == '/') {
+                    //Single line comment.
+                    p = lend;
+                } else if (p < lend && *p == '*') {
+                    p++;
+                    in_comment = true;
+                }
             }
         }
+        if (getLine() != ST_SUCC) {
+            //The block is not terminated. Restore the lexer to the character
+            //after '{', then the parser of block reports the missing '}'.
+            m_is_dos = LEX_POS_is_dos(begin);
+            m_cur_line = m_src_buf + LEX_POS_line_ofst(begin);
+            m_cur_line_ofst = LEX_POS_line_ofst(begin);
+            m_cur_line_num = (INT)LEX_POS_line_len(begin);
+            m_cur_line_pos = org_line_pos;
+            m_cur_src_ofst = LEX_POS_next_line_ofst(begin);
+            m_src_line_num = LEX_POS_src_line_num(begin);
+            return false;
+        }
     }
-    g_cur_token = token;
-    return token;
+    UNREACHABLE();
+    return false;
 }
 
 
 #ifdef _DEBUG_
 //Only for test.
-void test_lex()
+void Lexer::test_lex()
 {
     getNextToken();
-    while (g_cur_token != T_END) {
-        if (g_cur_token == T_UNDEF) {
-            printf("ERROR in line:%u\n\t", g_src_line_num);
+    while (m_cur_token != T_END) {
+        if (m_cur_token == T_UNDEF) {
+            printf("ERROR in line:%u\n\t", m_src_line_num);
             printf("S:%10s, T:%10s",
-                g_cur_token_string,
-                g_token_info[g_cur_token].name);
+                getCurTokenString(),
+                g_token_info[m_cur_token].name);
             break;
         }
         printf("S:%10s, T:%10s, L:%10u ",
-            g_cur_token_string,
-            g_token_info[g_cur_token].name,
-            g_src_line_num);
+            getCurTokenString(),
+            g_token_info[m_cur_token].name,
+            m_src_line_num);
         getNextToken();
     }
     printf("\n\n\n");
@@ -178,6 +178,40 @@ public:
 };
 
 
+//Record the spelling position of a token in src file.
+//The spelling of token is the byte range [ofst, ofst + len) of src file.
+//Note the spelling of string and char-list include the quotes and the
+//escape characters, whereas g_cur_token_string holds the escaped value.
+#define TOKEN_VIEW_ofst(tv) (tv)->ofst
+#define TOKEN_VIEW_len(tv) (tv)->len
+class TokenView {
+public:
+    UINT ofst;
+    UINT len;
+};
+
+
+//Record the scanning position of lexer at the beginning of a token, which
+//is the state of lexer after the line that contains the token has been
+//read. Another lexer is able to restart scanning from the token with
+//the position.
+#define LEX_POS_tok_ofst(p) ((p)->tok_ofst)
+#define LEX_POS_line_ofst(p) ((p)->line_ofst)
+#define LEX_POS_line_len(p) ((p)->line_len)
+#define LEX_POS_next_line_ofst(p) ((p)->next_line_ofst)
+#define LEX_POS_src_line_num(p) ((p)->src_line_num)
+#define LEX_POS_is_dos(p) ((p)->is_dos)
+class LexPos {
+public:
+    UINT tok_ofst; //the byte offset of token in src file.
+    UINT line_ofst; //the byte offset of the line that contains the token.
+    UINT line_len; //the byte length of the line.
+    UINT next_line_ofst; //the byte offset of the next line.
+    UINT src_line_num; //the line number after the line has been read.
+    bool is_dos;
+};
+
+
 #define KEYWORD_INFO_name(ti) (ti)->name
 #define KEYWORD_INFO_token(ti) (ti)->tok
 class KeywordInfo {
@@ -189,39 +223,193 @@ public:
 
 #define LEX_MAX_BUF_LINE 4096
 #define LEX_MAX_OFST_BUF_LEN 1024
-#define OFST_TAB_LINE_SIZE (g_ofst_tab_byte_size / sizeof(LONG))
+
+//Lexer holds the whole scanning state of one src file, thus several src files
+//can be scanned at the same time by different Lexer objects.
+#define LEX_hsrc(l) ((l)->m_hsrc)
+#define LEX_cur_token(l) ((l)->m_cur_token)
+#define LEX_src_line_num(l) ((l)->m_src_line_num)
+#define LEX_real_line_num(l) ((l)->m_real_line_num)
+#define LEX_disgarded_line_num(l) ((l)->m_disgarded_line_num)
+#define LEX_enable_newline_token(l) ((l)->m_enable_newline_token)
+class Lexer {
+    COPY_CONSTRUCTOR(Lexer);
+public:
+    FILE * m_hsrc; //the file handler of source file.
+    TOKEN m_cur_token; //the current token.
+    UINT m_src_line_num; //line number of src file
+    INT m_real_line_num;
+
+    //Record the number of disgarded line, that always
+    //sparking by preprecossor.
+    UINT m_disgarded_line_num;
+    bool m_enable_newline_token; //set true to regard '\n' as token.
+protected:
+    //The string buffer which token were reside.
+    //Note the buffer is not filled if the text of current token refers to
+    //the spelling in 'm_src_buf', see getCurTokenString().
+    CHAR m_cur_token_string[LEX_MAX_BUF_LINE];
+
+    //The text of current token, which refers to either
+    //'m_cur_token_string' or the spelling of token in 'm_src_buf'.
+    //The latter is not terminated by '\0'.
+    CHAR const* m_cur_token_text;
+    INT m_cur_token_string_pos;
+
+    //The hash value of current identifier that computed by
+    //CLSymTab::computeHash(), it is only valid if current token is T_ID.
+    UINT64 m_cur_token_hash;
+    CHAR m_cur_char; //See details about the paper about LL1
+    bool m_is_dos;
+
+    //Set true to return the newline charactors as normal character.
+    bool m_use_newline_char;
+    bool m_src_buf_is_mapped;
+    INT m_cur_line_pos;
+    INT m_cur_line_num;
+    INT m_file_buf_pos;
+    INT m_last_read_num;
+    UINT m_cur_src_ofst; //Record current file offset of src file
+
+    //The byte offset of the first character of 'm_cur_line' in src file.
+    UINT m_cur_line_ofst;
+    UINT m_cur_line_len; //The current line buf length ,than read from file buf
+    CHAR const* m_cur_line; //Current parsing line of src file
+
+    //The line buffer that hold the characters copied from 'm_file_buf'.
+    //It is only used when source file is not mapped.
+    CHAR * m_line_buf;
+    LONG * m_ofst_tab; //Record offset of each line in src file
+    LONG m_ofst_tab_byte_size; //Record byte size position of Offset Table
+
+    //The whole content of src file, which is either mapped into memory or
+    //read from src file handler once when 'g_enable_map_src_file' is true.
+    CHAR const* m_src_buf;
+    size_t m_src_buf_len;
+
+    //Set to true if 'm_src_buf' belongs to another lexer.
+    bool m_src_buf_is_borrowed;
+
+    //Lexer returns T_END if the token begins at or after the byte offset.
+    UINT m_stop_ofst;
+
+    //Record the spelling position of current token in src file.
+    TokenView m_cur_token_view;
+    LexScanKernel m_scan;
+    CHAR m_file_buf[LEX_MAX_BUF_LINE];
+protected:
+    bool initSrcBuf();
+    void finiSrcBuf();
+    void growOfstTab();
+    INT getLine();
+    INT getLineFromSrcBuf();
+    inline UINT getCurCharOfst() const;
+    CHAR getNextCharFromNewLine();
+    inline CHAR getNextChar();
+    void skipSpace();
+    void copyCharsUntil(LexScanFunc stop);
+    TOKEN parse_suffix(TOKEN t);
+    TOKEN t_num();
+    bool try_handle_escape_hex_digit(MOD CHAR & c);
+    bool try_handle_escape_digit(MOD CHAR & c);
+    bool try_handle_escape_char(MOD CHAR & c);
+    TOKEN t_string();
+    TOKEN t_char_list();
+    TOKEN t_id();
+    TOKEN classifyId();
+    TOKEN t_solidus_solidus(bool * is_restart);
+    TOKEN t_solidus_asterisk(bool * is_restart);
+    TOKEN t_solidus(bool * is_restart);
+    TOKEN t_dot();
+    TOKEN t_rest(bool * is_restart);
+public:
+    Lexer();
+    ~Lexer() { destroy(); }
+
+    //This is the first function you should invoke before start lex scanning.
+    //'m_hsrc' must have been set to the src file.
+    void init();
+    void destroy();
+
+    //Initialize the lexer to scan the content of 'src' from the token at
+    //'pos' until 'stop_ofst'. The content must be in memory, namely
+    //src.getSrcBuf() is not nullptr, and 'src' must not be destroyed
+    //before the lexer.
+    void initAt(Lexer const& src, LexPos const& pos, UINT stop_ofst);
+
+    //Get current token.
+    TOKEN getNextToken();
+
+    //Skip the block that begins with current token '{' until the matched
+    //'}', then the lexer goes on scanning the token after '}'. The
+    //string, char-list and comments are skipped as a whole, thus the braces
+    //inside them are not counted.
+    //begin: record the position of '{'.
+    //end: record the byte offset after the matched '}'.
+    //Return false if the block can not be skipped, e.g: there is no matched
+    //'}' till the end of src file, then the lexer is unchanged.
+    bool skipBlock(OUT LexPos * begin, OUT UINT * end);
+
+    //Get the spelling position of current token in src file.
+    TokenView const* getCurTokenView() const { return &m_cur_token_view; }
+
+    //Get the whole content of src file if 'g_enable_map_src_file' is true,
+    //otherwise return nullptr.
+    //len: return the byte length of the content.
+    //e.g: the spelling of current token is:
+    //  getSrcBuf(&len) + TOKEN_VIEW_ofst(getCurTokenView()).
+    CHAR const* getSrcBuf(OUT size_t * len) const;
+
+    //Get the text of current token, the byte length of text is
+    //getCurTokenStringLen(). The text refers to the spelling of token in
+    //src buffer if possible, thus it may not be terminated by '\0'.
+    CHAR const* getCurTokenText() const { return m_cur_token_text; }
+
+    //Get the string of current token that terminated by '\0'.
+    //The string is built from the text of token on demand.
+    CHAR const* getCurTokenString();
+
+    //Get the current token string length.
+    //e.g:current token string is "ab\0c", the function return 4.
+    UINT getCurTokenStringLen() const { return m_cur_token_string_pos; }
+
+    //Get the hash value of current identifier, the value is used to add
+    //the identifier into CLSymTab. It is only valid if current token is T_ID.
+    UINT64 getCurTokenHash() const { return m_cur_token_hash; }
+
+    //Get the kind of scan kernels that lexer is using.
+    LEX_SCAN_KIND getScanKind() const { return LEX_SCAN_kind(&m_scan); }
+
+    #ifdef _DEBUG_
+    //Only for test.
+    void test_lex();
+    #endif
+};
+
 
 //Exported Variables
-extern UINT g_src_line_num; //line number of src file
-extern CHAR g_cur_token_string[]; //the string name of current token.
-extern CHAR * g_cur_line; //the current line during parsing of src file.
-extern UINT g_cur_line_len; //the current line buffer length.
-extern TOKEN g_cur_token; //the current token.
-extern LONG * g_ofst_tab; //record the byte offset of each line in src file.
-extern LONG g_ofst_tab_byte_size;//record entry number of offset table.
-extern bool g_enable_newline_token; //set true to regard '\n' as token.
-extern FILE * g_hsrc; //the file handler of source file.
-extern INT g_real_line_num;
-//Record the number of disgarded line, that always
-//sparking by preprecossor.
-extern UINT g_disgarded_line_num;
+//Set true to map the whole src file into memory before scanning.
+//If src file can not be mapped, e.g: it is a pipe, the lexer reads the
+//whole content in once.
+extern bool g_enable_map_src_file;
 
-//Exported Functions
-//This is the first function you should invoke before start lex scanning.
-void initLexer();
-void finiLexer();
+//The lexer that current thread is working on.
+extern THREAD_LOCAL Lexer * g_cur_lexer;
 
-//Get current token.
-TOKEN getNextToken();
+//The following names refer to the state of the lexer of current thread.
+#define g_hsrc LEX_hsrc(g_cur_lexer)
+#define g_cur_token LEX_cur_token(g_cur_lexer)
+#define g_cur_token_string (g_cur_lexer->getCurTokenString())
+#define g_src_line_num LEX_src_line_num(g_cur_lexer)
+#define g_real_line_num LEX_real_line_num(g_cur_lexer)
+#define g_disgarded_line_num LEX_disgarded_line_num(g_cur_lexer)
+#define g_enable_newline_token LEX_enable_newline_token(g_cur_lexer)
 
+//Exported Functions
 //Get the string name of current token.
 CHAR const* getTokenName(TOKEN tok);
 
 TokenInfo const* get_token_info(TOKEN tok);
 
-//Get the current token string length. 
-//e.g:current token string is "ab\0c", the function return 4.
-UINT getCurTokenStringLen();
-
 } //namespace xfe
 #endif
@@ -0,0 +1,446 @@
+/*@
+Copyright (c) 2013-2021, Su Zhenyu steven.known@gmail.com
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the Su Zhenyu nor the names of its contributors
+      may be used to endorse or promote products derived from this software
+      without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+@*/
+#include "cfeinc.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define LEX_SCAN_X86
+#include <immintrin.h>
+#define ATTR_SSE2 __attribute__((target("sse2")))
+#define ATTR_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace xfe {
+
+#define S LEX_CC_SPACE
+#define A LEX_CC_ALPHA
+#define D LEX_CC_DIGIT
+BYTE const g_lex_char_class[256] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, S, 0, 0, 0, 0, 0, 0, //0x00
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, //0x10
+    S, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, //0x20
+    D, D, D, D, D, D, D, D, D, D, 0, 0, 0, 0, 0, 0, //0x30
+    0, A, A, A, A, A, A, A, A, A, A, A, A, A, A, A, //0x40
+    A, A, A, A, A, A, A, A, A, A, A, 0, 0, 0, 0, A, //0x50
+    0, A, A, A, A, A, A, A, A, A, A, A, A, A, A, A, //0x60
+    A, A, A, A, A, A, A, A, A, A, A, 0, 0, 0, 0, 0, //0x70
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, //0x80
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, //0x90
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, //0xA0
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, //0xB0
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, //0xC0
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, //0xD0
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, //0xE0
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, //0xF0
+};
+#undef S
+#undef A
+#undef D
+
+
+//
+//START Scalar Kernels
+//
+static CHAR const* skipSpaceScalar(CHAR const* start, CHAR const* end)
+{
+    for (; start < end && IS_LEX_CC(*start, LEX_CC_SPACE); start++) {}
+    return start;
+}
+
+
+static CHAR const* skipIdBodyScalar(CHAR const* start, CHAR const* end)
+{
+    for (; start < end && IS_LEX_CC(*start, LEX_CC_ID); start++) {}
+    return start;
+}
+
+
+static CHAR const* findAsteriskScalar(CHAR const* start, CHAR const* end)
+{
+    CHAR const* p = (CHAR const*)::memchr(start, '*', end - start);
+    return p != nullptr ? p : end;
+}
+
+
+static inline CHAR const* findByte2Scalar(CHAR const* start, CHAR const* end,
+                                          CHAR a, CHAR b)
+{
+    for (; start < end && *start != a && *start != b; start++) {}
+    return start;
+}
+
+
+static CHAR const* findLineEndScalar(CHAR const* start, CHAR const* end)
+{
+    return findByte2Scalar(start, end, '\n', '\r');
+}
+
+
+static CHAR const* findStringStopScalar(CHAR const* start, CHAR const* end)
+{
+    return findByte2Scalar(start, end, '"', '\\');
+}
+
+
+static CHAR const* findCharListStopScalar(CHAR const* start, CHAR const* end)
+{
+    return findByte2Scalar(start, end, '\'', '\\');
+}
+
+
+static CHAR const* findBlockStopScalar(CHAR const* start, CHAR const* end)
+{
+    for (; start < end; start++) {
+        CHAR c = *start;
+        if (c == '{' || c == '}' || c == '"' || c == '\'' || c == '/') {
+            return start;
+        }
+    }
+    return start;
+}
+//END Scalar Kernels
+
+
+#ifdef LEX_SCAN_X86
+//
+//START SSE2 Kernels
+//
+//Each kernel computes a mask for 16 characters once, where the bit is set if
+//the corresponding character stops the scanning.
+#define SSE2_WIDTH 16
+
+ATTR_SSE2
+static inline UINT stopMaskOfSpaceSSE2(__m128i v)
+{
+    __m128i sp = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')),
+                              _mm_cmpeq_epi8(v, _mm_set1_epi8('\t')));
+    return ~(UINT)_mm_movemask_epi8(sp) & 0xFFFF;
+}
+
+
+ATTR_SSE2
+static inline UINT stopMaskOfIdSSE2(__m128i v)
+{
+    //Characters that are larger than 0x7F are negative, they are out of
+    //all ranges in signed comparison.
+    __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+    __m128i alpha = _mm_and_si128(
+        _mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+        _mm_cmpgt_epi8(_mm_set1_epi8('z' + 1), lower));
+    __m128i digit = _mm_and_si128(
+        _mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)),
+        _mm_cmpgt_epi8(_mm_set1_epi8('9' + 1), v));
+    __m128i underline = _mm_cmpeq_epi8(v, _mm_set1_epi8('_'));
+    __m128i id = _mm_or_si128(_mm_or_si128(alpha, digit), underline);
+    return ~(UINT)_mm_movemask_epi8(id) & 0xFFFF;
+}
+
+
+ATTR_SSE2
+static inline UINT stopMaskOfByte2SSE2(__m128i v, __m128i a, __m128i b)
+{
+    return (UINT)_mm_movemask_epi8(
+        _mm_or_si128(_mm_cmpeq_epi8(v, a), _mm_cmpeq_epi8(v, b)));
+}
+
+
+ATTR_SSE2
+static inline UINT stopMaskOfBlockSSE2(__m128i v)
+{
+    __m128i brace = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('{')),
+                                 _mm_cmpeq_epi8(v, _mm_set1_epi8('}')));
+    __m128i quote = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('"')),
+                                 _mm_cmpeq_epi8(v, _mm_set1_epi8('\'')));
+    __m128i solidus = _mm_cmpeq_epi8(v, _mm_set1_epi8('/'));
+    return (UINT)_mm_movemask_epi8(
+        _mm_or_si128(_mm_or_si128(brace, quote), solidus));
+}
+
+
+ATTR_SSE2
+static CHAR const* skipSpaceSSE2(CHAR const* start, CHAR const* end)
+{
+    for (; end - start >= SSE2_WIDTH; start += SSE2_WIDTH) {
+        UINT m = stopMaskOfSpaceSSE2(
+            _mm_loadu_si128((__m128i const*)start));
+        if (m != 0) { return start + __builtin_ctz(m); }
+    }
+    return skipSpaceScalar(start, end);
+}
+
+
+ATTR_SSE2
+static CHAR const* skipIdBodySSE2(CHAR const* start, CHAR const* end)
+{
+    for (; end - start >= SSE2_WIDTH; start += SSE2_WIDTH) {
+        UINT m = stopMaskOfIdSSE2(_mm_loadu_si128((__m128i const*)start));
+        if (m != 0) { return start + __builtin_ctz(m); }
+    }
+    return skipIdBodyScalar(start, end);
+}
+
+
+ATTR_SSE2
+static inline CHAR const* findByte2SSE2(CHAR const* start, CHAR const* end,
+                                        CHAR a, CHAR b)
+{
+    __m128i va = _mm_set1_epi8(a);
+    __m128i vb = _mm_set1_epi8(b);
+    for (; end - start >= SSE2_WIDTH; start += SSE2_WIDTH) {
+        UINT m = stopMaskOfByte2SSE2(
+            _mm_loadu_si128((__m128i const*)start), va, vb);
+        if (m != 0) { return start + __builtin_ctz(m); }
+    }
+    return findByte2Scalar(start, end, a, b);
+}
+
+
+ATTR_SSE2
+static CHAR const* findAsteriskSSE2(CHAR const* start, CHAR const* end)
+{
+    return findByte2SSE2(start, end, '*', '*');
+}
+
+
+ATTR_SSE2
+static CHAR const* findLineEndSSE2(CHAR const* start, CHAR const* end)
+{
+    return findByte2SSE2(start, end, '\n', '\r');
+}
+
+
+ATTR_SSE2
+static CHAR const* findStringStopSSE2(CHAR const* start, CHAR const* end)
+{
+    return findByte2SSE2(start, end, '"', '\\');
+}
+
+
+ATTR_SSE2
+static CHAR const* findCharListStopSSE2(CHAR const* start, CHAR const* end)
+{
+    return findByte2SSE2(start, end, '\'', '\\');
+}
+
+
+ATTR_SSE2
+static CHAR const* findBlockStopSSE2(CHAR const* start, CHAR const* end)
+{
+    for (; end - start >= SSE2_WIDTH; start += SSE2_WIDTH) {
+        UINT m = stopMaskOfBlockSSE2(_mm_loadu_si128((__m128i const*)start));
+        if (m != 0) { return start + __builtin_ctz(m); }
+    }
+    return findBlockStopScalar(start, end);
+}
+//END SSE2 Kernels
+
+
+//
+//START AVX2 Kernels
+//
+#define AVX2_WIDTH 32
+
+ATTR_AVX2
+static CHAR const* skipSpaceAVX2(CHAR const* start, CHAR const* end)
+{
+    __m256i sp = _mm256_set1_epi8(' ');
+    __m256i tab = _mm256_set1_epi8('\t');
+    for (; end - start >= AVX2_WIDTH; start += AVX2_WIDTH) {
+        __m256i v = _mm256_loadu_si256((__m256i const*)start);
+        UINT m = ~(UINT)_mm256_movemask_epi8(_mm256_or_si256(
+            _mm256_cmpeq_epi8(v, sp), _mm256_cmpeq_epi8(v, tab)));
+        if (m != 0) { return start + __builtin_ctz(m); }
+    }
+    return skipSpaceSSE2(start, end);
+}
+
+
+ATTR_AVX2
+static CHAR const* skipIdBodyAVX2(CHAR const* start, CHAR const* end)
+{
+    for (; end - start >= AVX2_WIDTH; start += AVX2_WIDTH) {
+        __m256i v = _mm256_loadu_si256((__m256i const*)start);
+        __m256i lower = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+        __m256i alpha = _mm256_and_si256(
+            _mm256_cmpgt_epi8(lower, _mm256_set1_epi8('a' - 1)),
+            _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), lower));
+        __m256i digit = _mm256_and_si256(
+            _mm256_cmpgt_epi8(v, _mm256_set1_epi8('0' - 1)),
+            _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), v));
+        __m256i underline = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_'));
+        __m256i id = _mm256_or_si256(_mm256_or_si256(alpha, digit),
+                                     underline);
+        UINT m = ~(UINT)_mm256_movemask_epi8(id);
+        if (m != 0) { return start + __builtin_ctz(m); }
+    }
+    return skipIdBodySSE2(start, end);
+}
+
+
+ATTR_AVX2
+static inline CHAR const* findByte2AVX2(CHAR const* start, CHAR const* end,
+                                        CHAR a, CHAR b)
+{
+    __m256i va = _mm256_set1_epi8(a);
+    __m256i vb = _mm256_set1_epi8(b);
+    for (; end - start >= AVX2_WIDTH; start += AVX2_WIDTH) {
+        __m256i v = _mm256_loadu_si256((__m256i const*)start);
+        UINT m = (UINT)_mm256_movemask_epi8(_mm256_or_si256(
+            _mm256_cmpeq_epi8(v, va), _mm256_cmpeq_epi8(v, vb)));
+        if (m != 0) { return start + __builtin_ctz(m); }
+    }
+    return findByte2SSE2(start, end, a, b);
+}
+
+
+ATTR_AVX2
+static CHAR const* findAsteriskAVX2(CHAR const* start, CHAR const* end)
+{
+    return findByte2AVX2(start, end, '*', '*');
+}
+
+
+ATTR_AVX2
+static CHAR const* findLineEndAVX2(CHAR const* start, CHAR const* end)
+{
+    return findByte2AVX2(start, end, '\n', '\r');
+}
+
+
+ATTR_AVX2
+static CHAR const* findStringStopAVX2(CHAR const* start, CHAR const* end)
+{
+    return findByte2AVX2(start, end, '"', '\\');
+}
+
+
+ATTR_AVX2
+static CHAR const* findCharListStopAVX2(CHAR const* start, CHAR const* end)
+{
+    return findByte2AVX2(start, end, '\'', '\\');
+}
+
+
+ATTR_AVX2
+static CHAR const* findBlockStopAVX2(CHAR const* start, CHAR const* end)
+{
+    for (; end - start >= AVX2_WIDTH; start += AVX2_WIDTH) {
+        __m256i v = _mm256_loadu_si256((__m256i const*)start);
+        __m256i brace = _mm256_or_si256(
+            _mm256_cmpeq_epi8(v, _mm256_set1_epi8('{')),
+            _mm256_cmpeq_epi8(v, _mm256_set1_epi8('}')));
+        __m256i quote = _mm256_or_si256(
+            _mm256_cmpeq_epi8(v, _mm256_set1_epi8('"')),
+            _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\'')));
+        __m256i solidus = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('/'));
+        UINT m = (UINT)_mm256_movemask_epi8(
+            _mm256_or_si256(_mm256_or_si256(brace, quote), solidus));
+        if (m != 0) { return start + __builtin_ctz(m); }
+    }
+    return findBlockStopSSE2(start, end);
+}
+//END AVX2 Kernels
+#endif
+
+
+static LexScanKernel const g_scalar_kernel = {
+    LEX_SCAN_SCALAR,
+    skipSpaceScalar,
+    skipIdBodyScalar,
+    findAsteriskScalar,
+    findLineEndScalar,
+    findStringStopScalar,
+    findCharListStopScalar,
+    findBlockStopScalar,
+};
+
+#ifdef LEX_SCAN_X86
+static LexScanKernel const g_sse2_kernel = {
+    LEX_SCAN_SSE2,
+    skipSpaceSSE2,
+    skipIdBodySSE2,
+    findAsteriskSSE2,
+    findLineEndSSE2,
+    findStringStopSSE2,
+    findCharListStopSSE2,
+    findBlockStopSSE2,
+};
+
+static LexScanKernel const g_avx2_kernel = {
+    LEX_SCAN_AVX2,
+    skipSpaceAVX2,
+    skipIdBodyAVX2,
+    findAsteriskAVX2,
+    findLineEndAVX2,
+    findStringStopAVX2,
+    findCharListStopAVX2,
+    findBlockStopAVX2,
+};
+#endif
+
+//Specify the kind of scan kernels that Lexer::init() will select.
+LEX_SCAN_KIND g_lex_scan_kind = LEX_SCAN_AUTO;
+
+CHAR const* getLexScanKindName(LEX_SCAN_KIND kind)
+{
+    switch (kind) {
+    case LEX_SCAN_AUTO: return "auto";
+    case LEX_SCAN_SCALAR: return "scalar";
+    case LEX_SCAN_SSE2: return "sse2";
+    case LEX_SCAN_AVX2: return "avx2";
+    default: UNREACHABLE();
+    }
+    return nullptr;
+}
+
+
+LEX_SCAN_KIND initLexScanKernel(LEX_SCAN_KIND kind,
+                                OUT LexScanKernel * kernel)
+{
+    ASSERT0(kernel);
+    #ifdef LEX_SCAN_X86
+    __builtin_cpu_init();
+    bool has_avx2 = __builtin_cpu_supports("avx2");
+    bool has_sse2 = __builtin_cpu_supports("sse2");
+    if (kind == LEX_SCAN_AUTO) {
+        kind = has_avx2 ? LEX_SCAN_AVX2 :
+               has_sse2 ? LEX_SCAN_SSE2 : LEX_SCAN_SCALAR;
+    }
+    if (kind == LEX_SCAN_AVX2 && has_avx2) {
+        *kernel = g_avx2_kernel;
+        return LEX_SCAN_AVX2;
+    }
+    if ((kind == LEX_SCAN_AVX2 || kind == LEX_SCAN_SSE2) && has_sse2) {
+        *kernel = g_sse2_kernel;
+        return LEX_SCAN_SSE2;
+    }
+    #endif
+    *kernel = g_scalar_kernel;
+    return LEX_SCAN_SCALAR;
+}
+
+} //namespace xfe
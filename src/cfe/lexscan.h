@@ -0,0 +1,102 @@
+/*@
+Copyright (c) 2013-2021, Su Zhenyu steven.known@gmail.com
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the Su Zhenyu nor the names of its contributors
+      may be used to endorse or promote products derived from this software
+      without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+@*/
+#ifndef __LEX_SCAN_H__
+#define __LEX_SCAN_H__
+
+namespace xfe {
+
+//Character class of lexer.
+#define LEX_CC_SPACE 0x1 //' ', '\t'
+#define LEX_CC_ALPHA 0x2 //'a'-'z', 'A'-'Z', '_'
+#define LEX_CC_DIGIT 0x4 //'0'-'9'
+#define LEX_CC_ID (LEX_CC_ALPHA | LEX_CC_DIGIT)
+
+//Return true if 'c' belongs to any class in 'cc'.
+#define IS_LEX_CC(c, cc) ((g_lex_char_class[(BYTE)(c)] & (cc)) != 0)
+
+typedef enum _LEX_SCAN_KIND {
+    LEX_SCAN_AUTO = 0, //Select the best kernel that CPU supports.
+    LEX_SCAN_SCALAR,
+    LEX_SCAN_SSE2,
+    LEX_SCAN_AVX2,
+} LEX_SCAN_KIND;
+
+//Each kernel scans the character range [start, end), and returns the
+//position of the first character that stops the scanning. The kernel
+//returns 'end' if there is no such character.
+typedef CHAR const* (*LexScanFunc)(CHAR const* start, CHAR const* end);
+
+#define LEX_SCAN_kind(s) ((s)->kind)
+#define LEX_SCAN_skip_space(s) ((s)->skip_space)
+#define LEX_SCAN_skip_id_body(s) ((s)->skip_id_body)
+#define LEX_SCAN_find_asterisk(s) ((s)->find_asterisk)
+#define LEX_SCAN_find_line_end(s) ((s)->find_line_end)
+#define LEX_SCAN_find_string_stop(s) ((s)->find_string_stop)
+#define LEX_SCAN_find_char_list_stop(s) ((s)->find_char_list_stop)
+#define LEX_SCAN_find_block_stop(s) ((s)->find_block_stop)
+class LexScanKernel {
+public:
+    LEX_SCAN_KIND kind;
+
+    //Stop at the character that is neither ' ' nor '\t'.
+    LexScanFunc skip_space;
+
+    //Stop at the character that can not be part of identifier.
+    LexScanFunc skip_id_body;
+
+    //Stop at '*', used to find the end of block comment.
+    LexScanFunc find_asterisk;
+
+    //Stop at '\r' or '\n'.
+    LexScanFunc find_line_end;
+
+    //Stop at '"' or '\\'.
+    LexScanFunc find_string_stop;
+
+    //Stop at '\'' or '\\'.
+    LexScanFunc find_char_list_stop;
+
+    //Stop at '{', '}', '"', '\'' or '/', used to skip a block by matching
+    //the braces.
+    LexScanFunc find_block_stop;
+};
+
+//Exported Variables
+extern BYTE const g_lex_char_class[];
+extern LEX_SCAN_KIND g_lex_scan_kind; //kind of kernels used by Lexer::init().
+
+//Exported Functions
+//Select the scan kernels for lexer and record them in 'kernel'.
+//Return the kind of kernels actually selected, which will fall back to
+//scalar kernels if CPU does not support the given kind.
+LEX_SCAN_KIND initLexScanKernel(LEX_SCAN_KIND kind,
+                                OUT LexScanKernel * kernel);
+CHAR const* getLexScanKindName(LEX_SCAN_KIND kind);
+
+} //namespace xfe
+#endif
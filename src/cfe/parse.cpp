@@ -30,11 +30,14 @@ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 namespace xfe {
 
+#define g_tok_buf PARSER_tok_buf(g_cur_parser)
+#define g_realline2srcline PARSER_realline2srcline(g_cur_parser)
+#define g_dump_token PARSER_dump_token(g_cur_parser)
+
 bool g_enable_c99_declaration = true;
-xoc::LogMgr * g_logmgr = nullptr;
-static List<Cell*> g_cell_list;
-static xcom::Vector<UINT> g_realline2srcline;
-static bool g_dump_token = false;
+bool g_enable_prec_climbing = false;
+bool g_enable_lazy_fun_body = false;
+THREAD_LOCAL CParser * g_cur_parser = nullptr;
 
 static Tree * statement();
 static Tree * cast_exp();
@@ -44,60 +47,232 @@ static Tree * exp_list();
 static bool look_forward_token(INT num, ...);
 static INT suck_tok();
 static void suck_tok_to(INT placeholder, ...);
+static bool initBinOpTab();
+
+//
+//START TokenBuf
+//
+TokenBuf::TokenBuf()
+{
+    m_size = TOKEN_BUF_INIT_SIZE;
+    m_rec = (TokenRec*)::calloc(m_size, sizeof(TokenRec));
+    ASSERT0(m_rec);
+    clean();
+}
+
+
+TokenBuf::~TokenBuf()
+{
+    for (UINT i = 0; i < m_size; i++) {
+        if (m_rec[i].str != nullptr) {
+            ::free(m_rec[i].str);
+        }
+    }
+    ::free(m_rec);
+    m_rec = nullptr;
+}
 
-//Remove a token from head of list
-static size_t remove_head_tok()
+
+//Double the capacity, the records kept are moved to new buffer with their
+//absolute indices unchanged.
+void TokenBuf::grow()
+{
+    UINT newsize = m_size * 2;
+    TokenRec * newrec = (TokenRec*)::calloc(newsize, sizeof(TokenRec));
+    ASSERT0(newrec);
+    for (UINT i = m_start; i != m_tail; i++) {
+        TokenRec * r = getRec(i);
+        newrec[i & (newsize - 1)] = *r;
+        r->str = nullptr;
+    }
+    for (UINT i = 0; i < m_size; i++) {
+        if (m_rec[i].str != nullptr) {
+            ::free(m_rec[i].str);
+        }
+    }
+    ::free(m_rec);
+    m_rec = newrec;
+    m_size = newsize;
+}
+
+
+void TokenBuf::append(TOKEN tok, CHAR const* str, UINT len, UINT64 hash,
+                      UINT lineno)
 {
-    Cell * c = g_cell_list.remove_head();
-    if (c != nullptr) {
-        size_t v = (size_t)CELL_val(c);
-        free_cell(c);
-        return v;
+    if (m_tail - m_start == m_size) {
+        //Lookahead never exceeds the initial capacity, the buffer grows
+        //only if there are too many records after mark.
+        ASSERT0(is_marked());
+        grow();
+    }
+    TokenRec * r = getRec(m_tail);
+    if (r->cap <= len) {
+        //Reserve more room to reduce the times of reallocation.
+        r->cap = (len + 1) > 32 ? (len + 1) * 2 : 32;
+        r->str = (CHAR*)::realloc(r->str, r->cap);
+        ASSERT0(r->str);
     }
-    return 0;
+    ::memcpy(r->str, str, len);
+    r->str[len] = 0;
+    r->token = tok;
+    r->len = len;
+    r->hash = hash;
+    r->lineno = lineno;
+    m_tail++;
 }
 
 
+void TokenBuf::removeHead()
+{
+    ASSERT0(!is_empty());
+    m_head++;
+    if (!is_marked()) {
+        m_start = m_head;
+    }
+}
+
+
+UINT TokenBuf::mark()
+{
+    ASSERT0(!is_empty());
+    if (!is_marked()) {
+        m_start = m_head;
+    }
+    m_mark_num++;
+    return m_head;
+}
+
+
+void TokenBuf::rewind(UINT mark)
+{
+    ASSERT0(is_marked());
+    ASSERT0(mark - m_start <= m_tail - m_start);
+    m_head = mark;
+}
+
+
+void TokenBuf::release()
+{
+    ASSERT0(is_marked());
+    m_mark_num--;
+    if (!is_marked()) {
+        m_start = m_head;
+    }
+}
+//END TokenBuf
+
+
 static void setMapRealLineToSrcLine(UINT realline, UINT srcline)
 {
     g_realline2srcline.set(realline, srcline);
 }
 
 
-static TOKEN gettok()
+//Return the real line number of the token that lexer just scanned.
+static UINT get_real_line_num()
 {
-    TOKEN tok = getNextToken();
-    ASSERT0(tok == g_cur_token);
-    g_real_token = tok;
-    g_real_token_string = g_cur_token_string;
-    g_real_token_string_len = getCurTokenStringLen();
     ASSERT0(g_src_line_num >= g_disgarded_line_num);
-    g_real_line_num = g_src_line_num - g_disgarded_line_num;
+    UINT realline = g_src_line_num - g_disgarded_line_num;
     if (g_disgarded_line_num != 0) {
         //Map the real line to the line in input file, where input file
         //may be the output from preprocessor.
-        setMapRealLineToSrcLine(g_real_line_num, g_src_line_num);
+        setMapRealLineToSrcLine(realline, g_src_line_num);
     }
+    return realline;
+}
+
+
+static TOKEN gettok()
+{
+    TOKEN tok = g_cur_lexer->getNextToken();
+    ASSERT0(tok == g_cur_token);
+    g_real_token = tok;
+    g_real_token_text = g_cur_lexer->getCurTokenText();
+    PARSER_real_token_string(g_cur_parser) = nullptr;
+    g_real_token_string_len = g_cur_lexer->getCurTokenStringLen();
+    g_real_token_hash = g_cur_lexer->getCurTokenHash();
+    g_real_line_num = get_real_line_num();
     return g_real_token;
 }
 
 
+//Scan a token and append it to the tail of token buffer.
+static void fetch_tok()
+{
+    TOKEN tok = g_cur_lexer->getNextToken();
+    ASSERT0(tok == g_cur_token);
+    UINT len = g_cur_lexer->getCurTokenStringLen();
+    g_tok_buf.append(tok, g_cur_lexer->getCurTokenText(), len,
+                     g_cur_lexer->getCurTokenHash(), get_real_line_num());
+}
+
+
+//Set the current token with the head record of token buffer.
+static void set_cur_tok()
+{
+    TokenRec const* r = g_tok_buf.get(0);
+    g_real_token = r->token;
+    g_real_token_text = r->str;
+    PARSER_real_token_string(g_cur_parser) = r->str;
+    g_real_token_string_len = r->len;
+    g_real_token_hash = r->hash;
+    g_real_line_num = r->lineno;
+}
+
+
+//Save current token into token buffer if the buffer is empty, then the
+//string of current token keeps valid while lexer scanning the following
+//tokens.
+static void save_cur_tok()
+{
+    if (!g_tok_buf.is_empty()) { return; }
+    g_tok_buf.append(g_real_token, g_real_token_text,
+                     g_real_token_string_len, g_real_token_hash,
+                     g_real_line_num);
+    g_real_token_text = g_tok_buf.get(0)->str;
+    PARSER_real_token_string(g_cur_parser) = g_real_token_text;
+}
+
+
 static INT suck_tok()
 {
-    TokenInfo * tki = nullptr;
-    if ((tki = (TokenInfo*)remove_head_tok()) == nullptr) {
+    if (g_tok_buf.is_empty()) {
         gettok();
-    } else {
-        //Set the current token with head in token-info list
-        g_real_token_string = const_cast<CHAR*>(TOKEN_INFO_name(tki));
-        g_real_token = TOKEN_INFO_token(tki);
-        g_real_line_num = TOKEN_INFO_lineno(tki);
+        return ST_SUCC;
     }
-
+    g_tok_buf.removeHead();
+    if (g_tok_buf.is_empty()) {
+        if (!g_tok_buf.is_marked()) {
+            //Scan token directly if there is no need to keep it.
+            gettok();
+            return ST_SUCC;
+        }
+        fetch_tok();
+    }
+    set_cur_tok();
     return ST_SUCC;
 }
 
 
+//Record the position of current token.
+//The tokens after the mark can be parsed again by rewind_tok().
+static UINT mark_tok()
+{
+    save_cur_tok();
+    return g_tok_buf.mark();
+}
+
+
+//Restore current token to the token that 'mark' recorded, and release
+//the mark.
+static void rewind_tok(UINT mark)
+{
+    g_tok_buf.rewind(mark);
+    g_tok_buf.release();
+    set_cur_tok();
+}
+
+
 void CParser::setLogMgr(LogMgr * logmgr)
 {
     g_logmgr = logmgr;
@@ -124,22 +299,40 @@ bool CParser::isTerminateToken()
 //START CParser
 //
 //Initialize pool for parser.
-void CParser::init(xoc::LogMgr * lm, CHAR const* srcfile)
-{
-    ASSERT0(lm);
+void CParser::init(CompileCtx * ctx, xoc::LogMgr * lm, CHAR const* srcfile)
+{
+    ASSERT0(ctx && lm);
+    ASSERTN(CTX_parser(ctx) == nullptr, ("context is in use"));
+    m_ctx = ctx;
+    m_real_token_text = nullptr;
+    m_real_token_string = nullptr;
+    m_real_token_string_len = 0;
+    m_real_token_hash = 0;
+    m_real_token = T_UNDEF;
+    m_dump_token = false;
+    m_tok_buf.clean();
+    static bool s_is_binop_tab_init = initBinOpTab();
+    DUMMYUSE(s_is_binop_tab_init);
+    CTX_parser(ctx) = this;
+    setCurCompileCtx(ctx);
     setLogMgr(lm);
     g_scope_count = 0;
     g_tree_count = TREE_ID_UNDEF + 1;
     g_decl_count = DECL_ID_UNDEF + 1;
     g_aggr_count = AGGR_ID_UNDEF + 1;
     g_aggr_anony_name_count = AGGR_ANONY_ID_UNDEF + 1;
-    g_pool_general_used = smpoolCreate(256, MEM_COMM);
-    g_pool_tree_used = smpoolCreate(128, MEM_COMM);
-    g_pool_st_used = smpoolCreate(64, MEM_COMM);
+    if (g_pool_general_used == nullptr) {
+        //The pools may be kept by the parser of previous unit. The chunks
+        //are recycled through chunk cache, thus the units and the tasks
+        //compiled by any thread reuse them.
+        g_pool_general_used = smpoolCreateThreadCache(256);
+        g_pool_tree_used = smpoolCreateThreadCache(128);
+        g_pool_st_used = smpoolCreateThreadCache(64);
+    }
     if (!initSrcFile(srcfile)) {
         return;
     }
-    initLexer();
+    m_lexer.init();
     g_lab2lineno.init();
     g_lab_used.init();
 }
@@ -147,19 +340,41 @@ void CParser::init(xoc::LogMgr * lm, CHAR const* srcfile)
 
 void CParser::destroy()
 {
+    if (m_ctx == nullptr) { return; }
+    //Release the resource of the context of parser, which may not be the
+    //current context of thread.
+    CompileCtx * org = g_cur_ctx;
+    setCurCompileCtx(m_ctx);
     clean_free_cell_list();
     destroy_scope_list();
-    smpoolDelete(g_pool_general_used);
-    smpoolDelete(g_pool_tree_used);
-    smpoolDelete(g_pool_st_used);
-    g_pool_general_used = nullptr;
-    g_pool_tree_used = nullptr;
-    g_pool_st_used = nullptr;
-    finiLexer();
+    if (CTX_is_reuse_pool(m_ctx)) {
+        smpoolReset(g_pool_general_used);
+        smpoolReset(g_pool_tree_used);
+        smpoolReset(g_pool_st_used);
+    } else {
+        smpoolDelete(g_pool_general_used);
+        smpoolDelete(g_pool_tree_used);
+        smpoolDelete(g_pool_st_used);
+        g_pool_general_used = nullptr;
+        g_pool_tree_used = nullptr;
+        g_pool_st_used = nullptr;
+    }
+    for (SMemPool * p = CTX_task_pool_list(m_ctx).get_head();
+         p != nullptr; p = CTX_task_pool_list(m_ctx).get_next()) {
+        smpoolDelete(p);
+    }
+    CTX_task_pool_list(m_ctx).clean();
+    m_lexer.destroy();
     setLogMgr(nullptr);
     finiSrcFile();
     g_lab2lineno.destroy();
     g_lab_used.destroy();
+    CTX_parser(m_ctx) = nullptr;
+    m_ctx = nullptr;
+
+    //Note the context keeps being current if it was, since the diagnostic
+    //information is still available.
+    setCurCompileCtx(org);
 }
 
 
@@ -177,6 +392,7 @@ static bool verify(Tree * t)
     case TR_COND:
     case TR_LABEL:
     case TR_DECL:
+    case TR_DENSE_INIT:
         break;
     default: ASSERT0(TREE_token(t) != T_UNDEF && getTokenName(TREE_token(t)));
     }
@@ -236,6 +452,7 @@ static bool verify(Tree * t)
     case TR_SIZEOF:
     case TR_PREP:
     case TR_DECL:
+    case TR_DENSE_INIT:
         break;
     default: ASSERTN(0, ("unknown tree type:%d", t->getCode()));
     } //end switch
@@ -248,7 +465,7 @@ static bool verify(Tree * t)
 //append 'label' to tail of the list as correct,
 //otherwise return 'l'.
 //Add a label into outmost scope of current function.
-static LabelInfo * add_label(CHAR * name, INT lineno)
+static LabelInfo * add_label(CHAR const* name, INT lineno)
 {
     LabelInfo * li;
     Scope * sc = g_cur_scope;
@@ -278,7 +495,7 @@ static LabelInfo * add_label(CHAR * name, INT lineno)
 
 
 //Record a label reference into outmost scope of current function.
-static LabelInfo * add_ref_label(CHAR * name, INT lineno)
+static LabelInfo * add_ref_label(CHAR const* name, INT lineno)
 {
     LabelInfo * li;
     Scope * sc = g_cur_scope;
@@ -300,66 +517,14 @@ static LabelInfo * add_ref_label(CHAR * name, INT lineno)
 }
 
 
-//list operation
-//Append a token to tail of list
-static void append_c_tail(size_t v)
-{
-    //static Cell * g_cell_list_head=nullptr;
-    //static Cell * g_cell_list_tail=nullptr;
-    Cell * c = newcell(0);
-    CELL_val(c) = (LONGLONG)v;
-    CELL_line_no(c) = g_src_line_num;
-    g_cell_list.append_tail(c);
-}
-
-
-//Append a token to head of list
-static void append_c_head(size_t v)
-{
-    Cell * c = newcell(0);
-    CELL_val(c) = (LONGLONG)v;
-    CELL_line_no(c) = g_src_line_num;
-    g_cell_list.append_head(c);
-}
-
-
-//Append current token info described by 'g_cur_token','g_cur_token_string'
-//and 'g_src_line_num'
-static void append_tok_tail(TOKEN tok, CHAR * tokname, INT lineno)
-{
-    TokenInfo * tki = (TokenInfo*)xmalloc(sizeof(TokenInfo));
-    Sym const* s = g_fe_sym_tab->add(tokname);
-    TOKEN_INFO_name(tki) = SYM_name(s);
-    TOKEN_INFO_token(tki) = tok;
-    TOKEN_INFO_lineno(tki) = lineno;
-    append_c_tail((size_t)tki);
-}
-
-
-//Append current token info descripte by 'g_cur_token','g_cur_token_string'
-//and 'g_src_line_num'
-static void append_tok_head(TOKEN tok, CHAR const* tokname, INT lineno)
-{
-    TokenInfo * tki = (TokenInfo*)xmalloc(sizeof(TokenInfo));
-    Sym const* s = g_fe_sym_tab->add(tokname);
-    TOKEN_INFO_name(tki) = SYM_name(s);
-    TOKEN_INFO_token(tki) = tok;
-    TOKEN_INFO_lineno(tki) = lineno;
-    append_c_head((size_t)tki);
-}
-
-
 void CParser::dump_tok_list()
 {
-    Cell * c = g_cell_list.get_head();
-    if (c != nullptr) {
-        prt("\nTOKEN:");
-        for (; c; c = g_cell_list.get_next()) {
-            CHAR const* s = TOKEN_INFO_name((TokenInfo*)CELL_val(c));
-            prt("'%s' ", s);
-        }
-        prt("\n");
+    if (g_tok_buf.is_empty()) { return; }
+    prt("\nTOKEN:");
+    for (UINT i = 0; i < g_tok_buf.getNum(); i++) {
+        prt("'%s' ", g_tok_buf.get(i)->str);
     }
+    prt("\n");
 }
 
 
@@ -375,7 +540,7 @@ bool CParser::inFirstSetOfExp(TOKEN tok)
     Decl * ut = nullptr;
     switch (tok) {
     case T_ID:
-        if (isUserTypeExistInOuterScope(g_real_token_string, &ut)) {
+        if (isUserTypeExistInOuterScope(findTokenSym(), &ut)) {
             //If there is a type-name, then it
             //belongs to first-set of declarator.
             return false;
@@ -467,7 +632,7 @@ bool Tree::is_stor_spec(TOKEN tok)
 
 
 //Find if ID with named 'cl' exists and return the Decl.
-static bool isIdExistInOuterScope(CHAR const* cl, OUT Decl ** d)
+static bool isIdExistInOuterScope(Sym const* cl, OUT Decl ** d)
 {
     return isDeclExistInOuterScope(cl, d);
 }
@@ -550,10 +715,37 @@ FIN:
 }
 
 
+Sym const* CParser::addTokenToSymTab()
+{
+    if (g_real_token == T_ID) {
+        return g_fe_sym_tab->add(g_real_token_text, g_real_token_string_len,
+                                 g_real_token_hash);
+    }
+    return g_fe_sym_tab->add(g_real_token_string);
+}
+
+
+Sym const* CParser::findTokenSym()
+{
+    ASSERT0(g_real_token == T_ID);
+    return g_fe_sym_tab->find(g_real_token_text, g_real_token_string_len,
+                              g_real_token_hash);
+}
+
+
+CHAR const* CParser::getRealTokenString()
+{
+    if (m_real_token_string == nullptr) {
+        //The token is still the current token of lexer.
+        m_real_token_string = g_cur_lexer->getCurTokenString();
+    }
+    return m_real_token_string;
+}
+
+
 Tree * CParser::id()
 {
-    Sym const* sym = g_fe_sym_tab->add(g_real_token_string);
-    return id(sym, g_real_token);
+    return id(addTokenToSymTab(), g_real_token);
 }
 
 
@@ -572,21 +764,6 @@ UINT CParser::mapRealLineToSrcLine(UINT realline)
 }
 
 
-static TOKEN reset_tok()
-{
-    TokenInfo * tki = nullptr;
-    if ((tki = (TokenInfo*)remove_head_tok()) == nullptr) {
-        return g_real_token;
-    }
-
-    //Set the current token with the head element in token_list.
-    g_real_token_string = const_cast<CHAR*>(TOKEN_INFO_name(tki));
-    g_real_token = TOKEN_INFO_token(tki);
-    g_real_line_num = TOKEN_INFO_lineno(tki);
-    return g_real_token;
-}
-
-
 STATUS CParser::match(TOKEN tok)
 {
     if (g_real_token == tok) {
@@ -602,70 +779,33 @@ STATUS CParser::match(TOKEN tok)
 }
 
 
-//Pry next 'num' token info.
+//Pry the n-th token after current token.
 //n: represent the next N token to current token.
 //   If n is 0, it will return current token.
+//Return the terminal token if src file ends before the n-th token.
 static TOKEN look_next_token(INT n,
                              OUT CHAR ** tok_string,
                              OUT UINT * tok_line_num)
 {
-    TOKEN tok = T_UNDEF;
     if (n < 0) { return T_UNDEF; }
-
     if (n == 0) { return g_real_token; }
-
-    INT count = g_cell_list.get_elem_count();
-    if (count > 0) {
-        //Pry in token_buffer
-        if (n <= count) {
-            //'n' can be finded in token-buffer
-            Cell * c = g_cell_list.get_head_nth(n - 1);
-            ASSERT0(c);
-            return TOKEN_INFO_token((TokenInfo*)CELL_val(c));
-        }
-
-        //New tokens need to be fetched into the buffer.
-        n -= count;
-        //Restore current token into token-buffer
-        append_tok_head(g_real_token, g_real_token_string, g_real_line_num);
-        while (n > 0) {
-            //get new token from file
-            gettok();
-            tok = g_real_token;
-            if (CParser::isTerminateToken()) {
-                reset_tok();
-                return g_real_token;
-            }
-            append_tok_tail(g_real_token, g_real_token_string, g_real_line_num);
-            n--;
+    save_cur_tok();
+    while (g_tok_buf.getNum() <= (UINT)n) {
+        TOKEN last = g_tok_buf.get(g_tok_buf.getNum() - 1)->token;
+        if (last == T_END || last == T_UNDEF) {
+            n = g_tok_buf.getNum() - 1;
+            break;
         }
-
-        reset_tok();
-        return tok;
+        fetch_tok();
     }
-
-    //For now, count == 0
-    //Fetch a number of n tokens into the buffer
-    append_tok_tail(g_real_token, g_real_token_string, g_real_line_num);
-    while (n > 0) {
-        gettok();
-        tok = g_real_token;
-        if (tok_string != nullptr) {
-            *tok_string = g_real_token_string;
-        }
-        if (tok_line_num != nullptr) {
-            *tok_line_num = g_real_line_num;
-        }
-        if (CParser::isTerminateToken()) {
-            reset_tok();
-            return g_real_token;
-        }
-        append_tok_tail(g_real_token, g_real_token_string, g_real_line_num);
-        n--;
+    TokenRec const* r = g_tok_buf.get(n);
+    if (tok_string != nullptr) {
+        *tok_string = r->str;
     }
-
-    reset_tok();
-    return tok;
+    if (tok_line_num != nullptr) {
+        *tok_line_num = r->lineno;
+    }
+    return r->token;
 }
 
 
@@ -673,7 +813,7 @@ static TOKEN look_next_token(INT n,
 //'...': represent a token list which will to match.
 static bool look_forward_token(INT num, ...)
 {
-    if (num <= 0) { return 0; }
+    if (num <= 0) { return false; }
     va_list arg;
     va_start(arg, num);
     TOKEN v = (TOKEN)va_arg(arg, INT);
@@ -681,48 +821,21 @@ static bool look_forward_token(INT num, ...)
         va_end(arg);
         return g_real_token == v;
     }
-    Cell * c = g_cell_list.get_head();
-    if (c != nullptr) {
-        //append current real token to 'token-list'
-        append_tok_head(g_real_token, g_real_token_string, g_real_line_num);
-
-        //Restart again.
-        c = g_cell_list.get_head();
-        while (num > 0) {
-            if (c) { //match element resided in token_list.
-                TokenInfo * tki = (TokenInfo*)CELL_val(c);
-                if (TOKEN_INFO_token(tki) != v) {
-                    goto UNMATCH;
-                }
-                c = g_cell_list.get_next();
-            } else { //fetch new token to match.
-                gettok();
-                append_tok_tail(g_real_token, g_real_token_string,
-                                g_real_line_num);
-                if (g_real_token != v) {
-                    goto UNMATCH;
-                }
-            }
-            v = (TOKEN)va_arg(arg, INT);
-            num--;
-        }
-    } else {
-        //token_list is empty. So fetch new token to match.
-        while (num > 0) {
-            append_tok_tail(g_real_token, g_real_token_string, g_real_line_num);
-            if (g_real_token != v) { goto UNMATCH; }
-            gettok();
-            v = (TOKEN)va_arg(arg, INT);
-            num--;
+    UINT mark = mark_tok();
+    bool is_match = true;
+    for (;;) {
+        if (g_real_token != v) {
+            is_match = false;
+            break;
         }
-        append_tok_tail(g_real_token, g_real_token_string, g_real_line_num);
+        num--;
+        if (num == 0 || CParser::isTerminateToken()) { break; }
+        suck_tok();
+        v = (TOKEN)va_arg(arg, INT);
     }
     va_end(arg);
-    reset_tok();
-    return true;
-UNMATCH:
-    reset_tok();
-    return false;
+    rewind_tok(mark);
+    return is_match && num == 0;
 }
 
 
@@ -804,7 +917,8 @@ static Tree * primary_exp(MOD UINT * st)
     case T_ID: {
         Enum * e = nullptr;
         INT idx = 0;
-        if (findEnumVal(g_real_token_string, &e, &idx)) {
+        Sym const* sym = CParser::findTokenSym();
+        if (findEnumVal(sym, &e, &idx)) {
             t = NEWTN(TR_ENUM_CONST);
             TREE_enum(t) = e;
             TREE_enum_val_idx(t) = idx;
@@ -813,7 +927,7 @@ static Tree * primary_exp(MOD UINT * st)
             //parsed during declaration().
             Decl * dcl = nullptr;
             t = CParser::id();
-            if (!isIdExistInOuterScope(g_real_token_string, &dcl)) {
+            if (!isIdExistInOuterScope(sym, &dcl)) {
                 err(g_real_line_num, "'%s' undeclared identifier",
                     g_real_token_string);
                 CParser::match(T_ID);
@@ -1622,10 +1736,136 @@ FAILED:
 }
 
 
+//The precedence of binary operator, a greater value binds tighter.
+//Each precedence corresponds to one function of the recursive descent chain
+//from logical_OR_exp() to multiplicative_exp().
+typedef enum {
+    BINOP_PREC_UNDEF = 0, //not a binary operator.
+    BINOP_PREC_LOGICAL_OR,
+    BINOP_PREC_LOGICAL_AND,
+    BINOP_PREC_INCLUSIVE_OR,
+    BINOP_PREC_EXCLUSIVE_OR,
+    BINOP_PREC_AND,
+    BINOP_PREC_EQUALITY,
+    BINOP_PREC_RELATIONAL,
+    BINOP_PREC_SHIFT,
+    BINOP_PREC_ADDITIVE,
+    BINOP_PREC_MULTIPLICATIVE,
+    BINOP_PREC_NUM,
+} BINOP_PREC;
+
+#define BINOP_INFO_prec(bi) ((bi)->prec)
+#define BINOP_INFO_code(bi) ((bi)->code)
+class BinOpInfo {
+public:
+    BINOP_PREC prec;
+    TREE_CODE code;
+};
+
+//Map token to binary operator, it is indexed by TOKEN.
+static BinOpInfo g_binop_tab[T_END + 1];
+
+//The name of recursive descent function of each precedence.
+static CHAR const* g_binop_prec_name[] = {
+    "",
+    "logical_OR_exp",
+    "logical_AND_exp",
+    "inclusive_OR_exp",
+    "exclusive_OR_exp",
+    "AND_exp",
+    "equality_exp",
+    "relational_exp",
+    "shift_exp",
+    "additive_exp",
+    "multiplicative_exp",
+};
+
+
+static void setBinOp(TOKEN tok, BINOP_PREC prec, TREE_CODE code)
+{
+    BINOP_INFO_prec(&g_binop_tab[tok]) = prec;
+    BINOP_INFO_code(&g_binop_tab[tok]) = code;
+}
+
+
+static bool initBinOpTab()
+{
+    ASSERT0(sizeof(g_binop_prec_name) / sizeof(g_binop_prec_name[0]) ==
+            BINOP_PREC_NUM);
+    for (UINT i = 0; i <= T_END; i++) {
+        setBinOp((TOKEN)i, BINOP_PREC_UNDEF, TR_NUL);
+    }
+    setBinOp(T_OR, BINOP_PREC_LOGICAL_OR, TR_LOGIC_OR);
+    setBinOp(T_AND, BINOP_PREC_LOGICAL_AND, TR_LOGIC_AND);
+    setBinOp(T_BITOR, BINOP_PREC_INCLUSIVE_OR, TR_INCLUSIVE_OR);
+    setBinOp(T_XOR, BINOP_PREC_EXCLUSIVE_OR, TR_XOR);
+    setBinOp(T_BITAND, BINOP_PREC_AND, TR_INCLUSIVE_AND);
+    setBinOp(T_EQU, BINOP_PREC_EQUALITY, TR_EQUALITY);
+    setBinOp(T_NOEQU, BINOP_PREC_EQUALITY, TR_EQUALITY);
+    setBinOp(T_LESSTHAN, BINOP_PREC_RELATIONAL, TR_RELATION);
+    setBinOp(T_MORETHAN, BINOP_PREC_RELATIONAL, TR_RELATION);
+    setBinOp(T_NOMORETHAN, BINOP_PREC_RELATIONAL, TR_RELATION);
+    setBinOp(T_NOLESSTHAN, BINOP_PREC_RELATIONAL, TR_RELATION);
+    setBinOp(T_LSHIFT, BINOP_PREC_SHIFT, TR_SHIFT);
+    setBinOp(T_RSHIFT, BINOP_PREC_SHIFT, TR_SHIFT);
+    setBinOp(T_ADD, BINOP_PREC_ADDITIVE, TR_ADDITIVE);
+    setBinOp(T_SUB, BINOP_PREC_ADDITIVE, TR_ADDITIVE);
+    setBinOp(T_ASTERISK, BINOP_PREC_MULTIPLICATIVE, TR_MULTI);
+    setBinOp(T_DIV, BINOP_PREC_MULTIPLICATIVE, TR_MULTI);
+    setBinOp(T_MOD, BINOP_PREC_MULTIPLICATIVE, TR_MULTI);
+    return true;
+}
+
+
+//Parse the binary expression by precedence climbing, the operators of the
+//expression bind not looser than 'prec'. If 'prec' is BINOP_PREC_NUM, the
+//function parses cast expression only.
+//The function builds the same trees, in the same order, as the recursive
+//descent chain that starts at the function of 'prec', e.g: a+b-c is
+//left-associated as (a+b)-c. Operators are also accepted in the same way
+//when right operand is missing.
+static Tree * binary_exp(BINOP_PREC prec)
+{
+    ASSERT0(prec > BINOP_PREC_UNDEF && prec <= BINOP_PREC_NUM);
+    Tree * t = cast_exp();
+    if (t == nullptr) { return nullptr; }
+
+    //The tightest precedence that next operator may have. Once an operator
+    //of precedence P has been parsed, the descent functions tighter than P
+    //have returned, thus only operators not tighter than P are acceptable.
+    INT maxprec = BINOP_PREC_NUM - 1;
+    for (;;) {
+        BinOpInfo const* bi = &g_binop_tab[g_real_token];
+        INT opprec = BINOP_INFO_prec(bi);
+        if (opprec < prec || opprec > maxprec) { break; }
+        Tree * p = NEWTN(BINOP_INFO_code(bi));
+        TREE_token(p) = g_real_token;
+        TREE_lchild(p) = t;
+        Tree::setParent(p, TREE_lchild(p));
+        CParser::match(g_real_token);
+        TREE_rchild(p) = binary_exp((BINOP_PREC)(opprec + 1));
+        Tree::setParent(p, TREE_rchild(p));
+        if (TREE_rchild(p) == nullptr) {
+            err(g_real_line_num, "'%s': right operand cannot be nullptr",
+                TOKEN_INFO_name(get_token_info(TREE_token(p))));
+            prt("error in %s()", g_binop_prec_name[opprec]);
+
+            //The descent function of 'opprec' returns its left operand.
+            maxprec = opprec - 1;
+            continue;
+        }
+        maxprec = opprec;
+        t = p;
+    }
+    return t;
+}
+
+
 //logical_OR_expression ? expression : conditional_expression
 Tree * CParser::conditional_exp()
 {
-    Tree * t = logical_OR_exp();
+    Tree * t = g_enable_prec_climbing ?
+        binary_exp(BINOP_PREC_LOGICAL_OR) : logical_OR_exp();
     if (g_real_token == T_QUES_MARK) {
         CParser::match(T_QUES_MARK);
         Tree * p = NEWTN(TR_COND);
@@ -1781,7 +2021,7 @@ static TokenList * matchTokenTillNewLine()
             TL_imm(tl) = (UINT)xcom::xatoll(g_real_token_string, false);
             break;
         case T_ID:
-            TL_id_name(tl) = g_fe_sym_tab->add(g_real_token_string);
+            TL_id_name(tl) = CParser::addTokenToSymTab();
             break;
         case T_STRING:
             TL_str(tl) = g_fe_sym_tab->add(g_real_token_string);
@@ -2185,7 +2425,6 @@ static Tree * select_stmt()
 //Append parameters to declaration list of function body scope.
 static bool append_parameters(Scope * cur_scope, Decl const* para_list)
 {
-    Decl * lastdcl = xcom::get_last(cur_scope->getDeclList());
     UINT pos = 0;
     for (; para_list != nullptr; para_list = DECL_next(para_list), pos++) {
         if (para_list->is_dt_var()) {
@@ -2210,12 +2449,9 @@ static bool append_parameters(Scope * cur_scope, Decl const* para_list)
         }
 
         DECL_is_formal_param(declaration) = true;
-        xcom::add_next(&SCOPE_decl_list(cur_scope), &lastdcl, declaration);
-        DECL_decl_scope(declaration) = cur_scope;
+        cur_scope->addDecl(declaration);
         DECL_formal_param_pos(declaration) = pos;
 
-        lastdcl = declaration;
-
         //Append parameter list to symbol list of function body scope.
         Sym const* sym = declaration->getDeclSym();
         if (g_cur_scope->addToSymList(sym) != nullptr) {
@@ -2624,9 +2860,9 @@ static Tree * dispatch()
 bool CParser::initSrcFile(CHAR const* fn)
 {
     ASSERT0(fn);
-    ASSERT0(g_hsrc == nullptr);
-    g_hsrc = ::fopen(fn, "rb");
-    if (g_hsrc == nullptr) {
+    ASSERT0(LEX_hsrc(&m_lexer) == nullptr);
+    LEX_hsrc(&m_lexer) = ::fopen(fn, "rb");
+    if (LEX_hsrc(&m_lexer) == nullptr) {
         char const* msg = ::strerror(errno);
         err(0, "cannot open %s, error information is %s\n", fn, msg);
         return false;
@@ -2637,13 +2873,42 @@ bool CParser::initSrcFile(CHAR const* fn)
 
 void CParser::finiSrcFile()
 {
-    if (g_hsrc != nullptr) {
-        ::fclose(g_hsrc);
-        g_hsrc = nullptr;
+    if (LEX_hsrc(&m_lexer) != nullptr) {
+        ::fclose(LEX_hsrc(&m_lexer));
+        LEX_hsrc(&m_lexer) = nullptr;
     }
 }
 
 
+LazyFunBody * CParser::skipFunBody()
+{
+    ASSERT0(g_real_token == T_LLPAREN);
+    if (g_tok_buf.getNum() > 1 || g_tok_buf.is_marked()) {
+        //Lexer has scanned the tokens after '{', or the tokens may be
+        //parsed again.
+        return nullptr;
+    }
+    if (g_cur_lexer->getSrcBuf(nullptr) == nullptr) {
+        //The body can not be scanned again.
+        return nullptr;
+    }
+    LexPos begin;
+    UINT end = 0;
+    if (!g_cur_lexer->skipBlock(&begin, &end)) {
+        return nullptr;
+    }
+    LazyFunBody * body = (LazyFunBody*)xmalloc(sizeof(LazyFunBody));
+    LAZY_FUN_BODY_begin(body) = begin;
+    LAZY_FUN_BODY_end(body) = end;
+    LAZY_FUN_BODY_align(body) = g_alignment;
+    LAZY_FUN_BODY_visible_seq(body) = CTX_scope_obj_seq(g_cur_ctx);
+    LAZY_FUN_BODY_complete_aggr_num(body) =
+        CTX_complete_aggr_vec(g_cur_ctx).get_elem_count();
+    suck_tok();
+    return body;
+}
+
+
 //Start to parse a file.
 STATUS CParser::perform()
 {
@@ -2707,4 +2972,41 @@ STATUS CParser::perform()
 }
 //END CParser
 
+
+//
+//START LazyFunBodyScanner
+//
+LazyFunBodyScanner::LazyFunBodyScanner(LazyFunBody const* body)
+{
+    ASSERT0(body && g_cur_parser);
+    ASSERTN(g_tok_buf.getNum() <= 1 && !g_tok_buf.is_marked(),
+            ("parser is looking ahead"));
+    m_org_lexer = g_cur_lexer;
+    m_org_token_text = g_real_token_text;
+    m_org_token_string = PARSER_real_token_string(g_cur_parser);
+    m_org_token_string_len = g_real_token_string_len;
+    m_org_token_hash = g_real_token_hash;
+    m_org_token = g_real_token;
+    m_lexer.initAt(*m_org_lexer, LAZY_FUN_BODY_begin(body),
+                   LAZY_FUN_BODY_end(body));
+    g_cur_lexer = &m_lexer;
+    g_tok_buf.clean();
+    gettok();
+    ASSERT0(g_real_token == T_LLPAREN);
+}
+
+
+LazyFunBodyScanner::~LazyFunBodyScanner()
+{
+    ASSERT0(!g_tok_buf.is_marked());
+    g_tok_buf.clean();
+    g_cur_lexer = m_org_lexer;
+    g_real_token_text = m_org_token_text;
+    PARSER_real_token_string(g_cur_parser) = m_org_token_string;
+    g_real_token_string_len = m_org_token_string_len;
+    g_real_token_hash = m_org_token_hash;
+    g_real_token = m_org_token;
+}
+//END LazyFunBodyScanner
+
 } //namespace xfe
@@ -30,12 +30,110 @@ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 namespace xfe {
 
+class CompileCtx;
+
+//The record of token that parser has prefetched.
+class TokenRec {
+public:
+    TOKEN token;
+    UINT lineno;
+    UINT len; //the byte length of 'str', '\0' may be part of string.
+    UINT64 hash; //the hash value of identifier, only valid for T_ID.
+    UINT cap; //the byte size of the buffer that 'str' pointed to.
+    CHAR * str;
+};
+
+
+//TokenBuf is a circular buffer of prefetched tokens.
+//If the buffer is not empty, the head record describes the current token
+//of parser, and the following records are the lookahead tokens.
+//The string of token is copied into the buffer of record that is reused
+//round by round, thus peeking token neither allocates memory nor interns
+//the string.
+//The buffer also supports mark/rewind. The records after the outermost
+//mark are kept until the mark is released, and the buffer grows if the
+//records kept exceed the capacity.
+#define TOKEN_BUF_INIT_SIZE 16 //must be power of 2.
+class TokenBuf {
+    COPY_CONSTRUCTOR(TokenBuf);
+    TokenRec * m_rec;
+    UINT m_size; //the number of records, always power of 2.
+    //The following indices are absolute, and they are mapped to record
+    //by masking the low bits, thus wrap-around is harmless.
+    UINT m_head; //the index of current token.
+    UINT m_tail; //the index of next free record.
+    UINT m_start; //the index of the oldest record kept.
+    UINT m_mark_num; //the number of marks that are not released.
+
+    void grow();
+    TokenRec * getRec(UINT idx) const { return &m_rec[idx & (m_size - 1)]; }
+public:
+    TokenBuf();
+    ~TokenBuf();
+
+    //Append a token to the tail of buffer.
+    void append(TOKEN tok, CHAR const* str, UINT len, UINT64 hash,
+                UINT lineno);
+
+    //Drop all records and marks.
+    void clean() { m_head = m_tail = m_start = 0; m_mark_num = 0; }
+
+    //Return the n-th record after head.
+    TokenRec const* get(UINT n) const
+    { ASSERT0(n < getNum()); return getRec(m_head + n); }
+    UINT getNum() const { return m_tail - m_head; }
+
+    bool is_empty() const { return m_head == m_tail; }
+    bool is_marked() const { return m_mark_num != 0; }
+
+    //Return the mark of head. The records after the mark are kept until
+    //release() is invoked.
+    UINT mark();
+
+    void release();
+    void removeHead();
+
+    //Move head back to the record that 'mark' indicated.
+    void rewind(UINT mark);
+};
+
+
+//CParser holds the parsing state of one src file. The parser and its lexer
+//become the current ones of the thread that constructs the parser.
+#define PARSER_ctx(p) ((p)->m_ctx)
+#define PARSER_lexer(p) ((p)->m_lexer)
+#define PARSER_tok_buf(p) ((p)->m_tok_buf)
+#define PARSER_realline2srcline(p) ((p)->m_realline2srcline)
+#define PARSER_real_token_text(p) ((p)->m_real_token_text)
+#define PARSER_real_token_string(p) ((p)->m_real_token_string)
+#define PARSER_real_token_string_len(p) ((p)->m_real_token_string_len)
+#define PARSER_real_token_hash(p) ((p)->m_real_token_hash)
+#define PARSER_real_token(p) ((p)->m_real_token)
+#define PARSER_dump_token(p) ((p)->m_dump_token)
 class CParser {
     COPY_CONSTRUCTOR(CParser);
     bool initSrcFile(CHAR const* fn);
     void finiSrcFile();
 public:
-    CParser(xoc::LogMgr * lm, CHAR const* srcfile) { init(lm, srcfile); }
+    CompileCtx * m_ctx;
+    Lexer m_lexer;
+    TokenBuf m_tok_buf; //current token and lookahead tokens.
+    xcom::Vector<UINT> m_realline2srcline;
+    //The text of current token. It may refer to the spelling in src
+    //buffer, thus it is not always terminated by '\0'.
+    CHAR const* m_real_token_text;
+
+    //The string of current token that terminated by '\0', it is built
+    //from the text on demand. It is nullptr if the string has not been
+    //built, then the token is still the current token of lexer.
+    CHAR const* m_real_token_string;
+    UINT m_real_token_string_len;
+    UINT64 m_real_token_hash; //the hash value of current T_ID.
+    TOKEN m_real_token;
+    bool m_dump_token;
+public:
+    CParser(CompileCtx * ctx, xoc::LogMgr * lm, CHAR const* srcfile)
+    { init(ctx, lm, srcfile); }
     ~CParser() { destroy(); }
 
     static Tree * conditional_exp();
@@ -46,9 +144,20 @@ public:
 
     static Tree * exp();
 
-    void init(xoc::LogMgr * lm, CHAR const* srcfile);
+    void init(CompileCtx * ctx, xoc::LogMgr * lm, CHAR const* srcfile);
     static Tree * id();
     static Tree * id(Sym const* name, TOKEN tok);
+
+    //Add the string of current token into symbol table.
+    //The hash value of identifier has been computed by lexer.
+    static Sym const* addTokenToSymTab();
+
+    //Return the symbol of current T_ID if it has been added into symbol
+    //table, otherwise return nullptr. The string of token is not required.
+    static Sym const* findTokenSym();
+
+    //Return the string of current token, the string is built on demand.
+    CHAR const* getRealTokenString();
     static bool isTerminateToken();
     //Return true if 'tok' indicate terminal charactor, otherwise false.
     static bool inFirstSetOfExp(TOKEN tok);
@@ -62,16 +171,44 @@ public:
 
     //Start to parse a file.
     STATUS perform();
+
+    //Skip the function body that begins with current token '{' and record
+    //its range, then the token after the body becomes current token.
+    //Return nullptr if the body can not be skipped, it should be parsed
+    //right now.
+    static LazyFunBody * skipFunBody();
+};
+
+
+//LazyFunBodyScanner makes the parser of current thread scan the function
+//body that has been skipped by lazy parsing, the current token of parser
+//becomes the '{' of body. The lexer and the current token of parser are
+//restored when the scanner is destructed.
+//NOTE: the parser must not be looking ahead, e.g: it has finished parsing.
+class LazyFunBodyScanner {
+    COPY_CONSTRUCTOR(LazyFunBodyScanner);
+    Lexer m_lexer;
+    Lexer * m_org_lexer;
+    CHAR const* m_org_token_text;
+    CHAR const* m_org_token_string;
+    UINT m_org_token_string_len;
+    UINT64 m_org_token_hash;
+    TOKEN m_org_token;
+public:
+    explicit LazyFunBodyScanner(LazyFunBody const* body);
+    ~LazyFunBodyScanner();
 };
 
 //Exported Variables
-extern CHAR * g_real_token_string;
-extern TOKEN g_real_token;
-extern SMemPool * g_pool_general_used;
-extern SMemPool * g_pool_tree_used; //front end
-extern SMemPool * g_pool_st_used;
-extern CLSymTab * g_fe_sym_tab;
-extern LogMgr * g_logmgr; //the file handler of log file.
+//The parser that current thread is working on.
+extern THREAD_LOCAL CParser * g_cur_parser;
+
+//The following names refer to the state of the parser of current thread.
+#define g_real_token_text PARSER_real_token_text(g_cur_parser)
+#define g_real_token_string (g_cur_parser->getRealTokenString())
+#define g_real_token_string_len PARSER_real_token_string_len(g_cur_parser)
+#define g_real_token_hash PARSER_real_token_hash(g_cur_parser)
+#define g_real_token PARSER_real_token(g_cur_parser)
 
 } //namespace xfe
 #endif
@@ -29,14 +29,6 @@ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 namespace xfe {
 
-//The outermost scope is global region which id is 0, and the inner
-//scope scope is function body-stmt which id starts at 1, etc.
-Scope * g_cur_scope = nullptr;
-xcom::List<Scope*> g_scope_list;
-UINT g_scope_count = 0;
-Label2Lineno g_lab2lineno;
-xcom::TTab<xoc::LabelInfo const*> g_lab_used;
-
 static void * xmalloc(size_t size)
 {
     void * p = smpoolMalloc(size, g_pool_general_used);
@@ -46,6 +38,55 @@ static void * xmalloc(size_t size)
 }
 
 
+//The initial bucket size of the name index of scope.
+#define SCOPE_SYM_IDX_INIT_SIZE 16
+
+//Append 'obj' to the tail of 'chain'.
+static void append_sym_chain(MOD SymChain ** chain, void * obj, INT idx)
+{
+    SymChain * c = (SymChain*)xmalloc(sizeof(SymChain));
+    SYM_CHAIN_obj(c) = obj;
+    SYM_CHAIN_idx(c) = idx;
+    SYM_CHAIN_seq(c) = ++CTX_scope_obj_seq(g_cur_ctx);
+    SymChain ** p = chain;
+    while (*p != nullptr) { p = &SYM_CHAIN_next(*p); }
+    *p = c;
+}
+
+
+//Return true if the object in 'c' of scope 'sc' is visible to lookup.
+//When parsing the function body that has been skipped by lazy parsing,
+//the objects added into global scope after the body are invisible.
+static inline bool is_visible(Scope const* sc, SymChain const* c)
+{
+    UINT limit = CTX_visible_seq(g_cur_ctx);
+    return limit == 0 || SCOPE_level(sc) != GLOBAL_SCOPE ||
+           SYM_CHAIN_seq(c) <= limit;
+}
+
+
+//Return true if 'obj' is in 'chain'.
+static bool is_in_sym_chain(SymChain const* chain, void const* obj)
+{
+    for (; chain != nullptr; chain = SYM_CHAIN_next(chain)) {
+        if (SYM_CHAIN_obj(chain) == obj) { return true; }
+    }
+    return false;
+}
+
+
+//Return the symbol of 'name' if it has been added into g_fe_sym_tab,
+//otherwise return nullptr.
+//Note each name of declaration, type-name, enum and aggregate tag has been
+//added into g_fe_sym_tab, thus the name that is not in g_fe_sym_tab can not
+//be found in any scope.
+Sym const* find_sym(CHAR const* name)
+{
+    if (name == nullptr) { return nullptr; }
+    return g_fe_sym_tab->find(name);
+}
+
+
 //
 //START Scope
 //
@@ -61,6 +102,7 @@ void Scope::init(UINT & sc)
     SCOPE_nsibling(this) = nullptr;
     SCOPE_sub(this)  = nullptr;
     SCOPE_enum_tab(this) = new EnumTab();
+    SCOPE_sym_idx(this) = nullptr;
 }
 
 void Scope::destroy()
@@ -71,13 +113,125 @@ void Scope::destroy()
     SCOPE_union_list(this).destroy();
     delete SCOPE_enum_tab(this);
     SCOPE_enum_tab(this) = nullptr;
+    if (SCOPE_sym_idx(this) != nullptr) {
+        delete SCOPE_sym_idx(this);
+        SCOPE_sym_idx(this) = nullptr;
+    }
+}
+
+
+SymEntry * Scope::getSymEntry(Sym const* sym) const
+{
+    if (SCOPE_sym_idx(this) == nullptr || sym == nullptr) { return nullptr; }
+    return SCOPE_sym_idx(this)->get(sym);
+}
+
+
+SymEntry * Scope::genSymEntry(Sym const* sym)
+{
+    ASSERT0(sym);
+    if (SCOPE_sym_idx(this) == nullptr) {
+        SCOPE_sym_idx(this) = new Sym2Entry(SCOPE_SYM_IDX_INIT_SIZE);
+    }
+    Sym2Entry * idx = SCOPE_sym_idx(this);
+    SymEntry * se = idx->get(sym);
+    if (se != nullptr) { return se; }
+
+    //Keep the length of bucket list short.
+    if (idx->get_elem_count() >= idx->get_bucket_size()) {
+        idx->grow();
+    }
+    se = (SymEntry*)xmalloc(sizeof(SymEntry));
+    idx->set(sym, se);
+    return se;
+}
+
+
+SymChain const* Scope::getDeclChain(Sym const* sym) const
+{
+    SymEntry const* se = getSymEntry(sym);
+    return se != nullptr ? SYM_ENTRY_decl(se) : nullptr;
+}
+
+
+Decl * Scope::findDecl(Sym const* sym) const
+{
+    SymChain const* c = getDeclChain(sym);
+    return c != nullptr && is_visible(this, c) ?
+           (Decl*)SYM_CHAIN_obj(c) : nullptr;
+}
+
+
+Decl * Scope::findUserType(Sym const* sym) const
+{
+    SymEntry const* se = getSymEntry(sym);
+    if (se == nullptr || SYM_ENTRY_user_type(se) == nullptr ||
+        !is_visible(this, SYM_ENTRY_user_type(se))) {
+        return nullptr;
+    }
+    return (Decl*)SYM_CHAIN_obj(SYM_ENTRY_user_type(se));
+}
+
+
+Enum * Scope::findEnumTag(Sym const* sym) const
+{
+    SymEntry const* se = getSymEntry(sym);
+    if (se == nullptr) { return nullptr; }
+
+    //EnumTab is ordered by the address of Enum, pick the same one as
+    //the iteration of EnumTab does.
+    Enum * e = nullptr;
+    for (SymChain const* c = SYM_ENTRY_enum_tag(se);
+         c != nullptr && is_visible(this, c); c = SYM_CHAIN_next(c)) {
+        if (e == nullptr || (Enum*)SYM_CHAIN_obj(c) < e) {
+            e = (Enum*)SYM_CHAIN_obj(c);
+        }
+    }
+    return e;
+}
+
+
+Aggr * Scope::findAggr(Sym const* tag, bool is_struct, bool is_complete) const
+{
+    SymEntry const* se = getSymEntry(tag);
+    if (se == nullptr) { return nullptr; }
+    SymChain const* c = is_struct ? SYM_ENTRY_struct(se) :
+                                    SYM_ENTRY_union(se);
+    for (; c != nullptr && is_visible(this, c); c = SYM_CHAIN_next(c)) {
+        Aggr * a = (Aggr*)SYM_CHAIN_obj(c);
+        if (!is_complete || a->is_complete()) {
+            return a;
+        }
+    }
+    return nullptr;
 }
 
 
 Enum * Scope::addEnum(Enum * e)
 {
     ASSERT0(e);
-    return getEnumTab()->append_and_retrieve(e);
+    Enum * res = getEnumTab()->append_and_retrieve(e);
+    if (res != e) { return res; }
+    if (e->getName() != nullptr) {
+        append_sym_chain(&SYM_ENTRY_enum_tag(genSymEntry(e->getName())),
+                         e, 0);
+    }
+
+    //Index the enum-values that have been recorded in 'e'.
+    INT i = 0;
+    for (EnumValueList const* ev = e->getValList();
+         ev != nullptr; ev = EVAL_next(ev), i++) {
+        addEnumVal(e, ev, i);
+    }
+    return res;
+}
+
+
+void Scope::addEnumVal(Enum * e, EnumValueList const* ev, INT idx)
+{
+    ASSERT0(e && ev && EVAL_name(ev));
+    append_sym_chain(&SYM_ENTRY_enum_val(genSymEntry(EVAL_name(ev))),
+                     e, idx);
 }
 
 
@@ -86,6 +240,9 @@ void Scope::addStruct(Struct * s)
     ASSERT0(s);
     SCOPE_struct_list(this).append_tail(s);
     AGGR_scope(s) = this;
+    if (s->getTag() != nullptr) {
+        append_sym_chain(&SYM_ENTRY_struct(genSymEntry(s->getTag())), s, 0);
+    }
 }
 
 
@@ -94,14 +251,21 @@ void Scope::addUnion(Union * u)
     ASSERT0(u);
     SCOPE_union_list(this).append_tail(u);
     AGGR_scope(u) = this;
+    if (u->getTag() != nullptr) {
+        append_sym_chain(&SYM_ENTRY_union(genSymEntry(u->getTag())), u, 0);
+    }
 }
 
 
 void Scope::addDecl(Decl * decl)
 {
     ASSERT0(decl);
-    xcom::add_next(&SCOPE_decl_list(this), decl);
+    xcom::add_next(&SCOPE_decl_list(this), &m_last_decl, decl);
     DECL_decl_scope(decl) = this;
+    Sym const* sym = decl->getDeclSym();
+    if (sym != nullptr) {
+        append_sym_chain(&SYM_ENTRY_decl(genSymEntry(sym)), decl, 0);
+    }
 }
 
 
@@ -116,18 +280,29 @@ void Scope::addStmt(Tree * t)
 //idx: the index that indicates the position of pacticular Item in Enum.
 bool Scope::isEnumExist(CHAR const* vname, OUT Enum ** e, OUT INT * idx) const
 {
-    if (vname == nullptr) { return false; }
+    return isEnumExist(find_sym(vname), e, idx);
+}
 
-    EnumTabIter it;
-    EnumTab const* et = getEnumTab();
-    for (Enum * en = et->get_first(it);
-         en != nullptr; en = et->get_next(it)) {
-        if (en->isEnumValExist(vname, idx)) {
-            *e = en;
-            return true;
+
+bool Scope::isEnumExist(Sym const* vname, OUT Enum ** e, OUT INT * idx) const
+{
+    SymEntry const* se = getSymEntry(vname);
+    if (se == nullptr) { return false; }
+
+    //EnumTab is ordered by the address of Enum, pick the same one as
+    //the iteration of EnumTab does. The values of one Enum are chained
+    //in the order of their positions.
+    SymChain const* res = nullptr;
+    for (SymChain const* c = SYM_ENTRY_enum_val(se);
+         c != nullptr && is_visible(this, c); c = SYM_CHAIN_next(c)) {
+        if (res == nullptr || SYM_CHAIN_obj(c) < SYM_CHAIN_obj(res)) {
+            res = c;
         }
     }
-    return false;
+    if (res == nullptr) { return false; }
+    *e = (Enum*)SYM_CHAIN_obj(res);
+    *idx = SYM_CHAIN_idx(res);
+    return true;
 }
 //END Scope
 
@@ -163,25 +338,21 @@ void dec_indent(UINT ind)
 Sym const* Scope::addToSymList(Sym const* sym)
 {
     if (sym == nullptr) { return nullptr; }
-    if (SCOPE_sym_list(this) == nullptr) {
-        SCOPE_sym_list(this) = (SymList*)xmalloc(sizeof(SymList));
-        SYM_LIST_sym(SCOPE_sym_list(this)) = sym;
-        return nullptr;
+    SymEntry * se = genSymEntry(sym);
+    if (SYM_ENTRY_is_in_sym_list(se)) {
+        //'sym' already exist, return 'sym' as result
+        return sym;
     }
-
-    SymList * p = SCOPE_sym_list(this), * q = nullptr;
-    while (p != nullptr) {
-        q = p;
-        if (SYM_LIST_sym(p) == sym) {
-            //'sym' already exist, return 'sym' as result
-            return sym;
-        }
-        p = SYM_LIST_next(p);
+    SYM_ENTRY_is_in_sym_list(se) = true;
+    SymList * p = (SymList*)xmalloc(sizeof(SymList));
+    SYM_LIST_sym(p) = sym;
+    if (SCOPE_sym_list(this) == nullptr) {
+        SCOPE_sym_list(this) = p;
+    } else {
+        SYM_LIST_next(m_last_sym) = p;
+        SYM_LIST_prev(p) = m_last_sym;
     }
-    SYM_LIST_next(q) = (SymList*)xmalloc(sizeof(SymList));
-    SYM_LIST_prev(SYM_LIST_next(q)) = q;
-    q = SYM_LIST_next(q);
-    SYM_LIST_sym(q) = sym;
+    m_last_sym = p;
     return nullptr;
 }
 
@@ -192,26 +363,23 @@ Sym const* Scope::addToSymList(Sym const* sym)
 Decl * Scope::addToUserTypeList(Decl * decl)
 {
     if (decl == nullptr) { return nullptr; }
-    if (SCOPE_user_type_list(this) == nullptr) {
-        SCOPE_user_type_list(this) = (UserTypeList*)xmalloc(
-            sizeof(UserTypeList));
-        USER_TYPE_LIST_utype(SCOPE_user_type_list(this)) = decl;
-        return nullptr;
+    Sym const* sym = decl->getDeclSym();
+    ASSERT0(sym);
+    SymEntry * se = genSymEntry(sym);
+    if (is_in_sym_chain(SYM_ENTRY_user_type(se), decl)) {
+        //'decl' already exist, return 'decl' as result
+        return decl;
     }
-
-    UserTypeList * p = SCOPE_user_type_list(this), * q = nullptr;
-    while (p != nullptr) {
-        q = p;
-        if (USER_TYPE_LIST_utype(p) == decl) {
-            //'sym' already exist, return 'sym' as result
-            return decl;
-        }
-        p = USER_TYPE_LIST_next(p);
+    append_sym_chain(&SYM_ENTRY_user_type(se), decl, 0);
+    UserTypeList * p = (UserTypeList*)xmalloc(sizeof(UserTypeList));
+    USER_TYPE_LIST_utype(p) = decl;
+    if (SCOPE_user_type_list(this) == nullptr) {
+        SCOPE_user_type_list(this) = p;
+    } else {
+        USER_TYPE_LIST_next(m_last_utl) = p;
+        USER_TYPE_LIST_prev(p) = m_last_utl;
     }
-    USER_TYPE_LIST_next(q) = (UserTypeList*)xmalloc(sizeof(UserTypeList));
-    USER_TYPE_LIST_prev(USER_TYPE_LIST_next(q)) = q;
-    q = USER_TYPE_LIST_next(q);
-    USER_TYPE_LIST_utype(q) = decl;
+    m_last_utl = p;
     return nullptr;
 }
 
@@ -426,41 +594,50 @@ static void dump_unions(Scope const* s)
 }
 
 
+void dump_declaration(Decl const* dcl, UINT flag)
+{
+    if (g_logmgr == nullptr) { return; }
+    xcom::DefFixedStrBuf buf;
+    format_declaration(buf, dcl, true);
+    note(g_logmgr, "\n%s", buf.getBuf());
+
+    g_logmgr->incIndent(2);
+    dcl->dump();
+
+    //Dump function body. The body has been released if the function was
+    //compiled in streaming mode, and it is not parsed by dumping if it has
+    //been skipped by lazy parsing.
+    if (DECL_is_fun_def(dcl) && !DECL_is_lazy_body(dcl) &&
+        DECL_fun_body(dcl) != nullptr &&
+        HAVE_FLAG(flag, DUMP_SCOPE_FUNC_BODY)) {
+        g_logmgr->incIndent(2);
+        DECL_fun_body(dcl)->dump(flag);
+        g_logmgr->decIndent(2);
+    }
+
+    //Dump initializing value/expression.
+    if (DECL_is_init(DECL_decl_list(dcl))) {
+        prt(g_logmgr, " = ");
+        g_logmgr->incIndent(8);
+        DECL_init_tree(DECL_decl_list(dcl))->dump();
+        g_logmgr->decIndent(8);
+    }
+
+    g_logmgr->decIndent(2);
+    note(g_logmgr, "\n");
+}
+
+
 static void dump_declarations(Scope const* s, UINT flag)
 {
     //declarations
     Decl * dcl = s->getDeclList();
     if (dcl == nullptr) { return; }
 
-    xcom::DefFixedStrBuf buf;
     note(g_logmgr, "\nDECLARATIONS:");
     g_logmgr->incIndent(2);
-    while (dcl != nullptr) {
-        buf.clean();
-        format_declaration(buf, dcl, true);
-        note(g_logmgr, "\n%s", buf.getBuf());
-
-        g_logmgr->incIndent(2);
-        dcl->dump();
-
-        //Dump function body
-        if (DECL_is_fun_def(dcl) && HAVE_FLAG(flag, DUMP_SCOPE_FUNC_BODY)) {
-            g_logmgr->incIndent(2);
-            DECL_fun_body(dcl)->dump(flag);
-            g_logmgr->decIndent(2);
-        }
-
-        //Dump initializing value/expression.
-        if (DECL_is_init(DECL_decl_list(dcl))) {
-            prt(g_logmgr, " = ");
-            g_logmgr->incIndent(8);
-            DECL_init_tree(DECL_decl_list(dcl))->dump();
-            g_logmgr->decIndent(8);
-        }
-
-        g_logmgr->decIndent(2);
-        note(g_logmgr, "\n");
-        dcl = DECL_next(dcl);
+    for (; dcl != nullptr; dcl = DECL_next(dcl)) {
+        dump_declaration(dcl, flag);
     }
     g_logmgr->decIndent(2);
 }
@@ -555,11 +732,11 @@ bool is_lab_used(LabelInfo const* li)
 Aggr const* Scope::retrieveCompleteType(Aggr const* aggr, bool is_struct)
 {
     if (aggr->is_complete()) { return aggr; }
-    Aggr * findone = nullptr;
     if (is_struct) {
         ASSERT0(aggr->getScope());
+        Struct * findone = nullptr;
         if (isStructExistInOuterScope(aggr->getScope(), aggr->getTag(),
-                                      true, (Struct**)&findone)) {
+                                      true, &findone)) {
             ASSERT0(findone && findone->is_complete());
             return findone;
         }
@@ -567,8 +744,9 @@ Aggr const* Scope::retrieveCompleteType(Aggr const* aggr, bool is_struct)
     }
 
     ASSERT0(aggr->getScope());
+    Union * findone = nullptr;
     if (isUnionExistInOuterScope(aggr->getScope(), aggr->getTag(),
-                                 true, (Union**)&findone)) {
+                                 true, &findone)) {
         ASSERT0(findone && findone->is_complete());
         return findone;
     }
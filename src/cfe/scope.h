@@ -37,6 +37,7 @@ class Union;
 class Decl;
 class Enum;
 class Aggr;
+class EnumValueList;
 
 class SymList {
 public:
@@ -49,6 +50,47 @@ public:
 #define SYM_LIST_prev(syml) ((syml)->prev)
 
 
+//The class chains the objects of one kind that are named by a same symbol
+//in a scope, in the order that they were added into the scope.
+#define SYM_CHAIN_obj(sc) ((sc)->obj)
+#define SYM_CHAIN_idx(sc) ((sc)->idx)
+#define SYM_CHAIN_seq(sc) ((sc)->seq)
+#define SYM_CHAIN_next(sc) ((sc)->next)
+class SymChain {
+public:
+    SymChain * next;
+    void * obj;
+    INT idx; //the position of enum-value in its Enum.
+    UINT seq; //the order that the object was added, see CTX_scope_obj_seq.
+};
+
+
+//The class records all of the objects in a scope that are named by a
+//same symbol.
+//Because each chain keeps the adding order, a lookup via the entry gets
+//the same object as the linear scan of the scope's lists, and the
+//shadowing semantics is unchanged.
+#define SYM_ENTRY_is_in_sym_list(se) ((se)->m_is_in_sym_list)
+#define SYM_ENTRY_decl(se) ((se)->m_decl)
+#define SYM_ENTRY_user_type(se) ((se)->m_user_type)
+#define SYM_ENTRY_enum_tag(se) ((se)->m_enum_tag)
+#define SYM_ENTRY_enum_val(se) ((se)->m_enum_val)
+#define SYM_ENTRY_struct(se) ((se)->m_struct)
+#define SYM_ENTRY_union(se) ((se)->m_union)
+class SymEntry {
+public:
+    bool m_is_in_sym_list; //true if the symbol is in SCOPE_sym_list.
+    SymChain * m_decl; //declarations
+    SymChain * m_user_type; //type-names defined by 'typedef'
+    SymChain * m_enum_tag; //Enums
+    SymChain * m_enum_val; //Enums that define the enum-value.
+    SymChain * m_struct; //structures
+    SymChain * m_union; //unions
+};
+typedef xcom::HMap<Sym const*, SymEntry*,
+                   xcom::HashFuncBase2<Sym const*> > Sym2Entry;
+
+
 //Scope
 // |
 // |--EnumTab
@@ -78,6 +120,7 @@ public:
 #define SCOPE_struct_list(sc) ((sc)->m_struct_list)
 #define SCOPE_union_list(sc) ((sc)->m_union_list)
 #define SCOPE_stmt_list(sc) ((sc)->m_stmt_list)
+#define SCOPE_sym_idx(sc) ((sc)->m_sym_idx)
 class Scope {
     COPY_CONSTRUCTOR(Scope);
 public:
@@ -91,13 +134,22 @@ public:
     EnumTab * m_enum_tab; //enum-type tab
     UserTypeList * m_utl_list; //record type defined with 'typedef'
     Decl * m_decl_list; //record identifier declaration info
+    Decl * m_last_decl; //the tail of m_decl_list
     SymList * m_sym_tab_list; //record identifier name
+    SymList * m_last_sym; //the tail of m_sym_tab_list
+    UserTypeList * m_last_utl; //the tail of m_utl_list
     Tree * m_stmt_list; //record statement list to generate code
     List<LabelInfo*> m_li_list; //label definition
     List<LabelInfo*> m_lref_list;//reference label
     List<Struct*> m_struct_list; //structure list of current scope
     List<Union*> m_union_list; //union list of current scope
 
+    //Index the objects in current scope by their names.
+    //The table will be created when the first named object is added.
+    Sym2Entry * m_sym_idx;
+protected:
+    SymEntry * getSymEntry(Sym const* sym) const;
+    SymEntry * genSymEntry(Sym const* sym);
 public:
     Scope(UINT & sc) { SCOPE_enum_tab(this) = nullptr; init(sc); }
     ~Scope() { destroy(); }
@@ -121,10 +173,29 @@ public:
     void addDecl(Decl * decl);
     void addStmt(Tree * t);
 
+    //Record the enum-value 'ev' that is the 'idx'th item of Enum 'e'.
+    void addEnumVal(Enum * e, EnumValueList const* ev, INT idx);
+
+    //Return the first declaration in current scope that named 'sym'.
+    Decl * findDecl(Sym const* sym) const;
+
+    //Return the first type-name in current scope that named 'sym'.
+    Decl * findUserType(Sym const* sym) const;
+
+    //Return the Enum in current scope that tagged 'sym'.
+    Enum * findEnumTag(Sym const* sym) const;
+
+    //Return the first struct or union in current scope that tagged 'tag'.
+    //is_complete: true to find the complete aggregate only.
+    Aggr * findAggr(Sym const* tag, bool is_struct, bool is_complete) const;
+
     Tree * getStmtList() const { return SCOPE_stmt_list(this); }
     SymList * getSymList() const { return SCOPE_sym_list(this); }
     EnumTab * getEnumTab() const { return SCOPE_enum_tab(this); }
     Decl * getDeclList() const { return SCOPE_decl_list(this); }
+
+    //Return the declarations in current scope that named 'sym'.
+    SymChain const* getDeclChain(Sym const* sym) const;
     List<Struct*> * getStructList() { return &SCOPE_struct_list(this); }
     List<Union*> * getUnionList() { return &SCOPE_union_list(this); }
     Scope * getLastSubScope() const;
@@ -134,6 +205,7 @@ public:
     //Return true if enum-value existed in current scope.
     //idx: the index that indicates the position of pacticular Item in Enum.
     bool isEnumExist(CHAR const* vname, OUT Enum ** e, OUT INT * idx) const;
+    bool isEnumExist(Sym const* vname, OUT Enum ** e, OUT INT * idx) const;
 
     //Return complete aggregate if it has same tag with given 'aggr'.
     //The function will find aggregate from current scope and all of outer
@@ -168,6 +240,14 @@ void clean_global_scope();
 
 void destroy_scope_list();
 
+//Dump declaration 'dcl', the function body is dumped as well if 'dcl' is
+//function definition and 'flag' has DUMP_SCOPE_FUNC_BODY.
+void dump_declaration(Decl const* dcl, UINT flag);
+
+//Return the symbol of 'name' if it has been added into g_fe_sym_tab,
+//otherwise return nullptr.
+Sym const* find_sym(CHAR const* name);
+
 Scope * get_global_scope();
 
 bool is_lab_used(LabelInfo const* li);
@@ -181,11 +261,6 @@ Scope * new_scope();
 void set_map_lab2lineno(LabelInfo const* li, UINT lineno);
 void set_lab_used(LabelInfo const* li);
 
-//Export Variables
-extern Scope * g_cur_scope;
-extern UINT g_scope_count;
-extern Label2Lineno g_lab2lineno;
-extern xcom::TTab<xoc::LabelInfo const*> g_lab_used;
 
 } //namespace xfe
 #endif
@@ -29,7 +29,8 @@ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 namespace xfe {
 
-static Stack<Cell*> g_cell_stack;
+#define g_cell_stack CTX_st_cell_stack(g_cur_ctx)
+
 ST_INFO g_st_info[] = {
     {st_NULL, "nullptr"},
 
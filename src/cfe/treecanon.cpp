@@ -30,6 +30,454 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 namespace xfe {
 
+bool g_enable_fold_const = false;
+
+//Record the value of literal tree.
+class LitValue {
+public:
+    bool is_fp;
+    bool is_float; //true if the value is single precision float-point.
+    double fval; //available if is_fp is true.
+    CstValue ival; //available if is_fp is false.
+public:
+    LitValue() : is_fp(false), is_float(false), fval(0.0) {}
+
+    bool is_true() const { return is_fp ? fval != 0.0 : ival.val != 0; }
+
+    //Return the value as double precision float-point.
+    double getDouble() const
+    {
+        if (is_fp) { return fval; }
+        if (ival.is_unsigned) { return (double)(ULONGLONG)ival.val; }
+        return (double)ival.val;
+    }
+
+    void setFP(double v, bool is_single)
+    {
+        is_fp = true;
+        is_float = is_single;
+        fval = is_single ? (double)(float)v : v;
+    }
+};
+
+
+//Return true if the literal of type 'ty' can be built by constant folding.
+//Long double is not folded because host double may lose precision.
+static bool isFoldableType(Decl const* ty)
+{
+    if (ty == nullptr) { return false; }
+    if (ty->is_integer()) {
+        UINT size = ty->getDeclByteSize();
+        return size != 0 && size <= sizeof(LONGLONG);
+    }
+    return ty->is_fp() && !(ty->is_double() && ty->getTypeAttr()->is_long());
+}
+
+
+//Return true if literals of type 'a' and 'b' have the same representation,
+//namely they are both integers of same size and signedness, or both
+//float-point of same precision.
+static bool isSameLitType(Decl const* a, Decl const* b)
+{
+    if (!isFoldableType(a) || !isFoldableType(b)) { return false; }
+    if (a->is_fp() || b->is_fp()) {
+        return a->is_fp() && b->is_fp() && a->is_float() == b->is_float();
+    }
+    return a->getDeclByteSize() == b->getDeclByteSize() &&
+           a->getTypeAttr()->is_unsigned() == b->getTypeAttr()->is_unsigned();
+}
+
+
+//Return true if 't' is literal, and record its value in 'v'.
+static bool getLitValue(Tree const* t, OUT LitValue & v)
+{
+    if (t == nullptr || TREE_nsib(t) != nullptr) { return false; }
+    Decl const* ty = t->getResultType();
+    switch (t->getCode()) {
+    case TR_IMM:
+    case TR_IMMU:
+    case TR_IMML:
+    case TR_IMMUL:
+        if (!isFoldableType(ty)) { return false; }
+        v.is_fp = false;
+        v.ival.set((LONGLONG)TREE_imm_val(t), ty->getDeclByteSize(),
+                   ty->getTypeAttr()->is_unsigned());
+        return true;
+    case TR_ENUM_CONST:
+        v.is_fp = false;
+        v.ival.set(get_enum_const_val(TREE_enum(t), TREE_enum_val_idx(t)),
+                   BYTE_PER_INT, false);
+        return true;
+    case TR_FP:
+    case TR_FPF:
+        v.setFP(::atof(TREE_fp_str_val(t)->getStr()),
+                t->getCode() == TR_FPF);
+        return true;
+    default:;
+    }
+    return false;
+}
+
+
+//Convert literal value 'v' to type 'ty', and record the result in 'res'.
+//Return false if the conversion is not foldable, e.g: the float-point value
+//is out of the range of integer type.
+static bool convertLitValue(LitValue const& v, Decl const* ty,
+                            OUT LitValue & res)
+{
+    ASSERT0(isFoldableType(ty));
+    if (ty->is_fp()) {
+        res.setFP(v.getDouble(), ty->is_float());
+        return ::isfinite(res.fval);
+    }
+    UINT size = ty->getDeclByteSize();
+    bool is_unsigned = ty->getTypeAttr()->is_unsigned();
+    res.is_fp = false;
+    if (ty->getTypeAttr()->is_bool()) {
+        res.ival.set(v.is_true() ? 1 : 0, size, is_unsigned);
+        return true;
+    }
+    if (!v.is_fp) {
+        res.ival.set(v.ival.val, size, is_unsigned);
+        return true;
+    }
+
+    //The integral part of float-point value has to be representable.
+    double d = ::trunc(v.fval);
+    UINT bits = size * BIT_PER_BYTE;
+    double lo = is_unsigned ? 0.0 : -::ldexp(1.0, bits - 1);
+    double hi = is_unsigned ? ::ldexp(1.0, bits) : ::ldexp(1.0, bits - 1);
+    if (!(d >= lo && d < hi)) { return false; }
+    if (is_unsigned) {
+        res.ival.set((LONGLONG)(ULONGLONG)d, size, true);
+    } else {
+        res.ival.set((LONGLONG)d, size, false);
+    }
+    return true;
+}
+
+
+//Compute the binary operation of float-point literals.
+//Return false if the operation is not foldable.
+static bool computeFPBinaryOp(Tree const* t, LitValue const& l,
+                              LitValue const& r, OUT LitValue & res)
+{
+    //The operation is performed in float if neither operand is double.
+    bool is_single = (!l.is_fp || l.is_float) && (!r.is_fp || r.is_float);
+    LitValue cl;
+    LitValue cr;
+    cl.setFP(l.getDouble(), is_single);
+    cr.setFP(r.getDouble(), is_single);
+    double a = cl.fval;
+    double b = cr.fval;
+    switch (t->getCode()) {
+    case TR_LOGIC_OR:
+        res.ival.setBool(a != 0.0 || b != 0.0);
+        return true;
+    case TR_LOGIC_AND:
+        res.ival.setBool(a != 0.0 && b != 0.0);
+        return true;
+    case TR_EQUALITY:
+        res.ival.setBool(TREE_token(t) == T_EQU ? a == b : a != b);
+        return true;
+    case TR_RELATION:
+        switch (TREE_token(t)) {
+        case T_LESSTHAN: res.ival.setBool(a < b); return true;
+        case T_MORETHAN: res.ival.setBool(a > b); return true;
+        case T_NOLESSTHAN: res.ival.setBool(a >= b); return true;
+        case T_NOMORETHAN: res.ival.setBool(a <= b); return true;
+        default: UNREACHABLE();
+        }
+        return false;
+    case TR_ADDITIVE:
+        res.setFP(TREE_token(t) == T_ADD ? a + b : a - b, is_single);
+        return ::isfinite(res.fval);
+    case TR_MULTI:
+        if (TREE_token(t) == T_ASTERISK) {
+            res.setFP(a * b, is_single);
+            return ::isfinite(res.fval);
+        }
+        if (TREE_token(t) != T_DIV || b == 0.0) { return false; }
+        res.setFP(a / b, is_single);
+        return ::isfinite(res.fval);
+    default:;
+    }
+    return false;
+}
+
+
+//Build literal tree for value 'v' of type 'ty'.
+static Tree * buildLit(LitValue const& v, Decl * ty, INT lineno)
+{
+    Tree * t = nullptr;
+    if (v.is_fp) {
+        //Print the shortest string that reads back to the same value.
+        CHAR buf[64];
+        ::snprintf(buf, sizeof(buf), v.is_float ? "%.9g" : "%.17g", v.fval);
+        if (::strpbrk(buf, ".eEn") == nullptr) {
+            ::strcat(buf, ".0");
+        }
+
+        //The symbol is not added into g_fe_sym_tab, because the table is
+        //shared by the task contexts that run concurrently.
+        //The string is rounded up to keep the following nodes aligned.
+        UINT len = (UINT)::strlen(buf);
+        CHAR * str = (CHAR*)smpoolMalloc(
+            (size_t)xcom::ceil_align(len + 1, alignof(Tree)), g_pool_tree_used);
+        ::memcpy(str, buf, len + 1);
+        CLSym * sym = (CLSym*)smpoolMalloc(sizeof(CLSym), g_pool_tree_used);
+        sym->init();
+        sym->initByString(str, len);
+        t = NEWTN(v.is_float ? TR_FPF : TR_FP);
+        TREE_token(t) = v.is_float ? T_FPF : T_FP;
+        TREE_fp_str_val(t) = sym;
+    } else if (v.ival.size >= BYTE_PER_LONGLONG) {
+        t = NEWTN(v.ival.is_unsigned ? TR_IMMUL : TR_IMML);
+        TREE_token(t) = v.ival.is_unsigned ? T_IMMUL : T_IMML;
+        TREE_imm_val(t) = (HOST_INT)v.ival.val;
+    } else {
+        t = NEWTN(v.ival.is_unsigned ? TR_IMMU : TR_IMM);
+        TREE_token(t) = v.ival.is_unsigned ? T_IMMU : T_IMM;
+        TREE_imm_val(t) = (HOST_INT)v.ival.val;
+    }
+    TREE_lineno(t) = lineno;
+    TREE_result_type(t) = ty;
+    return t;
+}
+
+
+//Return true if 'tl' or its kid contains the label that can be the target
+//of jump from outside, e.g: label, case and default.
+static bool hasJumpTarget(Tree const* tl)
+{
+    for (Tree const* t = tl; t != nullptr; t = TREE_nsib(t)) {
+        switch (t->getCode()) {
+        case TR_LABEL:
+        case TR_CASE:
+        case TR_DEFAULT:
+            return true;
+        case TR_SCOPE:
+            if (hasJumpTarget(TREE_scope(t)->getStmtList())) { return true; }
+            continue;
+        default:;
+        }
+        for (UINT i = 0; i < t->getFldNum(); i++) {
+            if (hasJumpTarget(TREE_fld(t, i))) { return true; }
+        }
+    }
+    return false;
+}
+
+
+//Unlink the scopes of 'tl' and its kid from their parent scopes, the
+//scopes are removed along with the dead statements, thus they should not
+//be seen by the consumers that walk the scope tree.
+static void unlinkScope(Tree const* tl)
+{
+    for (Tree const* t = tl; t != nullptr; t = TREE_nsib(t)) {
+        if (t->getCode() == TR_SCOPE) {
+            //The sub-scopes are unlinked along with the scope.
+            Scope * sc = TREE_scope(t);
+            ASSERT0(SCOPE_parent(sc));
+            xcom::remove(&SCOPE_sub(SCOPE_parent(sc)), sc);
+            continue;
+        }
+        for (UINT i = 0; i < t->getFldNum(); i++) {
+            unlinkScope(TREE_fld(t, i));
+        }
+    }
+}
+
+
+//Return true if 'tl' or its kid contains the break or continue that
+//belongs to the loop which encloses 'tl'.
+//is_in_switch: true if 'tl' is enclosed in switch inside the loop, thus only
+//              continue belongs to the loop.
+static bool hasLoopJump(Tree const* tl, bool is_in_switch)
+{
+    for (Tree const* t = tl; t != nullptr; t = TREE_nsib(t)) {
+        switch (t->getCode()) {
+        case TR_BREAK:
+            if (!is_in_switch) { return true; }
+            continue;
+        case TR_CONTINUE:
+            return true;
+        case TR_DO:
+        case TR_WHILE:
+        case TR_FOR:
+            //Both break and continue belong to the inner loop.
+            continue;
+        case TR_SWITCH:
+            if (hasLoopJump(TREE_switch_body(t), true)) { return true; }
+            continue;
+        case TR_SCOPE:
+            if (hasLoopJump(TREE_scope(t)->getStmtList(), is_in_switch)) {
+                return true;
+            }
+            continue;
+        default:;
+        }
+        for (UINT i = 0; i < t->getFldNum(); i++) {
+            if (hasLoopJump(TREE_fld(t, i), is_in_switch)) { return true; }
+        }
+    }
+    return false;
+}
+
+
+//Return the literal that computed by operator 't' whose operands are
+//literals, or return 't' if it is not foldable.
+Tree * TreeCanon::foldConst(Tree * t, TreeCanonCtx * ctx)
+{
+    if (!g_enable_fold_const) { return t; }
+    Decl * ty = t->getResultType();
+    if (!isFoldableType(ty)) { return t; }
+    LitValue res;
+    bool succ = false;
+    switch (t->getCode()) {
+    case TR_LOGIC_OR:
+    case TR_LOGIC_AND:
+    case TR_INCLUSIVE_OR:
+    case TR_INCLUSIVE_AND:
+    case TR_XOR:
+    case TR_EQUALITY:
+    case TR_RELATION:
+    case TR_SHIFT:
+    case TR_ADDITIVE:
+    case TR_MULTI:
+        succ = foldBinaryOp(t, res);
+        break;
+    case TR_PLUS:
+    case TR_MINUS:
+    case TR_REV:
+        succ = foldUnaryOp(t, res);
+        break;
+    case TR_NOT:
+        //The result of '!' is int, whereas TypeTran gives it the type of
+        //operand.
+        ty = g_type_tab->getTypeName(CTX_sint_type(g_cur_ctx));
+        succ = foldUnaryOp(t, res);
+        break;
+    case TR_COND: {
+        //TypeTran gives '?:' the type of true arm rather than the usual
+        //arithmetic conversion of both arms, thus the expression is not
+        //folded unless the arms have the same type.
+        if (!isSameLitType(TREE_true_part(t)->getResultType(),
+                           TREE_false_part(t)->getResultType())) {
+            break;
+        }
+
+        //Only the selected arm is evaluated.
+        LitValue det;
+        succ = getLitValue(TREE_det(t), det) &&
+               getLitValue(det.is_true() ?
+                           TREE_true_part(t) : TREE_false_part(t), res);
+        break;
+    }
+    case TR_CVT:
+        succ = getLitValue(TREE_cvt_exp(t), res);
+        break;
+    default:;
+    }
+    LitValue v;
+    if (!succ || !convertLitValue(res, ty, v)) { return t; }
+    Tree * newt = buildLit(v, ty, t->getLineno());
+    TREE_parent(newt) = t->parent();
+    TCC_change(ctx) = true;
+    return newt;
+}
+
+
+bool TreeCanon::foldUnaryOp(Tree const* t, OUT LitValue & res)
+{
+    if (!getLitValue(TREE_lchild(t), res)) { return false; }
+    if (!res.is_fp) {
+        if (isConstUnaryOpUndef(t->getCode(), res.ival)) { return false; }
+        computeConstUnaryOp(t->getCode(), res.ival);
+        return true;
+    }
+    switch (t->getCode()) {
+    case TR_PLUS:
+        return true;
+    case TR_MINUS:
+        res.fval = -res.fval;
+        return true;
+    case TR_NOT:
+        res.is_fp = false;
+        res.ival.setBool(res.fval == 0.0);
+        return true;
+    default:;
+    }
+    return false;
+}
+
+
+bool TreeCanon::foldBinaryOp(Tree const* t, OUT LitValue & res)
+{
+    LitValue l;
+    LitValue r;
+    if (!getLitValue(TREE_lchild(t), l)) { return false; }
+    if ((t->getCode() == TR_LOGIC_OR && l.is_true()) ||
+        (t->getCode() == TR_LOGIC_AND && !l.is_true())) {
+        //The right operand is not evaluated.
+        res.ival.setBool(l.is_true());
+        return true;
+    }
+    if (!getLitValue(TREE_rchild(t), r)) { return false; }
+    if (l.is_fp || r.is_fp) {
+        return computeFPBinaryOp(t, l, r, res);
+    }
+    if (isConstBinaryOpUndef(t, l.ival, r.ival)) { return false; }
+    return computeConstBinaryOp(t, l.ival, r.ival, res.ival);
+}
+
+
+//Remove the statement that can not be executed.
+//Return the statement that substitutes for 't', or nullptr if 't' is
+//removed entirely.
+Tree * TreeCanon::pruneDeadStmt(Tree * t, TreeCanonCtx * ctx)
+{
+    if (!g_enable_fold_const) { return t; }
+    LitValue det;
+    Tree * live = nullptr;
+    Tree * dead = nullptr;
+    switch (t->getCode()) {
+    case TR_IF:
+        if (!getLitValue(TREE_if_det(t), det)) { return t; }
+        live = det.is_true() ? TREE_if_true_stmt(t) : TREE_if_false_stmt(t);
+        dead = det.is_true() ? TREE_if_false_stmt(t) : TREE_if_true_stmt(t);
+        if (hasJumpTarget(dead)) { return t; }
+        break;
+    case TR_WHILE:
+        if (!getLitValue(TREE_whiledo_det(t), det) || det.is_true() ||
+            hasJumpTarget(TREE_whiledo_body(t))) {
+            return t;
+        }
+        dead = TREE_whiledo_body(t);
+        break;
+    case TR_DO:
+        //The body is executed once, unless it jumps to the loop.
+        if (!getLitValue(TREE_dowhile_det(t), det) || det.is_true() ||
+            hasLoopJump(TREE_dowhile_body(t), false)) {
+            return t;
+        }
+        live = TREE_dowhile_body(t);
+        break;
+    default: UNREACHABLE();
+    }
+    if (live != nullptr && TREE_nsib(live) != nullptr) {
+        //The statement list can not substitute for one statement.
+        return t;
+    }
+    if (live != nullptr) {
+        TREE_parent(live) = t->parent();
+    }
+    unlinkScope(dead);
+    TCC_change(ctx) = true;
+    return live;
+}
+
+
 bool TreeCanon::handleParam(Decl * formalp, Decl * realp)
 {
     return true;
@@ -164,7 +612,7 @@ Tree * TreeCanon::handleCvt(Tree * t, TreeCanonCtx * ctx)
 {
     TREE_cvt_exp(t) = handleTreeList(TREE_cvt_exp(t), ctx);
     t->setParentForKid();
-    return t;
+    return foldConst(t, ctx);
 }
 
 
@@ -344,6 +792,8 @@ Tree * TreeCanon::handleTree(Tree * t, TreeCanonCtx * ctx)
     case TR_FPF: // float
     case TR_FPLD: // long double
     case TR_ENUM_CONST:
+        //Leaf node does not have kid.
+        return t;
     case TR_LOGIC_OR: // logical or ||
     case TR_LOGIC_AND: // logical and &&
     case TR_INCLUSIVE_OR: // inclusive or |
@@ -357,7 +807,7 @@ Tree * TreeCanon::handleTree(Tree * t, TreeCanonCtx * ctx)
         TREE_lchild(t) = handleTreeList(TREE_lchild(t), ctx);
         TREE_rchild(t) = handleTreeList(TREE_rchild(t), ctx);
         t->setParentForKid();
-        return t;
+        return foldConst(t, ctx);
     case TR_SCOPE:
         SCOPE_stmt_list(TREE_scope(t)) = handleTreeList(
             TREE_scope(t)->getStmtList(), ctx);
@@ -369,17 +819,17 @@ Tree * TreeCanon::handleTree(Tree * t, TreeCanonCtx * ctx)
         TREE_if_true_stmt(t) = handleTreeList(TREE_if_true_stmt(t), ctx);
         TREE_if_false_stmt(t) = handleTreeList(TREE_if_false_stmt(t), ctx);
         t->setParentForKid();
-        return t;
+        return pruneDeadStmt(t, ctx);
     case TR_DO:
         TREE_dowhile_body(t) = handleTreeList(TREE_dowhile_body(t), ctx);
         TREE_dowhile_det(t) = handleTreeList(TREE_dowhile_det(t), ctx);
         t->setParentForKid();
-        return t;
+        return pruneDeadStmt(t, ctx);
     case TR_WHILE:
         TREE_whiledo_det(t) = handleTreeList(TREE_whiledo_det(t), ctx);
         TREE_whiledo_body(t) = handleTreeList(TREE_whiledo_body(t), ctx);
         t->setParentForKid();
-        return t;
+        return pruneDeadStmt(t, ctx);
     case TR_FOR:
         TREE_for_init(t) = handleTreeList(TREE_for_init(t), ctx);
         TREE_for_det(t) = handleTreeList(TREE_for_det(t), ctx);
@@ -408,7 +858,7 @@ Tree * TreeCanon::handleTree(Tree * t, TreeCanonCtx * ctx)
         TREE_true_part(t) = handleTreeList(TREE_true_part(t), ctx);
         TREE_false_part(t) = handleTreeList(TREE_false_part(t), ctx);
         t->setParentForKid();
-        return t;
+        return foldConst(t, ctx);
     case TR_CVT:
         return handleCvt(t, ctx);
     case TR_TYPE_NAME: //user defined type or C standard type
@@ -416,13 +866,16 @@ Tree * TreeCanon::handleTree(Tree * t, TreeCanonCtx * ctx)
     case TR_LDA: // &a get address of 'a'
         return handleLda(t, ctx);
     case TR_DEREF: // *p  dereferencing the pointer 'p'
+        TREE_lchild(t) = handleTreeList(TREE_lchild(t), ctx);
+        t->setParentForKid();
+        return t;
     case TR_PLUS: // +123
     case TR_MINUS: // -123
     case TR_REV: // Reverse
     case TR_NOT: // get non-value
         TREE_lchild(t) = handleTreeList(TREE_lchild(t), ctx);
         t->setParentForKid();
-        return t;
+        return foldConst(t, ctx);
     case TR_INC: //++a
     case TR_POST_INC: //a++
         TREE_inc_exp(t) = handleTreeList(TREE_inc_exp(t), ctx);
@@ -447,6 +900,7 @@ Tree * TreeCanon::handleTree(Tree * t, TreeCanonCtx * ctx)
     case TR_PRAGMA:
     case TR_PREP:
     case TR_DECL:
+    case TR_DENSE_INIT:
         break;
     default: ASSERTN(0, ("unknown tree type:%d", t->getCode()));
     }
@@ -455,47 +909,53 @@ Tree * TreeCanon::handleTree(Tree * t, TreeCanonCtx * ctx)
 
 
 //Return true if there is no error occur during handling tree list.
+bool TreeCanon::handleTreeInList(Tree * t, OUT Tree ** tl,
+                                 TreeCanonCtx * ctx)
+{
+    TreeCanonCtx lctx;
+    Tree * newt = handleTree(t, &lctx);
+    if (newt != t) {
+        xcom::replace_one(tl, t, newt);
+    }
+    if (g_err_msg_list.has_msg()) {
+        return false;
+    }
+    ctx->unionInfoBottomUp(lctx);
+    return true;
+}
+
+
 Tree * TreeCanon::handleTreeList(Tree * tl, TreeCanonCtx * ctx)
 {
     Tree * next = nullptr;
     for (Tree * t = tl; t != nullptr; t = next) {
         next = TREE_nsib(t);
-        TreeCanonCtx lctx;
-        Tree * newt = handleTree(t, &lctx);
-        if (newt != t) {
-            xcom::replace_one(&tl, t, newt);
-        }
-        if (g_err_msg_list.has_msg()) {
+        if (!handleTreeInList(t, &tl, ctx)) {
             return nullptr;
         }
-        ctx->unionInfoBottomUp(lctx);
     }
     return tl;
 }
 
 
-INT TreeCanonicalize()
+//Canonicalize the function definition of global scope.
+STATUS canonGlobalDecl(Decl * dcl)
 {
+    if (!dcl->is_fun_def()) { return ST_SUCC; }
+    TreeCanon tc;
+    TreeCanonCtx ctx;
+    Scope * body = dcl->getFunBody();
+    SCOPE_stmt_list(body) = tc.handleTreeList(body->getStmtList(), &ctx);
     if (g_err_msg_list.has_msg()) {
         return ST_ERR;
     }
+    return ST_SUCC;
+}
 
-    Scope * s = get_global_scope();
-    if (s == nullptr) { return ST_SUCC; }
-
-    for (Decl * dcl = s->getDeclList(); dcl != nullptr; dcl = DECL_next(dcl)) {
-        ASSERT0(dcl->getDeclScope() == s);
-        if (!dcl->is_fun_def()) { continue; }
-
-        TreeCanon tc;
-        TreeCanonCtx ctx;
-        SCOPE_stmt_list(DECL_fun_body(dcl)) = tc.handleTreeList(
-            dcl->getFunBody()->getStmtList(), &ctx);
-        if (g_err_msg_list.has_msg()) {
-            return ST_ERR;
-        }
-    }
 
+STATUS canonGlobalStmt()
+{
+    Scope * s = get_global_scope();
     TreeCanon tc;
     TreeCanonCtx ctx;
     SCOPE_stmt_list(s) = tc.handleTreeList(s->getStmtList(), &ctx);
@@ -505,4 +965,19 @@ INT TreeCanonicalize()
     return ST_SUCC;
 }
 
+
+INT TreeCanonicalize()
+{
+    if (g_err_msg_list.has_msg()) {
+        return ST_ERR;
+    }
+
+    Scope * s = get_global_scope();
+    if (s == nullptr) { return ST_SUCC; }
+    if (ST_SUCC != performFuncTask(canonGlobalDecl, nullptr)) {
+        return ST_ERR;
+    }
+    return canonGlobalStmt();
+}
+
 } //namespace xfe
@@ -32,6 +32,8 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 namespace xfe {
 
+class LitValue;
+
 #define TCC_change(p) ((p)->m_change)
 
 //This class represents the context informatin during tree canonicalization.
@@ -55,6 +57,12 @@ public:
 class TreeCanon {
     COPY_CONSTRUCTOR(TreeCanon);
 
+    bool foldBinaryOp(Tree const* t, OUT LitValue & res);
+    bool foldUnaryOp(Tree const* t, OUT LitValue & res);
+
+    //Return the literal if 't' is foldable, otherwise return 't'.
+    Tree * foldConst(Tree * t, TreeCanonCtx * ctx);
+
     //Return original tree if there is no change, or new tree.
     bool handleParam(Decl * formalp, Decl * realp);
     Tree * handleAssign(Tree * t, TreeCanonCtx * ctx);
@@ -67,15 +75,28 @@ class TreeCanon {
     Tree * handleAggrAccess(Tree * t, TreeCanonCtx * ctx);
     Tree * handleArray(Tree * t, TreeCanonCtx * ctx);
 
+    //Return the statement that substitutes for 't' if 't' has dead branch.
+    Tree * pruneDeadStmt(Tree * t, TreeCanonCtx * ctx);
+
 public:
     TreeCanon() {}
     ~TreeCanon() {}
 
     //Return true if there is no error occur during handling tree list.
     Tree * handleTreeList(Tree * tl, TreeCanonCtx * ctx);
+
+    //Canonicalize tree 't' that is an element of list 'tl', and replace
+    //'t' with the new tree in 'tl' if there is change.
+    //Return true if there is no error occur during handling tree.
+    bool handleTreeInList(Tree * t, OUT Tree ** tl, TreeCanonCtx * ctx);
 };
 
 INT TreeCanonicalize();
 
+//Canonicalize the declaration 'dcl' of global scope, and the stmt list of
+//global scope respectively.
+STATUS canonGlobalDecl(Decl * dcl);
+STATUS canonGlobalStmt();
+
 } //namespace xfe
 #endif
@@ -30,14 +30,6 @@ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 namespace xfe {
 
-SMemPool * g_pool_general_used = nullptr;
-SMemPool * g_pool_st_used = nullptr;
-SMemPool * g_pool_tree_used = nullptr;
-CLSymTab * g_fe_sym_tab = nullptr;
-CHAR * g_real_token_string = nullptr;
-UINT g_real_token_string_len = 0;
-TOKEN g_real_token = T_UNDEF;
-
 Tree * buildDeref(Tree * base)
 {
     //The basetype of pointer is an array. Convert a[] to (*a)[].
@@ -159,6 +151,15 @@ Tree * buildInitvalScope(Tree * exp_list)
 }
 
 
+Tree * buildDenseInit(DenseInit * di)
+{
+    ASSERT0(di && DENSE_INIT_decl(di));
+    Tree * t = NEWTN(TR_DENSE_INIT);
+    TREE_dense_init(t) = di;
+    return t;
+}
+
+
 Tree * buildInt(HOST_INT val)
 {
     Tree * t = NEWTN(TR_IMM);
@@ -278,12 +279,12 @@ Tree * copyTree(Tree const* t)
     if (t == nullptr) { return nullptr; }
     Tree * newt = NEWTN(t->getCode());
     UINT id = newt->id();
-    ::memcpy(newt, t, sizeof(Tree));
+    ::memcpy(newt, t, Tree::getByteSize(t->getCode()));
     TREE_id(newt) = id;
     TREE_parent(newt) = nullptr;
     TREE_psib(newt) = nullptr;
     TREE_nsib(newt) = nullptr;
-    for (UINT i = 0; i < MAX_TREE_FLDS; i++) {
+    for (UINT i = 0; i < t->getFldNum(); i++) {
         Tree * kid = TREE_fld(t, i);
         if (kid == nullptr) { continue; }
         Tree * newkid_list = copyTreeList(kid);
@@ -32,16 +32,6 @@ namespace xfe {
 
 #define NEWTN(tok)  allocTreeNode((tok), g_real_line_num)
 
-//Exported Variables
-extern CHAR * g_real_token_string;
-extern UINT g_real_token_string_len;
-extern TOKEN g_real_token;
-extern SMemPool * g_pool_general_used;
-extern SMemPool * g_pool_tree_used; //front end
-extern SMemPool * g_pool_st_used;
-extern CLSymTab * g_fe_sym_tab;
-extern LogMgr * g_logmgr; //the file handler of log file.
-
 Tree * buildDeref(Tree * base);
 Tree * buildInitvalScope(Tree * exp_list);
 Tree * buildString(ESym const* str);
@@ -65,6 +55,8 @@ Tree * buildAggrRef(Tree * base, Decl const* fld);
 Tree * buildCvt(Decl const* tgt_type, Tree * src);
 Tree * buildCvt(Tree * tgt_type, Tree * src);
 Tree * buildTypeName(Decl * decl);
+//Build TR_DENSE_INIT that records the constant initial values of array.
+Tree * buildDenseInit(DenseInit * di);
 
 //Duplicate 't' and its kids, but without ir's sibiling node.
 Tree * copyTree(Tree const* t);
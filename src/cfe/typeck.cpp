@@ -45,7 +45,7 @@ static bool checkParam(Decl * formalp, Decl * realp)
 
 
 //Declaration checking
-static INT checkDeclaration(Decl const* d)
+INT checkDeclaration(Decl const* d)
 {
     ASSERT0(DECL_dt(d) == DCL_DECLARATION);
     Decl const* dclor = d->getTraitList();
@@ -247,14 +247,17 @@ static bool checkAssign(Tree * t, TYCtx * cont)
 {
     checkTreeList(TREE_lchild(t), cont);
     checkTreeList(TREE_rchild(t), cont);
-    if ((TREE_lchild(t)->getResultType()->is_pointer() &&
-         !isConsistentWithPointer(TREE_rchild(t))) ||
-        (TREE_rchild(t)->getResultType()->is_pointer() &&
-         !isConsistentWithPointer(TREE_lchild(t)))) {
+    Decl const* ld = TREE_lchild(t)->getResultType();
+    Decl const* rd = TREE_rchild(t)->getResultType();
+
+    //Operands of same canonical type are always compatible.
+    if (ld != rd &&
+        ((ld->is_pointer() && !isConsistentWithPointer(TREE_rchild(t))) ||
+         (rd->is_pointer() && !isConsistentWithPointer(TREE_lchild(t))))) {
         xcom::DefFixedStrBuf bufl;
         xcom::DefFixedStrBuf bufr;
-        format_declaration(bufl, TREE_lchild(t)->getResultType(), true);
-        format_declaration(bufr, TREE_rchild(t)->getResultType(), true);
+        format_declaration(bufl, ld, true);
+        format_declaration(bufr, rd, true);
         warn(t->getLineno(),
              "should not assign '%s' to '%s'", bufr.getBuf(), bufl.getBuf());
     }
@@ -352,7 +355,7 @@ static bool checkCvt(Tree * t, TYCtx * cont)
 }
 
 
-static void checkDeclInit(Decl const* decl, TYCtx * cont)
+void checkDeclInit(Decl const* decl, TYCtx * cont)
 {
     for (Decl const* dcl = decl; dcl != nullptr; dcl = DECL_next(dcl)) {
         if (!dcl->is_initialized()) { continue; }
@@ -370,158 +373,179 @@ static void checkInitValScope(Tree const* t, TYCtx * cont)
 }
 
 
+//Perform type checking for tree 't', whereas the siblings of 't' are
+//not checked.
+bool checkTree(Tree * t, TYCtx * cont)
+{
+    ASSERT0(t && cont);
+    g_src_line_num = t->getLineno();
+    switch (t->getCode()) {
+    case TR_ASSIGN:
+        checkAssign(t, cont);
+        break;
+    case TR_ID:
+    case TR_IMM:
+    case TR_IMML:
+    case TR_IMMU:
+    case TR_IMMUL:
+    case TR_FP: // double
+    case TR_FPF: // float
+    case TR_FPLD: // long double
+    case TR_ENUM_CONST:
+    case TR_STRING:
+        break;
+    case TR_LOGIC_OR: // logical or ||
+    case TR_LOGIC_AND: // logical and &&
+    case TR_INCLUSIVE_OR: // inclusive or |
+    case TR_XOR: // exclusive or
+    case TR_INCLUSIVE_AND: // inclusive and &
+    case TR_SHIFT: // >> <<
+    case TR_EQUALITY: // == !=
+    case TR_RELATION: // < > >= <=
+    case TR_ADDITIVE: // '+' '-'
+    case TR_MULTI: // '*' '/' '%'
+        checkTreeList(TREE_lchild(t), cont);
+        checkTreeList(TREE_rchild(t), cont);
+        break;
+    case TR_SCOPE:
+        checkDeclInit(TREE_scope(t)->getDeclList(), cont);
+        checkTreeList(TREE_scope(t)->getStmtList(), cont);
+        break;
+    case TR_INITVAL_SCOPE:
+        checkInitValScope(t, cont);
+        break;
+    case TR_IF:
+        checkTreeList(TREE_if_det(t), cont);
+        checkTreeList(TREE_if_true_stmt(t), cont);
+        checkTreeList(TREE_if_false_stmt(t), cont);
+        break;
+    case TR_DO:
+        checkTreeList(TREE_dowhile_body(t), cont);
+        checkTreeList(TREE_dowhile_det(t), cont);
+        break;
+    case TR_WHILE:
+        checkTreeList(TREE_whiledo_det(t), cont);
+        checkTreeList(TREE_whiledo_body(t), cont);
+        break;
+    case TR_FOR:
+        checkTreeList(TREE_for_init(t), cont);
+        checkTreeList(TREE_for_det(t), cont);
+        checkTreeList(TREE_for_step(t), cont);
+        checkTreeList(TREE_for_body(t), cont);
+        break;
+    case TR_SWITCH:
+        checkTreeList(TREE_switch_det(t), cont);
+        checkTreeList(TREE_switch_body(t), cont);
+        break;
+    case TR_BREAK:
+    case TR_CONTINUE:
+    case TR_GOTO:
+    case TR_LABEL:
+    case TR_DEFAULT:
+    case TR_CASE:
+        break;
+    case TR_RETURN:
+        if (!checkReturn(t, cont)) { return false; }
+        break;
+    case TR_COND:
+        checkTreeList(TREE_det(t), cont);
+        checkTreeList(TREE_true_part(t), cont);
+        checkTreeList(TREE_false_part(t), cont);
+        break;
+    case TR_CVT:
+        checkCvt(t, cont);
+        break;
+    case TR_TYPE_NAME: //user defined type or C standard type
+        break;
+    case TR_LDA: // &a get address of 'a'
+        checkLda(t, cont);
+        break;
+    case TR_DEREF: // *p  dereferencing the pointer 'p'
+    case TR_PLUS: // +123
+    case TR_MINUS: // -123
+    case TR_REV: // Reverse
+    case TR_NOT: // get non-value
+        checkTreeList(TREE_lchild(t), cont);
+        break;
+    case TR_INC: //++a
+    case TR_POST_INC: //a++
+        checkTreeList(TREE_inc_exp(t), cont);
+        break;
+    case TR_DEC: //--a
+    case TR_POST_DEC: //a--
+        checkTreeList(TREE_dec_exp(t), cont);
+        break;
+    case TR_SIZEOF: // sizeof(a)
+        checkTreeList(TREE_sizeof_exp(t), cont);
+        break;
+    case TR_CALL:
+        if (!checkCall(t, cont)) { return false; }
+        break;
+    case TR_ARRAY:
+        checkTreeList(TREE_array_base(t), cont);
+        checkTreeList(TREE_array_indx(t), cont);
+        break;
+    case TR_DMEM: // a.b
+    case TR_INDMEM: // a->b
+    case TR_PRAGMA:
+    case TR_PREP:
+    case TR_DECL:
+    case TR_DENSE_INIT:
+        break;
+    default: ASSERTN(0, ("unknown tree type:%d", t->getCode()));
+    }
+    return true;
+}
+
+
 //Perform type checking.
-bool checkTreeList(Tree * t, TYCtx * cont)
+static bool checkTreeList(Tree * t, TYCtx * cont)
 {
     TYCtx ct;
     if (cont == nullptr) {
         cont = &ct;
     }
     for (; t != nullptr; t = TREE_nsib(t)) {
-        g_src_line_num = t->getLineno();
-        switch (t->getCode()) {
-        case TR_ASSIGN:
-            checkAssign(t, cont);
-            break;
-        case TR_ID:
-        case TR_IMM:
-        case TR_IMML:
-        case TR_IMMU:
-        case TR_IMMUL:
-        case TR_FP: // double
-        case TR_FPF: // float
-        case TR_FPLD: // long double
-        case TR_ENUM_CONST:
-        case TR_STRING:
-            break;
-        case TR_LOGIC_OR: // logical or ||
-        case TR_LOGIC_AND: // logical and &&
-        case TR_INCLUSIVE_OR: // inclusive or |
-        case TR_XOR: // exclusive or
-        case TR_INCLUSIVE_AND: // inclusive and &
-        case TR_SHIFT: // >> <<
-        case TR_EQUALITY: // == !=
-        case TR_RELATION: // < > >= <=
-        case TR_ADDITIVE: // '+' '-'
-        case TR_MULTI: // '*' '/' '%'
-            checkTreeList(TREE_lchild(t), cont);
-            checkTreeList(TREE_rchild(t), cont);
-            break;
-        case TR_SCOPE:
-            checkDeclInit(TREE_scope(t)->getDeclList(), cont);
-            checkTreeList(TREE_scope(t)->getStmtList(), cont);
-            break;
-        case TR_INITVAL_SCOPE:
-            checkInitValScope(t, cont);
-            break;
-        case TR_IF:
-            checkTreeList(TREE_if_det(t), cont);
-            checkTreeList(TREE_if_true_stmt(t), cont);
-            checkTreeList(TREE_if_false_stmt(t), cont);
-            break;
-        case TR_DO:
-            checkTreeList(TREE_dowhile_body(t), cont);
-            checkTreeList(TREE_dowhile_det(t), cont);
-            break;
-        case TR_WHILE:
-            checkTreeList(TREE_whiledo_det(t), cont);
-            checkTreeList(TREE_whiledo_body(t), cont);
-            break;
-        case TR_FOR:
-            checkTreeList(TREE_for_init(t), cont);
-            checkTreeList(TREE_for_det(t), cont);
-            checkTreeList(TREE_for_step(t), cont);
-            checkTreeList(TREE_for_body(t), cont);
-            break;
-        case TR_SWITCH:
-            checkTreeList(TREE_switch_det(t), cont);
-            checkTreeList(TREE_switch_body(t), cont);
-            break;
-        case TR_BREAK:
-        case TR_CONTINUE:
-        case TR_GOTO:
-        case TR_LABEL:
-        case TR_DEFAULT:
-        case TR_CASE:
-            break;
-        case TR_RETURN:
-            if (!checkReturn(t, cont)) { return false; }
-            break;
-        case TR_COND:
-            checkTreeList(TREE_det(t), cont);
-            checkTreeList(TREE_true_part(t), cont);
-            checkTreeList(TREE_false_part(t), cont);
-            break;
-        case TR_CVT:
-            checkCvt(t, cont);
-            break;
-        case TR_TYPE_NAME: //user defined type or C standard type
-            break;
-        case TR_LDA: // &a get address of 'a'
-            checkLda(t, cont);
-            break;
-        case TR_DEREF: // *p  dereferencing the pointer 'p'
-        case TR_PLUS: // +123
-        case TR_MINUS: // -123
-        case TR_REV: // Reverse
-        case TR_NOT: // get non-value
-            checkTreeList(TREE_lchild(t), cont);
-            break;
-        case TR_INC: //++a
-        case TR_POST_INC: //a++
-            checkTreeList(TREE_inc_exp(t), cont);
-            break;
-        case TR_DEC: //--a
-        case TR_POST_DEC: //a--
-            checkTreeList(TREE_dec_exp(t), cont);
-            break;
-        case TR_SIZEOF: // sizeof(a)
-            checkTreeList(TREE_sizeof_exp(t), cont);
-            break;
-        case TR_CALL:
-            if (!checkCall(t, cont)) { return false; }
-            break;
-        case TR_ARRAY:
-            checkTreeList(TREE_array_base(t), cont);
-            checkTreeList(TREE_array_indx(t), cont);
-            break;
-        case TR_DMEM: // a.b
-        case TR_INDMEM: // a->b
-        case TR_PRAGMA:
-        case TR_PREP:
-        case TR_DECL:
-            break;
-        default: ASSERTN(0, ("unknown tree type:%d", t->getCode()));
-        }
+        if (!checkTree(t, cont)) { return false; }
     }
     return true;
 }
 
 
-INT TypeCheck()
+//Check the declaration of global scope.
+STATUS checkGlobalDecl(Decl * dcl)
 {
-    Scope * s = get_global_scope();
-    if (s == nullptr) { return ST_SUCC; }
-    for (Decl * dcl = s->getDeclList(); dcl != nullptr; dcl = DECL_next(dcl)) {
-        ASSERT0(dcl->getDeclScope() == s);
-        checkDeclaration(dcl);
-        if (dcl->is_fun_def()) {
-            TYCtx ct;
-            ct.current_func_declaration = dcl;
-            checkDeclInit(dcl->getFunBody()->getDeclList(), nullptr);
-            checkTreeList(dcl->getFunBody()->getStmtList(), &ct);
-            if (g_err_msg_list.has_msg()) {
-                return ST_ERR;
-            }
-        }
+    checkDeclaration(dcl);
+    if (!dcl->is_fun_def()) { return ST_SUCC; }
+    TYCtx ct;
+    ct.current_func_declaration = dcl;
+    checkDeclInit(dcl->getFunBody()->getDeclList(), nullptr);
+    checkTreeList(dcl->getFunBody()->getStmtList(), &ct);
+    if (g_err_msg_list.has_msg()) {
+        return ST_ERR;
     }
+    return ST_SUCC;
+}
+
 
-    checkTreeList(s->getStmtList(), nullptr);
+STATUS checkGlobalStmt()
+{
+    checkTreeList(get_global_scope()->getStmtList(), nullptr);
     if (g_err_msg_list.has_msg()) {
         return ST_ERR;
     }
-
     return ST_SUCC;
 }
 
+
+INT TypeCheck()
+{
+    Scope * s = get_global_scope();
+    if (s == nullptr) { return ST_SUCC; }
+    if (ST_SUCC != performFuncTask(checkGlobalDecl, nullptr)) {
+        return ST_ERR;
+    }
+    return checkGlobalStmt();
+}
+
 } //namespace xfe
@@ -69,6 +69,22 @@ public:
 };
 
 bool isConsistentWithPointer(Tree * t);
+
+//Check the declaration-type of declaration 'd'.
+INT checkDeclaration(Decl const* d);
+
+//Check the initializing trees of each declaration in list 'decl'.
+void checkDeclInit(Decl const* decl, TYCtx * cont);
+
+//Perform type checking for tree 't', whereas the siblings of 't' are
+//not checked.
+//Return false if checking should not go on to the siblings of 't'.
+bool checkTree(Tree * t, TYCtx * cont);
+
+//Check the declaration 'dcl' of global scope, and the stmt list of global
+//scope respectively.
+STATUS checkGlobalDecl(Decl * dcl);
+STATUS checkGlobalStmt();
 INT TypeCheck();
 
 } //namespace xfe
@@ -0,0 +1,396 @@
+/*@
+Copyright (c) 2013-2021, Su Zhenyu steven.known@gmail.com
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the Su Zhenyu nor the names of its contributors
+      may be used to endorse or promote products derived from this software
+      without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+@*/
+#include "cfeinc.h"
+
+namespace xfe {
+
+//The initial bucket size of TypeTab.
+#define TYPE_TAB_INIT_SIZE 64
+
+//The pool does not align the memory, and the general pool also holds the
+//objects of variable length. Allocate extra bytes to pad the memory to
+//the alignment of TypeTabEntry.
+static void * xmalloc(size_t size)
+{
+    size_t align = alignof(TypeTabEntry);
+    BYTE * p = (BYTE*)smpoolMalloc(size + align - 1, g_pool_general_used);
+    ASSERT0(p);
+    p += (align - (size_t)p % align) % align;
+    ::memset((void*)p, 0, size);
+    return p;
+}
+
+
+static inline UINT64 mixHash(UINT64 h, UINT64 v)
+{
+    return h ^ (v + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2));
+}
+
+
+//Return true if 'spec' only consists of descriptor.
+static bool isBareSpec(TypeAttr const* spec)
+{
+    if (spec->is_user_type_ref() || TYPE_user_type(spec) != nullptr ||
+        spec->u1.anony != nullptr) {
+        return false;
+    }
+    for (UINT i = 0; i < MAX_TYPE_FLD; i++) {
+        if (spec->m_sub_field[i] != nullptr) { return false; }
+    }
+    return true;
+}
+
+
+static UINT64 hashSpec(UINT64 h, TypeAttr const* spec)
+{
+    if (spec == nullptr) { return mixHash(h, 0); }
+    if (isBareSpec(spec)) { return mixHash(h, (UINT64)TYPE_des(spec)); }
+    return mixHash(h, (UINT64)(size_t)spec);
+}
+
+
+//Return true if 'canon' is the canonical specifier of 'spec'.
+static bool isSameSpec(TypeAttr const* canon, TypeAttr const* spec)
+{
+    if (canon == spec) { return true; }
+    if (canon == nullptr || spec == nullptr) { return false; }
+    return isBareSpec(canon) && isBareSpec(spec) &&
+           TYPE_des(canon) == TYPE_des(spec);
+}
+
+
+static UINT64 hashTrait(UINT64 h, Decl const* t)
+{
+    h = mixHash(h, (UINT64)DECL_dt(t));
+    h = mixHash(h, (UINT64)DECL_is_paren(t));
+    switch (DECL_dt(t)) {
+    case DCL_POINTER:
+        return hashSpec(h, DECL_qua(t));
+    case DCL_ARRAY:
+        return mixHash(h, (UINT64)DECL_array_dim(t));
+    case DCL_FUN:
+        return mixHash(h, (UINT64)(size_t)DECL_fun_para_list(t));
+    default: UNREACHABLE();
+    }
+    return h;
+}
+
+
+TypeTab::TypeTab()
+{
+    m_elem_count = 0;
+    m_bucket_size = 0;
+    m_bucket = nullptr;
+}
+
+
+TypeTabEntry ** TypeTab::allocBucket(UINT size)
+{
+    return (TypeTabEntry**)xmalloc(sizeof(TypeTabEntry*) * size);
+}
+
+
+UINT64 TypeTab::computeHash(TypeAttr const* spec, Decl const* head,
+                            Decl const* traits)
+{
+    UINT64 h = hashSpec(0, spec);
+    if (head != nullptr) {
+        h = hashTrait(h, head);
+    }
+    for (Decl const* t = traits; t != nullptr; t = DECL_next(t)) {
+        h = hashTrait(h, t);
+    }
+    return h;
+}
+
+
+TypeAttr * TypeTab::getCanonSpec(TypeAttr * spec)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    return internSpec(spec);
+}
+
+
+TypeAttr * TypeTab::internSpec(TypeAttr * spec)
+{
+    if (spec == nullptr || !isBareSpec(spec)) { return spec; }
+    bool find = false;
+    TypeAttr * canon = m_des2spec.get(TYPE_des(spec), &find);
+    if (find) { return canon; }
+    canon = newTypeAttr(TYPE_des(spec));
+    m_des2spec.set(TYPE_des(spec), canon);
+    m_spec_vec.append(canon);
+    return canon;
+}
+
+
+TypeAttr * TypeTab::getCanonQua(TypeAttr * qua)
+{
+    return internSpec(qua);
+}
+
+
+void TypeTab::grow()
+{
+    UINT newsize = m_bucket_size == 0 ?
+        TYPE_TAB_INIT_SIZE : m_bucket_size * 2;
+    TypeTabEntry ** newbucket = allocBucket(newsize);
+    for (UINT i = 0; i < m_bucket_size; i++) {
+        TypeTabEntry * next = nullptr;
+        for (TypeTabEntry * e = m_bucket[i]; e != nullptr; e = next) {
+            next = TYPE_TAB_ENTRY_next(e);
+            UINT pos = (UINT)(TYPE_TAB_ENTRY_hash(e) & (newsize - 1));
+            TYPE_TAB_ENTRY_next(e) = newbucket[pos];
+            newbucket[pos] = e;
+        }
+    }
+    //The old bucket is recycled along with the pool.
+    m_bucket = newbucket;
+    m_bucket_size = newsize;
+}
+
+
+bool TypeTab::isEqualTrait(Decl const* t1, Decl const* t2)
+{
+    if (DECL_dt(t1) != DECL_dt(t2) ||
+        DECL_is_paren(t1) != DECL_is_paren(t2)) {
+        return false;
+    }
+    switch (DECL_dt(t1)) {
+    case DCL_POINTER:
+        return isSameSpec(DECL_qua(t1), DECL_qua(t2));
+    case DCL_ARRAY:
+        return DECL_array_dim(t1) == DECL_array_dim(t2);
+    case DCL_FUN:
+        return DECL_fun_para_list(t1) == DECL_fun_para_list(t2);
+    default: UNREACHABLE();
+    }
+    return false;
+}
+
+
+//Return true if canonical type-name 'tn' is identical to the type-name that
+//consists of 'spec', 'head' and 'traits'.
+bool TypeTab::isEqual(Decl const* tn, TypeAttr const* spec, Decl const* head,
+                      Decl const* traits)
+{
+    if (!isSameSpec(DECL_spec(tn), spec)) { return false; }
+    Decl const* t = DECL_trait(tn);
+    if (head != nullptr) {
+        if (t == nullptr || !isEqualTrait(t, head)) { return false; }
+        t = DECL_next(t);
+    }
+    for (; t != nullptr && traits != nullptr;
+         t = DECL_next(t), traits = DECL_next(traits)) {
+        if (!isEqualTrait(t, traits)) { return false; }
+    }
+    return t == nullptr && traits == nullptr;
+}
+
+
+//Only POINTER, ARRAY and FUN could be the trait of canonical type-name.
+bool TypeTab::isInternable(Decl const* head, Decl const* traits)
+{
+    if (head != nullptr && !head->is_dt_pointer() && !head->is_dt_array() &&
+        !head->is_dt_fun()) {
+        return false;
+    }
+    for (Decl const* t = traits; t != nullptr; t = DECL_next(t)) {
+        if (!t->is_dt_pointer() && !t->is_dt_array() && !t->is_dt_fun()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+Decl * TypeTab::newTypeName(TypeAttr * spec, Decl const* head,
+                            Decl const* traits)
+{
+    Decl * tn = newDecl(DCL_TYPE_NAME);
+    DECL_decl_list(tn) = newDecl(DCL_ABS_DECLARATOR);
+    DECL_spec(tn) = internSpec(spec);
+    DECL_is_canon_type(tn) = true;
+    Decl * last = nullptr;
+    for (Decl const* t = head != nullptr ? head : traits; t != nullptr;
+         t = (t == head) ? traits : DECL_next(t)) {
+        Decl * q = dupDecl(t);
+        if (q->is_dt_pointer()) {
+            DECL_qua(q) = getCanonQua(DECL_qua(q));
+        }
+        xcom::add_next(&DECL_trait(tn), &last, q);
+    }
+    return tn;
+}
+
+
+Decl * TypeTab::getTypeName(TypeAttr * spec, Decl const* head,
+                            Decl const* traits)
+{
+    ASSERT0(spec);
+    if (!isInternable(head, traits)) { return nullptr; }
+    std::lock_guard<std::mutex> guard(m_lock);
+    return intern(spec, head, traits);
+}
+
+
+Decl * TypeTab::intern(TypeAttr * spec, Decl const* head, Decl const* traits)
+{
+    UINT64 h = computeHash(spec, head, traits);
+    if (m_bucket_size != 0) {
+        UINT pos = (UINT)(h & (m_bucket_size - 1));
+        for (TypeTabEntry * e = m_bucket[pos]; e != nullptr;
+             e = TYPE_TAB_ENTRY_next(e)) {
+            if (TYPE_TAB_ENTRY_hash(e) == h &&
+                isEqual(TYPE_TAB_ENTRY_type_name(e), spec, head, traits)) {
+                return TYPE_TAB_ENTRY_type_name(e);
+            }
+        }
+    }
+    if (m_elem_count >= m_bucket_size) {
+        grow();
+    }
+    TypeTabEntry * e = (TypeTabEntry*)xmalloc(sizeof(TypeTabEntry));
+    TYPE_TAB_ENTRY_hash(e) = h;
+    TYPE_TAB_ENTRY_type_name(e) = newTypeName(spec, head, traits);
+    UINT pos = (UINT)(h & (m_bucket_size - 1));
+    TYPE_TAB_ENTRY_next(e) = m_bucket[pos];
+    m_bucket[pos] = e;
+    m_elem_count++;
+    m_entry_vec.append(e);
+    return TYPE_TAB_ENTRY_type_name(e);
+}
+
+
+Decl * TypeTab::getPointerTypeName(TypeAttr * spec, Decl const* traits)
+{
+    //Prototype of the trait that prepends to the traits of type-name.
+    Decl head;
+    ::memset((void*)&head, 0, sizeof(Decl));
+    DECL_dt(&head) = DCL_POINTER;
+    return getTypeName(spec, &head, traits);
+}
+
+
+Decl * TypeTab::getArrayTypeName(TypeAttr * spec, ULONGLONG dim)
+{
+    Decl head;
+    ::memset((void*)&head, 0, sizeof(Decl));
+    DECL_dt(&head) = DCL_ARRAY;
+    DECL_array_dim(&head) = dim;
+    return getTypeName(spec, &head, nullptr);
+}
+
+
+TypeTabMark TypeTab::mark()
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    TypeTabMark m;
+    TYPE_TAB_MARK_entry_num(m) = m_elem_count;
+    TYPE_TAB_MARK_spec_num(m) = m_spec_vec.get_elem_count();
+    TYPE_TAB_MARK_bucket(m) = m_bucket;
+    TYPE_TAB_MARK_bucket_size(m) = m_bucket_size;
+    return m;
+}
+
+
+//Rehash the entries in creation order into 'bucket', thus the order of
+//entries in each bucket list is the same as the order before grow().
+void TypeTab::rebuildBucket(TypeTabEntry ** bucket, UINT size)
+{
+    ::memset((void*)bucket, 0, sizeof(TypeTabEntry*) * size);
+    for (UINT i = 0; i < m_elem_count; i++) {
+        TypeTabEntry * e = m_entry_vec.get(i);
+        UINT pos = (UINT)(TYPE_TAB_ENTRY_hash(e) & (size - 1));
+        TYPE_TAB_ENTRY_next(e) = bucket[pos];
+        bucket[pos] = e;
+    }
+    m_bucket = bucket;
+    m_bucket_size = size;
+}
+
+
+void TypeTab::release(TypeTabMark const& mark)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    UINT entry_num = TYPE_TAB_MARK_entry_num(mark);
+    ASSERT0(entry_num <= m_elem_count);
+    if (m_bucket != TYPE_TAB_MARK_bucket(mark)) {
+        //The bucket has grown after the mark, the new bucket is allocated
+        //after the mark as well. Restore the old one.
+        m_elem_count = entry_num;
+        if (TYPE_TAB_MARK_bucket(mark) == nullptr) {
+            m_bucket = nullptr;
+            m_bucket_size = 0;
+        } else {
+            rebuildBucket(TYPE_TAB_MARK_bucket(mark),
+                          TYPE_TAB_MARK_bucket_size(mark));
+        }
+    } else {
+        //Each new entry was prepended to its bucket list, thus the entries
+        //that created after the mark are at the head of the lists.
+        for (UINT i = m_elem_count; i > entry_num; i--) {
+            TypeTabEntry * e = m_entry_vec.get(i - 1);
+            UINT pos = (UINT)(TYPE_TAB_ENTRY_hash(e) & (m_bucket_size - 1));
+            ASSERT0(m_bucket[pos] == e);
+            m_bucket[pos] = TYPE_TAB_ENTRY_next(e);
+        }
+        m_elem_count = entry_num;
+    }
+    if (entry_num < m_entry_vec.get_elem_count()) {
+        m_entry_vec.cleanFrom(entry_num);
+    }
+
+    UINT spec_num = TYPE_TAB_MARK_spec_num(mark);
+    for (UINT i = spec_num; i < m_spec_vec.get_elem_count(); i++) {
+        m_des2spec.remove(TYPE_des(m_spec_vec.get(i)));
+    }
+    if (spec_num < m_spec_vec.get_elem_count()) {
+        m_spec_vec.cleanFrom(spec_num);
+    }
+}
+
+
+bool TypeTab::isExactCanon(Decl const* tn)
+{
+    if (!DECL_is_canon_type(tn)) { return false; }
+    TypeAttr const* spec = DECL_spec(tn);
+    if (!isBareSpec(spec) || spec->is_typedef()) { return false; }
+    for (Decl const* t = DECL_trait(tn); t != nullptr; t = DECL_next(t)) {
+        //Decl::is_equal() neglects the parentheses and the parameters of
+        //function.
+        if (t->is_dt_fun() || DECL_is_paren(t)) { return false; }
+        if (t->is_dt_pointer() && DECL_qua(t) != nullptr &&
+            !isBareSpec(DECL_qua(t))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} //namespace xfe
@@ -0,0 +1,149 @@
+/*@
+Copyright (c) 2013-2021, Su Zhenyu steven.known@gmail.com
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the Su Zhenyu nor the names of its contributors
+      may be used to endorse or promote products derived from this software
+      without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+@*/
+#ifndef __TYPETAB_H__
+#define __TYPETAB_H__
+
+namespace xfe {
+
+//The class records one canonical type-name in TypeTab.
+#define TYPE_TAB_ENTRY_next(e) ((e)->next)
+#define TYPE_TAB_ENTRY_hash(e) ((e)->hash)
+#define TYPE_TAB_ENTRY_type_name(e) ((e)->type_name)
+class TypeTabEntry {
+public:
+    TypeTabEntry * next;
+    UINT64 hash;
+    Decl * type_name;
+};
+
+
+//The class records the state of TypeTab. The canonical objects that created
+//after the mark can be dropped all together by TypeTab::release().
+#define TYPE_TAB_MARK_entry_num(m) ((m).entry_num)
+#define TYPE_TAB_MARK_spec_num(m) ((m).spec_num)
+#define TYPE_TAB_MARK_bucket(m) ((m).bucket)
+#define TYPE_TAB_MARK_bucket_size(m) ((m).bucket_size)
+class TypeTabMark {
+public:
+    UINT entry_num;
+    UINT spec_num;
+    TypeTabEntry ** bucket;
+    UINT bucket_size;
+};
+
+
+//TypeTab interns the canonical type descriptors of one compilation.
+//Structurally identical type-names share one TYPE_NAME Decl, thus the result
+//type of expressions do not need to be allocated for each tree node, and
+//the identity of two canonical types could be determined by pointer compare.
+//A type-name is keyed by its specifier and the list of traits, where the
+//specifier that only consists of descriptor is canonicalized by descriptor,
+//whereas the specifier of aggregate, enum and user-type is keyed by its
+//address, because these specifiers may be refilled after parsing.
+//NOTE: the canonical type-name, its declarator and traits are shared by all
+//users, thus they MUST NOT be modified. Call dupTypeName() to get a private
+//copy before modification.
+//The table is shared by the task contexts that run concurrently, thus the
+//access to the table is serialized by lock. The canonical objects are
+//allocated in the pool of the context that first requests them.
+class TypeTab {
+    COPY_CONSTRUCTOR(TypeTab);
+    UINT m_elem_count;
+    UINT m_bucket_size;
+    TypeTabEntry ** m_bucket;
+    xcom::TMap<DesSet, TypeAttr*> m_des2spec;
+    std::mutex m_lock;
+
+    //Record the entries and the canonical specifiers in creation order.
+    xcom::Vector<TypeTabEntry*> m_entry_vec;
+    xcom::Vector<TypeAttr*> m_spec_vec;
+protected:
+    TypeTabEntry ** allocBucket(UINT size);
+    static UINT64 computeHash(TypeAttr const* spec, Decl const* head,
+                              Decl const* traits);
+    TypeAttr * getCanonQua(TypeAttr * qua);
+    void grow();
+    static bool isEqualTrait(Decl const* t1, Decl const* t2);
+    static bool isEqual(Decl const* tn, TypeAttr const* spec,
+                        Decl const* head, Decl const* traits);
+    static bool isInternable(Decl const* head, Decl const* traits);
+    void rebuildBucket(TypeTabEntry ** bucket, UINT size);
+
+    //The following functions are the implementation of the interfaces
+    //of the same name without lock.
+    TypeAttr * internSpec(TypeAttr * spec);
+    Decl * intern(TypeAttr * spec, Decl const* head, Decl const* traits);
+    Decl * newTypeName(TypeAttr * spec, Decl const* head,
+                       Decl const* traits);
+public:
+    TypeTab();
+
+    //Return the canonical specifier of 'spec'.
+    //The specifier that only consists of descriptor is interned by the
+    //descriptor, otherwise 'spec' itself is canonical.
+    TypeAttr * getCanonSpec(TypeAttr * spec);
+    UINT get_elem_count() const { return m_elem_count; }
+
+    //Return the canonical type-name that consists of 'spec', the leading
+    //trait 'head' and the trait list 'traits'. 'head' may be nullptr, and
+    //its next is neglected. 'traits' may be nullptr.
+    //Return nullptr if the traits can not be interned.
+    Decl * getTypeName(TypeAttr * spec, Decl const* head, Decl const* traits);
+
+    //Return the canonical type-name of 'spec' without any trait.
+    Decl * getTypeName(TypeAttr * spec)
+    { return getTypeName(spec, nullptr, nullptr); }
+
+    //Return the canonical type-name that consists of 'spec' and 'traits'.
+    Decl * getTypeName(TypeAttr * spec, Decl const* traits)
+    { return getTypeName(spec, nullptr, traits); }
+
+    //Return the canonical type-name of pointer that points to 'traits'.
+    //e.g: given spec is 'int', traits is '[10]', return 'int (*)[10]'.
+    Decl * getPointerTypeName(TypeAttr * spec, Decl const* traits);
+
+    //Return the canonical type-name of array of 'spec' with 'dim' elements.
+    Decl * getArrayTypeName(TypeAttr * spec, ULONGLONG dim);
+
+    //Return the current state of table.
+    TypeTabMark mark();
+
+    //Drop the canonical objects that created after 'mark', the table
+    //returns to the state of the mark. The function is used when the memory
+    //allocated after the mark is about to be released, e.g: the objects
+    //that created for a function body in streaming mode.
+    void release(TypeTabMark const& mark);
+
+    //Return true if 'tn' is canonical type-name, and the canonicalization
+    //is exact, namely, two such type-names are equal if and only if they are
+    //the same object.
+    static bool isExactCanon(Decl const* tn);
+};
+
+} //namespace xfe
+#endif
@@ -36,22 +36,22 @@ static INT process_singledim_array_init_recur(
     Decl * dcl, TypeAttr * ty, MOD Tree ** init, bool has_declared_dim,
     ULONGLONG dim, OUT ULONGLONG * count);
 
-#define BUILD_TYNAME(T)  buildTypeName(buildBaseTypeSpec(T))
-
-static TypeAttr * g_schar_type;
-static TypeAttr * g_sshort_type;
-static TypeAttr * g_sint_type;
-static TypeAttr * g_slong_type;
-static TypeAttr * g_slonglong_type;
-static TypeAttr * g_uchar_type;
-static TypeAttr * g_ushort_type;
-static TypeAttr * g_uint_type;
-static TypeAttr * g_ulong_type;
-static TypeAttr * g_ulonglong_type;
-static TypeAttr * g_float_type;
-static TypeAttr * g_double_type;
-static TypeAttr * g_void_type;
-static TypeAttr * g_enum_type;
+#define BUILD_TYNAME(T)  g_type_tab->getTypeName(buildBaseTypeSpec(T))
+
+#define g_schar_type CTX_schar_type(g_cur_ctx)
+#define g_sshort_type CTX_sshort_type(g_cur_ctx)
+#define g_sint_type CTX_sint_type(g_cur_ctx)
+#define g_slong_type CTX_slong_type(g_cur_ctx)
+#define g_slonglong_type CTX_slonglong_type(g_cur_ctx)
+#define g_uchar_type CTX_uchar_type(g_cur_ctx)
+#define g_ushort_type CTX_ushort_type(g_cur_ctx)
+#define g_uint_type CTX_uint_type(g_cur_ctx)
+#define g_ulong_type CTX_ulong_type(g_cur_ctx)
+#define g_ulonglong_type CTX_ulonglong_type(g_cur_ctx)
+#define g_float_type CTX_float_type(g_cur_ctx)
+#define g_double_type CTX_double_type(g_cur_ctx)
+#define g_void_type CTX_void_type(g_cur_ctx)
+#define g_enum_type CTX_enum_type(g_cur_ctx)
 
 static INT process_pointer_init(Decl const* dcl, TypeAttr * ty, Tree ** init);
 static INT process_struct_init(TypeAttr * ty, Tree ** init);
@@ -197,6 +197,7 @@ static INT process_array_init_recur(Decl * dcl, TypeAttr * ty, Tree ** init)
     if (!has_declared_dim) {
         //Complete the array declaration by padding dimension.
         DECL_array_dim(head) = count;
+        g_layout_epoch++;
     }
     return st;
 }
@@ -604,11 +605,7 @@ static Decl * buildBinaryOpType(TREE_CODE tok, Decl * l, Decl * r)
 static Decl * buildPointerType(TypeAttr * ty)
 {
     ASSERT0(ty);
-    Decl * newdecl = buildTypeName(ty);
-    ASSERT0(DECL_decl_list(newdecl) &&
-            DECL_decl_list(newdecl)->is_dt_abs_declarator());
-    DECL_trait(newdecl) = newDecl(DCL_POINTER);
-    return newdecl;
+    return g_type_tab->getPointerTypeName(ty, nullptr);
 }
 
 
@@ -728,6 +725,7 @@ static bool findAndRefillAggrField(Decl const* base, Sym const* field_name,
             //Try to find complete aggr declaration in outer scope.
             ASSERT0(findone && findone->is_complete());
             TYPE_aggr_type(base_spec) = findone;
+            g_layout_epoch++;
             field_list = findone->getDeclList();
         }
 
@@ -770,6 +768,7 @@ static bool findAndRefillAggrField(Decl const* base, Sym const* field_name,
                                     (*field_decl)->getTypeAttr(), &findone2)) {
             //Update and refill current field's type-specifier.
             TYPE_aggr_type((*field_decl)->getTypeAttr()) = findone2;
+            g_layout_epoch++;
         }
     }
     return true;
@@ -799,51 +798,35 @@ static INT TypeTranIDField(Tree * t, Decl ** field_decl, TYCtx * cont)
 }
 
 
-//Return sub-dimension type if 'decl' is multi-dimensional array or multi-level
-//pointer.
-//e.g: given ID->ARRAY[10]->ARRAY[20], return ID->ARRAY[10].
-static void reduceDimForArrayOrPointer(Decl * decl)
-{
-    ASSERT0(decl);
-    ASSERT0(decl->is_dt_declaration() || decl->is_dt_typename());
-    Decl * dcl = DECL_trait(decl); //dcl will changed.
-    if (dcl->is_dt_id()) {
-        dcl = DECL_next(dcl);
-    }
-    if (dcl->is_dt_array() || dcl->is_dt_pointer()) {
-        xcom::remove(&DECL_trait(decl), dcl);
-    }
-}
-
-
 //Reduce the number of DCL_POINTER of function-pointer, and remain only
 //one.
 //e.g: In C, you can define function pointer like: int (*******fun)();
 //     We will simply it to be 'int (*fun)()'.
-static Decl * refineFuncPtr(Decl * dcl_list)
+//Return the first DCL of 'dcl_list' that is left after the refinement, the
+//function does not modify 'dcl_list'.
+static Decl const* findRefinedFuncPtr(Decl const* dcl_list)
 {
-    Decl * tmp = dcl_list;
-    while (tmp != nullptr) {
-        if (tmp->is_dt_pointer()) {
-            tmp = DECL_next(tmp);
-        } else {
-            if (tmp->is_dt_fun()) {
-                break;
-            } else {
-                tmp = dcl_list;
-                break;
-            }
-        }
+    Decl const* tmp = dcl_list;
+    while (tmp != nullptr && tmp->is_dt_pointer()) {
+        tmp = DECL_next(tmp);
     }
-
     if (tmp != nullptr && tmp->is_dt_fun() &&
         DECL_prev(tmp) != nullptr && DECL_prev(tmp)->is_dt_pointer()) {
         //CASE: tmp is PTR->FUN.
         //Change traits of result-type of 't' to be function pointer.
-        tmp = DECL_prev(tmp);
+        return DECL_prev(tmp);
+    }
+    return dcl_list;
+}
+
+
+static Decl * refineFuncPtr(Decl * dcl_list)
+{
+    Decl * tmp = const_cast<Decl*>(findRefinedFuncPtr(dcl_list));
+    if (tmp != nullptr) {
         DECL_prev(tmp) = nullptr;
     }
-    return tmp != nullptr ? tmp : dcl_list;
+    return tmp;
 }
 
 
@@ -869,57 +852,64 @@ static INT TypeTranID(Tree * t, TYCtx * cont)
         id_decl = expandUserType(id_decl);
     }
 
+    Decl * traits = const_cast<Decl*>(id_decl->getTraitList());
+    ASSERTN(traits->is_dt_id(),
+            ("'id' should be declarator-list-head. Illegal declaration"));
+    Decl * declarator = id_decl->getPureDeclaratorList();
+    if (!DECL_is_bit_field(declarator)) {
+        //Because we are building Type-Name, neglect the first DCL_ID node,
+        //we only need the rest decl-type to build Abs-Declarator.
+        //The result-type of 't' is the canonical type-name of ID.
+        TREE_result_type(t) = g_type_tab->getTypeName(
+            id_decl->getTypeAttr(), findRefinedFuncPtr(DECL_next(traits)));
+        ASSERT0(TREE_result_type(t));
+        return ST_SUCC;
+    }
+
     //Construct TYPE_NAME for ID, that would
     //be used to infer decl-type of tree node.
     Decl * res_ty = buildTypeName(id_decl->getTypeAttr());
     TREE_result_type(t) = res_ty;
-    Decl * declarator = id_decl->getPureDeclaratorList();
-    if (DECL_is_bit_field(declarator)) {
-        //Set bit info if idenifier is bitfield.
-        //Bitfield info is stored at declarator list.
-        DECL_is_bit_field(DECL_decl_list(res_ty)) = true;
-        DECL_bit_len(DECL_decl_list(res_ty)) = DECL_bit_len(declarator);
-
-        //Check bitfield properties.
-        if (id_decl->is_pointer()) {
-            xcom::DefFixedStrBuf buf;
-            format_declaration(buf, id_decl, true);
-            err(t->getLineno(),
-                "'%s' : pointer cannot assign bit length", buf.getBuf());
-            return ST_ERR;
-        }
+    //Set bit info if idenifier is bitfield.
+    //Bitfield info is stored at declarator list.
+    DECL_is_bit_field(DECL_decl_list(res_ty)) = true;
+    DECL_bit_len(DECL_decl_list(res_ty)) = DECL_bit_len(declarator);
 
-        if (id_decl->is_array()) {
-            xcom::DefFixedStrBuf buf;
-            format_declaration(buf, id_decl, true);
-            err(t->getLineno(),
-                "'%s' : array type cannot assign bit length", buf.getBuf());
-            return ST_ERR;
-        }
+    //Check bitfield properties.
+    if (id_decl->is_pointer()) {
+        xcom::DefFixedStrBuf buf;
+        format_declaration(buf, id_decl, true);
+        err(t->getLineno(),
+            "'%s' : pointer cannot assign bit length", buf.getBuf());
+        return ST_ERR;
+    }
 
-        if (!id_decl->is_integer()) {
-            xcom::DefFixedStrBuf buf;
-            format_declaration(buf, id_decl, true);
-            err(t->getLineno(), "'%s' : bit field must have integer type",
-                buf.getBuf());
-            return ST_ERR;
-        }
+    if (id_decl->is_array()) {
+        xcom::DefFixedStrBuf buf;
+        format_declaration(buf, id_decl, true);
+        err(t->getLineno(),
+            "'%s' : array type cannot assign bit length", buf.getBuf());
+        return ST_ERR;
+    }
 
-        //Check bitfield's base type is big enough to hold it.
-        UINT size = id_decl->getDeclByteSize() * BIT_PER_BYTE;
-        if (size < (UINT)DECL_bit_len(declarator)) {
-            xcom::DefFixedStrBuf buf;
-            format_declaration(buf, id_decl, true);
-            err(t->getLineno(),
-                "'%s' : type of bit field too small for number of bits",
-                buf.getBuf());
-            return ST_ERR;
-        }
+    if (!id_decl->is_integer()) {
+        xcom::DefFixedStrBuf buf;
+        format_declaration(buf, id_decl, true);
+        err(t->getLineno(), "'%s' : bit field must have integer type",
+            buf.getBuf());
+        return ST_ERR;
     }
 
-    Decl * traits = const_cast<Decl*>(id_decl->getTraitList());
-    ASSERTN(traits->is_dt_id(),
-            ("'id' should be declarator-list-head. Illegal declaration"));
+    //Check bitfield's base type is big enough to hold it.
+    UINT size = id_decl->getDeclByteSize() * BIT_PER_BYTE;
+    if (size < (UINT)DECL_bit_len(declarator)) {
+        xcom::DefFixedStrBuf buf;
+        format_declaration(buf, id_decl, true);
+        err(t->getLineno(),
+            "'%s' : type of bit field too small for number of bits",
+            buf.getBuf());
+        return ST_ERR;
+    }
 
     //Because we are building Type-Name, neglect the first DCL_ID node,
     //we only need the rest decl-type to build Abs-Declarator.
@@ -952,24 +942,24 @@ static INT TypeTranDeref(Tree * t, TYCtx * cont)
         return ST_ERR;
     }
 
-    Decl * td = dupTypeName(ld);
-    ld = DECL_trait(td); //ld may changed.
-    ASSERTN(ld, ("left child must be pointer type"));
-    if (ld->is_dt_pointer() || ld->is_dt_array()) {
+    Decl const* trait = DECL_trait(ld);
+    ASSERTN(trait, ("left child must be pointer type"));
+    if (trait->is_dt_pointer() || trait->is_dt_array()) {
         //In C, base of array only needs address, so the DEREF
         //operator has alias effect. It means ARRAY(LD(p)) for
         //given declaration: int (*p)[].
         //
         //The value is needed if there is not an ARRAY operator,
         //e.g: a = *p, should generate a=LD(LD(p)).
-        xcom::remove(&DECL_trait(td), ld);
-    } else if (ld->is_dt_fun()) {
+        trait = DECL_next(trait);
+    } else if (trait->is_dt_fun()) {
         //ACCEPT
     } else {
         err(t->getLineno(), "illegal indirection");
         return ST_ERR;
     }
-    TREE_result_type(t) = td;
+    TREE_result_type(t) = g_type_tab->getTypeName(ld->getTypeAttr(), trait);
+    ASSERT0(TREE_result_type(t));
     return ST_SUCC;
 }
 
@@ -1195,8 +1185,9 @@ static INT TypeTranInDMem(Tree * t, TYCtx * cont)
         return ST_ERR;
     }
 
-    TREE_result_type(t) = buildTypeName(rd->getTypeAttr());
-    DECL_trait(TREE_result_type(t)) = dupDeclBeginAt(DECL_trait(rd));
+    TREE_result_type(t) = g_type_tab->getTypeName(rd->getTypeAttr(),
+                                                  DECL_trait(rd));
+    ASSERT0(TREE_result_type(t));
     return ST_SUCC;
 }
 
@@ -1235,8 +1226,9 @@ static INT TypeTranDMem(Tree * t, TYCtx * cont)
         return ST_ERR;
     }
 
-    TREE_result_type(t) = buildTypeName(rd->getTypeAttr());
-    DECL_trait(TREE_result_type(t)) = dupDeclBeginAt(DECL_trait(rd));
+    TREE_result_type(t) = g_type_tab->getTypeName(rd->getTypeAttr(),
+                                                  DECL_trait(rd));
+    ASSERT0(TREE_result_type(t));
     return ST_SUCC;
 }
 
@@ -1261,14 +1253,16 @@ static INT TypeTranArray(Tree * t, TYCtx * cont)
 
     //Return sub-dimension type if 'basetype' is
     //multi-dimensional array or multi-level pointer.
-    Decl * resty = dupTypeName(basetype);
-    if (resty->getTraitList() == nullptr) {
+    Decl const* trait = basetype->getTraitList();
+    if (trait == nullptr) {
         err(t->getLineno(),
             "The referrence of array is not match with its declaration.");
-    } else {
-        reduceDimForArrayOrPointer(resty);
+    } else if (trait->is_dt_array() || trait->is_dt_pointer()) {
+        trait = DECL_next(trait);
     }
-    TREE_result_type(t) = resty;
+    TREE_result_type(t) = g_type_tab->getTypeName(basetype->getTypeAttr(),
+                                                  trait);
+    ASSERT0(TREE_result_type(t));
     return ST_SUCC;
 }
 
@@ -1422,7 +1416,7 @@ static INT TypeTranAdditive(Tree * t, TYCtx * cont)
 }
 
 
-static INT TypeTranDeclInit(Decl * decl, TYCtx * cont)
+INT TypeTranDeclInit(Decl * decl, TYCtx * cont)
 {
     ASSERT0(decl->is_initialized());
     Tree * inittree = decl->getDeclInitTree();
@@ -1437,7 +1431,7 @@ static INT TypeTranDeclInit(Decl * decl, TYCtx * cont)
 }
 
 
-static INT TypeTranDeclInitList(Decl const* decl, TYCtx * cont)
+INT TypeTranDeclInitList(Decl const* decl, TYCtx * cont)
 {
     for (Decl const* dcl = decl; dcl != nullptr; dcl = DECL_next(dcl)) {
         ASSERT0(dcl->is_dt_declaration());
@@ -1649,12 +1643,10 @@ INT TypeTran(Tree * t, TYCtx * cont)
         TREE_result_type(t) = BUILD_TYNAME(T_SPEC_ENUM|T_QUA_CONST);
         break;
     case TR_STRING: {
-        Decl * tn = BUILD_TYNAME(T_SPEC_CHAR|T_QUA_CONST);
-        Decl * d = newDecl(DCL_ARRAY);
         ASSERT0(TREE_string_val(t));
-        DECL_array_dim(d) = TREE_string_val(t)->getLen() + 1;
-        xcom::add_next(&DECL_trait(tn), d);
-        TREE_result_type(t) = tn;
+        TREE_result_type(t) = g_type_tab->getArrayTypeName(
+            buildBaseTypeSpec(T_SPEC_CHAR|T_QUA_CONST),
+            TREE_string_val(t)->getLen() + 1);
         break;
     }
     case TR_LOGIC_OR: //logical or ||
@@ -1850,6 +1842,7 @@ INT TypeTran(Tree * t, TYCtx * cont)
     case TR_PRAGMA:
     case TR_PREP:
     case TR_DECL:
+    case TR_DENSE_INIT:
         break;
     default: ASSERTN(0, ("unknown tree type:%d", t->getCode()));
     }
@@ -1880,34 +1873,55 @@ void initTypeTran()
 }
 
 
-//Infer type to tree nodes.
-INT TypeTransform()
+//Infer type to tree nodes of the declaration of global scope.
+STATUS TypeTranGlobalDecl(Decl * dcl)
 {
-    initTypeTran();
-    Scope * s = get_global_scope();
-    if (s == nullptr) { return ST_SUCC; }
-    for (Decl * dcl = s->getDeclList(); dcl != nullptr; dcl = DECL_next(dcl)) {
-        ASSERT0(dcl->getDeclScope() == s);
-        TYCtx cont;
-        if (dcl->is_fun_def()) {
-            if (ST_SUCC != TypeTranScope(dcl->getFunBody(), &cont) ||
-                g_err_msg_list.has_msg()) {
-                return ST_ERR;
-            }
+    TYCtx cont;
+    if (dcl->is_fun_def()) {
+        if (ST_SUCC != TypeTranScope(dcl->getFunBody(), &cont) ||
+            g_err_msg_list.has_msg()) {
+            return ST_ERR;
         }
-        if (dcl->is_initialized()) {
-            if (ST_SUCC != TypeTranDeclInit(dcl, &cont) ||
-                g_err_msg_list.has_msg()) {
-                return ST_ERR;
-            }
+    }
+    if (dcl->is_initialized()) {
+        if (ST_SUCC != TypeTranDeclInit(dcl, &cont) ||
+            g_err_msg_list.has_msg()) {
+            return ST_ERR;
         }
     }
+    return ST_SUCC;
+}
+
+
+//Inferring the initializer of global variable may complete the dimension
+//of array, which is read by function definitions.
+static bool isSerialGlobalDecl(Decl const* dcl)
+{
+    return !dcl->is_fun_def() && dcl->is_initialized();
+}
+
+
+STATUS TypeTranGlobalStmt()
+{
     TYCtx cont;
-    if (ST_SUCC != TypeTranList(s->getStmtList(), &cont) ||
+    if (ST_SUCC != TypeTranList(get_global_scope()->getStmtList(), &cont) ||
         g_err_msg_list.has_msg()) {
         return ST_ERR;
     }
     return ST_SUCC;
 }
 
+
+//Infer type to tree nodes.
+INT TypeTransform()
+{
+    initTypeTran();
+    Scope * s = get_global_scope();
+    if (s == nullptr) { return ST_SUCC; }
+    if (ST_SUCC != performFuncTask(TypeTranGlobalDecl, isSerialGlobalDecl)) {
+        return ST_ERR;
+    }
+    return TypeTranGlobalStmt();
+}
+
 } //namespace xfe
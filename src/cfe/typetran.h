@@ -38,6 +38,18 @@ INT process_init_of_declaration(Decl * decl);
 //Transfering type declaration for all AST nodes.
 INT TypeTranList(Tree * t, TYCtx * cont);
 INT TypeTran(Tree * t, TYCtx * cont);
+
+//Transfering type declaration for the initializing trees of 'decl'.
+INT TypeTranDeclInit(Decl * decl, TYCtx * cont);
+
+//Transfering type declaration for the initializing trees of each
+//declaration in list 'decl'.
+INT TypeTranDeclInitList(Decl const* decl, TYCtx * cont);
+
+//Transfering type declaration for the declaration 'dcl' of global scope,
+//and for the stmt list of global scope respectively.
+STATUS TypeTranGlobalDecl(Decl * dcl);
+STATUS TypeTranGlobalStmt();
 INT TypeTransform();
 
 } //namespace xfe
@@ -26,11 +26,9 @@ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
 (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
 SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 @*/
-#include "stdio.h"
-#include "../ltype.h"
-#include "../comf.h"
-#include "../smempool.h"
-#include "../sstl.h"
+#include "../xcominc.h"
+
+using namespace xcom;
 
 class S {
 public:
@@ -39,18 +37,109 @@ public:
     char c[13];
 };
 
-int main()
+#define MIXED_ALLOC_NUM 100000
+#define MIXED_ROUND_NUM 100
+
+//Return the byte size of next request of mixed-size allocation. Most of
+//requests are small objects, and one of 1024 requests is bigger than the
+//chunk of pool.
+static size_t get_mixed_size(unsigned int & seed)
+{
+    seed = seed * 1103515245 + 12345;
+    unsigned int r = (seed >> 16) & 0x3FF;
+    if (r == 0) { return 256 * 1024; }
+    return 8 + (r & 0xFF);
+}
+
+
+//Allocate objects of same size.
+static void test_const_size()
 {
     SMemPool * x = smpoolCreate(sizeof(S) * 1000, MEM_CONST_SIZE);
-    for(int j=0;j<1000;j++) {
-        for(int i=0;i<100000;i++) {
-            //S * m = new S();
-            //S * m = (S*)smpool_malloc_h_const_size(sizeof(S), x);
+    for (int j = 0; j < 1000; j++) {
+        for (int i = 0; i < 100000; i++) {
+            #ifdef RUN_MALLOC
+            S * m = (S*)malloc(sizeof(S));
+            free(m);
+            #else
             S * m = (S*)smpoolMalloc(sizeof(S), x);
+            #endif
+            m->a = i;
         }
     }
-    //printf("\nmempool statisitc : %u bytes\n", smpool_get_pool_size_handle(x));
-    //smpool_free_handle(x);
-    return 0;
+    smpoolDelete(x);
+}
+
+
+//Allocate objects of mixed size, the objects are released all together
+//after each round.
+static void test_mixed_size()
+{
+    static void * ptrs[MIXED_ALLOC_NUM];
+    unsigned int seed = 1;
+    #ifndef RUN_MALLOC
+    SMemPool * x = smpoolCreate(256, MEM_COMM);
+    #endif
+    for (int j = 0; j < MIXED_ROUND_NUM; j++) {
+        for (int i = 0; i < MIXED_ALLOC_NUM; i++) {
+            size_t size = get_mixed_size(seed);
+            #ifdef RUN_MALLOC
+            ptrs[i] = malloc(size);
+            #else
+            ptrs[i] = smpoolMalloc(size, x);
+            #endif
+            *(char*)ptrs[i] = (char)i;
+        }
+        #ifdef RUN_MALLOC
+        for (int i = 0; i < MIXED_ALLOC_NUM; i++) {
+            free(ptrs[i]);
+        }
+        #else
+        smpoolReset(x);
+        #endif
+    }
+    #ifndef RUN_MALLOC
+    smpoolDelete(x);
+    #endif
 }
 
+
+//Allocate objects from the pool that grows by fixed size of chunk, e.g:
+//the replacement new-operator in allocator.h.
+static void test_fixed_grow()
+{
+    for (int j = 0; j < 10; j++) {
+        #ifndef RUN_MALLOC
+        SMemPool * x = smpoolCreate(1024, MEM_COMM);
+        #endif
+        for (int i = 0; i < MIXED_ALLOC_NUM; i++) {
+            #ifdef RUN_MALLOC
+            S * m = (S*)malloc(sizeof(S));
+            free(m);
+            #else
+            S * m = (S*)smpoolMalloc(sizeof(S), x, 1024);
+            #endif
+            m->a = i;
+        }
+        #ifndef RUN_MALLOC
+        smpoolDelete(x);
+        #endif
+    }
+}
+
+
+int main(int argc, char * argv[])
+{
+    //Run the test that given by command line, or all tests.
+    bool all = argc < 2;
+    if (all || strcmp(argv[1], "const") == 0) {
+        test_const_size();
+    }
+    if (all || strcmp(argv[1], "mixed") == 0) {
+        test_mixed_size();
+    }
+    if (all || strcmp(argv[1], "fixed_grow") == 0) {
+        test_fixed_grow();
+    }
+    return 0;
+}
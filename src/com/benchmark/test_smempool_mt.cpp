@@ -0,0 +1,130 @@
+/*@
+Copyright (c) 2013-2021, Su Zhenyu steven.known@gmail.com
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the Su Zhenyu nor the names of its contributors
+      may be used to endorse or promote products derived from this software
+      without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+@*/
+#include <time.h>
+#include <thread>
+#include <vector>
+#include "../xcominc.h"
+
+using namespace xcom;
+
+//Evaluate the scalability of allocation when several threads allocate
+//objects concurrently. Each thread repeatedly creates a pool, allocates
+//mixed-size objects and deletes the pool, which is the way front end
+//allocates the trees of a function. The pool that queries chunks from
+//chunk cache, the pool that queries chunks from malloc and the glibc
+//malloc are compared.
+#define ALLOC_NUM 20000
+#define ROUND_NUM 200
+
+typedef enum {
+    ALLOC_THREAD_CACHE = 0,
+    ALLOC_POOL,
+    ALLOC_MALLOC,
+} ALLOC_KIND;
+
+static char const* g_kind_name[] = { "thread-cache", "pool", "malloc" };
+
+static double get_time()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+
+//Return the byte size of next request, most of requests are small objects.
+static size_t get_size(unsigned int & seed)
+{
+    seed = seed * 1103515245 + 12345;
+    unsigned int r = (seed >> 16) & 0x3FF;
+    if (r == 0) { return 64 * 1024; }
+    return 8 + (r & 0xFF);
+}
+
+
+static void run_thread(ALLOC_KIND kind, unsigned int tid)
+{
+    std::vector<void*> ptrs(ALLOC_NUM);
+    unsigned int seed = tid + 1;
+    for (int j = 0; j < ROUND_NUM; j++) {
+        SMemPool * pool = nullptr;
+        if (kind == ALLOC_THREAD_CACHE) {
+            pool = smpoolCreateThreadCache(256);
+        } else if (kind == ALLOC_POOL) {
+            pool = smpoolCreate(256, MEM_COMM);
+        }
+        for (int i = 0; i < ALLOC_NUM; i++) {
+            size_t size = get_size(seed);
+            ptrs[i] = pool != nullptr ? smpoolMalloc(size, pool) :
+                                        malloc(size);
+            *(char*)ptrs[i] = (char)i;
+        }
+        if (pool != nullptr) {
+            smpoolDelete(pool);
+            continue;
+        }
+        for (int i = 0; i < ALLOC_NUM; i++) {
+            free(ptrs[i]);
+        }
+    }
+}
+
+
+static double run(ALLOC_KIND kind, unsigned int thread_num)
+{
+    std::vector<std::thread> threads;
+    double start = get_time();
+    for (unsigned int i = 0; i < thread_num; i++) {
+        threads.push_back(std::thread(run_thread, kind, i));
+    }
+    for (unsigned int i = 0; i < thread_num; i++) {
+        threads[i].join();
+    }
+    return get_time() - start;
+}
+
+
+int main(int argc, char * argv[])
+{
+    unsigned int max_thread = std::thread::hardware_concurrency();
+    if (argc > 1) { max_thread = (unsigned int)atoi(argv[1]); }
+    if (max_thread == 0) { max_thread = 1; }
+    for (unsigned int n = 1; n <= max_thread; n *= 2) {
+        printf("\nthreads:%-3u", n);
+        for (int k = ALLOC_THREAD_CACHE; k <= ALLOC_MALLOC; k++) {
+            double t = run((ALLOC_KIND)k, n);
+            printf(" %s:%.3fs(%.1fM allocs/s)", g_kind_name[k], t,
+                   (double)n * ALLOC_NUM * ROUND_NUM / t / 1e6);
+        }
+    }
+    printf("\nchunks reused:%llu, bytes allocated by malloc:%llu\n",
+           (unsigned long long)g_stat_chunk_reuse_num.load(),
+           (unsigned long long)g_stat_mem_size.load());
+    return 0;
+}
@@ -567,6 +567,33 @@ inline UINT32 hash32bit(UINT32 n)
     return n;
 }
 
+//Calculate a 64-bit hash value of the first 'len' bytes of string 's'.
+//Note '\0' is regarded as normal byte.
+inline UINT64 hash64bitString(CHAR const* s, UINT len)
+{
+    UINT64 const m = 0xc6a4a7935bd1e995ULL;
+    UINT64 h = 0x9e3779b97f4a7c15ULL ^ ((UINT64)len * m);
+    for (; len >= 8; s += 8, len -= 8) {
+        UINT64 w;
+        ::memcpy(&w, s, 8);
+        w *= m;
+        w ^= w >> 47;
+        w *= m;
+        h ^= w;
+        h *= m;
+    }
+    if (len != 0) {
+        UINT64 w = 0;
+        ::memcpy(&w, s, len);
+        h ^= w;
+        h *= m;
+    }
+    h ^= h >> 47;
+    h *= m;
+    h ^= h >> 47;
+    return h;
+}
+
 //convert half to EHP64(64-bit extended half-precision) format.
 UINT64 half2EHP64(UINT64 val);
 
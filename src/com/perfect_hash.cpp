@@ -5,14 +5,14 @@ All rights reserved.
 Redistribution and use in source and binary forms, with or without
 modification, are permitted provided that the following conditions are met:
 
-* Redistributions of source code must retain the above copyright
-notice, this list of conditions and the following disclaimer.
-* Redistributions in binary form must reproduce the above copyright
-notice, this list of conditions and the following disclaimer in the
-documentation and/or other materials provided with the distribution.
-* Neither the name of the Su Zhenyu nor the names of its contributors
-may be used to endorse or promote products derived from this software
-without specific prior written permission.
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the Su Zhenyu nor the names of its contributors
+      may be used to endorse or promote products derived from this software
+      without specific prior written permission.
 
 THIS SOFTWARE IS PROVIDED "AS IS" AND ANY
 EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
@@ -25,137 +25,173 @@ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
 OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
 USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 @*/
-#include "xcominc.h"
+//This is a standalone generator that finds a collision-free hash table
+//for a small fixed set of strings, e.g: the keywords of a language.
+//The hash value only depends on the length, the first and the last
+//character of string:
+//  hash(s) = (len * MUL_LEN + s[0] * MUL_FIRST + s[len-1] * MUL_LAST) &
+//            (TAB_SIZE - 1)
+//thus the lookup can use the three values as a pre-filter before
+//comparing the whole string.
+//
+//Input: each line of stdin that contains a C string literal contributes
+//the first literal of the line, the index of the string is the order of
+//appearance. Lines without literal are ignored.
+//Output: a table definition in C that maps hash value to
+//  { index, length, first character, last character }
+//the empty slot has index PERFECT_HASH_EMPTY.
+//
+//Build and usage, e.g: regenerate the keyword table of cfe/lex.cpp:
+//  >g++ perfect_hash.cpp -o perfect_hash
+//  >sed -n '/g_keyword_info\[\] = {/,/^};/p' ../cfe/lex.cpp | ./perfect_hash
+#include "ltype.h"
 
 namespace xcom {
 
-UINT g_gap;
-UINT g_bucket_sz;
-
-class PerfectStringHashMap;
-class PerfectHashFunc {
-public:
-    PerfectStringHashMap * map_ptr;
-public:
-    UINT get_hash_value(CHAR const* s, UINT bucket_size) const
-    {
-        ASSERT0(bucket_size != 0);
-        UINT v = 0;
-        while (*s++) {
-            v += (UINT)(*s);
-        }
-        //return hash32bit(v) % g_bucket_sz;
-        v %= g_bucket_sz;
-        v += map_ptr->offset_vec.get(map_ptr->offset_in_vec);
-        UINT start_offset = map_ptr->offset_vec.get(map_ptr->offset_in_vec);
+#define PERFECT_HASH_MAX_STR_NUM 254
+#define PERFECT_HASH_MAX_STR_LEN 255
+#define PERFECT_HASH_EMPTY 0xFF
+#define PERFECT_HASH_MAX_TAB_SIZE 1024
+#define PERFECT_HASH_MAX_MUL 64
 
-        for (; v + start_offset < bucket_size &&
-             HB_member(map_ptr->m_bucket[v + start_offset]) != nullptr;
-             start_offset++) {
-            //Entry has been occupied.
+static CHAR g_str[PERFECT_HASH_MAX_STR_NUM][PERFECT_HASH_MAX_STR_LEN + 1];
+static UINT g_str_len[PERFECT_HASH_MAX_STR_NUM];
+static UINT g_str_num = 0;
+static UINT g_tab[PERFECT_HASH_MAX_TAB_SIZE];
 
+//Parse the first string literal in 'line' and record it.
+//Return false if there is no literal.
+static bool parseLiteral(CHAR const* line)
+{
+    CHAR const* p = strchr(line, '"');
+    if (p == nullptr) { return false; }
+    if (g_str_num >= PERFECT_HASH_MAX_STR_NUM) {
+        fprintf(stderr, "too many strings\n");
+        exit(1);
+    }
+    CHAR * buf = g_str[g_str_num];
+    UINT len = 0;
+    for (p++; *p != 0 && *p != '"'; p++) {
+        CHAR c = *p;
+        if (c == '\\') {
+            p++;
+            switch (*p) {
+            case 'n': c = '\n'; break;
+            case 't': c = '\t'; break;
+            case 0: fprintf(stderr, "bad literal:%s\n", line); exit(1);
+            default: c = *p; break;
+            }
         }
-
-        if (v + start_offset < bucket_size &&
-            HB_member(map_ptr->m_bucket[v + start_offset]) == nullptr) {
-            //Find avaiable entry.
-            map_ptr->offset_vec.set(map_ptr->offset_in_vec, start_offset);
-        } else {
-            //Failed! Need to expand gap!
-            map_ptr->need_expand_gap = true;
+        if (len >= PERFECT_HASH_MAX_STR_LEN) {
+            fprintf(stderr, "string too long:%s\n", line);
+            exit(1);
         }
-
-        return v;
+        buf[len++] = c;
     }
+    buf[len] = 0;
+    g_str_len[g_str_num] = len;
+    g_str_num++;
+    return true;
+}
 
-    UINT get_hash_value(OBJTY v, UINT bucket_size) const
-    {
-        ASSERT_DUMMYUSE(sizeof(OBJTY) == sizeof(CHAR*),
-            ("exception will taken place in type-cast"));
-        return get_hash_value((CHAR const*)v, bucket_size);
-    }
 
-    bool compare(CHAR const* s1, CHAR const* s2) const
-    {
-        return strcmp(s1, s2) == 0;
-    }
+static UINT computeHash(UINT i, UINT mul_len, UINT mul_first, UINT mul_last,
+                        UINT tab_size)
+{
+    UINT len = g_str_len[i];
+    UINT first = len == 0 ? 0 : (BYTE)g_str[i][0];
+    UINT last = len == 0 ? 0 : (BYTE)g_str[i][len - 1];
+    return (len * mul_len + first * mul_first + last * mul_last) &
+           (tab_size - 1);
+}
+
 
-    bool compare(CHAR const* s, OBJTY val) const
-    {
-        ASSERT_DUMMYUSE(sizeof(OBJTY) == sizeof(CHAR const*),
-            ("exception will taken place in type-cast"));
-        return (strcmp(s, (CHAR const*)val) == 0);
+//Return true if all strings are placed without collision.
+static bool tryPlace(UINT mul_len, UINT mul_first, UINT mul_last,
+                     UINT tab_size)
+{
+    for (UINT i = 0; i < tab_size; i++) {
+        g_tab[i] = PERFECT_HASH_EMPTY;
     }
-};
-
-
-class PerfectStringHashMap : public HMap<CHAR const*, UINT, PerfectHashFunc> {
-public:
-    xcom::Vector<UINT> offset_vec;
-    UINT offset_in_vec;
-    bool need_expand_gap;
-public:
-    PerfectStringHashMap(UINT sz = 0) : HMap<CHAR const*, UINT, PerfectHashFunc>(sz)
-    {
-        m_hf.map_ptr = this;
+    for (UINT i = 0; i < g_str_num; i++) {
+        UINT h = computeHash(i, mul_len, mul_first, mul_last, tab_size);
+        if (g_tab[h] != PERFECT_HASH_EMPTY) { return false; }
+        g_tab[h] = i;
     }
-    virtual ~PerfectStringHashMap() {}
+    return true;
+}
+
 
-    void set(CHAR const* string, UINT val)
-    {
-        HMap<CHAR const*, UINT, PerfectHashFunc>::set(string, val);
+static void dumpChar(UINT c)
+{
+    if (c >= 0x20 && c < 0x7f && c != '\'' && c != '\\') {
+        printf("'%c'", c);
+        return;
     }
+    printf("%u", c);
+}
 
-    void addAllString(xcom::Vector<CHAR const*> & input)
-    {
-        for (;;) {
-            need_expand_gap = false;
-            for (VecIdx i = 0; i <= input.get_last_idx(); i++) {
-                offset_in_vec = i;
-                set(input.get(i), i);
-                if (need_expand_gap) {
-                    break;
-                }
-            }
 
-            if (need_expand_gap) {
-                g_gap += 2;
-                UINT bucket_sz = g_bucket_sz + g_gap;
-                clean();
-                init(bucket_sz);
-            } else {
-                //Find the perfect hash map.
-                break;
-            }
+static void dumpTab(UINT mul_len, UINT mul_first, UINT mul_last,
+                    UINT tab_size)
+{
+    printf("//Generated by com/perfect_hash.cpp, do not edit.\n");
+    printf("#define PERFECT_HASH_MUL_LEN %u\n", mul_len);
+    printf("#define PERFECT_HASH_MUL_FIRST %u\n", mul_first);
+    printf("#define PERFECT_HASH_MUL_LAST %u\n", mul_last);
+    printf("#define PERFECT_HASH_TAB_SIZE %u\n", tab_size);
+    printf("static PerfectHashEntry const "
+           "g_perfect_hash_tab[PERFECT_HASH_TAB_SIZE] = {\n");
+    for (UINT i = 0; i < tab_size; i++) {
+        UINT idx = g_tab[i];
+        if (idx == PERFECT_HASH_EMPTY) {
+            printf("    { PERFECT_HASH_EMPTY, 0, 0, 0 },\n");
+            continue;
         }
+        UINT len = g_str_len[idx];
+        printf("    { %u, %u, ", idx, len);
+        dumpChar(len == 0 ? 0 : (BYTE)g_str[idx][0]);
+        printf(", ");
+        dumpChar(len == 0 ? 0 : (BYTE)g_str[idx][len - 1]);
+        printf(" },\n");
     }
-};
+    printf("};\n");
+}
 
 
-void findPerfectHash(xcom::Vector<CHAR const*> & input)
+static INT generate()
 {
-    VecIdx str_num = input.get_elem_count();
-    ASSERT0(str_num > 0);
-    g_bucket_sz = str_num + 5;
-    g_gap = 10;
-
-    //xcom::getNearestPowerOf2((UINT)g_bucket_sz);
-    UINT bucket_sz = g_bucket_sz + g_gap;
-    PerfectStringHashMap pshmap(bucket_sz);
-    pshmap.addAllString(input);
-    pshmap.dump_intersp(g_tfile);
+    CHAR line[1024];
+    while (fgets(line, sizeof(line), stdin) != nullptr) {
+        parseLiteral(line);
+    }
+    if (g_str_num == 0) {
+        fprintf(stderr, "no string found\n");
+        return 1;
+    }
+    UINT tab_size = 1;
+    while (tab_size < g_str_num) { tab_size <<= 1; }
+    for (; tab_size <= PERFECT_HASH_MAX_TAB_SIZE; tab_size <<= 1) {
+        for (UINT mf = 1; mf <= PERFECT_HASH_MAX_MUL; mf++) {
+            for (UINT ml = 1; ml <= PERFECT_HASH_MAX_MUL; ml++) {
+                for (UINT mlen = 1; mlen <= PERFECT_HASH_MAX_MUL; mlen++) {
+                    if (tryPlace(mlen, mf, ml, tab_size)) {
+                        dumpTab(mlen, mf, ml, tab_size);
+                        return 0;
+                    }
+                }
+            }
+        }
+    }
+    fprintf(stderr, "can not find collision-free table, the length, "
+            "first and last character may not distinguish all strings\n");
+    return 1;
 }
 
-
 } //namespace xcom
 
 
 int main()
 {
-    xcom::Vector<CHAR const*> input;
-    UINT j = 0;
-    for (UINT i = X_UNDEF + 1; i < X_LAST; i++, j++) {
-        input.set(j, g_keyword_info[i].name);
-    }
-    findPerfectHash(input);
+    return xcom::generate();
 }
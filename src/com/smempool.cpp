@@ -31,6 +31,10 @@ IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 author: Su Zhenyu
 @*/
+#ifndef _ON_WINDOWS_
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 #include "xcominc.h"
 
 namespace xcom {
@@ -57,16 +61,48 @@ static MEMPOOL_HASH * g_mem_pool_hash_tab = nullptr;
 static SMemPool * g_mem_pool=nullptr;
 static UINT g_mem_pool_count = 0;
 #ifdef _DEBUG_
-static UINT g_mem_pool_chunk_count = 0;
+static std::atomic<ULONG> g_mem_pool_chunk_count(0);
 #endif
 
+//Protect the pool list and the hash table of the index-based API.
+static std::mutex g_mem_pool_lock;
+
+static INT delete_pool_via_index(MEMPOOLIDX mpt_idx);
+
 
 //First of all marker of memory pool should be initialized
 static bool g_is_pool_init = false;
 
 //Build hash table of memory pool
 static bool g_is_pool_hashed = true;
-ULONGLONG g_stat_mem_size = 0;
+std::atomic<ULONGLONG> g_stat_mem_size(0);
+std::atomic<ULONGLONG> g_stat_chunk_reuse_num(0);
+size_t g_smpool_mmap_threshold = 0;
+
+//The global free lists of chunk cache, one list for each class. Chunks are
+//pushed by CAS, and the whole list is taken by exchange, thus the list is
+//lock-free and does not suffer from ABA problem.
+static std::atomic<SMemPool*> g_free_chunk_list[MEMPOOL_CACHE_MAX_CLASS + 1];
+
+//ChunkCache records the free chunks of each class that owned by a thread.
+//The chunks are recycled into global free lists when thread exits.
+class ChunkCache {
+    COPY_CONSTRUCTOR(ChunkCache);
+public:
+    SMemPool * list[MEMPOOL_CACHE_MAX_CLASS + 1];
+    UINT num[MEMPOOL_CACHE_MAX_CLASS + 1];
+public:
+    ChunkCache()
+    {
+        ::memset((void*)list, 0, sizeof(list));
+        ::memset((void*)num, 0, sizeof(num));
+    }
+    ~ChunkCache() { flush(); }
+
+    //Recycle all chunks into global free lists.
+    void flush();
+};
+static thread_local ChunkCache g_chunk_cache;
 
 void dumpPool(SMemPool * handler, FILE * h)
 {
@@ -87,66 +123,266 @@ void dumpPool(SMemPool * handler, FILE * h)
 }
 
 
-static SMemPool * new_mem_pool(size_t size, MEMPOOLTYPE mpt)
+//Return the byte size of the header of chunk.
+inline static size_t get_header_size()
 {
-    INT size_mp = sizeof(SMemPool);
+    size_t size_mp = sizeof(SMemPool);
     if (size_mp % WORD_ALIGN) {
         size_mp = (sizeof(SMemPool) / WORD_ALIGN + 1 ) * WORD_ALIGN;
     }
+    return size_mp;
+}
 
-    SMemPool * mp = (SMemPool*)malloc(size_mp + size + END_BOUND_BYTE);
-    ASSERTN(mp, ("create mem pool failed, no enough memory"));
+
+//Initialize the header of chunk 'mp' that has 'size' bytes of room.
+static void init_mem_pool(SMemPool * mp, size_t size, MEMPOOLTYPE mpt)
+{
+    size_t size_mp = get_header_size();
     ::memset((void*)mp, 0, size_mp);
     ::memset((void*)(((BYTE*)mp) + size_mp + size),
              BOUNDARY_NUM, END_BOUND_BYTE);
 
     MEMPOOL_type(mp) = mpt;
     #ifdef _DEBUG_
-    g_stat_mem_size += size_mp + size; //Only for statistic purpose
     MEMPOOL_chunk_id(mp) = ++g_mem_pool_chunk_count;
     #endif
     MEMPOOL_pool_ptr(mp) = ((BYTE*)mp) + size_mp;
     MEMPOOL_pool_size(mp) = size;
     MEMPOOL_start_pos(mp) = 0;
     MEMPOOL_grow_size(mp) = size;
+    MEMPOOL_cur(mp) = mp;
+    MEMPOOL_grow_factor(mp) = MEMPOOL_DEF_GROW_FACTOR;
+    MEMPOOL_max_grow_size(mp) = MEMPOOL_DEF_MAX_GROW_SIZE;
+}
+
+
+//Return the byte size of the whole chunk.
+inline static size_t get_chunk_size(SMemPool const* mp)
+{
+    return get_header_size() + MEMPOOL_pool_size(mp) + END_BOUND_BYTE;
+}
+
+
+//Allocate the memory of chunk that has 'bytesize' bytes.
+//is_mmap: set to true if the memory is mapped by mmap.
+static SMemPool * alloc_chunk_mem(size_t bytesize, OUT bool & is_mmap)
+{
+    g_stat_mem_size.fetch_add(bytesize, std::memory_order_relaxed);
+    is_mmap = false;
+    #ifndef _ON_WINDOWS_
+    if (g_smpool_mmap_threshold != 0 && bytesize >= g_smpool_mmap_threshold) {
+        void * mp = ::mmap(nullptr, bytesize, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mp != MAP_FAILED) {
+            #ifdef MADV_HUGEPAGE
+            ::madvise(mp, bytesize, MADV_HUGEPAGE);
+            #endif
+            is_mmap = true;
+            return (SMemPool*)mp;
+        }
+    }
+    #endif
+    SMemPool * mp = (SMemPool*)malloc(bytesize);
+    ASSERTN(mp, ("create mem pool failed, no enough memory"));
     return mp;
 }
 
 
-inline static void remove_smp(SMemPool * t)
+static void free_chunk_mem(SMemPool * mp)
 {
-    if (t == nullptr) { return; }
-    ASSERTN(t->prev != nullptr, ("t should not be first."));
-    t->prev->next = t->next;
-    if (t->next != nullptr) {
-        t->next->prev = t->prev;
+    #ifndef _ON_WINDOWS_
+    if (MEMPOOL_is_mmap(mp)) {
+        ::munmap((void*)mp, get_chunk_size(mp));
+        return;
     }
-    t->next = t->prev = nullptr;
+    #endif
+    free(mp);
 }
 
 
-inline static void append_head_smp(SMemPool ** head, SMemPool * t)
+//Return the pages of the room of mapped chunk from 'pos' to current
+//allocation position to OS. The pages are zero-filled when they are
+//touched again.
+static void discard_chunk_room(SMemPool * mp, size_t pos)
 {
-    ASSERTN(t && head, ("Mem pool internal error 1"));
-    t->prev = nullptr;
-    t->next = *head;
-    *head = t;
+    #ifndef _ON_WINDOWS_
+    if (!MEMPOOL_is_mmap(mp) || MEMPOOL_start_pos(mp) <= pos) { return; }
+    static size_t pagesize = (size_t)::sysconf(_SC_PAGESIZE);
+    size_t start = (size_t)MEMPOOL_pool_ptr(mp) + pos;
+    size_t end = (size_t)MEMPOOL_pool_ptr(mp) + MEMPOOL_start_pos(mp);
+    start = (start + pagesize - 1) & ~(pagesize - 1);
+    end &= ~(pagesize - 1);
+    if (end <= start || end - start < MEMPOOL_DISCARD_MIN_SIZE) { return; }
+    ::madvise((void*)start, end - start, MADV_DONTNEED);
+    #else
+    DUMMYUSE(mp);
+    DUMMYUSE(pos);
+    #endif
 }
 
 
-inline static void append_after_smp(SMemPool * marker, SMemPool * tlst)
+static SMemPool * new_mem_pool(size_t size, MEMPOOLTYPE mpt)
 {
-    ASSERTN(marker && tlst && marker != tlst, ("Mem pool internal error 2"));
-    if (marker->next != nullptr) {
-        SMemPool * last = tlst;
-        while (last != nullptr && last->next != nullptr) {
-            last = last->next;
-        }
-        marker->next->prev = last;
-        last->next = marker->next;
+    bool is_mmap = false;
+    SMemPool * mp = alloc_chunk_mem(
+        get_header_size() + size + END_BOUND_BYTE, is_mmap);
+    init_mem_pool(mp, size, mpt);
+    MEMPOOL_is_mmap(mp) = is_mmap;
+    return mp;
+}
+
+
+//Return the class of chunk cache that the chunk of 'bytesize' belongs to,
+//or 0 if the chunk is too big to be cached.
+static UINT get_cache_class(size_t bytesize)
+{
+    UINT c = MEMPOOL_CACHE_MIN_CLASS;
+    while (c <= MEMPOOL_CACHE_MAX_CLASS && ((size_t)1 << c) < bytesize) {
+        c++;
+    }
+    return c <= MEMPOOL_CACHE_MAX_CLASS ? c : 0;
+}
+
+
+//Push the list of chunks from 'first' to 'last' into global free list.
+static void push_free_chunk(UINT c, SMemPool * first, SMemPool * last)
+{
+    std::atomic<SMemPool*> & head = g_free_chunk_list[c];
+    SMemPool * old = head.load(std::memory_order_relaxed);
+    do {
+        MEMPOOL_next(last) = old;
+    } while (!head.compare_exchange_weak(old, first,
+                                         std::memory_order_release,
+                                         std::memory_order_relaxed));
+}
+
+
+void ChunkCache::flush()
+{
+    for (UINT c = MEMPOOL_CACHE_MIN_CLASS; c <= MEMPOOL_CACHE_MAX_CLASS; c++) {
+        if (list[c] == nullptr) { continue; }
+        SMemPool * last = list[c];
+        while (MEMPOOL_next(last) != nullptr) { last = MEMPOOL_next(last); }
+        push_free_chunk(c, list[c], last);
+        list[c] = nullptr;
+        num[c] = 0;
+    }
+}
+
+
+//Query a free chunk of class 'c' from the cache of current thread. If the
+//cache is empty, take all chunks of the global free list.
+static SMemPool * pop_free_chunk(UINT c)
+{
+    ChunkCache & cache = g_chunk_cache;
+    if (cache.list[c] == nullptr) {
+        SMemPool * l = g_free_chunk_list[c].exchange(
+            nullptr, std::memory_order_acquire);
+        cache.list[c] = l;
+        for (; l != nullptr; l = MEMPOOL_next(l)) { cache.num[c]++; }
+    }
+    SMemPool * mp = cache.list[c];
+    if (mp != nullptr) {
+        cache.list[c] = MEMPOOL_next(mp);
+        cache.num[c]--;
+    }
+    return mp;
+}
+
+
+//Recycle chunk 'mp' into the cache of current thread, or into global free
+//list if the thread has cached enough chunks.
+static void recycle_chunk(SMemPool * mp)
+{
+    UINT c = MEMPOOL_cache_class(mp);
+    ASSERT0(c >= MEMPOOL_CACHE_MIN_CLASS && c <= MEMPOOL_CACHE_MAX_CLASS);
+    discard_chunk_room(mp, 0);
+    ChunkCache & cache = g_chunk_cache;
+    if (cache.num[c] < MEMPOOL_CACHE_LOCAL_NUM) {
+        MEMPOOL_next(mp) = cache.list[c];
+        cache.list[c] = mp;
+        cache.num[c]++;
+        return;
+    }
+    push_free_chunk(c, mp, mp);
+}
+
+
+//Query chunk that has at least 'size' bytes of room from chunk cache. The
+//room of chunk is rounded up to fill the whole chunk of the class.
+static SMemPool * new_cached_mem_pool(size_t size, MEMPOOLTYPE mpt)
+{
+    size_t size_mp = get_header_size();
+    UINT c = get_cache_class(size_mp + size + END_BOUND_BYTE);
+    if (c == 0) { return new_mem_pool(size, mpt); }
+
+    size_t bytesize = (size_t)1 << c;
+    SMemPool * mp = pop_free_chunk(c);
+    bool is_mmap = false;
+    if (mp != nullptr) {
+        g_stat_chunk_reuse_num.fetch_add(1, std::memory_order_relaxed);
+        is_mmap = MEMPOOL_is_mmap(mp);
+    } else {
+        mp = alloc_chunk_mem(bytesize, is_mmap);
+    }
+    init_mem_pool(mp, bytesize - size_mp - END_BOUND_BYTE, mpt);
+    MEMPOOL_cache_class(mp) = c;
+    MEMPOOL_is_mmap(mp) = is_mmap;
+    return mp;
+}
+
+
+//Query new chunk for pool 'handler'.
+inline static SMemPool * new_chunk(SMemPool const* handler, size_t size)
+{
+    if (MEMPOOL_is_thread_cache(handler)) {
+        return new_cached_mem_pool(size, MEM_COMM);
     }
-    tlst->prev = marker;
-    marker->next = tlst;
+    return new_mem_pool(size, MEM_COMM);
+}
+
+
+//Remove chunk 't' from the chunk list of pool, 't' can not be the first.
+inline static void remove_smp(SMemPool * t)
+{
+    ASSERTN(MEMPOOL_prev(t) != nullptr, ("t should not be first."));
+    MEMPOOL_next(MEMPOOL_prev(t)) = MEMPOOL_next(t);
+    if (MEMPOOL_next(t) != nullptr) {
+        MEMPOOL_prev(MEMPOOL_next(t)) = MEMPOOL_prev(t);
+    }
+    MEMPOOL_next(t) = MEMPOOL_prev(t) = nullptr;
+}
+
+
+//Insert chunk 't' after chunk 'marker'.
+inline static void insert_after_smp(SMemPool * marker, SMemPool * t)
+{
+    ASSERTN(marker && t && marker != t, ("Mem pool internal error 2"));
+    MEMPOOL_prev(t) = marker;
+    MEMPOOL_next(t) = MEMPOOL_next(marker);
+    if (MEMPOOL_next(marker) != nullptr) {
+        MEMPOOL_prev(MEMPOOL_next(marker)) = t;
+    }
+    MEMPOOL_next(marker) = t;
+}
+
+
+//Return the byte size of the rest room of chunk.
+inline static size_t get_rest_size(SMemPool const* p)
+{
+    ASSERTN(MEMPOOL_pool_size(p) >= MEMPOOL_start_pos(p),
+            ("start_pos overflow the pool size"));
+    return MEMPOOL_pool_size(p) - MEMPOOL_start_pos(p);
+}
+
+
+//Allocate 'size' bytes from the rest room of chunk.
+inline static void * bump_smp(SMemPool * p, size_t size)
+{
+    ASSERT0(size <= get_rest_size(p));
+    void * addr = ((BYTE*)MEMPOOL_pool_ptr(p)) + MEMPOOL_start_pos(p);
+    MEMPOOL_start_pos(p) += size;
+    return addr;
 }
 
 
@@ -158,6 +394,7 @@ inline static void append_after_smp(SMemPool * marker, SMemPool * tlst)
 //smpoolCreatePoolIndex or smpoolMalloc.
 void smpoolInitPool()
 {
+    std::lock_guard<std::mutex> lock(g_mem_pool_lock);
     if (g_is_pool_init) { return; }
 
     if (g_is_pool_hashed) {
@@ -191,6 +428,7 @@ void smpoolInitPool()
 //if smpoolInitPool() has been invoked.
 void smpoolFiniPool()
 {
+    std::lock_guard<std::mutex> lock(g_mem_pool_lock);
     if (g_is_pool_init && g_is_pool_hashed) {
         ASSERTN(g_mem_pool == nullptr, ("illegal init process"));
         SMemPool * next = nullptr;
@@ -213,7 +451,7 @@ void smpoolFiniPool()
     while (mp != nullptr) {
         SMemPool * tmp = mp;
         mp = MEMPOOL_next(mp);
-        smpoolDeleteViaPoolIndex(MEMPOOL_id(tmp));
+        delete_pool_via_index(MEMPOOL_id(tmp));
     }
     g_mem_pool = nullptr;
     g_mem_pool_count = 0;
@@ -233,6 +471,30 @@ SMemPool * smpoolCreate(size_t size, MEMPOOLTYPE mpt)
 }
 
 
+SMemPool * smpoolCreateThreadCache(size_t size)
+{
+    if (size == 0) { return nullptr; }
+    SMemPool * mp = new_cached_mem_pool(size, MEM_COMM);
+    MEMPOOL_is_thread_cache(mp) = true;
+    return mp;
+}
+
+
+void smpoolFreeChunkCache()
+{
+    g_chunk_cache.flush();
+    for (UINT c = MEMPOOL_CACHE_MIN_CLASS; c <= MEMPOOL_CACHE_MAX_CLASS; c++) {
+        SMemPool * l = g_free_chunk_list[c].exchange(
+            nullptr, std::memory_order_acquire);
+        while (l != nullptr) {
+            SMemPool * next = MEMPOOL_next(l);
+            free_chunk_mem(l);
+            l = next;
+        }
+    }
+}
+
+
 //Create new memory pool, return the pool idx.
 #define MAX_TRY 1024
 
@@ -244,6 +506,7 @@ MEMPOOLIDX smpoolCreatePoolIndex(size_t size, MEMPOOLTYPE mpt)
     SMemPool * mp = nullptr;
     if (size <= 0 || mpt == MEM_NONE) { return 0; }
 
+    std::lock_guard<std::mutex> lock(g_mem_pool_lock);
     if (g_is_pool_hashed && g_is_pool_init) {
         MEMPOOLIDX idx,i = 0;
         idx = (MEMPOOLIDX)rand();
@@ -287,19 +550,78 @@ INT smpoolDelete(SMemPool * handler)
         return ST_NO_SUCH_MEMPOOL_FIND;
     }
 
-    //Free local pool list
+    //Free local pool list, the chunks of chunk cache are recycled.
     SMemPool * tmp = handler;
     while (tmp != nullptr) {
         SMemPool * d_tmp = tmp;
         tmp = MEMPOOL_next(tmp);
-        free(d_tmp);
+        if (MEMPOOL_cache_class(d_tmp) != 0) {
+            recycle_chunk(d_tmp);
+            continue;
+        }
+        free_chunk_mem(d_tmp);
     }
     return ST_SUCC;
 }
 
 
+void smpoolReset(SMemPool * handler)
+{
+    if (handler == nullptr) { return; }
+    //The chunks of const size pool are not ordered by current chunk, thus
+    //all chunks are rewound.
+    for (SMemPool * p = handler; p != nullptr; p = MEMPOOL_next(p)) {
+        discard_chunk_room(p, 0);
+        MEMPOOL_start_pos(p) = 0;
+    }
+    MEMPOOL_cur(handler) = handler;
+}
+
+
+SMemPoolMark smpoolMark(SMemPool const* handler)
+{
+    ASSERTN(handler, ("mempool handler is null"));
+    ASSERTN(MEMPOOL_type(handler) == MEM_COMM, ("need common pool"));
+    SMemPoolMark mark;
+    MEMPOOL_MARK_chunk(mark) = MEMPOOL_cur(handler);
+    MEMPOOL_MARK_pos(mark) = MEMPOOL_start_pos(MEMPOOL_cur(handler));
+    return mark;
+}
+
+
+//The chunks after current chunk are empty, thus only the chunks from the
+//chunk of mark to current chunk are rewound.
+void smpoolRelease(SMemPool * handler, SMemPoolMark const& mark)
+{
+    ASSERTN(handler, ("mempool handler is null"));
+    SMemPool * markchunk = MEMPOOL_MARK_chunk(mark);
+    ASSERT0(markchunk && MEMPOOL_MARK_pos(mark) <=
+            MEMPOOL_start_pos(markchunk));
+    SMemPool * cur = MEMPOOL_cur(handler);
+    for (SMemPool * p = cur; p != markchunk; p = MEMPOOL_prev(p)) {
+        ASSERTN(p != nullptr, ("mark does not belong to the pool"));
+        discard_chunk_room(p, 0);
+        MEMPOOL_start_pos(p) = 0;
+    }
+    discard_chunk_room(markchunk, MEMPOOL_MARK_pos(mark));
+    MEMPOOL_start_pos(markchunk) = MEMPOOL_MARK_pos(mark);
+    MEMPOOL_cur(handler) = markchunk;
+}
+
+
+void smpoolSetGrowPolicy(SMemPool * handler, size_t grow_factor,
+                         size_t max_grow_size)
+{
+    ASSERTN(handler, ("mempool handler is null"));
+    ASSERTN(grow_factor > 0 && max_grow_size > 0, ("invalid grow policy"));
+    MEMPOOL_grow_factor(handler) = grow_factor;
+    MEMPOOL_max_grow_size(handler) = max_grow_size;
+}
+
+
 //Destroy mem pool totally.
-INT smpoolDeleteViaPoolIndex(MEMPOOLIDX mpt_idx)
+//The caller should hold g_mem_pool_lock.
+static INT delete_pool_via_index(MEMPOOLIDX mpt_idx)
 {
     //search the mempool which indicated with 'mpt_idx'
     SMemPool * mp = g_mem_pool;
@@ -350,6 +672,14 @@ INT smpoolDeleteViaPoolIndex(MEMPOOLIDX mpt_idx)
 }
 
 
+//Destroy mem pool totally.
+INT smpoolDeleteViaPoolIndex(MEMPOOLIDX mpt_idx)
+{
+    std::lock_guard<std::mutex> lock(g_mem_pool_lock);
+    return delete_pool_via_index(mpt_idx);
+}
+
+
 //The function is used to check whether given elem_size can satified given
 //pool's constraints.
 bool smpoolIsValidConstPool(size_t elem_size, SMemPool const* handler)
@@ -424,92 +754,92 @@ void * smpoolMallocConstSize(size_t elem_size, IN SMemPool * handler)
 }
 
 
-//Query memory space from pool via handler.
-//This function will search pool list to find enough memory space to return.
-void * smpoolMalloc(size_t size, IN SMemPool * handler, size_t grow_size)
+//Allocate memory when current chunk of pool lacks room.
+//The chunks before current chunk are used, and the chunks after current
+//chunk are empty chunks kept by smpoolReset or smpoolRelease. A few of the
+//empty chunks are searched, the chunk that has enough room is moved to
+//be the next of current chunk, then it becomes current chunk. Otherwise a
+//new chunk is inserted after current chunk.
+static void * smpoolMallocSlow(size_t size, SMemPool * handler,
+                               size_t grow_size)
 {
-    ASSERTN(size > 0, ("query size can not be 0"));
-    ASSERTN(handler, ("mempool handler is null"));
-    if (size % WORD_ALIGN) {
-        size = (size / WORD_ALIGN + 1) * WORD_ALIGN;
+    SMemPool * cur = MEMPOOL_cur(handler);
+    SMemPool * p = MEMPOOL_next(cur);
+    for (UINT i = 0; p != nullptr && i < MEMPOOL_SEARCH_NUM;
+         p = MEMPOOL_next(p), i++) {
+        ASSERT0(MEMPOOL_start_pos(p) == 0);
+        if (size <= get_rest_size(p)) { break; }
     }
-
-    //Search free block in the pool.
-    void * addr = nullptr;
-    SMemPool * tmp_rest = handler, * last = nullptr;
-    SMemPool * full_head = nullptr;
-    while (tmp_rest != nullptr) {
-        ASSERTN(MEMPOOL_pool_size(tmp_rest) >= MEMPOOL_start_pos(tmp_rest),
-                ("start_pos overflow the pool size"));
-        ASSERTN(MEMPOOL_pool_size(tmp_rest) > 0, ("pool size is zero"));
-        size_t s = MEMPOOL_pool_size(tmp_rest) - MEMPOOL_start_pos(tmp_rest);
-        if (size <= s) {
-            addr = (size_t*)(((BYTE*)MEMPOOL_pool_ptr(tmp_rest)) +
-                             MEMPOOL_start_pos(tmp_rest));
-            goto FIN;
-        }
-
-        SMemPool * cur = tmp_rest;
-        tmp_rest = MEMPOOL_next(tmp_rest);
-        if (s <= MIN_MARGIN && cur != handler) {
-            remove_smp(cur);
-            append_head_smp(&full_head, cur);
-        } else {
-            last = cur;
+    if (p != nullptr && size <= get_rest_size(p)) {
+        if (p != MEMPOOL_next(cur)) {
+            remove_smp(p);
+            insert_after_smp(cur, p);
         }
+        MEMPOOL_cur(handler) = p;
+        return bump_smp(p, size);
     }
-    ASSERTN(last && MEMPOOL_next(last) == nullptr,
-            ("mempool internal error 3"));
 
-    //We lack free blocks, and quering new mem block.
-    tmp_rest = last;
+    //We lack free chunks, and query new chunk.
     if (grow_size == 0) {
+        //Grow the pool according to its growth policy.
         ASSERTN(MEMPOOL_grow_size(handler) > 0, ("grow size is 0"));
-        grow_size = MEMPOOL_grow_size(handler) * 4;
+        grow_size = MEMPOOL_grow_size(handler) * MEMPOOL_grow_factor(handler);
+        grow_size = MIN(grow_size, MEMPOOL_max_grow_size(handler));
+        grow_size = MAX(grow_size, MEMPOOL_grow_size(handler));
         MEMPOOL_grow_size(handler) = grow_size;
     }
+    //The request that is too big to be served by regular chunk is
+    //allocated in a dedicated chunk.
+    SMemPool * newpool = new_chunk(handler, MAX(size, grow_size));
+    insert_after_smp(cur, newpool);
+    MEMPOOL_cur(handler) = newpool;
+    return bump_smp(newpool, size);
+}
 
-    if (size > grow_size) {
-        MEMPOOL_next(tmp_rest) = new_mem_pool(
-            (size / grow_size + 1) * grow_size, MEM_COMM);
-    } else {
-        MEMPOOL_next(tmp_rest) = new_mem_pool(grow_size, MEM_COMM);
+
+//Query memory space from pool via handler.
+//The memory is allocated by bumping the position of current chunk, a new
+//chunk is queried if current chunk lacks room.
+void * smpoolMalloc(size_t size, IN SMemPool * handler, size_t grow_size)
+{
+    ASSERTN(size > 0, ("query size can not be 0"));
+    ASSERTN(handler, ("mempool handler is null"));
+    if (size % WORD_ALIGN) {
+        size = (size / WORD_ALIGN + 1) * WORD_ALIGN;
+    }
+    SMemPool * cur = MEMPOOL_cur(handler);
+    if (size <= get_rest_size(cur)) {
+        return bump_smp(cur, size);
     }
+    return smpoolMallocSlow(size, handler, grow_size);
+}
+
 
-    MEMPOOL_prev(MEMPOOL_next(tmp_rest)) = tmp_rest;
-    tmp_rest = MEMPOOL_next(tmp_rest);
-    addr = (size_t*)(((BYTE*)MEMPOOL_pool_ptr(tmp_rest)) +
-                     MEMPOOL_start_pos(tmp_rest));
-FIN:
-    if (full_head != nullptr) {
-        append_after_smp(tmp_rest, full_head);
+//Return the pool which indicated with 'mpt_idx', or nullptr if not find.
+static SMemPool * find_pool_via_index(MEMPOOLIDX mpt_idx)
+{
+    std::lock_guard<std::mutex> lock(g_mem_pool_lock);
+    if (g_is_pool_hashed && g_is_pool_init) {
+        return g_mem_pool_hash_tab->find((xcom::OBJTY)(size_t)mpt_idx);
     }
-    MEMPOOL_start_pos(tmp_rest) += size;
-    ASSERTN(MEMPOOL_pool_size(tmp_rest) >= MEMPOOL_start_pos(tmp_rest),
-            ("\nstart_pos overflow the pool size\n"));
-    return addr;
+    SMemPool * mp = g_mem_pool;
+    while (mp != nullptr) {
+        if (MEMPOOL_id(mp) == mpt_idx) {
+            break;
+        }
+        mp = mp->next;
+    }
+    return mp;
 }
 
 
 //Quering memory space from pool via pool index.
+//The pool itself should be used by one thread at a time.
 void * smpoolMallocViaPoolIndex(size_t size, MEMPOOLIDX mpt_idx,
                                 size_t grow_size)
 {
     ASSERTN(size > 0, ("request size can not be 0"));
-    SMemPool * mp = g_mem_pool;
-
-    //Searching the mempool which indicated with 'mpt_idx'
-    if (g_is_pool_hashed && g_is_pool_init) {
-        mp = g_mem_pool_hash_tab->find((xcom::OBJTY)(size_t)mpt_idx);
-    } else {
-        while (mp != nullptr) {
-            if (MEMPOOL_id(mp) == mpt_idx) {
-                break;
-            }
-            mp = mp->next;
-        }
-    }
-
+    SMemPool * mp = find_pool_via_index(mpt_idx);
     if (mp == nullptr) {
         //Mem pool of Index %lu does not exist", (ULONG)mpt_idx);
         return nullptr;
@@ -536,19 +866,7 @@ size_t smpoolGetPoolSize(SMemPool const* handle)
 //Get total pool byte-size.
 size_t smpoolGetPoolSizeViaIndex(MEMPOOLIDX mpt_idx)
 {
-    SMemPool * mp = g_mem_pool;
-    if (g_is_pool_hashed && g_is_pool_init) {
-        mp = g_mem_pool_hash_tab->find((xcom::OBJTY)(size_t)mpt_idx);
-    } else {
-        //Searching the mempool which indicated with 'mpt_idx'
-        while (mp!=nullptr) {
-            if(MEMPOOL_id(mp) == mpt_idx ){
-                break;
-            }
-            mp = mp->next;
-        }
-    }
-
+    SMemPool * mp = find_pool_via_index(mpt_idx);
     if (mp == nullptr) {
         return 0;
     }
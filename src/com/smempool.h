@@ -48,6 +48,33 @@ namespace xcom {
 #define WORD_ALIGN 1
 #define MIN_MARGIN 0
 
+//The default growth policy of pool. The byte size of new chunk is the size
+//of previous chunk multiplied by the factor, and it is not greater than the
+//max grow size.
+#define MEMPOOL_DEF_GROW_FACTOR 4
+#define MEMPOOL_DEF_MAX_GROW_SIZE (16 * 1024 * 1024)
+
+//The chunks of thread cache pool are classified by the power of 2 of their
+//byte size, from 2^MEMPOOL_CACHE_MIN_CLASS to 2^MEMPOOL_CACHE_MAX_CLASS.
+//The bigger chunk is allocated and freed by malloc.
+#define MEMPOOL_CACHE_MIN_CLASS 12
+#define MEMPOOL_CACHE_MAX_CLASS 24
+
+//The number of chunks of each class that kept by a thread, the more chunks
+//are recycled into global free list.
+#define MEMPOOL_CACHE_LOCAL_NUM 4
+
+//The number of empty chunks that searched when current chunk lacks room.
+#define MEMPOOL_SEARCH_NUM 8
+
+//The default threshold of the byte size of chunk that is mapped by mmap
+//when mapping is enabled.
+#define MEMPOOL_DEF_MMAP_THRESHOLD (1024 * 1024)
+
+//The minimum byte size of released room of mapped chunk that is returned
+//to OS.
+#define MEMPOOL_DISCARD_MIN_SIZE (64 * 1024)
+
 typedef size_t MEMPOOLIDX;
 typedef enum {
     MEM_NONE = 0,
@@ -63,6 +90,15 @@ typedef enum {
 #define MEMPOOL_start_pos(p) ((p)->start_pos)
 #define MEMPOOL_pool_size(p) ((p)->mem_pool_size)
 #define MEMPOOL_pool_ptr(p) ((p)->ppool)
+#define MEMPOOL_cache_class(p) ((p)->cache_class)
+#define MEMPOOL_is_mmap(p) ((p)->is_mmap)
+
+//The following fields are only valid in the first chunk of pool, namely
+//the handle of pool.
+#define MEMPOOL_cur(p) ((p)->cur)
+#define MEMPOOL_grow_factor(p) ((p)->grow_factor)
+#define MEMPOOL_max_grow_size(p) ((p)->max_grow_size)
+#define MEMPOOL_is_thread_cache(p) ((p)->is_thread_cache)
 #ifdef _DEBUG_
 #define MEMPOOL_chunk_id(p) ((p)->chunk_id)
 #endif
@@ -77,11 +113,37 @@ typedef struct _MemPool {
     size_t grow_size;
     void * ppool; //start address of mem pool
 
+    //The chunk that serves allocations by bumping its start_pos. The
+    //chunks before it are full, and the chunks after it are either empty
+    //chunks kept by smpoolReset or the dedicated chunks of big requests.
+    struct _MemPool * cur;
+    size_t grow_factor;
+    size_t max_grow_size; //the upper bound of the byte size of new chunk.
+
+    //The class of chunk cache that chunk is recycled into, it is 0 if the
+    //chunk is freed by free().
+    UINT cache_class;
+
+    //Set to true if the chunks of pool are queried from chunk cache.
+    bool is_thread_cache;
+
+    //Set to true if the chunk is mapped by mmap rather than malloc.
+    bool is_mmap;
+
     #ifdef _DEBUG_
     ULONG chunk_id;
     #endif
 } SMemPool;
 
+//Record the allocation position of pool, the memory allocated after the
+//mark can be released all together by smpoolRelease.
+#define MEMPOOL_MARK_chunk(m) ((m).chunk)
+#define MEMPOOL_MARK_pos(m) ((m).pos)
+typedef struct _MemPoolMark {
+    SMemPool * chunk;
+    size_t pos;
+} SMemPoolMark;
+
 //Create memory pool
 //size: the initial byte size of pool. For MEM_CONST_SIZE, 'size'
 //      must be integer multiples of element byte size.
@@ -89,11 +151,51 @@ typedef struct _MemPool {
 MEMPOOLIDX smpoolCreatePoolIndex(size_t size, MEMPOOLTYPE mpt = MEM_COMM);
 SMemPool * smpoolCreate(size_t size, MEMPOOLTYPE mpt = MEM_COMM);
 
+//Create memory pool that queries chunks from the chunk cache of current
+//thread rather than malloc. The chunks are recycled into the cache when
+//the pool is deleted, and they may be reused by the pools of any thread.
+//A pool still has to be used by one thread at a time.
+//size: the initial byte size of pool.
+SMemPool * smpoolCreateThreadCache(size_t size);
+
+//Free the chunks that cached by current thread and the global free lists.
+void smpoolFreeChunkCache();
+
+//The chunk whose byte size is not less than the threshold is mapped by
+//mmap, 0 means all chunks are allocated by malloc. The big mapped chunk is
+//backed by huge pages if OS supports, and the room released by
+//smpoolReset, smpoolRelease and the recycling of chunk cache is returned to
+//OS by MADV_DONTNEED. It only takes effect on Linux.
+extern size_t g_smpool_mmap_threshold;
+
 //delete memory pool
 INT smpoolDeleteViaPoolIndex(MEMPOOLIDX mpt_idx);
 INT smpoolDelete(SMemPool * handle);
 
+//Reset the pool to be empty, whereas the memory blocks of pool are kept to
+//serve the following allocations.
+void smpoolReset(SMemPool * handle);
+
+//Return the current allocation position of pool.
+SMemPoolMark smpoolMark(SMemPool const* handle);
+
+//Release the memory that allocated after 'mark', the chunks are kept to
+//serve the following allocations. The marks taken after 'mark' become
+//invalid.
+void smpoolRelease(SMemPool * handle, SMemPoolMark const& mark);
+
+//Set the growth policy of pool.
+//grow_factor: the byte size of new chunk is the size of previous chunk
+//             multiplied by the factor.
+//max_grow_size: the upper bound of the byte size of new chunk. The request
+//             that is bigger than the size of new chunk is served by a
+//             dedicated chunk.
+void smpoolSetGrowPolicy(SMemPool * handle, size_t grow_factor,
+                         size_t max_grow_size);
+
 //alloc memory from corresponding mem pool
+//grow_size: the byte size of new chunk if the pool lacks room, 0 means
+//           the size is decided by the growth policy of pool.
 void * smpoolMallocViaPoolIndex(size_t size, MEMPOOLIDX mpt_idx,
                                 size_t grow_size = 0);
 void * smpoolMalloc(size_t size, SMemPool * handle, size_t grow_size = 0);
@@ -122,7 +224,13 @@ void smpoolFiniPool(); //Finializing pool
 
 void dumpPool(SMemPool * handler, FILE * h);
 
-extern ULONGLONG g_stat_mem_size;
+//The statistics of memory pools. They are updated atomically, thus pools
+//can be created and deleted by several threads.
+//The byte size of chunks that allocated by malloc.
+extern std::atomic<ULONGLONG> g_stat_mem_size;
+
+//The number of chunks that reused from chunk cache.
+extern std::atomic<ULONGLONG> g_stat_chunk_reuse_num;
 
 } //namespace xcom
 
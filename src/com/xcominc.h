@@ -6,6 +6,8 @@
 
 //libxcom
 #include <math.h>
+#include <atomic>
+#include <mutex>
 #include "ltype.h"
 #include "spec_type.h"
 #include "diagnostic.h"
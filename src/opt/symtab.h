@@ -246,136 +246,299 @@ public:
 };
 //END SymTabHash
 
-
 //
-//START SymTabBase based on Hash
+//START SymTabBase
 //
-class CompareFuncSymTab {
-    COPY_CONSTRUCTOR(CompareFuncSymTab);
-protected:
-    CHAR * xstrdup(CHAR const* s)
-    {
-        if (s == nullptr) {
-            return nullptr;
-        }
-        size_t l = ::strlen(s);
-        CHAR * ns = (CHAR*)smpoolMalloc(l + 1, m_pool);
-        ::memcpy(ns, s, l);
-        ns[l] = 0;
-        return ns;
-    }
+//The iterator walks through symbols in the order that they were added.
+template <class SymType>
+class SymTabBaseIter {
 public:
-    SMemPool * m_pool;
+    VecIdx m_pos;
+    bool m_is_end;
 public:
-    CompareFuncSymTab() {}
-
-    bool is_less(Sym const* t1, Sym const* t2) const
-    { return ::strcmp(SYM_name(t1), SYM_name(t2)) < 0; }
+    SymTabBaseIter() { clean(); }
 
-    bool is_equ(Sym const* t1, Sym const* t2) const
-    { return ::strcmp(SYM_name(t1), SYM_name(t2)) == 0; }
+    void clean() { m_pos = VEC_UNDEF; m_is_end = false; }
 
-    //Note the function createKey() will modify parameter's contents, thus the
-    //'const' qualifier is unusable.
-    Sym * createKey(Sym * t)
-    {
-        SYM_name(t) = xstrdup(SYM_name(t));
-        return t;
-    }
+    //Return true if the iteration is at the end.
+    bool end() const { return m_is_end; }
 };
 
 
-//Note the symbol might be modified by CompareFuncSymTab::createKey(), thus the
-//'const' qualifier of 'SymType*' is unusable.
-template <class SymType>
-class SymTabBaseIter : public xcom::TTabIter<SymType*> {};
+//The initial number of slots of SymTabBase, it must be power of 2.
+#define SYMTAB_INIT_SLOT_NUM 256
+
+//The byte size of the block that string arena allocates from pool.
+#define SYMTAB_ARENA_BLOCK_SIZE 8192
+
+//The slot that indicates the symbol has been removed.
+#define SYMTAB_REMOVED_SYM ((SymType*)(size_t)1)
 
-template <class SymType, class CompareFuncType>
-class SymTabBase : public xcom::TTab<SymType*, CompareFuncType> {
+//The symbol table interns strings via an open addressing hash table.
+//Each slot records the 64-bit hash value and the byte length of the string
+//next to the symbol, thus probing compares the bytes of string only if both
+//of them are equal. Symbols and the bytes of strings are bump-allocated in
+//blocks of pool, which will not be freed until the table destroyed.
+//Since a string is interned only once, the symbols that have the same string
+//can be compared by pointer.
+//NOTE: Sym regards the string as terminated by '\0', whereas ESym regards
+//the given byte length as the length of string. e.g: given "ab\0c", the
+//length of Sym is 2, the length of ESym is 4.
+template <class SymType>
+class SymTabBase {
     COPY_CONSTRUCTOR(SymTabBase);
 protected:
-    SymType * m_free_one;
+    class Slot {
+    public:
+        UINT64 hash;
+        UINT len; //the byte length of string.
+        UINT idx; //the index of symbol in 'm_sym_vec'.
+        SymType * sym; //nullptr indicates the slot is empty.
+    };
+    bool m_is_dup_string; //true to copy string into the table.
+    bool m_is_len_sensitive; //true if '\0' may be part of string.
+    UINT m_slot_num; //the number of slots, always be power of 2.
+    UINT m_elem_num; //the number of symbols in the table.
+    UINT m_used_num; //the number of non-empty slots, include removed ones.
+    Slot * m_slot;
+    BYTE * m_arena_pos;
+    BYTE * m_arena_end;
     SMemPool * m_pool;
+    xcom::Vector<SymType*> m_sym_vec; //record symbols in adding order.
+protected:
+    void * allocBytes(size_t size, size_t align);
+    SymType * allocSym(CHAR const* s, UINT len);
+
+    //Return the slot of given string, or the empty slot that the string
+    //should be placed in.
+    Slot * findSlot(CHAR const* s, UINT len, UINT64 hashv) const;
+    UINT getKeyLen(CHAR const* s, UINT slen) const
+    { return m_is_len_sensitive ? slen : (UINT)::strlen(s); }
+    void grow();
 public:
-    SymTabBase()
-    {
-        m_pool = smpoolCreate(64, MEM_COMM);
-        m_free_one = nullptr;
-        xcom::TTab<SymType*, CompareFuncType>::m_ck.m_pool = m_pool;
-        ASSERT0(m_pool);
-    }
-    virtual ~SymTabBase() { smpoolDelete(m_pool); }
+    SymTabBase(bool is_dup_string, bool is_len_sensitive);
+    virtual ~SymTabBase();
 
     //Add const string into symbol table.
-    SymType const* add(CHAR const* s);
+    SymType const* add(CHAR const* s) { return add(s, (UINT)::strlen(s)); }
 
     //Add const string into symbol table.
     //NOTE slen may be longer than the result of strlen(s).
     //e.g: given s is "ab\0c", slen is 4.
-    SymType const* add(CHAR const* s, UINT slen);
+    SymType const* add(CHAR const* s, UINT slen)
+    {
+        UINT len = getKeyLen(s, slen);
+        return add(s, len, computeHash(s, len));
+    }
+
+    //Add const string into symbol table with the hash value that has been
+    //computed by computeHash(), e.g: the lexer computes the hash value of
+    //identifier while scanning.
+    //slen: byte length of string, it must be equal to strlen(s) if the table
+    //      is not length sensitive.
+    SymType const* add(CHAR const* s, UINT slen, UINT64 hashv);
+
+    //Compute the hash value of string that used by symbol table.
+    static UINT64 computeHash(CHAR const* s, UINT slen)
+    { return xcom::hash64bitString(s, slen); }
 
     //Find const string in symbol table.
     //Return the Symbol if string existed.
-    SymType * find(CHAR const* s) const;
+    SymType * find(CHAR const* s) const
+    {
+        ASSERT0(s);
+        UINT len = (UINT)::strlen(s);
+        return find(s, len, computeHash(s, len));
+    }
+    SymType * find(CHAR const* s, UINT slen, UINT64 hashv) const
+    {
+        ASSERT0(s);
+        Slot const* slot = findSlot(s, slen, hashv);
+        return slot->sym;
+    }
+
+    UINT get_elem_count() const { return m_elem_num; }
+
+    //Iterate symbols in the order that they were added.
+    SymType * get_first(SymTabBaseIter<SymType> & iter) const
+    {
+        iter.clean();
+        return get_next(iter);
+    }
+    SymType * get_next(SymTabBaseIter<SymType> & iter) const;
 
     //Remove const string from symbol table.
     void remove(CHAR const* s);
 };
 
-//Add const string into symbol table.
-template <class SymType, class CompareFuncType>
-SymType const* SymTabBase<SymType, CompareFuncType>::add(CHAR const* s)
+
+template <class SymType>
+SymTabBase<SymType>::SymTabBase(bool is_dup_string, bool is_len_sensitive)
 {
-    return add(s, (UINT)::strlen(s));
+    m_is_dup_string = is_dup_string;
+    m_is_len_sensitive = is_len_sensitive;
+    m_slot_num = SYMTAB_INIT_SLOT_NUM;
+    m_elem_num = 0;
+    m_used_num = 0;
+    m_slot = (Slot*)::malloc(sizeof(Slot) * m_slot_num);
+    ASSERT0(m_slot);
+    ::memset((void*)m_slot, 0, sizeof(Slot) * m_slot_num);
+    m_arena_pos = nullptr;
+    m_arena_end = nullptr;
+    m_pool = smpoolCreate(SYMTAB_ARENA_BLOCK_SIZE, MEM_COMM);
+    ASSERT0(m_pool);
+    m_sym_vec.init();
 }
 
 
-//Add const string into symbol table.
-template <class SymType, class CompareFuncType>
-SymType const* SymTabBase<SymType, CompareFuncType>::add(
-    CHAR const* s, UINT slen)
+template <class SymType>
+SymTabBase<SymType>::~SymTabBase()
 {
-    ASSERT0(s);
-    SymType * sym = m_free_one;
-    if (sym == nullptr) {
-        sym = (SymType*)smpoolMalloc(sizeof(SymType), m_pool);
-        sym->init();
+    ::free(m_slot);
+    m_slot = nullptr;
+    smpoolDelete(m_pool);
+    m_pool = nullptr;
+    m_sym_vec.destroy();
+}
+
+
+template <class SymType>
+void * SymTabBase<SymType>::allocBytes(size_t size, size_t align)
+{
+    ASSERT0(xcom::isPowerOf2(align));
+    BYTE * p = (BYTE*)(((size_t)m_arena_pos + align - 1) & ~(align - 1));
+    if (m_arena_pos == nullptr || p + size > m_arena_end) {
+        if (size > SYMTAB_ARENA_BLOCK_SIZE / 4) {
+            //Big string does not waste the rest of current block.
+            return smpoolMalloc(size, m_pool);
+        }
+        m_arena_pos = (BYTE*)smpoolMalloc(SYMTAB_ARENA_BLOCK_SIZE, m_pool);
+        ASSERT0(m_arena_pos);
+        m_arena_end = m_arena_pos + SYMTAB_ARENA_BLOCK_SIZE;
+        p = m_arena_pos;
     }
-    sym->initByString(s, slen);
-    SymType const* appended_one =
-        xcom::TTab<SymType*, CompareFuncType>::append(sym);
-    ASSERT0(m_free_one == nullptr || m_free_one == sym);
-    if (appended_one != sym) {
-        //'s' has already been appended.
-        sym->clean();
-        m_free_one = sym;
-    } else {
-        //m_free_one has been inserted into table.
-        //'s' is a new string so far.
-        m_free_one = nullptr;
+    m_arena_pos = p + size;
+    return p;
+}
+
+
+template <class SymType>
+SymType * SymTabBase<SymType>::allocSym(CHAR const* s, UINT len)
+{
+    SymType * sym = (SymType*)allocBytes(sizeof(SymType), sizeof(void*));
+    sym->init();
+    if (m_is_dup_string) {
+        CHAR * ns = (CHAR*)allocBytes(len + 1, 1);
+        ::memcpy(ns, s, len);
+        ns[len] = 0;
+        s = ns;
+    }
+    sym->initByString(s, len);
+    return sym;
+}
+
+
+template <class SymType>
+typename SymTabBase<SymType>::Slot * SymTabBase<SymType>::findSlot(
+    CHAR const* s, UINT len, UINT64 hashv) const
+{
+    UINT mask = m_slot_num - 1;
+    for (UINT i = (UINT)hashv & mask;; i = (i + 1) & mask) {
+        Slot * slot = &m_slot[i];
+        if (slot->sym == nullptr) { return slot; }
+        if (slot->hash == hashv && slot->len == len &&
+            slot->sym != SYMTAB_REMOVED_SYM &&
+            ::memcmp(slot->sym->getStr(), s, len) == 0) {
+            return slot;
+        }
+    }
+    UNREACHABLE();
+    return nullptr;
+}
+
+
+template <class SymType>
+void SymTabBase<SymType>::grow()
+{
+    Slot * old = m_slot;
+    UINT old_num = m_slot_num;
+    if (m_elem_num * 4 >= m_slot_num) {
+        //Extend the table if it is not full of removed slots.
+        m_slot_num *= 2;
+    }
+    m_slot = (Slot*)::malloc(sizeof(Slot) * m_slot_num);
+    ASSERT0(m_slot);
+    ::memset((void*)m_slot, 0, sizeof(Slot) * m_slot_num);
+    UINT mask = m_slot_num - 1;
+    for (UINT i = 0; i < old_num; i++) {
+        if (old[i].sym == nullptr || old[i].sym == SYMTAB_REMOVED_SYM) {
+            continue;
+        }
+        UINT j = (UINT)old[i].hash & mask;
+        while (m_slot[j].sym != nullptr) { j = (j + 1) & mask; }
+        m_slot[j] = old[i];
     }
-    return appended_one;
+    m_used_num = m_elem_num;
+    ::free(old);
 }
 
 
-//Find const string in symbol table.
-template <class SymType, class CompareFuncType>
-SymType * SymTabBase<SymType, CompareFuncType>::find(CHAR const* s) const
+template <class SymType>
+SymType const* SymTabBase<SymType>::add(
+    CHAR const* s, UINT slen, UINT64 hashv)
 {
     ASSERT0(s);
-    SymType sym;
-    SYM_name(&sym) = const_cast<CHAR*>(s);
-    bool find = false;
-    return xcom::TTab<SymType*, CompareFuncType>::get(&sym, &find);
+    ASSERT0(m_is_len_sensitive || slen == ::strlen(s));
+    ASSERT0(hashv == computeHash(s, slen));
+    Slot * slot = findSlot(s, slen, hashv);
+    if (slot->sym != nullptr) { return slot->sym; }
+
+    //Keep the load factor less than 1/2.
+    if ((m_used_num + 1) * 2 > m_slot_num) {
+        grow();
+        slot = findSlot(s, slen, hashv);
+        ASSERT0(slot->sym == nullptr);
+    }
+    SymType * sym = allocSym(s, slen);
+    slot->hash = hashv;
+    slot->len = slen;
+    slot->idx = m_sym_vec.get_elem_count();
+    slot->sym = sym;
+    m_sym_vec.set(slot->idx, sym);
+    m_elem_num++;
+    m_used_num++;
+    return sym;
 }
 
 
-template <class SymType, class CompareFuncType>
-void SymTabBase<SymType, CompareFuncType>::remove(CHAR const* s)
+template <class SymType>
+SymType * SymTabBase<SymType>::get_next(SymTabBaseIter<SymType> & iter) const
 {
-    SymType * sym = find(s);
-    if (sym == nullptr) { return; }
-    xcom::TTab<SymType*, CompareFuncType>::remove(sym);
+    VecIdx i = iter.m_pos == VEC_UNDEF ? 0 : iter.m_pos + 1;
+    for (; i <= m_sym_vec.get_last_idx(); i++) {
+        SymType * sym = m_sym_vec.get((UINT)i);
+        if (sym != nullptr) {
+            iter.m_pos = i;
+            return sym;
+        }
+    }
+    iter.m_pos = m_sym_vec.get_last_idx();
+    iter.m_is_end = true;
+    return nullptr;
+}
+
+
+template <class SymType>
+void SymTabBase<SymType>::remove(CHAR const* s)
+{
+    ASSERT0(s);
+    UINT len = (UINT)::strlen(s);
+    Slot * slot = findSlot(s, len, computeHash(s, len));
+    if (slot->sym == nullptr) { return; }
+    m_sym_vec.set(slot->idx, nullptr);
+    slot->sym = SYMTAB_REMOVED_SYM;
+    ASSERT0(m_elem_num > 0);
+    m_elem_num--;
 }
 //END SymTabBase
 
@@ -383,11 +546,11 @@ void SymTabBase<SymType, CompareFuncType>::remove(CHAR const* s)
 //
 //START SymTab
 //
-class SymTabIter : public SymTabBaseIter<Sym>  {};
-class SymTab : public SymTabBase<Sym, CompareFuncSymTab> {
+class SymTabIter : public SymTabBaseIter<Sym> {};
+class SymTab : public SymTabBase<Sym> {
     COPY_CONSTRUCTOR(SymTab);
 public:
-    SymTab() {}
+    SymTab() : SymTabBase<Sym>(true, false) {}
     void dump(MOD LogMgr * lm) const;
 };
 //END SymTab
@@ -396,81 +559,26 @@ public:
 //
 //START SymTabWithoutDupString
 //
-class CompareFuncSymTabWithoutDupString : public CompareFuncSymTab {
-    COPY_CONSTRUCTOR(CompareFuncSymTabWithoutDupString);
-public:
-    CompareFuncSymTabWithoutDupString() {}
-
-    //No need to copy string.
-    Sym * createKey(Sym * t) { return t; }
-};
-
-
+//The symbol table refers to the string that given by caller rather than
+//copying it, thus the string must be alive as long as the table.
 class SymTabWithoutDupStringIter : public SymTabBaseIter<Sym> {};
-class SymTabWithoutDupString
-    : public SymTabBase<Sym, CompareFuncSymTabWithoutDupString> {
+class SymTabWithoutDupString : public SymTabBase<Sym> {
     COPY_CONSTRUCTOR(SymTabWithoutDupString);
 public:
-    SymTabWithoutDupString() {}
+    SymTabWithoutDupString() : SymTabBase<Sym>(false, false) {}
     void dump(MOD LogMgr * lm) const;
 };
 //END SymTabWithoutDupString
 
 
-//The class represents the comparison bewteen two ESym.
-class CompareFuncESymTab {
-    COPY_CONSTRUCTOR(CompareFuncESymTab);
-protected:
-    CHAR * xstrdup(CHAR const* s, UINT slen)
-    {
-        if (s == nullptr) { return nullptr; }
-        CHAR * ns = (CHAR*)smpoolMalloc(slen + 1, m_pool);
-        ::memcpy(ns, s, slen);
-        ns[slen] = 0;
-        return ns;
-    }
-public:
-    SMemPool * m_pool;
-public:
-    CompareFuncESymTab() {}
-
-    bool is_less(ESym const* t1, ESym const* t2) const
-    {
-        ASSERT0(t1 && t2);
-        ASSERT0(t1->verify() && t2->verify());
-        return t1->getLen() < t2->getLen() ||
-               (t1->getLen() == t2->getLen() &&
-                ::memcmp(ESYM_name(t1), ESYM_name(t2), t1->getLen()) < 0);
-    }
-
-    bool is_equ(ESym const* t1, ESym const* t2) const
-    {
-        ASSERT0(t1 && t2);
-        ASSERT0(t1->verify() && t2->verify());
-        return t1->getLen() == t2->getLen() &&
-               ::memcmp(ESYM_name(t1), ESYM_name(t2), t1->getLen()) == 0;
-    }
-
-    //Note the function createKey() will modify parameter's contents, thus the
-    //'const' qualifier is unusable.
-    ESym * createKey(ESym * t)
-    {
-        ASSERT0(t && t->verify());
-        ESYM_name(t) = xstrdup(t->getStr(), t->getLen());
-        ESYM_len(t) = t->getLen();
-        return t;
-    }
-};
-
-
 //
 //START ESymTab
 //
 class ESymTabIter : public SymTabBaseIter<ESym>  {};
-class ESymTab : public xoc::SymTabBase<ESym, CompareFuncESymTab> {
+class ESymTab : public xoc::SymTabBase<ESym> {
     COPY_CONSTRUCTOR(ESymTab);
 public:
-    ESymTab() {}
+    ESymTab() : SymTabBase<ESym>(true, true) {}
     void dump(MOD LogMgr * lm) const;
 };
 //END ESymTab
@@ -0,0 +1,65 @@
+/*
+Probes of -fold_const. Compile with
+
+    xocfe.exe test_fold_const.c -fold_const -dump fold.dump
+
+and check the trees of each function in the dump, the comment of each
+statement gives the expected result.
+*/
+int g(int);
+
+/* The operations whose result is undefined are not folded. */
+void undefined_op(void)
+{
+    int a = 0x7fffffff + 1;                 /* kept */
+    int b = -0x7fffffff - 2;                /* kept */
+    int c = 0x10000 * 0x10000;              /* kept */
+    int d = 1 << 31;                        /* kept */
+    int e = 3 << 30;                        /* kept */
+    int f = -1 << 1;                        /* kept */
+    int h = 1 << 32;                        /* kept */
+    int i = 1 << -1;                        /* kept */
+    int j = (-0x7fffffff - 1) / -1;         /* kept */
+    int k = (-0x7fffffff - 1) % -1;         /* kept */
+    int l = 5 / 0;                          /* kept */
+    long long m = 0x7fffffffffffffffLL + 1; /* kept */
+    long long n = 0x4000000000000000LL * 2; /* kept */
+    long long o = 1LL << 63;                /* kept */
+}
+
+/* The operations whose result is defined are folded. */
+void defined_op(void)
+{
+    int a = 0x7ffffffe + 1;                 /* 2147483647 */
+    int b = -0x7fffffff - 1;                /* -2147483648 */
+    int c = 1 << 30;                        /* 1073741824 */
+    unsigned d = 1u << 31;                  /* 2147483648 */
+    unsigned e = 0xffffffffu + 1;           /* 0 */
+    int f = -8 >> 1;                        /* -4 */
+    long long h = 1LL << 62;                /* 4611686018427387904 */
+    long long i = 0x7fffffff + 1LL;         /* 2147483648 */
+    int j = (int)(1u << 31);                /* -2147483648 */
+}
+
+
+/* The dead branches, and their scopes, are removed. */
+void dead_branch(int x)
+{
+    if (0) { int dead_if; g(1); }           /* removed */
+    if (1) g(2); else { int dead_else; g(3); }  /* g(2) */
+    while (0) { int dead_while; g(4); }     /* removed */
+    do { int live_do; g(5); } while (0);    /* the body */
+    if (0) { L: g(6); }                     /* kept, it has label */
+    do { if (x) break; g(7); } while (0);   /* kept, it breaks loop */
+    goto L;
+}
+
+
+/* The result type of '?:' and '!' follows C rather than the tree type. */
+void mixed_type(void)
+{
+    double z = (1 ? 1 : 2.0) / 2;           /* kept, arms differ in type */
+    int y = (0 ? 1 : 2) * 3;                /* 6 */
+    int n = !0.5;                           /* 0, an int literal */
+    double m = !0.0;                        /* 1, an int literal */
+}
@@ -0,0 +1,60 @@
+/*
+Probes of -prec_climbing. Compile with
+
+    xocfe.exe test_prec_climbing.c -dump chain.dump
+    xocfe.exe test_prec_climbing.c -prec_climbing -dump climb.dump
+
+the two dumps and the diagnostics must be identical. The comment of each
+statement gives the expected grouping.
+*/
+struct S { int f; int a[4]; };
+
+int precedence(int a, int b, int c, int d, struct S * s)
+{
+    int x;
+    x = a || b && c;                /* a || (b && c) */
+    x = a && b | c;                 /* a && (b | c) */
+    x = a | b ^ c;                  /* a | (b ^ c) */
+    x = a ^ b & c;                  /* a ^ (b & c) */
+    x = a & b == c;                 /* a & (b == c) */
+    x = a == b < c;                 /* a == (b < c) */
+    x = a != b >= c;                /* a != (b >= c) */
+    x = a < b << c;                 /* a < (b << c) */
+    x = a > b >> c;                 /* a > (b >> c) */
+    x = a << b + c;                 /* a << (b + c) */
+    x = a - b * c;                  /* a - (b * c) */
+    x = a + b / c % d;              /* a + ((b / c) % d) */
+    x = a * b + c * d;              /* (a * b) + (c * d) */
+    x = a | b & c ^ d;              /* a | ((b & c) ^ d) */
+    x = a < b == c > d;             /* (a < b) == (c > d) */
+    return x;
+}
+
+int associativity(int a, int b, int c, int d)
+{
+    int x;
+    x = a - b - c - d;              /* ((a - b) - c) - d */
+    x = a / b / c;                  /* (a / b) / c */
+    x = a << b << c;                /* (a << b) << c */
+    x = a < b < c;                  /* (a < b) < c */
+    x = a == b != c;                /* (a == b) != c */
+    x = a || b || c;                /* (a || b) || c */
+    x = a && b && c;                /* (a && b) && c */
+    x = a = b = c;                  /* a = (b = c) */
+    x = a ? b : c ? d : a;          /* a ? b : (c ? d : a) */
+    return x;
+}
+
+int operand(int a, int b, long c, struct S * s, int * p)
+{
+    int x;
+    x = -a * !b + ~a;               /* ((-a) * (!b)) + (~a) */
+    x = (int)c + a * (b - a);       /* ((int)c) + (a * (b - a)) */
+    x = *p + p[1] * s->f;           /* (*p) + (p[1] * s->f) */
+    x = sizeof(int) * a + s->a[2];  /* ((sizeof(int)) * a) + s->a[2] */
+    x = a++ + ++b - a--;            /* ((a++) + (++b)) - (a--) */
+    x = a + b ? a - b : a * b;      /* (a + b) ? (a - b) : (a * b) */
+    x = (a, b + c);                 /* a, (b + c) */
+    x += a | b;                     /* x += (a | b) */
+    return x;
+}